@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_AUDIO_ANALYZER_H
+#define SOLARUSEDITOR_AUDIO_ANALYZER_H
+
+#include <solarus/core/ResourceType.h>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+namespace SolarusEditor {
+
+class Quest;
+
+using ResourceType = Solarus::ResourceType;
+
+/**
+ * @brief Computes properties of the sound and music files of a quest.
+ *
+ * Files are decoded in background threads without any audio device:
+ * Ogg Vorbis files with vorbisfile and Impulse Tracker files with ModPlug.
+ * SPC files are not decoded, only their size is known.
+ *
+ * Results are kept in memory and in the .editor-cache directory of the
+ * quest, and are computed again when the file is modified.
+ *
+ * This class must only be used from the main thread.
+ */
+class AudioAnalyzer : public QObject {
+  Q_OBJECT
+
+public:
+
+  /**
+   * @brief Properties of a sound or music file computed by decoding it.
+   */
+  struct Analysis {
+    QString format;                     /**< Name of the file format. */
+    bool decoded;                       /**< Whether the samples could be decoded. */
+    qint64 file_size;                   /**< Size of the file in bytes. */
+    qint64 duration;                    /**< Duration in milliseconds. */
+    qint32 sample_rate;                 /**< Samples per second and per channel. */
+    qint32 num_channels;                /**< Number of channels. */
+    double peak;                        /**< Peak level in dBFS. */
+    double rms;                         /**< RMS level in dBFS. */
+    qint64 decoded_size;                /**< Size of all decoded samples in bytes. */
+    qint64 loop_start;                  /**< LOOPSTART of an Ogg file in samples
+                                         * per channel, or -1. */
+    qint64 loop_end;                    /**< LOOPEND of an Ogg file in samples
+                                         * per channel, or -1. */
+  };
+
+  explicit AudioAnalyzer(const Quest& quest, QObject* parent = nullptr);
+  ~AudioAnalyzer();
+
+  bool get_analysis(const QString& path, Analysis& analysis);
+  void request_analysis(const QStringList& paths);
+  bool is_busy() const;
+  void clear();
+
+  static qint64 get_memory_size(ResourceType resource_type, const Analysis& analysis);
+  static QString get_summary(ResourceType resource_type, const Analysis& analysis);
+  static QString format_duration(qint64 duration);
+  static QString format_level(double level);
+  static QString format_loop(const Analysis& analysis);
+
+signals:
+
+  void analysis_ready(const QString& path);
+  void all_analyses_ready();
+
+private slots:
+
+  void result_ready(int index);
+  void job_finished();
+
+private:
+
+  /**
+   * @brief A file to analyze.
+   */
+  struct Request {
+    const Quest* quest;                 /**< The quest. */
+    QString path;                       /**< Path of the audio file. */
+  };
+
+  /**
+   * @brief The analysis of a file.
+   */
+  struct Result {
+    QString path;                       /**< Path of the audio file. */
+    qint64 last_modified;               /**< Date of the file when analyzed. */
+    Analysis analysis;                  /**< Properties of the file. */
+  };
+
+  static Result analyze(const Request& request);
+  void start_job();
+
+  const Quest& quest;                   /**< The quest. */
+  QHash<QString, Result> results;       /**< Known analyses by path. */
+  QStringList pending_paths;            /**< Files waiting for the next job. */
+  QSet<QString> queued_paths;           /**< Files pending or being analyzed. */
+  QFutureWatcher<Result> job;           /**< Analyses in progress. */
+
+};
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_AUDIO_DECODER_H
+#define SOLARUSEDITOR_AUDIO_DECODER_H
+
+#include <QByteArray>
+#include <functional>
+
+class QMutex;
+
+namespace SolarusEditor {
+
+/**
+ * @brief Decodes audio files into raw samples without any audio device.
+ */
+namespace AudioDecoder {
+
+/**
+ * @brief Raw samples of a decoded audio file.
+ *
+ * Samples are signed 16-bit integers in native byte order, interleaved
+ * when there are several channels.
+ */
+struct DecodedAudio {
+
+  DecodedAudio();
+
+  QByteArray samples;            /**< The decoded samples. */
+  int num_channels;              /**< Number of channels (1 or 2). */
+  int sample_rate;               /**< Number of samples per second and per channel. */
+  qint64 loop_start;             /**< LOOPSTART comment of an Ogg file in samples
+                                  * per channel, or -1. */
+  qint64 loop_end;               /**< LOOPEND comment of an Ogg file in samples
+                                  * per channel, or -1. */
+};
+
+/**
+ * @brief Function receiving chunks of decoded samples.
+ *
+ * The first parameter is the samples, interleaved like in DecodedAudio,
+ * the second one is their number.
+ */
+using SampleCallback = std::function<void (const qint16*, int)>;
+
+QMutex& get_modplug_mutex();
+
+bool decode_ogg(const QByteArray& data, DecodedAudio& audio,
+                const SampleCallback& callback = SampleCallback());
+bool decode_it(const QByteArray& data, DecodedAudio& audio,
+               const SampleCallback& callback = SampleCallback());
+
+}
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_AUDIO_PLAYER_H
+#define SOLARUSEDITOR_AUDIO_PLAYER_H
+
+#include <QCache>
+#include <QDateTime>
+#include <QObject>
+#include <vector>
+
+class QTimer;
+
+namespace SolarusEditor {
+
+/**
+ * @brief Plays sounds and musics of a quest in a dedicated thread.
+ *
+ * The player is meant to be moved to its own thread. All its slots must be
+ * invoked from there, typically with queued connections, so that decoding
+ * files never blocks the GUI.
+ *
+ * The quest stays mounted on the engine's side between two playbacks.
+ * Sounds are decoded once and kept in a least-recently-used cache whose
+ * total size of decoded samples is limited.
+ * Musics are played and streamed by the Solarus sound system, which is
+ * updated regularly from this thread.
+ * Calls to the engine that may touch a music hold the ModPlug lock of
+ * AudioDecoder, because the audio analyzer may decode an Impulse Tracker
+ * file at the same time.
+ */
+class AudioPlayer : public QObject {
+  Q_OBJECT
+
+public:
+
+  explicit AudioPlayer(QObject* parent = nullptr);
+
+public slots:
+
+  void initialize();
+  void quit();
+
+  void play_sound(const QString& root_path, const QString& sound_id);
+  void play_music(const QString& root_path, const QString& music_id);
+  void stop_music();
+  void close_quest();
+
+private slots:
+
+  void update_sound_system();
+
+private:
+
+  /**
+   * @brief A decoded sound stored in an OpenAL buffer.
+   */
+  struct CachedSound {
+
+    CachedSound(unsigned buffer, const std::vector<unsigned>& sources);
+    ~CachedSound();
+
+    unsigned buffer;                        /**< OpenAL buffer with the samples. */
+    const std::vector<unsigned>& sources;   /**< Sources that may play the buffer. */
+    QDateTime last_modified;                /**< Date of the file when it was decoded. */
+  };
+
+  bool mount_quest(const QString& root_path);
+  CachedSound* get_sound(const QString& sound_id);
+  unsigned get_free_source();
+
+  QTimer* update_timer;                     /**< Updates the Solarus sound system. */
+  QString program_name;                     /**< Program name given to the engine. */
+  QString mounted_root_path;                /**< Quest currently mounted if any. */
+  QCache<QString, CachedSound> sounds;      /**< Decoded sounds by id,
+                                             * the cost being their size in bytes. */
+  std::vector<unsigned> sources;            /**< OpenAL sources to play sounds. */
+  size_t next_source_index;                 /**< Source to reuse if all are busy. */
+
+};
+
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_AUDIO_REPORT_MODEL_H
+#define SOLARUSEDITOR_AUDIO_REPORT_MODEL_H
+
+#include "audio_analyzer.h"
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QList>
+
+namespace SolarusEditor {
+
+class Quest;
+
+/**
+ * @brief Model of the properties of all sounds and musics of a quest.
+ *
+ * Each row is a sound or a music. Rows are filled as the audio analyzer
+ * of the quest finishes analyzing their file.
+ *
+ * The Qt::UserRole of each cell contains a value suitable for sorting.
+ */
+class AudioReportModel : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+
+  /**
+   * @brief Columns of the model.
+   */
+  enum Column {
+    TYPE_COLUMN,
+    ID_COLUMN,
+    FORMAT_COLUMN,
+    DURATION_COLUMN,
+    LOOP_COLUMN,
+    SAMPLE_RATE_COLUMN,
+    CHANNELS_COLUMN,
+    PEAK_COLUMN,
+    RMS_COLUMN,
+    FILE_SIZE_COLUMN,
+    MEMORY_COLUMN,
+    NUM_COLUMNS
+  };
+
+  explicit AudioReportModel(Quest& quest, QObject* parent = nullptr);
+
+  void reload();
+  ResourceType get_resource_type(int row) const;
+  QString get_element_id(int row) const;
+  int get_num_pending() const;
+  qint64 get_total_memory_size(ResourceType resource_type) const;
+
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private slots:
+
+  void analysis_ready(const QString& path);
+
+private:
+
+  /**
+   * @brief A sound or a music.
+   */
+  struct Row {
+    ResourceType resource_type;         /**< SOUND or MUSIC. */
+    QString element_id;                 /**< Id of the resource element. */
+    QString path;                       /**< Path of its file. */
+    bool analyzed;                      /**< Whether the analysis is known. */
+    AudioAnalyzer::Analysis analysis;   /**< Properties of the file. */
+  };
+
+  Quest& quest;                         /**< The quest. */
+  QList<Row> rows;                      /**< All sounds and musics. */
+  QHash<QString, int> rows_by_path;     /**< Row of each file. */
+
+};
+
+}
+
+#endif
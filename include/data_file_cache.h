@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_DATA_FILE_CACHE_H
+#define SOLARUSEDITOR_DATA_FILE_CACHE_H
+
+#include <QString>
+#include <functional>
+
+class QDataStream;
+
+namespace Solarus {
+
+class MapData;
+
+}
+
+namespace SolarusEditor {
+
+class Quest;
+
+/**
+ * @brief Binary snapshots of parsed data files.
+ *
+ * Snapshots are stored in the .editor-cache directory of the quest.
+ * Each one records the path, size and modification date of its data file
+ * and the editor version that wrote it. A snapshot is only used if all of
+ * them still match, so it never needs to be invalidated explicitly.
+ *
+ * Map snapshots are handled here. Other kinds of snapshots, like map
+ * thumbnails or audio analyses, are read and written by the classes that
+ * compute them, with read_snapshot() and write_snapshot().
+ *
+ * Failures to read or write snapshots are silently ignored:
+ * the data file is then parsed as usual.
+ */
+namespace DataFileCache {
+
+/**
+ * @brief Function that reads or writes the content of a snapshot
+ * after its header.
+ */
+using SnapshotFunction = std::function<void (QDataStream&)>;
+
+bool load_map(const Quest& quest, const QString& path, Solarus::MapData& map);
+bool load_map_data(const Quest& quest, const QString& path, Solarus::MapData& map);
+void save_map(const Quest& quest, const QString& path, const Solarus::MapData& map);
+
+bool read_snapshot(
+    const Quest& quest,
+    const QString& path,
+    const QString& kind,
+    const SnapshotFunction& read_content
+);
+void write_snapshot(
+    const Quest& quest,
+    const QString& path,
+    const QString& kind,
+    const SnapshotFunction& write_content
+);
+
+}
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_DATA_FILE_PARSER_H
+#define SOLARUSEDITOR_DATA_FILE_PARSER_H
+
+class QString;
+
+namespace Solarus {
+
+class DialogResources;
+class MapData;
+class QuestDatabase;
+class StringResources;
+
+}
+
+namespace SolarusEditor {
+
+/**
+ * @brief Native parser of Solarus data files.
+ *
+ * Data files are Lua scripts, but the ones written by Solarus only contain
+ * a sequence of calls like <tt>name{ key = value, ... }</tt> with literal
+ * values. These functions read such files directly without creating a Lua
+ * state, which is much faster.
+ *
+ * They give up on anything outside this restricted grammar or on any value
+ * they cannot validate exactly like the Lua loader does.
+ * In this case they return @c false without modifying the data and the
+ * caller should load the file with the Lua loader of Solarus instead.
+ *
+ * Tilesets and sprites are not supported: their loaders validate frame lists
+ * and enumerated values with rules that would have to be replicated here,
+ * and they are few compared to maps, so they always use the Lua loader.
+ *
+ * The parser can be disabled at build time with the CMake option
+ * SOLARUSEDITOR_NATIVE_DATA_PARSER.
+ * The test data_file_parser_test checks that it gives the same results as
+ * the Lua loader on sample quests.
+ */
+namespace DataFileParser {
+
+bool import_map(const QString& path, Solarus::MapData& map);
+bool import_strings(const QString& path, Solarus::StringResources& strings);
+bool import_dialogs(const QString& path, Solarus::DialogResources& dialogs);
+bool import_quest_database(const QString& path, Solarus::QuestDatabase& database);
+
+}
+
+}
+
+#endif
@@ -133,7 +133,7 @@ public slots:
 private:
 
   void build_dialog_tree();
-  void clear_translation_from_tree();
+  void set_translation_resources(Solarus::DialogResources translation);
 
   const Quest& quest;             /**< The quest the dialogs belongs to. */
   const QString language_id;      /**< Language of the dialogs. */
@@ -38,6 +38,7 @@ public:
   static const QString save_files_before_running;
   static const QString no_audio;
   static const QString quest_size;
+  static const QString texture_budget;
 
   // Console keys.
   static const QString console_history;
@@ -58,6 +59,8 @@ public:
   static const QString map_grid_size;
   static const QString map_grid_style;
   static const QString map_grid_color;
+  static const QString map_lod_enabled;
+  static const QString map_lod_zoom;
   static const QString map_tileset_background;
   static const QString map_tileset_zoom;
 
@@ -73,6 +73,10 @@ public:
   void about_to_be_removed_from_map();
   void index_changed(const EntityIndex& index);
 
+  // Selection state, independent from graphic items.
+  bool is_selected() const;
+  void set_selected(bool selected);
+
   EntityType get_type() const;
   QString get_type_name() const;
   bool is_dynamic() const;
@@ -145,6 +149,7 @@ public:
 
   // Displaying in the editor.
   virtual void draw(QPainter& painter) const;
+  virtual void draw_low_detail(QPainter& painter, double level_of_detail) const;
   virtual void notify_tileset_changed(const QString& tileset_id);
 
   void reload_sprite();
@@ -253,6 +258,7 @@ private:
                                    * (could be a reference but we want operator=). */
   EntityIndex index;              /**< Index of this entity in the map.
                                    * When invalid, the entity is not added to the map yet. */
+  bool selected;                  /**< Whether the entity is selected in the map editor. */
   Solarus::EntityData stub;       /**< Stub of entity, used before it gets added to the map. */
   QString name;                   /**< Name of the entity. */
   QPoint origin;                  /**< Origin point of the entity relative to its top-left corner. */
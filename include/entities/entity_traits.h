@@ -20,6 +20,7 @@
 #include "enum_traits.h"
 #include <solarus/core/MapData.h>
 #include <solarus/entities/EntityType.h>
+#include <QColor>
 #include <QList>
 #include <memory>
 
@@ -45,6 +46,7 @@ public:
   static QList<EntityType> get_values();
   static QString get_friendly_name(EntityType value);
   static QIcon get_icon(EntityType value);
+  static QColor get_marker_color(EntityType value);
 
   static QString get_lua_name(EntityType value);
 
@@ -18,6 +18,7 @@
 #define SOLARUSEDITOR_TILE_H
 
 #include "entity_model.h"
+#include <array>
 
 namespace SolarusEditor {
 
@@ -37,6 +38,7 @@ public:
   const TilesetModel* get_tileset() const;
 
   void draw(QPainter& painter) const override;
+  void draw_low_detail(QPainter& painter, double level_of_detail) const override;
   void notify_tileset_changed(const QString& tileset_id) override;
 
 protected:
@@ -50,7 +52,12 @@ private:
   void update_pattern();
   ResizeMode get_pattern_resize_mode() const;
 
+  static constexpr int max_mipmap_level = 3;  /**< Smallest mipmap used in low detail. */
+
   mutable QPixmap pattern_image;     /**< Cached image of the tile pattern. */
+  mutable std::array<QPixmap, max_mipmap_level>
+      pattern_mipmaps;               /**< Cached downsampled images of the tile
+                                      * pattern, from level 1 to max_mipmap_level. */
 
 };
 
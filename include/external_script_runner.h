@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_EXTERNAL_SCRIPT_RUNNER_H
+#define SOLARUSEDITOR_EXTERNAL_SCRIPT_RUNNER_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+
+struct lua_Debug;
+struct lua_State;
+
+namespace SolarusEditor {
+
+/**
+ * @brief Runs an external Lua script in a worker thread.
+ *
+ * The script runs in its own Lua state with standard libraries.
+ * print() and io.write() are redirected to a thread-safe queue:
+ * the output_available() signal is emitted when new output can be
+ * retrieved with take_output().
+ *
+ * For require(), everything works as if the current directory was the one
+ * containing the script file, even if the script is a Qt resource.
+ *
+ * The script can be interrupted with cancel(): a Lua hook periodically
+ * checks the cancellation flag and raises an error.
+ * With LuaJIT, the JIT compiler is disabled in these states because
+ * compiled code does not run hooks.
+ *
+ * The script can also call run_tasks(tasks) to run independent calls of
+ * the form require(task.module).convert(unpack(task.args)) in parallel,
+ * each one in its own Lua state. It returns the number of tasks that failed
+ * and reports failures and timings to the output.
+ */
+class ExternalScriptRunner : public QThread {
+  Q_OBJECT
+
+public:
+
+  ExternalScriptRunner(const QString& script_path, const QString& script_arg,
+                       QObject* parent = nullptr);
+  ~ExternalScriptRunner();
+
+  bool is_successful() const;
+  bool is_canceled() const;
+  void cancel();
+
+  QString take_output();
+
+signals:
+
+  void output_available();
+
+protected:
+
+  void run() override;
+
+private:
+
+  /**
+   * @brief A call to run by run_tasks().
+   */
+  struct Task {
+    ExternalScriptRunner* runner;      /**< Runner that owns the task. */
+    QString stage;                     /**< Kind of task, like "maps". */
+    QString label;                     /**< Description of the task. */
+    QByteArray module;                 /**< Module whose convert() function to call. */
+    QList<QByteArray> args;            /**< Arguments, a null array meaning nil. */
+  };
+
+  /**
+   * @brief Outcome of a task.
+   */
+  struct TaskResult {
+    bool successful;                   /**< Whether the task succeeded. */
+    QString error;                     /**< Error message in case of failure. */
+    qint64 elapsed_ms;                 /**< Time spent in the task. */
+  };
+
+  static int l_write(lua_State* l);
+  static int l_print(lua_State* l);
+  static int l_flush(lua_State* l);
+  static int l_run_tasks(lua_State* l);
+  static void l_hook(lua_State* l, lua_Debug* ar);
+  static ExternalScriptRunner& get_runner(lua_State* l);
+
+  static TaskResult run_task(const Task& task);
+
+  lua_State* create_state();
+  int run_tasks(const QList<Task>& tasks);
+  void append_output(const QString& text);
+
+  QString script_path;                 /**< Lua script to run, without extension. */
+  QString script_arg;                  /**< Optional argument to pass to the script. */
+  QAtomicInt successful;               /**< Whether the script is successfully finished. */
+  QAtomicInt cancel_requested;         /**< Whether the script should stop. */
+
+  mutable QMutex output_mutex;         /**< Protects the output queue. */
+  QStringList output;                  /**< Output not retrieved yet. */
+
+};
+
+}
+
+#endif
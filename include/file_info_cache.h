@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_FILE_INFO_CACHE_H
+#define SOLARUSEDITOR_FILE_INFO_CACHE_H
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+namespace SolarusEditor {
+
+/**
+ * @brief Cache of the existence, type, size and modification date of files.
+ *
+ * Information is read from the filesystem the first time a path is requested
+ * and then kept until a QFileSystemWatcher reports a change of its parent
+ * directory, or until invalidate() is called.
+ * Only directories are watched, so that the number of watches does not grow
+ * with the number of files. As a consequence, the size and date of a file
+ * modified in place may be outdated until invalidate() is called.
+ * Paths whose parent directory does not exist are cached as missing and
+ * invalidated by a change of their nearest existing ancestor directory.
+ * Paths with no ancestor directory that can be watched are not cached.
+ *
+ * This is intended for code called very often like painting or item views.
+ * Code that modifies files and immediately checks the result should query
+ * the filesystem directly instead.
+ *
+ * This class must only be used from the main thread.
+ */
+class FileInfoCache : public QObject {
+  Q_OBJECT
+
+public:
+
+  explicit FileInfoCache(QObject* parent = nullptr);
+
+  bool exists(const QString& path) const;
+  bool is_dir(const QString& path) const;
+  qint64 get_size(const QString& path) const;
+  QDateTime get_last_modified(const QString& path) const;
+
+  void invalidate(const QString& path);
+  void clear();
+
+private slots:
+
+  void directory_changed(const QString& path);
+
+private:
+
+  /**
+   * @brief Cached information about a path.
+   */
+  struct Entry {
+    bool exists;                             /**< Whether the path exists. */
+    bool is_dir;                             /**< Whether the path is a directory. */
+    qint64 size;                             /**< Size of the file in bytes. */
+    QDateTime last_modified;                 /**< Last modification date. */
+    QString watched_dir;                     /**< Watched directory whose changes
+                                              * invalidate this entry. */
+  };
+
+  Entry get_entry(const QString& path) const;
+  bool watch(const QString& path) const;
+  void remove_entry(const QString& path);
+
+  mutable QHash<QString, Entry> entries;     /**< Cached information by path. */
+  mutable QHash<QString, QSet<QString>>
+      children_by_dir;                       /**< Cached paths invalidated by each
+                                              * watched directory. */
+  mutable QSet<QString> watched_paths;       /**< Directories watched. */
+  mutable QFileSystemWatcher watcher;        /**< Detects changes in directories
+                                              * of cached paths. */
+
+};
+
+}
+
+#endif
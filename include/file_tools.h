@@ -17,6 +17,9 @@
 #ifndef SOLARUSEDITOR_FILE_TOOLS_H
 #define SOLARUSEDITOR_FILE_TOOLS_H
 
+#include <QtGlobal>
+#include <functional>
+
 class QRegularExpression;
 class QString;
 
@@ -30,7 +33,19 @@ namespace SolarusEditor {
  */
 namespace FileTools {
 
-void copy_recursive(const QString& src, const QString& dst);
+/**
+ * @brief Function called to report the progress of a long operation.
+ *
+ * The first parameter is the number of items done and the second one
+ * the total number of items.
+ */
+using ProgressCallback = std::function<void (int, int)>;
+
+void copy_recursive(
+    const QString& src,
+    const QString& dst,
+    const ProgressCallback& progress_callback = ProgressCallback()
+);
 void delete_recursive(const QString& path);
 void create_directories(const QString& path);
 
@@ -40,6 +55,8 @@ bool replace_in_file(
     const QString& replacement
 );
 
+QString format_size(qint64 size);
+
 void initialize_assets();
 QString get_assets_path();
 
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_IMAGE_STORE_H
+#define SOLARUSEDITOR_IMAGE_STORE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QImage>
+
+namespace SolarusEditor {
+
+/**
+ * @brief Images of a quest decoded once and shared by all users.
+ *
+ * Images are identified by their path, modification date and size:
+ * an image is decoded again only if its file has changed.
+ * Returned images are implicitly shared with the store, so loading the same
+ * PNG file many times costs no decoding and no extra memory.
+ *
+ * Images that are no longer used outside the store are kept as long as
+ * their total size stays under a limit, least recently used ones being
+ * released first.
+ *
+ * This class must only be used from the main thread.
+ */
+class ImageStore {
+
+public:
+
+  /**
+   * @brief Memory usage of the store.
+   */
+  struct Statistics {
+    int num_images;             /**< Number of images in the store. */
+    int num_used_images;        /**< Number of images also used outside the store. */
+    qint64 memory_size;         /**< Size in bytes of all decoded images. */
+    int num_requests;           /**< Number of images requested so far. */
+    int num_hits;               /**< Number of requests that needed no decoding. */
+  };
+
+  ImageStore();
+
+  QImage get_image(const QString& path);
+  Statistics get_statistics() const;
+  void clear();
+
+  static qint64 get_memory_size(const QImage& image);
+
+private:
+
+  /**
+   * @brief An image and the state of its file when it was decoded.
+   */
+  struct Entry {
+    QDateTime last_modified;    /**< Modification date of the file. */
+    qint64 file_size;           /**< Size of the file. */
+    QImage image;               /**< The decoded image. */
+    quint64 last_used;          /**< Request counter when last requested. */
+  };
+
+  void release_unused_images();
+
+  QHash<QString, Entry> entries;  /**< Images by path. */
+  quint64 num_requests;           /**< Number of images requested so far. */
+  quint64 num_hits;               /**< Number of requests that needed no decoding. */
+
+};
+
+}
+
+#endif
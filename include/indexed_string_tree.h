@@ -18,8 +18,9 @@
 #define SOLARUSEDITOR_INDEXED_STRING_TREE_H
 
 #include "natural_comparator.h"
+#include <QHash>
 #include <QString>
-#include <map>
+#include <vector>
 
 namespace SolarusEditor {
 
@@ -27,6 +28,10 @@ namespace SolarusEditor {
  * @brief Tree of indexed string keys.
  * This class provides methods to manage a map indexed by string like a tree
  * for a QAbstractItemModel (see StringsModel and DialogsModel).
+ *
+ * Children of a node are stored in a vector sorted in natural order and
+ * all nodes are hashed by their complete key, so that accessing a row or
+ * a key takes constant time.
  */
 class IndexedStringTree {
 
@@ -51,6 +56,7 @@ public:
   bool remove_key(const QString& key);
 
   bool add_ref(const QString &key, QString& parent_key, int& index);
+  bool add_ref(const QString &key);
 
   bool can_remove_ref(const QString& key, QString& parent_key, int& index);
   bool remove_ref(const QString& key, bool keep_key = false);
@@ -69,19 +75,23 @@ private:
   struct Node {
 
     /** Constructor. */
-    Node() : parent(nullptr), index(0), type(CONTAINER) {
+    explicit Node(const QString& sub_key = QString()) :
+      parent(nullptr), index(0), sub_key(sub_key), type(CONTAINER) {
     }
 
     Node* parent;   /**< The parent node. */
-    int index;      /**< The index of the node. */
+    int index;      /**< The index of the node in its parent. */
 
     QString key;    /**< The internal key of the node
                      * (complete key from the root). */
 
+    NaturalKey
+      sub_key;      /**< Last part of the key, used to sort siblings. */
+
     int type;       /**< Type of the node. */
 
-    std::map<QString, Node*, NaturalComparator>
-      children;     /**< Children of the node. */
+    std::vector<Node*>
+      children;     /**< Children of the node in natural order. */
   };
 
   Node* get_child(const QString& key) const;
@@ -94,12 +104,14 @@ private:
       const QString& key, int type, QString& parent_key, int& index);
   bool remove_child(const QString& key, int type, bool keep_key = false);
 
-  void build_index_map(const Node* node) const;
+  void build_index_map(const Node* node, int first_index = 0) const;
 
   void clear_children(Node *node);
 
   QString separator;  /**< The separator character. */
   Node* root;         /**< The root node of the tree. */
+  QHash<QString, Node*>
+      nodes;          /**< All nodes except the root by complete key. */
 
 };
 
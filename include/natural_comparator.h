@@ -18,29 +18,77 @@
 #define SOLARUSEDITOR_NATURAL_COMPARATOR_H
 
 #include <QCollator>
+#include <QCollatorSortKey>
 
 namespace SolarusEditor {
 
+/**
+ * @brief Returns the collator used to sort strings in natural order.
+ *
+ * Creating a QCollator is expensive, so all natural comparisons share
+ * this one.
+ *
+ * @return The natural order collator.
+ */
+inline const QCollator& get_natural_collator() {
+
+  static const QCollator collator = []() {
+    QCollator collator;
+    collator.setNumericMode(true);
+    // Initialize it now rather than lazily in a const function.
+    collator.compare(QString(), QString());
+    return collator;
+  }();
+  return collator;
+}
+
 /**
  * @brief A string comparator that sorts number parts intuitively.
  *
  * For example, "enemy_2" is before "enemy_10".
+ *
+ * Each call performs a full collation of both strings.
+ * To sort many strings or to use them as keys of an ordered container,
+ * prefer NaturalKey.
  */
 class NaturalComparator {
 
 public:
 
-  NaturalComparator() {
-    collator.setNumericMode(true);
+  bool operator() (const QString& lhs, const QString& rhs) const {
+    return get_natural_collator().compare(lhs, rhs) < 0;
   }
 
-  bool operator() (const QString& lhs, const QString& rhs) const {
-    return collator.compare(lhs, rhs) < 0;
+};
+
+/**
+ * @brief A string with its natural order sort key computed once.
+ *
+ * Comparing two keys only compares their precomputed sort keys,
+ * which is much faster than collating the strings again each time.
+ * The order is the same as NaturalComparator.
+ */
+class NaturalKey {
+
+public:
+
+  explicit NaturalKey(const QString& string) :
+    string(string),
+    sort_key(get_natural_collator().sortKey(string)) {
+  }
+
+  const QString& get_string() const {
+    return string;
+  }
+
+  bool operator<(const NaturalKey& other) const {
+    return sort_key.compare(other.sort_key) < 0;
   }
 
 private:
 
-  QCollator collator;
+  QString string;                 /**< The original string. */
+  QCollatorSortKey sort_key;      /**< Its natural order sort key. */
 
 };
 
@@ -17,6 +17,9 @@
 #ifndef SOLARUSEDITOR_QUEST_H
 #define SOLARUSEDITOR_QUEST_H
 
+#include <audio_analyzer.h>
+#include <file_info_cache.h>
+#include <image_store.h>
 #include <quest_database.h>
 #include <quest_properties.h>
 #include <solarus/core/ResourceType.h>
@@ -56,6 +59,10 @@ public:
   const QuestDatabase& get_database() const;
   QuestDatabase& get_database();
 
+  const FileInfoCache& get_file_info_cache() const;
+  AudioAnalyzer& get_audio_analyzer() const;
+  ImageStore& get_image_store() const;
+
   // Get paths.
   QString get_name() const;
   QString get_data_path() const;
@@ -181,11 +188,24 @@ signals:
 
 private:
 
+  bool find_resource_dir(
+      const QString& path, ResourceType& resource_type, int& relative_index) const;
+  bool get_path_from_resource_dir(
+      const QString& path, ResourceType resource_type, QStringRef& path_from_resource) const;
+
   QString root_path;               /**< Root path of this quest.
                                     * An empty string means no quest. */
+  QString data_path_prefix;        /**< Data path followed by a slash,
+                                    * or an empty string if there is no quest. */
 
   QuestProperties properties;      /**< Properties given in quest.dat. */
   QuestDatabase database;          /**< Resources and files declared in project_db.dat. */
+  FileInfoCache file_info_cache;   /**< Cached metadata of files for code
+                                    * that needs it very often like painting. */
+  mutable AudioAnalyzer
+      audio_analyzer;              /**< Properties of sound and music files. */
+  mutable ImageStore
+      image_store;                 /**< Decoded images shared by all editors. */
   QString current_music_id;        /**< Id of the music currently playing if any. */
 
   mutable QMap<QString, TilesetModel*>
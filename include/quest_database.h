@@ -20,6 +20,8 @@
 #include <solarus/core/QuestDatabase.h>
 #include <QMap>
 #include <QObject>
+#include <QSet>
+#include <QTimer>
 
 namespace SolarusEditor {
 
@@ -29,15 +31,45 @@ class Quest;
 
 /**
  * @brief Stores the resources and other file information of a quest.
+ *
+ * Changes are written to project_db.dat in write-behind mode:
+ * save() only schedules a write that happens after a short delay,
+ * so that several consecutive changes produce a single write.
+ * Use a Transaction to group a bulk operation, and flush() before
+ * anything else reads the file.
  */
 class QuestDatabase : public QObject {
   Q_OBJECT
 
 public:
 
+  /**
+   * @brief Delays writes of the database during its lifetime.
+   *
+   * Transactions can be nested. Pending changes are written after the
+   * outermost transaction is destroyed.
+   */
+  class Transaction {
+
+  public:
+
+    explicit Transaction(QuestDatabase& database);
+    ~Transaction();
+
+  private:
+
+    Q_DISABLE_COPY(Transaction)
+
+    QuestDatabase& database;   /**< The database being modified. */
+
+  };
+
   explicit QuestDatabase(Quest& quest);
+  ~QuestDatabase();
 
   void save() const;
+  void flush() const;
+  bool has_pending_save() const;
 
   bool exists(ResourceType type, const QString& id) const;
   bool exists_with_prefix(ResourceType type, const QString& prefix) const;
@@ -92,12 +124,28 @@ signals:
 private slots:
 
   void reload();
+  void save_timer_expired();
 
 private:
 
+  void build_element_prefixes() const;
+  void write() const;
+
   Quest& quest;                                  /**< The quest. */
   Solarus::QuestDatabase database;               /**< The wrapped data. */
 
+  mutable QMap<ResourceType, QSet<QString>>
+      element_prefixes;                          /**< Directory prefixes of element ids
+                                                  * of each resource type, like "dungeons/".
+                                                  * Built on demand. */
+  mutable bool element_prefixes_dirty;           /**< Whether element_prefixes needs
+                                                  * to be rebuilt. */
+
+  int transaction_depth;                         /**< Number of transactions in progress. */
+  mutable bool save_pending;                     /**< Whether there are unsaved changes
+                                                  * waiting to be written. */
+  mutable QTimer save_timer;                     /**< Delays writes to coalesce them. */
+
   QMap<ResourceType, QString>
       resource_type_friendly_names;              /**< Human-readable name of each resource type. */
   QMap<ResourceType, QString>
@@ -106,6 +106,8 @@ private slots:
   void source_model_rows_inserted(const QModelIndex& source_parent, int first, int last);
   void source_model_rows_about_to_be_removed(const QModelIndex& source_parent, int first, int last);
 
+  void audio_analysis_ready(const QString& path);
+
 private:
 
   using ExtraPathColumnPtrs = std::array<QString*, NUM_COLUMNS>;
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_QUEST_SEARCH_INDEX_H
+#define SOLARUSEDITOR_QUEST_SEARCH_INDEX_H
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QVector>
+
+namespace SolarusEditor {
+
+class Quest;
+
+/**
+ * @brief Full-text index of the Lua scripts, dialogs and strings of a quest.
+ *
+ * Files are read and split into trigrams in worker threads.
+ * The index itself is only modified from the main thread, when loaded files
+ * are received, so searching never needs to lock anything.
+ *
+ * The index follows the files created, renamed and deleted in the quest,
+ * and files should be reindexed with file_saved() when they are saved.
+ */
+class QuestSearchIndex : public QObject {
+  Q_OBJECT
+
+public:
+
+  /**
+   * @brief An occurrence of the searched text.
+   */
+  struct Match {
+    QString path;                 /**< Path of the file. */
+    int line;                     /**< Line number, starting at 1. */
+    int column;                   /**< Column, starting at 0. */
+    QString line_text;            /**< Full text of the line. */
+  };
+
+  explicit QuestSearchIndex(Quest& quest);
+  ~QuestSearchIndex();
+
+  bool is_indexable(const QString& path) const;
+  bool is_building() const;
+  int get_num_files() const;
+
+  QList<Match> find(const QString& text, int max_results) const;
+
+signals:
+
+  void index_changed();
+
+public slots:
+
+  void file_saved(const QString& path);
+
+private slots:
+
+  void root_path_changed();
+  void file_created(const QString& path);
+  void file_renamed(const QString& old_path, const QString& new_path);
+  void file_deleted(const QString& path);
+  void file_loaded(int index);
+  void job_finished();
+
+private:
+
+  /**
+   * @brief Content of an indexed file.
+   */
+  struct IndexedFile {
+    QString path;                 /**< Path of the file. */
+    quint64 generation;           /**< Generation of the path when the file
+                                   * was scheduled. */
+    bool valid;                   /**< Whether the file could be read. */
+    QString text;                 /**< Full content of the file. */
+    QVector<int> line_starts;     /**< Index in the text where each line starts. */
+    QVector<quint64> trigrams;    /**< Distinct trigrams of the case-folded text. */
+  };
+
+  static IndexedFile load_file(const IndexedFile& request);
+  static QVector<quint64> get_trigrams(const QString& folded_text);
+
+  void cancel_job();
+  void schedule_file(const QString& path);
+  void schedule_dir(const QString& path);
+  void start_next_job();
+  void add_file(const IndexedFile& file);
+  void remove_file(const QString& path);
+  void rename_indexed_file(const QString& old_path, const QString& new_path);
+  void bump_generation(const QString& path);
+
+  Quest& quest;                                /**< The quest to index. */
+  QHash<int, IndexedFile> files;               /**< Indexed files by id. */
+  QHash<QString, int> file_ids;                /**< Id of each indexed file by path. */
+  QHash<quint64, QSet<int>> postings;          /**< Ids of files containing each trigram. */
+  int next_file_id;                            /**< Id of the next file to index. */
+  QSet<QString> pending_paths;                 /**< Files waiting to be loaded. */
+  QHash<QString, quint64> generations;         /**< Incremented each time a path is
+                                                * deleted, renamed or saved. */
+  QFutureWatcher<IndexedFile> job;             /**< Files being loaded in worker threads. */
+
+};
+
+}
+
+#endif
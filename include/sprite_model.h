@@ -17,14 +17,13 @@
 #ifndef SOLARUSEDITOR_SPRITE_MODEL_H
 #define SOLARUSEDITOR_SPRITE_MODEL_H
 
-#include "natural_comparator.h"
 
 #include <solarus/graphics/SpriteData.h>
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QImage>
 #include <QItemSelectionModel>
 #include <QPixmap>
-#include <map>
 #include <memory>
 
 namespace SolarusEditor {
@@ -163,6 +162,7 @@ public:
 
   // Images.
   QImage get_animation_image(const Index& index) const;
+  QList<QImage> get_images() const;
   QList<QPixmap> get_direction_all_frames(const Index& index) const;
   QPixmap get_direction_first_frame(const Index& index) const;
   QPixmap get_direction_frame(const Index& index, int frame) const;
@@ -286,9 +286,9 @@ private:
   Solarus::SpriteData sprite;     /**< Sprite data wrapped by this model. */
   QString tileset_id;             /**< Tileset id used for animations images. */
 
-  std::map<QString, int, NaturalComparator>
+  QHash<QString, int>
       names_to_indexes;           /**< Index in the list of each animation.
-                                   * The order is determined here. */
+                                   * Indexes follow the natural order of names. */
 
   QList<AnimationModel>
       animations;                 /**< All animations. */
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_SPRITE_PACKER_H
+#define SOLARUSEDITOR_SPRITE_PACKER_H
+
+#include "sprite_model.h"
+#include <QImage>
+#include <QList>
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+
+namespace SolarusEditor {
+
+/**
+ * @brief Packs the frames of a sprite into a single compact image.
+ *
+ * Transparent borders of each direction are trimmed and directions are
+ * placed in the smallest atlas found with a MaxRects packer.
+ * Directions showing the same frames share their place in the atlas.
+ *
+ * All frames of a direction have the same size and are laid out in a grid,
+ * so the trimmed rectangle is the union of the visible pixels of all frames
+ * of the direction.
+ * Animations whose source image is the tileset are left unchanged.
+ */
+namespace SpritePacker {
+
+/**
+ * @brief New geometry of a direction in the atlas.
+ */
+struct PackedDirection {
+
+  SpriteModel::Index index;      /**< The direction. */
+  QPoint position;               /**< Position of its first frame in the atlas. */
+  QSize size;                    /**< Size of its frames after trimming. */
+  QPoint origin;                 /**< Origin of its frames after trimming. */
+};
+
+/**
+ * @brief Result of packing a sprite.
+ */
+struct PackedSprite {
+
+  PackedSprite();
+
+  QImage atlas;                  /**< The image containing all frames. */
+  QList<PackedDirection>
+      directions;                /**< New geometry of each packed direction. */
+  QList<QString> animations;     /**< Names of the packed animations. */
+  int num_packed_rects;          /**< Number of distinct blocks of frames. */
+  qint64 memory_size_before;     /**< Decoded size of the original images. */
+  qint64 memory_size_after;      /**< Decoded size of the atlas. */
+};
+
+PackedSprite pack_sprite(const SpriteModel& model);
+
+QList<QPoint> pack_rectangles(const QList<QSize>& sizes, QSize& atlas_size);
+
+}
+
+}
+
+#endif
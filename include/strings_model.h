@@ -120,7 +120,7 @@ public slots:
 private:
 
   void build_string_tree();
-  void clear_translation_from_tree();
+  void set_translation_resources(Solarus::StringResources translation);
 
   const Quest& quest;             /**< The quest the strings belongs to. */
   const QString language_id;      /**< Language of the strings. */
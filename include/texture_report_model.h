@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_TEXTURE_REPORT_MODEL_H
+#define SOLARUSEDITOR_TEXTURE_REPORT_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QFutureWatcher>
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <memory>
+
+namespace SolarusEditor {
+
+class Quest;
+
+/**
+ * @brief Model of the texture memory needed by each map and world of a quest.
+ *
+ * The memory of a map is the decoded size of every image it needs in game:
+ * the tiles and entities images of its tilesets and the source images of
+ * the sprites of its entities, each image being counted once.
+ * The memory of a world is the one of all images used by its maps.
+ *
+ * Maps are analyzed in worker threads. The tilesets and sprites used by a
+ * map and the images of a sprite are kept in the .editor-cache directory of
+ * the quest, so only modified files are parsed again.
+ *
+ * Rows above the memory budget are highlighted.
+ * The Qt::UserRole of each cell contains a value suitable for sorting.
+ */
+class TextureReportModel : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+
+  /**
+   * @brief Columns of the model.
+   */
+  enum Column {
+    TYPE_COLUMN,
+    ID_COLUMN,
+    WORLD_COLUMN,
+    TILESETS_COLUMN,
+    SPRITES_COLUMN,
+    IMAGES_COLUMN,
+    MEMORY_COLUMN,
+    NUM_COLUMNS
+  };
+
+  explicit TextureReportModel(Quest& quest, QObject* parent = nullptr);
+  ~TextureReportModel();
+
+  void reload();
+  bool is_loading() const;
+  QString get_map_id(int row) const;
+  int get_num_pending() const;
+  int get_num_maps_over_budget() const;
+  qint64 get_budget() const;
+  void set_budget(qint64 budget);
+
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+signals:
+
+  void loading_finished();
+
+private slots:
+
+  void map_ready(int index);
+  void job_finished();
+
+private:
+
+  class TextureStore;
+
+  /**
+   * @brief A map to analyze in a worker thread.
+   */
+  struct MapRequest {
+    const Quest* quest;                     /**< The quest. */
+    QString map_id;                         /**< Id of the map. */
+    std::shared_ptr<TextureStore> store;    /**< Sprites and images already known. */
+  };
+
+  /**
+   * @brief Textures needed by a map or a world.
+   */
+  struct Textures {
+    QString world;                          /**< World or an empty string. */
+    QStringList tilesets;                   /**< Tilesets used. */
+    QStringList sprites;                    /**< Sprites used. */
+    QStringList missing_files;              /**< Sprites and images not found. */
+    QMap<QString, qint64> images;           /**< Memory size of each image by path. */
+  };
+
+  /**
+   * @brief Result of the analysis of a map.
+   */
+  struct MapTextures {
+    QString map_id;                         /**< Id of the map. */
+    bool valid;                             /**< Whether the map could be loaded. */
+    Textures textures;                      /**< Textures of the map. */
+  };
+
+  /**
+   * @brief A map or a world.
+   */
+  struct Row {
+    bool is_world;                          /**< Whether this is a world. */
+    QString id;                             /**< Map id or world name. */
+    bool analyzed;                          /**< Whether the textures are known. */
+    bool valid;                             /**< Whether the map could be loaded. */
+    Textures textures;                      /**< Textures needed. */
+    qint64 memory_size;                     /**< Total size of the images. */
+    QString largest_map;                    /**< Map of a world using the most memory. */
+  };
+
+  static MapTextures analyze_map(const MapRequest& request);
+  static qint64 get_memory_size(const Textures& textures);
+  QString get_tooltip(const Row& row) const;
+  void add_world_rows();
+
+  Quest& quest;                             /**< The quest. */
+  QList<Row> rows;                          /**< Maps then worlds. */
+  QMap<QString, int> map_rows;              /**< Row of each map. */
+  qint64 budget;                            /**< Memory budget of a map in bytes. */
+  QFutureWatcher<MapTextures> job;          /**< Maps being analyzed. */
+
+};
+
+}
+
+#endif
@@ -17,16 +17,16 @@
 #ifndef SOLARUSEDITOR_TILESET_MODEL_H
 #define SOLARUSEDITOR_TILESET_MODEL_H
 
-#include "natural_comparator.h"
 #include "pattern_animation.h"
 #include "pattern_separation.h"
 #include <solarus/entities/TilesetData.h>
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QImage>
 #include <QItemSelectionModel>
 #include <QList>
+#include <QMap>
 #include <QPixmap>
-#include <map>
 
 namespace SolarusEditor {
 
@@ -104,6 +104,7 @@ public:
 
   QPixmap get_pattern_image(int index) const;
   QPixmap get_pattern_image_all_frames(int index) const;
+  QPixmap get_pattern_mipmap(int index, int level) const;
   QPixmap get_pattern_icon(int index) const;
   QImage get_patterns_image() const;
   void reload_patterns_image();
@@ -196,6 +197,7 @@ private:
       image = QPixmap();
       image_all_frames = QPixmap();
       icon = QPixmap();
+      mipmaps.clear();
     }
 
     QString id;                   /**< String id of the pattern. */
@@ -207,6 +209,9 @@ private:
                                    * with all frames for multi-frame
                                    * patterns. */
     mutable QPixmap icon;         /**< 32x32 icon of the pattern. */
+    mutable QMap<int, QPixmap>
+        mipmaps;                  /**< Downsampled images of the first frame
+                                   * by mipmap level. */
   };
 
   void build_index_map();
@@ -216,9 +221,9 @@ private:
   Solarus::TilesetData tileset;   /**< Tileset data wrapped by this model. */
   QImage patterns_image;          /**< PNG image of all tile patterns. */
 
-  std::map<QString, int, NaturalComparator>
+  QHash<QString, int>
       ids_to_indexes;             /**< Index in the list of each pattern.
-                                   * The order is determined here. */
+                                   * Indexes follow the natural order of ids. */
   QList<PatternModel>
       patterns;                   /**< All patterns. */
 
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_TRANSLATION_MATRIX_MODEL_H
+#define SOLARUSEDITOR_TRANSLATION_MATRIX_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+namespace SolarusEditor {
+
+class Quest;
+
+/**
+ * @brief Model of the dialogs or strings of all languages of a quest.
+ *
+ * Rows are dialog ids or string keys and columns are languages.
+ * All language files are loaded at the same time in worker threads.
+ * Keys are stored once in a table shared by all languages, and each
+ * language only stores the text of each row.
+ *
+ * Each cell has flags comparing it to a reference language.
+ * When a language file is saved, only this language is loaded again and
+ * only the flags of the rows that changed are updated.
+ */
+class TranslationMatrixModel : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+
+  /**
+   * @brief Kind of language files shown.
+   */
+  enum class Kind {
+    DIALOGS,
+    STRINGS
+  };
+
+  /**
+   * @brief Problems of a translated text.
+   */
+  enum Flag {
+    MISSING = 0x1,    /**< The reference language has a text but not this one. */
+    UNUSED = 0x2,     /**< This language has a text but not the reference one. */
+    OUTDATED = 0x4    /**< The reference text changed since this one was saved. */
+  };
+
+  explicit TranslationMatrixModel(Quest& quest, QObject* parent = nullptr);
+  ~TranslationMatrixModel();
+
+  Kind get_kind() const;
+  void load(Kind kind);
+  bool is_loading() const;
+
+  QString get_reference_language() const;
+  void set_reference_language(const QString& language_id);
+
+  QString get_key(int row) const;
+  QString get_language(int column) const;
+  QString get_text(int row, int column) const;
+  int get_flags(int row, int column) const;
+  int get_row_flags(int row) const;
+
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role) const override;
+  QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+signals:
+
+  void loading_finished();
+
+public slots:
+
+  void file_saved(const QString& path);
+
+private slots:
+
+  void job_finished();
+
+private:
+
+  /**
+   * @brief A language file to load in a worker thread.
+   */
+  struct LanguageRequest {
+    QString language_id;          /**< Id of the language. */
+    QString path;                 /**< Path of its dialogs or strings file. */
+    Kind kind;                    /**< Kind of file. */
+  };
+
+  /**
+   * @brief Texts of a language file loaded by a worker thread.
+   */
+  struct LanguageTexts {
+    QString language_id;          /**< Id of the language. */
+    bool valid;                   /**< Whether the file could be loaded. */
+    QHash<QString, QString> texts;  /**< Text of each key. */
+  };
+
+  /**
+   * @brief A column of the matrix.
+   */
+  struct Language {
+    QString id;                   /**< Id of the language. */
+    bool valid;                   /**< Whether the file could be loaded. */
+    QVector<QString> texts;       /**< Text of each row, null if missing. */
+    QVector<quint8> flags;        /**< Flags of each row. */
+  };
+
+  static LanguageTexts load_language(const LanguageRequest& request);
+
+  LanguageRequest make_request(const QString& language_id) const;
+  void build_table(const QList<LanguageTexts>& loaded);
+  void update_language(const LanguageTexts& loaded);
+  quint8 compute_flags(int row, int column) const;
+  void update_flags(int row);
+  int get_column(const QString& language_id) const;
+
+  Quest& quest;                               /**< The quest. */
+  Kind kind;                                  /**< Kind of files shown. */
+  QString reference_language;                 /**< Language others are compared to. */
+  QStringList keys;                           /**< Key of each row in natural order. */
+  QHash<QString, int> key_rows;               /**< Row of each key. */
+  QVector<Language> languages;                /**< Texts and flags of each column. */
+  QHash<QString, QSet<QString>> outdated_keys;  /**< Outdated keys of each language. */
+  QFutureWatcher<LanguageTexts> job;          /**< Languages being loaded. */
+
+};
+
+}
+
+#endif
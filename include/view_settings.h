@@ -52,6 +52,12 @@ public:
   QColor get_grid_color() const;
   void set_grid_color(const QColor& color);
 
+  bool is_lod_enabled() const;
+  void set_lod_enabled(bool lod_enabled);
+  double get_lod_zoom() const;
+  void set_lod_zoom(double lod_zoom);
+  bool is_low_detail(double zoom) const;
+
   void get_layer_range(int& min_layer, int& max_layer) const;
   void set_layer_range(int min_layer, int max_layer);
   void set_layer_locked(int layer, bool locked);
@@ -78,6 +84,7 @@ signals:
   void grid_size_changed(const QSize& size);
   void grid_style_changed(GridStyle style);
   void grid_color_changed(const QColor& color);
+  void lod_changed();
   void layer_range_changed(int min_layer, int max_layer);
   void layer_locking_changed(int layer, bool locked);
   void layer_visibility_changed(int layer, bool visible);
@@ -92,6 +99,10 @@ private:
   QSize grid_size;                          /**< If supported, the current grid size. */
   GridStyle grid_style;                     /**< If supported, the current grid style. */
   QColor grid_color;                        /**< If supported, the current grid color. */
+  bool lod_enabled;                         /**< If supported, whether simplified rendering
+                                             * is used when zoomed out. */
+  double lod_zoom;                          /**< Zoom factor below which simplified
+                                             * rendering is used. */
   int min_layer;                            /**< Lowest layer in the editor
                                              * (0 if showing/hiding layers is not supported). */
   int max_layer;                            /**< Highest layer in the editor
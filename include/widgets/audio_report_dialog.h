@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_AUDIO_REPORT_DIALOG_H
+#define SOLARUSEDITOR_AUDIO_REPORT_DIALOG_H
+
+#include "audio_report_model.h"
+#include "ui_audio_report_dialog.h"
+#include <QDialog>
+#include <QSortFilterProxyModel>
+
+namespace SolarusEditor {
+
+class Quest;
+
+/**
+ * @brief A dialog listing the duration, loudness and memory usage of all
+ * sounds and musics of a quest.
+ *
+ * Columns can be sorted, for example to find the files that use the most
+ * memory in game.
+ * Double-clicking a row plays the sound or music.
+ */
+class AudioReportDialog : public QDialog {
+  Q_OBJECT
+
+public:
+
+  explicit AudioReportDialog(Quest& quest, QWidget* parent = nullptr);
+
+  void reload();
+
+private slots:
+
+  void row_activated(const QModelIndex& index);
+  void update_status();
+
+private:
+
+  Ui::AudioReportDialog ui;           /**< The widgets. */
+  Quest& quest;                       /**< The quest. */
+  AudioReportModel model;             /**< Properties of all audio files. */
+  QSortFilterProxyModel sort_model;   /**< Sorts the rows. */
+
+};
+
+}
+
+#endif
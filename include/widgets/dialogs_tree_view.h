@@ -17,6 +17,7 @@
 #ifndef SOLARUSEDITOR_DIALOGS_TREE_VIEW_H
 #define SOLARUSEDITOR_DIALOGS_TREE_VIEW_H
 
+#include <QStringList>
 #include <QTreeView>
 
 namespace SolarusEditor {
@@ -48,6 +49,11 @@ protected:
 
   virtual void contextMenuEvent(QContextMenuEvent* event) override;
 
+private slots:
+
+  void save_expanded_items();
+  void restore_expanded_items();
+
 private:
 
   DialogsModel*
@@ -60,6 +66,8 @@ private:
     set_id_action;    /**< Action of change the id of the selected dialog(s). */
   QAction*
     delete_action;    /**< Action of deleting the selected dialog(s). */
+  QStringList
+    expanded_ids;     /**< Expanded dialog ids saved while the model is reset. */
 
 };
 
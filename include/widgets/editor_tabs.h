@@ -80,6 +80,7 @@ signals:
   void can_copy_changed(bool can_copy);
   void can_paste_changed(bool can_paste);
   void refactoring_requested(const Refactoring& refactoring);
+  void file_saved(const QString& path);
 
 public slots:
 
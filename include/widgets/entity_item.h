@@ -48,12 +48,14 @@ public:
   EntityType get_entity_type() const;
   QRectF boundingRect() const override;
 
+  static bool is_entity_visible(const EntityModel& entity, const ViewSettings& view_settings);
   void update_visibility(const ViewSettings& view_settings);
   void update_xy();
   void update_size();
 
 protected:
 
+  QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
   void paint(QPainter* painter,
              const QStyleOptionGraphicsItem* option,
              QWidget* widget = nullptr) override;
@@ -19,19 +19,27 @@
 
 #include "ui_external_script_dialog.h"
 #include <QDialog>
+#include <QElapsedTimer>
+#include <QTimer>
 
 namespace SolarusEditor {
 
+class ExternalScriptRunner;
+
 /**
  * @brief A dialog that runs an external Lua script and shows its output.
  *
- * The script runs in a normal Lua environment with standard libraries.
- * io.write() outputs in the text area of this dialog instead of stdout.
+ * The script runs in a worker thread, in a normal Lua environment with
+ * standard libraries.
+ * print() and io.write() output in the text area of this dialog in real time
+ * instead of stdout.
  * For require(), everything works as if the current directory was the one
  * containing the script file.
  * This even works if the script file is located in Qt resources: in this
  * case, the script can require() other scripts that are also Qt resources,
  * using a relative path.
+ *
+ * The user can cancel the script while it is running.
  */
 class ExternalScriptDialog : public QDialog {
   Q_OBJECT
@@ -40,6 +48,7 @@ public:
 
   ExternalScriptDialog(const QString& title, const QString& script_path,
                        const QString& script_arg, QWidget* parent = 0);
+  ~ExternalScriptDialog();
 
   bool is_finished() const;
   bool is_successful() const;
@@ -47,6 +56,7 @@ public:
 public slots:
 
   virtual int exec() override;
+  virtual void reject() override;
 
 protected:
 
@@ -54,15 +64,18 @@ protected:
 
 private slots:
 
-  void run_script();
+  void output_available();
+  void script_finished();
+  void update_elapsed_time();
 
 private:
 
   void set_finished(bool finished);
 
   Ui::ExternalScriptDialog ui;         /**< The widgets. */
-  QString script_path;                 /**< Lua script to run, without extension. */
-  QString script_arg;                  /**< Optional argument to pass to the script. */
+  ExternalScriptRunner* runner;        /**< Runs the script in a worker thread. */
+  QElapsedTimer elapsed_timer;         /**< Measures the running time of the script. */
+  QTimer elapsed_time_update_timer;    /**< Refreshes the running time displayed. */
   bool finished;                       /**< Whether the script is finished. */
   bool successful;                     /**< Whether the script is successfully finished. */
 
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_FIND_IN_QUEST_DIALOG_H
+#define SOLARUSEDITOR_FIND_IN_QUEST_DIALOG_H
+
+#include "ui_find_in_quest_dialog.h"
+#include <QDialog>
+
+namespace SolarusEditor {
+
+class Quest;
+class QuestSearchIndex;
+
+/**
+ * @brief A dialog to find text in all scripts, dialogs and strings of a quest.
+ *
+ * Results are updated as the user types.
+ */
+class FindInQuestDialog : public QDialog {
+  Q_OBJECT
+
+public:
+
+  FindInQuestDialog(Quest& quest, QuestSearchIndex& index, QWidget* parent = nullptr);
+
+  void set_text(const QString& text);
+
+signals:
+
+  void open_file_requested(const QString& path, int line);
+
+private slots:
+
+  void update_results();
+  void result_activated(QTreeWidgetItem* item);
+
+private:
+
+  Ui::FindInQuestDialog ui;     /**< The widgets. */
+  Quest& quest;                 /**< The quest to search in. */
+  QuestSearchIndex& index;      /**< The search index of the quest. */
+
+};
+
+}
+
+#endif
@@ -20,14 +20,17 @@
 #include "quest.h"
 #include "ui_import_dialog.h"
 #include <QDialog>
-#include <QMessageBox>
-
-class QFileInfo;
+#include <QFuture>
 
 namespace SolarusEditor {
 
 /**
  * @brief Dialog to import files from another quest.
+ *
+ * Comparing and copying files is done by worker threads while a progress
+ * dialog is shown.
+ * Files that already exist in the destination quest with a different
+ * content are all presented in one dialog before anything is copied.
  */
 class ImportDialog : public QDialog {
   Q_OBJECT
@@ -56,22 +59,44 @@ private slots:
 
 private:
 
-  void import_path(const QString& source_path);
-  void import_file(const QFileInfo& source_info);
-  void import_dir(const QFileInfo& source_info);
+  /**
+   * @brief A file or directory to import.
+   */
+  struct ImportEntry {
+    QString source_path;          /**< Path in the source quest. */
+    QString destination_path;     /**< Path in the destination quest. */
+    bool is_dir;                  /**< Whether this is a directory. */
+    bool exists;                  /**< Whether the destination path exists. */
+    bool identical;               /**< Whether the destination file has the same content. */
+    bool overwrite;               /**< Whether to replace the destination file. */
+    bool copied;                  /**< Whether the file was successfully copied. */
+    QString error;                /**< Error message if something went wrong. */
+  };
+
+  template<typename T>
+  bool wait_for_future(const QString& label, QFuture<T> future);
+  bool confirm_overwrites(QVector<ImportEntry>& entries);
+  void register_imported_entries(const QVector<ImportEntry>& entries);
   void import_path_meta_information(const QString& source_path, const QString& destination_path);
   QString source_to_destination_path(const QString& source_path);
-  void find_source_paths_not_in_destination_quest(
+
+  static QVector<ImportEntry> list_entries(
+      const QStringList& source_paths,
+      const QString& source_root_path,
+      const QString& destination_root_path
+  );
+  static void compare_entry(ImportEntry& entry);
+  static void copy_entry(ImportEntry& entry);
+  static QStringList find_source_paths_not_in_destination_quest(
       const QString& source_path,
-      QStringList& missing_source_paths
+      const QString& source_root_path,
+      const QString& destination_root_path
   );
 
   Ui::ImportDialog ui;
 
   Quest source_quest;
   Quest& destination_quest;
-  QMessageBox::StandardButton last_confirm_overwrite_file;
-  QMessageBox::StandardButton last_confirm_overwrite_directory;
   QStringList paths_to_select;
 };
 
@@ -17,18 +17,25 @@
 #ifndef SOLARUSEDITOR_LUA_SYNTAX_HIGHLIGHTER_H
 #define SOLARUSEDITOR_LUA_SYNTAX_HIGHLIGHTER_H
 
-#include <QRegExp>
 #include <QSyntaxHighlighter>
+#include <QTextBlock>
 #include <QTextCharFormat>
-#include <QVector>
 
 namespace SolarusEditor {
 
 /**
- * @brief A simple syntax highlighter for Lua code.
+ * @brief A syntax highlighter for Lua code.
  *
- * This class is highly inspired from Qt syntax highlighter example:
- * http://qt-project.org/doc/qt-4.8/richtext-syntaxhighlighter.html
+ * Each line is tokenized in a single pass by a small hand-written lexer.
+ * The lexer state at the end of a line (inside a long comment or a long
+ * string, and its bracket level) is stored as the block state so that
+ * only lines whose starting state changed need to be highlighted again.
+ *
+ * To keep the editor responsive with very large scripts, a limited number
+ * of lines is highlighted per event loop iteration.
+ * Remaining lines are marked as pending and highlighted later in idle
+ * slices, except the ones that become visible, which are highlighted
+ * immediately by highlight_until().
  */
 class LuaSyntaxHighlighter : public QSyntaxHighlighter {
     Q_OBJECT
@@ -37,29 +44,49 @@ public:
 
   explicit LuaSyntaxHighlighter(QTextDocument* document = nullptr);
 
+  void highlight_until(int block_number);
+
 protected:
 
   virtual void highlightBlock(const QString& text) override;
 
+private slots:
+
+  void highlight_next_slice();
+
+private:
+
   /**
-   * @brief A single-line highlighting rule.
+   * @brief Lexer state at the end of a line.
    */
-  struct HighlightingRule {
-    QRegExp pattern;                             /**< A regexp. If it contains a capture, only the
-                                                  * captured text will be highlighted. */
-    QTextCharFormat format;                      /**< Format to apply to text matching the regexp. */
+  enum LexerState {
+    STATE_PENDING = -2,                          /**< Line not highlighted yet. */
+    STATE_NORMAL = 0,                            /**< Regular code. */
+    STATE_LONG_COMMENT = 1,                      /**< Inside a --[[ ]] comment. */
+    STATE_LONG_STRING = 2                        /**< Inside a [[ ]] string. */
   };
 
-  QVector<HighlightingRule> rules;               /**< The rule set. */
+  static int make_state(LexerState kind, int level);
+  static LexerState get_state_kind(int state);
+  static int get_state_level(int state);
 
-  QRegExp comment_start_pattern;                 /**< Regexp of multi-line comments start. */
-  QRegExp comment_end_pattern;                   /**< Regexp of multi-line comments end. */
+  void schedule_next_slice();
+  QTextBlock find_first_pending_block() const;
+  int find_long_bracket_end(const QString& text, int index, int level) const;
 
   QTextCharFormat keyword_format;                /**< Format applied to Lua keywords. */
-  QTextCharFormat single_line_comment_format;    /**< Format applied to single-line comments. */
-  QTextCharFormat multi_line_comment_format;     /**< Format applied to multi-line comments. */
+  QTextCharFormat comment_format;                /**< Format applied to comments. */
   QTextCharFormat string_format;                 /**< Format applied to strings litterals. */
 
+  int remaining_lines_in_slice;                  /**< Number of lines that can still be
+                                                  * highlighted in the current slice. */
+  bool slice_scheduled;                          /**< Whether a new slice is already
+                                                  * scheduled. */
+  int first_pending_block;                       /**< Hint on the number of the first pending
+                                                  * block, or -1. */
+  int priority_block_number;                     /**< Blocks up to this one are highlighted
+                                                  * regardless of the slice limit. */
+
 };
 
 }
@@ -19,6 +19,7 @@
 
 #include "widgets/settings_dialog.h"
 #include "quest.h"
+#include "quest_search_index.h"
 #include "ui_main_window.h"
 #include <solarus/entities/EntityType.h>
 #include <solarus/gui/quest_runner.h>
@@ -28,9 +29,14 @@ class QToolButton;
 
 namespace SolarusEditor {
 
+class AudioReportDialog;
 class Editor;
+class FindInQuestDialog;
 class PairSpinBox;
 class Refactoring;
+class TextureReportDialog;
+class TranslationMatrixDialog;
+class WorldView;
 
 using EntityType = Solarus::EntityType;
 
@@ -71,8 +77,11 @@ private slots:
   void on_action_select_all_triggered();
   void on_action_unselect_all_triggered();
   void on_action_find_triggered();
+  void on_action_find_in_quest_triggered();
   void on_action_run_quest_triggered();
   void on_action_stop_music_triggered();
+  void on_action_audio_report_triggered();
+  void on_action_texture_report_triggered();
   void on_action_show_grid_triggered();
   void on_action_show_console_triggered();
   void change_grid_size();
@@ -88,6 +97,8 @@ private slots:
 
   void current_editor_changed(int index);
   void rename_file_requested(Quest& quest, const QString& path);
+  void show_world_requested(Quest& quest, const QString& map_id);
+  void translation_matrix_requested(Quest& quest, const QString& language_id);
   void refactoring_requested(const Refactoring& refactoring);
 
   void update_zoom();
@@ -110,6 +121,7 @@ private slots:
   void current_music_changed(const QString& music_id);
   void update_music_actions();
   void selected_path_changed(const QString& path);
+  void open_file_at_line(const QString& path, int line);
 
   void reload_settings();
 
@@ -120,6 +132,7 @@ protected:
 private:
 
   bool confirm_before_closing();
+  void flush_quest_database();
   void update_title();
   void upgrade_quest();
   void add_quest_to_recent_list();
@@ -167,6 +180,16 @@ private:
   Quest quest;                    /**< The current quest open if any. */
   SolarusGui::QuestRunner
       quest_runner;               /**< The executor of the current quest. */
+  QuestSearchIndex search_index;  /**< Full-text index of the current quest. */
+  FindInQuestDialog*
+      find_in_quest_dialog;       /**< The find in quest dialog, created when needed. */
+  WorldView* world_view;          /**< The world view, created when needed. */
+  TranslationMatrixDialog*
+      translation_matrix_dialog;  /**< The translations dialog, created when needed. */
+  AudioReportDialog*
+      audio_report_dialog;        /**< The audio report dialog, created when needed. */
+  TextureReportDialog*
+      texture_report_dialog;      /**< The texture report dialog, created when needed. */
 
   QMenu* recent_quests_menu;      /**< The menu to open a recent quest. */
   QMenu* zoom_menu;               /**< The zoom menu. */
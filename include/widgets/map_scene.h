@@ -20,6 +20,8 @@
 #include "map_model.h"
 #include "view_settings.h"
 #include <QGraphicsScene>
+#include <QHash>
+#include <QSet>
 
 namespace SolarusEditor {
 
@@ -29,6 +31,13 @@ class ViewSettings;
 
 /**
  * @brief The scene containing all entities in the map main view.
+ *
+ * Graphic items are only created for entities close to the area shown by
+ * the view, and deleted when they get far from it.
+ * The selection is stored in entity models so that it does not depend on
+ * which items currently exist.
+ * Entities are also indexed in a grid of square cells so that finding the
+ * entities of an area does not need to traverse the whole map.
  */
 class MapScene : public QGraphicsScene {
   Q_OBJECT
@@ -51,16 +60,23 @@ public:
   void update_obstacles_visibility(const ViewSettings& view_settings);
   void update_entity_type_visibility(EntityType type, const ViewSettings& view_settings);
 
+  void update_level_of_detail(const ViewSettings& view_settings);
+  bool is_low_detail(double level_of_detail) const;
+
+  void set_visible_area(const QRectF& visible_area);
+
   EntityIndexes get_selected_entities();
   void set_selected_entities(const EntityIndexes& indexes);
   void select_entity(const EntityIndex& index, bool selected);
   void select_all();
   void select_all_except_locked();
   void unselect_all();
+  void update_entity_selection(EntityModel& entity);
 
   void redraw_entity(const EntityIndex& index);
   void redraw_entities(const EntityIndexes& indexes);
 
+  EntityIndexes get_entities_in_rectangle(const QRect& rectangle) const;
   int get_layer_in_rectangle(
       const QRect& rectangle
   ) const;
@@ -87,18 +103,43 @@ private:
   using ByLayer = QMap<int, T>;
 
   using EntityItems = QList<EntityItem*>;
+  using GridCell = quint64;
 
   void build();
   void update_scene_size();
   void create_layer_parent_item(int layer);
-  void create_entity_item(EntityModel& entity);
+  bool is_in_item_area(const EntityModel& entity) const;
+  bool is_entity_visible(const EntityModel& entity) const;
+  static QList<GridCell> get_grid_cells(const QRect& area);
+  void add_to_grid(EntityModel& entity);
+  void remove_from_grid(EntityModel& entity);
+  void update_in_grid(EntityModel& entity);
+  QSet<EntityModel*> get_entities_near(const QRect& area) const;
+  void update_item_area(const QRect& area);
+  void create_entity_item(EntityModel& entity, EntityItem* item_above);
+  void delete_entity_item(const EntityIndex& index);
   EntityItem* get_entity_item(const EntityIndex& index);
+  EntityItem* get_next_entity_item(const EntityIndex& index);
+  void set_entity_selected(const EntityIndex& index, bool selected);
+  void unselect_hidden_entities();
   const EntityItems& get_entity_items(int layer);
   const ByLayer<EntityItems>& get_entity_items() const;
 
   MapModel& map;                            /**< The map represented. */
   ByLayer<EntityItems> entity_items;        /**< Entities items on each layer,
-                                             * ordered as in the map. */
+                                             * ordered as in the map.
+                                             * nullptr for entities without item. */
+  QRect item_area;                          /**< Area of the map where entities
+                                             * have an item. */
+  QSet<EntityModel*> entities_with_item;    /**< Entities that currently have an item.
+                                             * Some of them may have moved out of
+                                             * the item area since. */
+  QSet<EntityModel*> selected_entities;     /**< Entities whose selection flag is set. */
+  QHash<GridCell, QSet<EntityModel*>>
+      grid;                                 /**< Entities whose bounding box
+                                             * overlaps each cell of the grid. */
+  QHash<EntityModel*, QRect> grid_boxes;    /**< Bounding box of each entity
+                                             * when it was put in the grid. */
   ByLayer<QGraphicsItem*>
       layer_parent_items;                   /**< Artificial parent item of everything on a layer. */
 
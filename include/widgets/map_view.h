@@ -161,6 +161,7 @@ public slots:
   void update_traversables_visibility();
   void update_obstacles_visibility();
   void update_entity_type_visibility(EntityType type);
+  void update_level_of_detail();
   void tileset_selection_changed();
   void tileset_id_changed(const QString& tileset_id);
   void tileset_reloaded();
@@ -178,6 +179,7 @@ public slots:
 protected:
 
   void paintEvent(QPaintEvent* event) override;
+  void resizeEvent(QResizeEvent* event) override;
 
   void keyPressEvent(QKeyEvent* event) override;
   void mousePressEvent(QMouseEvent* event) override;
@@ -186,6 +188,10 @@ protected:
   void mouseDoubleClickEvent(QMouseEvent* event) override;
   void contextMenuEvent(QContextMenuEvent* event) override;
 
+private slots:
+
+  void update_visible_area();
+
 private:
 
   void build_context_menu_actions();
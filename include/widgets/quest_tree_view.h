@@ -54,6 +54,8 @@ signals:
 
   void open_file_requested(Quest& quest, const QString& path);
   void rename_file_requested(Quest& quest, const QString& path);
+  void show_world_requested(Quest& quest, const QString& map_id);
+  void translation_matrix_requested(Quest& quest, const QString& language_id);
   void selected_path_changed(const QString& path);
 
 public slots:
@@ -65,7 +67,9 @@ public slots:
   void play_action_triggered();
   void open_action_triggered();
   void open_map_script_action_triggered();
+  void show_world_action_triggered();
   void open_language_strings_action_triggered();
+  void compare_languages_action_triggered();
   void rename_action_triggered();
   void file_renamed(const QString& old_path, const QString& new_path);
   void change_description_action_triggered();
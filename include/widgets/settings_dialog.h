@@ -81,6 +81,10 @@ public slots:
   void change_map_grid_style();
   void update_map_grid_color();
   void change_map_grid_color();
+  void update_map_lod_enabled();
+  void change_map_lod_enabled();
+  void update_map_lod_zoom();
+  void change_map_lod_zoom();
   void update_map_tileset_background();
   void change_map_tileset_background();
   void update_map_tileset_zoom();
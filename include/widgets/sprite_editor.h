@@ -50,6 +50,9 @@ public slots:
   void update_description_to_gui();
   void set_description_from_gui();
 
+  void update_images_field();
+  void pack_images_requested();
+
   void update_selection();
   void create_requested();
   void create_animation_requested();
@@ -18,6 +18,7 @@
 #define SOLARUSEDITOR_SPRITE_SCENE_H
 
 #include <QGraphicsScene>
+#include <QPixmap>
 #include "sprite_model.h"
 
 namespace SolarusEditor {
@@ -70,6 +71,8 @@ private:
 
   QGraphicsTextItem* missing_text;    /**< Text displayed when the
                                        * source image is missing. */
+  QPixmap background;                 /**< Dimmed source image of the
+                                       * animation drawn as background. */
 
 };
 
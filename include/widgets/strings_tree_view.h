@@ -17,6 +17,7 @@
 #ifndef SOLARUSEDITOR_STRINGS_TREE_VIEW_H
 #define SOLARUSEDITOR_STRINGS_TREE_VIEW_H
 
+#include <QStringList>
 #include <QTreeView>
 
 namespace SolarusEditor {
@@ -48,6 +49,11 @@ protected:
 
   virtual void contextMenuEvent(QContextMenuEvent* event) override;
 
+private slots:
+
+  void save_expanded_items();
+  void restore_expanded_items();
+
 private:
 
   StringsModel*
@@ -60,6 +66,8 @@ private:
     set_key_action;   /**< Action of change the key of the selected string(s).*/
   QAction*
     delete_action;    /**< Action of deleting the selected string(s). */
+  QStringList
+    expanded_keys;    /**< Expanded string keys saved while the model is reset. */
 
 };
 
@@ -21,6 +21,7 @@
 
 namespace SolarusEditor {
 
+class LuaSyntaxHighlighter;
 class TextEditorWidget;
 
 /**
@@ -48,16 +49,21 @@ public:
   void find() override;
   void reload_settings() override;
 
+  void go_to_line(int line);
+
 private slots:
 
   int find_text_requested(const QString& text);
   void replace_text_requested(const QString& text_search, const QString& text_replace);
   void open_map_requested();
+  void highlight_visible_text(const QRect& rect, int dy);
 
 private:
 
   TextEditorWidget*
     text_widget;    /**< The text editing area contained. */
+  LuaSyntaxHighlighter*
+    highlighter;    /**< The syntax highlighter, or nullptr if this is not a script. */
   QString map_id;   /**< The map id of this script (if it is a map script). */
 
 };
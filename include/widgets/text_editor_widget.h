@@ -49,6 +49,7 @@ public:
 
   void line_number_area_paint_event(QPaintEvent* event);
   int get_line_number_area_width();
+  int get_last_visible_block_number();
 
   virtual void contextMenuEvent(QContextMenuEvent* event) override;
   virtual void keyPressEvent(QKeyEvent* event) override;
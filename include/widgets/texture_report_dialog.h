@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_TEXTURE_REPORT_DIALOG_H
+#define SOLARUSEDITOR_TEXTURE_REPORT_DIALOG_H
+
+#include "texture_report_model.h"
+#include "ui_texture_report_dialog.h"
+#include <QDialog>
+#include <QSortFilterProxyModel>
+
+namespace SolarusEditor {
+
+class Quest;
+
+/**
+ * @brief A dialog listing the texture memory needed by each map and world
+ * of a quest.
+ *
+ * Maps needing more memory than the budget are highlighted.
+ * Double-clicking a map opens it.
+ */
+class TextureReportDialog : public QDialog {
+  Q_OBJECT
+
+public:
+
+  explicit TextureReportDialog(Quest& quest, QWidget* parent = nullptr);
+
+  void reload();
+
+signals:
+
+  void open_file_requested(Quest& quest, const QString& path);
+
+private slots:
+
+  void row_activated(const QModelIndex& index);
+  void budget_changed();
+  void update_status();
+
+private:
+
+  Ui::TextureReportDialog ui;         /**< The widgets. */
+  Quest& quest;                       /**< The quest. */
+  TextureReportModel model;           /**< Textures of all maps and worlds. */
+  QSortFilterProxyModel sort_model;   /**< Sorts the rows. */
+
+};
+
+}
+
+#endif
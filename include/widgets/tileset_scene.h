@@ -18,17 +18,24 @@
 #define SOLARUSEDITOR_TILESET_SCENE_H
 
 #include <QGraphicsScene>
+#include <QList>
+#include <QVector>
 
 class QItemSelection;
 
 namespace SolarusEditor {
 
-class PatternItem;
 class Quest;
 class TilesetModel;
 
 /**
- * @brief The scene containing all patterns in the tileset main view.
+ * @brief The scene showing the tileset image in the tileset main view.
+ *
+ * The tileset image is drawn once as background.
+ * There is no graphic item per pattern: pattern selection markers are drawn
+ * as an overlay on the exposed area only, and the patterns at a given place
+ * are found with a grid of pattern frames.
+ * The selection is the one of the tileset model.
  */
 class TilesetScene : public QGraphicsScene {
   Q_OBJECT
@@ -40,7 +47,9 @@ public:
   const TilesetModel& get_model() const;
   const Quest& get_quest() const;
 
-  int get_pattern_index(const QGraphicsItem* item);
+  int get_pattern_index_at(const QPoint& xy) const;
+  QList<int> get_pattern_indexes_in(
+      const QRect& area, Qt::ItemSelectionMode mode) const;
 
   void select_all();
   void unselect_all();
@@ -48,12 +57,12 @@ public:
 protected:
 
   void drawBackground(QPainter* painter, const QRectF& rect) override;
+  void drawForeground(QPainter* painter, const QRectF& rect) override;
 
 private slots:
 
   void update_selection_to_scene(
       const QItemSelection& selected, const QItemSelection& deselected);
-  void set_selection_from_scene();
   void update_pattern_position(int index);
   void update_pattern_animation(int index);
   void pattern_created(int new_index, const QString& new_id);
@@ -65,11 +74,17 @@ private slots:
 private:
 
   void build();
+  void patterns_changed();
+  void build_pattern_cells() const;
 
   TilesetModel& model;      /**< The tileset represented. */
-  QList<PatternItem*>
-      pattern_items;        /**< Each pattern item in the scene,
-                             * ordered as in the model. */
+  mutable bool
+      pattern_cells_dirty;  /**< Whether pattern_cells needs to be rebuilt. */
+  mutable int num_columns;  /**< Number of columns of pattern_cells. */
+  mutable int num_rows;     /**< Number of rows of pattern_cells. */
+  mutable QVector<QList<int>>
+      pattern_cells;        /**< Indexes of patterns whose frames intersect
+                             * each cell of a grid over the tileset image. */
 
 };
 
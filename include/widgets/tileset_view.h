@@ -109,7 +109,7 @@ private:
   void end_state_moving_patterns();
   void update_current_areas(const QPoint& start_point, const QPoint& current_point);
   void clear_current_areas();
-  QList<QGraphicsItem*> get_items_intersecting_current_areas(
+  QList<int> get_patterns_intersecting_current_areas(
       bool ignore_selected = true) const;
   QRect get_selection_bounding_box() const;
 
@@ -138,8 +138,8 @@ private:
       current_area_items;              /**< In states DRAWING_RECTANGLE and
                                         * MOVING_PATTERN: graphic item(s) of the
                                         * rectangle(s) the user is drawing. */
-  QList<QGraphicsItem*>
-      initially_selected_items;        /**< In state DRAWING_RECTANGLE: items
+  QList<int>
+      initially_selected_indexes;      /**< In state DRAWING_RECTANGLE: patterns
                                         * to keep selected if Ctrl or Shift was pressed. */
   QPointer<ViewSettings>
       view_settings;                   /**< How the view is displayed. */
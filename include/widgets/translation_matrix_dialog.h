@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_TRANSLATION_MATRIX_DIALOG_H
+#define SOLARUSEDITOR_TRANSLATION_MATRIX_DIALOG_H
+
+#include "translation_matrix_model.h"
+#include "ui_translation_matrix_dialog.h"
+#include <QDialog>
+
+namespace SolarusEditor {
+
+class Quest;
+
+/**
+ * @brief A dialog showing the dialogs or strings of all languages side by side.
+ *
+ * Missing, unused and outdated translations are highlighted compared to
+ * a reference language.
+ * Double-clicking a cell opens the corresponding language file.
+ */
+class TranslationMatrixDialog : public QDialog {
+  Q_OBJECT
+
+public:
+
+  explicit TranslationMatrixDialog(Quest& quest, QWidget* parent = nullptr);
+
+  void set_reference_language(const QString& language_id);
+
+signals:
+
+  void open_file_requested(Quest& quest, const QString& path);
+
+public slots:
+
+  void file_saved(const QString& path);
+
+private slots:
+
+  void kind_selector_activated();
+  void reference_selector_activated();
+  void cell_activated(const QModelIndex& index);
+  void update_rows();
+
+private:
+
+  Ui::TranslationMatrixDialog ui;     /**< The widgets. */
+  Quest& quest;                       /**< The quest. */
+  TranslationMatrixModel model;       /**< Texts of all languages. */
+
+};
+
+}
+
+#endif
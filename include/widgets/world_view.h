@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUSEDITOR_WORLD_VIEW_H
+#define SOLARUSEDITOR_WORLD_VIEW_H
+
+#include <QFutureWatcher>
+#include <QGraphicsView>
+#include <QImage>
+#include <QMap>
+#include <QRect>
+#include <QSet>
+#include <memory>
+
+namespace Solarus {
+
+class MapData;
+
+}
+
+namespace SolarusEditor {
+
+class Quest;
+
+/**
+ * @brief A read-only view of all maps of a world, placed at their location.
+ *
+ * Maps are not loaded as MapModel objects. Each map is drawn once
+ * at a reduced scale in worker threads and the result is cached in
+ * the .editor-cache/thumbnails directory of the quest.
+ * When the user zooms in, maps near the visible area are drawn again
+ * at full scale, and they go back to their thumbnail when they are far.
+ *
+ * Only tiles are drawn.
+ * Double-clicking a map opens it.
+ */
+class WorldView : public QGraphicsView {
+  Q_OBJECT
+
+public:
+
+  explicit WorldView(Quest& quest, QWidget* parent = nullptr);
+  ~WorldView();
+
+  QString get_world() const;
+  void show_world_of_map(const QString& map_id);
+  void clear();
+
+signals:
+
+  void open_file_requested(Quest& quest, const QString& path);
+
+public slots:
+
+  void zoom_in();
+  void zoom_out();
+
+protected:
+
+  void mouseDoubleClickEvent(QMouseEvent* event) override;
+  void resizeEvent(QResizeEvent* event) override;
+
+private slots:
+
+  void thumbnail_loaded(int index);
+  void detail_loaded(int index);
+  void detail_job_finished();
+  void update_visible_area();
+
+private:
+
+  class MapItem;
+  class TilesetStore;
+
+  /**
+   * @brief Overview of a map drawn at a reduced scale.
+   */
+  struct MapThumbnail {
+    QString world;                    /**< World of the map or an empty string. */
+    QRect area;                       /**< Location and size of the map. */
+    QMap<QString, qint64> tilesets;   /**< Modification date of each tileset drawn. */
+    QImage image;                     /**< Tiles of the map at a reduced scale. */
+  };
+
+  /**
+   * @brief A map to draw in a worker thread.
+   */
+  struct MapRequest {
+    const Quest* quest;           /**< The quest. */
+    TilesetStore* tilesets;       /**< Tilesets shared by all workers. */
+    QString map_id;               /**< Id of the map to draw. */
+    QString world;                /**< World being shown. */
+  };
+
+  /**
+   * @brief Result of drawing a map in a worker thread.
+   */
+  struct MapImage {
+    QString map_id;               /**< Id of the map. */
+    bool valid;                   /**< Whether the map could be loaded. */
+    MapThumbnail thumbnail;       /**< Location and image of the map. */
+  };
+
+  static bool load_cached_thumbnail(
+      const Quest& quest, const QString& path, MapThumbnail& thumbnail);
+  static void save_cached_thumbnail(
+      const Quest& quest, const QString& path, const MapThumbnail& thumbnail);
+  static MapImage load_thumbnail(const MapRequest& request);
+  static MapImage load_detail(const MapRequest& request);
+  static QImage draw_map(
+      const Solarus::MapData& map,
+      double scale,
+      TilesetStore& tilesets,
+      QMap<QString, qint64>& tileset_dates);
+
+  void cancel_jobs();
+  void set_zoom(double zoom);
+  void start_next_detail_job();
+
+  Quest& quest;                               /**< The quest. */
+  QString world;                              /**< World shown or an empty string. */
+  QString initial_map_id;                     /**< Map to center the view on. */
+  double zoom;                                /**< Current zoom. */
+  std::unique_ptr<TilesetStore> tilesets;     /**< Tilesets used by workers. */
+  QMap<QString, MapItem*> map_items;          /**< Item of each map shown. */
+  QSet<QString> pending_details;              /**< Maps waiting to be drawn at full scale. */
+  QSet<QString> drawing_details;              /**< Maps being drawn at full scale. */
+  QFutureWatcher<MapImage> thumbnail_job;     /**< Maps being drawn at a reduced scale. */
+  QFutureWatcher<MapImage> detail_job;        /**< Maps being drawn at full scale. */
+
+};
+
+}
+
+#endif
@@ -6,13 +6,18 @@
 
 local converter = {}
 
+local converter_tasks = require("converter_tasks")
+
 local function write_info(message)
 
   io.write(message, "\n")
   io.flush()
 end
 
-function converter.convert(quest_path)
+-- Converts the files that concern the whole quest and returns the list
+-- of independent data files that remain to be converted
+-- (see converter_tasks).
+function converter.prepare(quest_path)
 
   assert(quest_path)
 
@@ -34,23 +39,25 @@ function converter.convert(quest_path)
   local quest_db_converter = require("1_0_to_1_1/quest_db_converter_1_0")
   local resources = quest_db_converter.convert(quest_path, languages)
 
-  -- Convert tilesets.
-  write_info("  Converting tilesets...")
-  local tileset_converter = require("1_0_to_1_1/tileset_converter_1_0")
+  -- List the files to convert.
+  local tasks = {}
   for _, resource in pairs(resources["tileset"]) do
-    write_info("    Tileset " .. resource.id .. " (" .. resource.description .. ")")
-    tileset_converter.convert(quest_path, resource.id)
+    converter_tasks.add(tasks, "tilesets",
+        "Tileset " .. resource.id .. " (" .. resource.description .. ")",
+        "1_0_to_1_1/tileset_converter_1_0", quest_path, resource.id)
   end
-  write_info("  All tilesets were converted.")
-
-  -- Convert sprites.
-  write_info("  Converting sprites...")
-  local sprite_converter = require("1_0_to_1_1/sprite_converter_1_0")
   for _, resource in pairs(resources["sprite"]) do
-    write_info("    Sprite " .. resource.id .. " (" .. resource.description .. ")")
-    sprite_converter.convert(quest_path, resource.id)
+    converter_tasks.add(tasks, "sprites",
+        "Sprite " .. resource.id .. " (" .. resource.description .. ")",
+        "1_0_to_1_1/sprite_converter_1_0", quest_path, resource.id)
   end
-  write_info("  All sprites were converted.")
+  return tasks
+end
+
+function converter.convert(quest_path)
+
+  local tasks = converter.prepare(quest_path)
+  converter_tasks.run(tasks)
 
   write_info("Update successful!")
 
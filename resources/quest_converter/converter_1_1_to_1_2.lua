@@ -6,13 +6,18 @@
 
 local converter = {}
 
+local converter_tasks = require("converter_tasks")
+
 local function write_info(message)
 
   io.write(message, "\n")
   io.flush()
 end
 
-function converter.convert(quest_path)
+-- Converts the files that concern the whole quest and returns the list
+-- of independent data files that remain to be converted
+-- (see converter_tasks).
+function converter.prepare(quest_path)
 
   assert(quest_path)
 
@@ -29,28 +34,30 @@ function converter.convert(quest_path)
   local quest_db_converter = require("1_1_to_1_2/quest_db_converter_1_1")
   local resources = quest_db_converter.convert(quest_path)
 
-  -- Convert maps.
-  write_info("  Converting maps...")
-  local map_converter = require("1_1_to_1_2/map_converter_1_1")
+  -- Create new required sound.
+  write_info("  Converting sounds...")
+  local sounds_converter = require("1_1_to_1_2/sound_converter_1_1")
+  sounds_converter.convert(quest_path)
+
+  -- List the files to convert.
+  local tasks = {}
   for _, resource in pairs(resources["map"]) do
-    write_info("    Map " .. resource.id .. " (" .. resource.description .. ")")
-    map_converter.convert(quest_path, resource.id)
+    converter_tasks.add(tasks, "maps",
+        "Map " .. resource.id .. " (" .. resource.description .. ")",
+        "1_1_to_1_2/map_converter_1_1", quest_path, resource.id)
   end
-  write_info("  All maps were converted.")
-
-  -- Convert strings.dat files.
-  write_info("  Converting strings...")
-  local strings_converter = require("1_1_to_1_2/strings_converter_1_1")
   for _, resource in pairs(resources["language"]) do
-    write_info("    Language " .. resource.id .. " (" .. resource.description .. ")")
-    strings_converter.convert(quest_path, resource.id)
+    converter_tasks.add(tasks, "strings files",
+        "Language " .. resource.id .. " (" .. resource.description .. ")",
+        "1_1_to_1_2/strings_converter_1_1", quest_path, resource.id)
   end
-  write_info("  All strings files were converted.")
+  return tasks
+end
 
-  -- Create new required sound.
-  write_info("  Converting sounds...")
-  local sounds_converter = require("1_1_to_1_2/sound_converter_1_1")
-  sounds_converter.convert(quest_path)
+function converter.convert(quest_path)
+
+  local tasks = converter.prepare(quest_path)
+  converter_tasks.run(tasks)
 
   write_info("Update successful!")
 
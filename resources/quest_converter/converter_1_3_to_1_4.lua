@@ -7,13 +7,18 @@
 
 local converter = {}
 
+local converter_tasks = require("converter_tasks")
+
 local function write_info(message)
 
   io.write(message, "\n")
   io.flush()
 end
 
-function converter.convert(quest_path)
+-- Converts the files that concern the whole quest and returns the list
+-- of independent data files that remain to be converted
+-- (see converter_tasks).
+function converter.prepare(quest_path)
 
   assert(quest_path)
 
@@ -35,14 +40,20 @@ function converter.convert(quest_path)
   local quest_db_converter = require("1_3_to_1_4/quest_db_converter_1_3")
   local resources = quest_db_converter.convert(quest_path, fonts)
 
-  -- Convert maps.
-  write_info("  Converting maps...")
-  local map_converter = require("1_3_to_1_4/map_converter_1_3")
+  -- List the files to convert.
+  local tasks = {}
   for _, resource in pairs(resources["map"]) do
-    write_info("    Map " .. resource.id .. " (" .. resource.description .. ")")
-    map_converter.convert(quest_path, resource.id, default_font)
+    converter_tasks.add(tasks, "maps",
+        "Map " .. resource.id .. " (" .. resource.description .. ")",
+        "1_3_to_1_4/map_converter_1_3", quest_path, resource.id, default_font)
   end
-  write_info("  All maps were converted.")
+  return tasks
+end
+
+function converter.convert(quest_path)
+
+  local tasks = converter.prepare(quest_path)
+  converter_tasks.run(tasks)
 
   write_info("Update successful!")
 
@@ -0,0 +1,58 @@
+-- This module builds and runs the lists of data files to convert
+-- returned by converter.prepare().
+-- Each file is converted by a call like
+-- require(task.module).convert(unpack(task.args)) and does not depend on
+-- the other files, so files can be converted in any order or in parallel.
+-- Usage:
+--   local converter_tasks = require("converter_tasks")
+--   local tasks = {}
+--   converter_tasks.add(tasks, "maps", "Map " .. map_id, "1_4_to_1_5/map_converter_1_4", quest_path, map_id)
+--   converter_tasks.run(tasks)
+
+local converter_tasks = {}
+
+local unpack = unpack or table.unpack
+
+local function write_info(message)
+
+  io.write(message, "\n")
+  io.flush()
+end
+
+-- Adds a file conversion to a list of tasks.
+-- stage is the kind of files being converted, like "maps".
+-- label describes the file in messages.
+-- Extra arguments are passed to the convert() function of the module,
+-- nil values included.
+function converter_tasks.add(tasks, stage, label, module, ...)
+
+  tasks[#tasks + 1] = {
+    stage = stage,
+    label = label,
+    module = module,
+    args = { n = select("#", ...), ... },
+  }
+end
+
+-- Converts all files of a list of tasks one after the other.
+function converter_tasks.run(tasks)
+
+  local stage = nil
+  for _, task in ipairs(tasks) do
+    if task.stage ~= stage then
+      if stage ~= nil then
+        write_info("  All " .. stage .. " were converted.")
+      end
+      stage = task.stage
+      write_info("  Converting " .. stage .. "...")
+    end
+    write_info("    " .. task.label)
+    local module = require(task.module)
+    module.convert(unpack(task.args, 1, task.args.n))
+  end
+  if stage ~= nil then
+    write_info("  All " .. stage .. " were converted.")
+  end
+end
+
+return converter_tasks
@@ -54,7 +54,18 @@ local function update_step(quest_path, old_format, new_format)
   new_format = new_format:gsub("%.", "_")
   local converter_name = "converter_" .. old_format .. "_to_" .. new_format
   local converter = require(converter_name)
-  converter.convert(quest_path)
+  if run_tasks ~= nil and converter.prepare ~= nil then
+    -- The quest editor provides run_tasks() to convert independent files
+    -- in parallel. It returns the number of files that failed.
+    local tasks = converter.prepare(quest_path)
+    local num_failures = run_tasks(tasks)
+    if num_failures > 0 then
+      error(num_failures .. " file(s) could not be converted")
+    end
+    write_info("Update successful!")
+  else
+    converter.convert(quest_path)
+  end
 end
 
 -- Main function.
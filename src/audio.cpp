@@ -15,66 +15,49 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "audio.h"
+#include "audio_player.h"
 #include "quest.h"
-#include <solarus/audio/Music.h>
-#include <solarus/audio/Sound.h>
-#include <solarus/core/Arguments.h>
-#include <solarus/core/QuestFiles.h>
-#include <QApplication>
-#include <QDebug>
-#include <QTimer>
+#include <QCoreApplication>
+#include <QThread>
 
 namespace SolarusEditor {
 
 namespace {
 
-bool initialized = false;
+AudioPlayer* player = nullptr;
+QThread* player_thread = nullptr;
+
+/**
+ * @brief Stops the audio thread and cleans up the sound system.
+ */
+void quit() {
+
+  QMetaObject::invokeMethod(player, "quit", Qt::BlockingQueuedConnection);
+  player_thread->quit();
+  player_thread->wait();
+  delete player;
+  player = nullptr;
+}
 
 /**
  * @brief Initializes the sound features.
+ *
+ * Audio files are decoded and played by a player running in its own thread.
  */
 void initialize() {
 
-  Solarus::Sound::initialize(Solarus::Arguments());
-  initialized = true;
+  player_thread = new QThread(QCoreApplication::instance());
+  player = new AudioPlayer();
+  player->moveToThread(player_thread);
+  player_thread->start();
+  QMetaObject::invokeMethod(player, "initialize", Qt::QueuedConnection);
 
   // Cleanup Solarus sound system at exit.
   QObject::connect(
         QCoreApplication::instance(),
-        &QApplication::aboutToQuit,
-        Solarus::Sound::quit
+        &QCoreApplication::aboutToQuit,
+        quit
   );
-
-  // Update the Solarus sound system from time to time.
-  QTimer* update_timer = new QTimer(QCoreApplication::instance());
-  QObject::connect(
-        update_timer,
-        &QTimer::timeout,
-        Solarus::Sound::update
-  );
-  update_timer->setSingleShot(false);
-  update_timer->start(10);
-}
-
-/**
- * @brief Opens a quest on the engine's side, making it the current one.
- * @param quest The quest to open.
- * @return @c true in case of success.
- */
-bool open_quest(const Quest& quest) {
-
-  // TODO factorize this more.
-  QStringList arguments = QApplication::arguments();
-  QString program_name = arguments.isEmpty() ? QString() : arguments.first();
-  return Solarus::QuestFiles::open_quest(program_name.toStdString(),
-                                         quest.get_root_path().toStdString());
-}
-
-/**
- * @brief Closes the current quest on the engine's side.
- */
-void close_quest() {
-  Solarus::QuestFiles::close_quest();
 }
 
 }  // Anonymous namespace.
@@ -89,22 +72,13 @@ namespace Audio {
  */
 void play_sound(const Quest& quest, const QString& sound_id) {
 
-  if (!initialized) {
+  if (player == nullptr) {
     initialize();
   }
 
-  if (!open_quest(quest)) {
-    qWarning() << "Failed to open quest " << quest.get_root_path();
-    return;
-  }
-
-  if (!Solarus::Sound::exists(sound_id.toStdString())) {
-    qWarning() << "Cannot open sound file " << sound_id;
-    return;
-  }
-  Solarus::Sound::play(sound_id.toStdString());
-
-  close_quest();
+  QMetaObject::invokeMethod(player, "play_sound", Qt::QueuedConnection,
+                            Q_ARG(QString, quest.get_root_path()),
+                            Q_ARG(QString, sound_id));
 }
 
 /**
@@ -115,22 +89,13 @@ void play_sound(const Quest& quest, const QString& sound_id) {
  */
 void play_music(Quest& quest, const QString& music_id) {
 
-  if (!initialized) {
+  if (player == nullptr) {
     initialize();
   }
 
-  if (!open_quest(quest)) {
-    qWarning() << "Failed to open quest " << quest.get_root_path();
-    return;
-  }
-
-  if (!Solarus::Music::exists(music_id.toStdString())) {
-    qWarning() << "Cannot open music file " << music_id;
-    return;
-  }
-  Solarus::Music::play(music_id.toStdString(), true);
-
-  close_quest();
+  QMetaObject::invokeMethod(player, "play_music", Qt::QueuedConnection,
+                            Q_ARG(QString, quest.get_root_path()),
+                            Q_ARG(QString, music_id));
 
   quest.set_current_music_id(music_id);
 }
@@ -141,15 +106,29 @@ void play_music(Quest& quest, const QString& music_id) {
  */
 void stop_music(Quest& quest) {
 
-  if (!initialized) {
+  if (player == nullptr) {
     initialize();
   }
 
-  Solarus::Music::stop_playing();
+  QMetaObject::invokeMethod(player, "stop_music", Qt::QueuedConnection);
 
   quest.set_current_music_id("");
 }
 
+/**
+ * @brief Forgets the quest currently mounted for audio if any.
+ *
+ * Call this function when closing a quest to release its decoded sounds.
+ */
+void close_quest() {
+
+  if (player == nullptr) {
+    return;
+  }
+
+  QMetaObject::invokeMethod(player, "close_quest", Qt::QueuedConnection);
+}
+
 /**
  * @brief Returns the id of the music currently playing if any.
  * @param quest The quest.
@@ -0,0 +1,420 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "audio_analyzer.h"
+#include "audio_decoder.h"
+#include "data_file_cache.h"
+#include "file_tools.h"
+#include "quest.h"
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace SolarusEditor {
+
+namespace {
+
+/**
+ * @brief Lowest level reported, in dBFS.
+ *
+ * This is the dynamic range of 16-bit samples.
+ */
+constexpr double min_level = -96.0;
+
+/**
+ * @brief Converts a linear amplitude to dBFS.
+ * @param amplitude An amplitude between 0 and 1.
+ * @return The corresponding level, at least min_level.
+ */
+double to_level(double amplitude) {
+
+  if (amplitude <= 0.0) {
+    return min_level;
+  }
+  return std::max(20.0 * std::log10(amplitude), min_level);
+}
+
+/**
+ * @brief Loads the analysis of an audio file from the cache if it is up to
+ * date with the file.
+ * @param[in] quest The quest.
+ * @param[in] path Path of the audio file.
+ * @param[out] analysis The analysis to fill. Unchanged in case of failure.
+ * @return @c true if the analysis was loaded from the cache.
+ */
+bool load_cached_analysis(
+    const Quest& quest, const QString& path, AudioAnalyzer::Analysis& analysis) {
+
+  AudioAnalyzer::Analysis result;
+  const bool success = DataFileCache::read_snapshot(
+        quest, path, "audio", [&result](QDataStream& stream) {
+    stream >> result.format >> result.decoded >> result.file_size >> result.duration
+           >> result.sample_rate >> result.num_channels >> result.peak >> result.rms
+           >> result.decoded_size >> result.loop_start >> result.loop_end;
+  });
+  if (!success) {
+    return false;
+  }
+
+  analysis = result;
+  return true;
+}
+
+/**
+ * @brief Writes the analysis of an audio file to the cache.
+ * @param quest The quest.
+ * @param path Path of the audio file, which must be up to date with the analysis.
+ * @param analysis The analysis.
+ */
+void save_cached_analysis(
+    const Quest& quest, const QString& path, const AudioAnalyzer::Analysis& analysis) {
+
+  DataFileCache::write_snapshot(quest, path, "audio", [&analysis](QDataStream& stream) {
+    stream << analysis.format << analysis.decoded << analysis.file_size << analysis.duration
+           << analysis.sample_rate << analysis.num_channels << analysis.peak << analysis.rms
+           << analysis.decoded_size << analysis.loop_start << analysis.loop_end;
+  });
+}
+
+}
+
+/**
+ * @brief Creates an audio analyzer.
+ * @param quest The quest whose files will be analyzed.
+ * @param parent The parent object or nullptr.
+ */
+AudioAnalyzer::AudioAnalyzer(const Quest& quest, QObject* parent) :
+  QObject(parent),
+  quest(quest),
+  results(),
+  pending_paths(),
+  queued_paths(),
+  job() {
+
+  connect(&job, SIGNAL(resultReadyAt(int)),
+          this, SLOT(result_ready(int)));
+  connect(&job, SIGNAL(finished()),
+          this, SLOT(job_finished()));
+}
+
+/**
+ * @brief Destructor.
+ *
+ * Waits for analyses in progress.
+ */
+AudioAnalyzer::~AudioAnalyzer() {
+
+  job.cancel();
+  job.waitForFinished();
+}
+
+/**
+ * @brief Returns the analysis of an audio file if it is known.
+ *
+ * If the file was never analyzed or was modified since, it is scheduled
+ * for analysis and analysis_ready() will be emitted later.
+ *
+ * @param[in] path Path of an audio file of the quest.
+ * @param[out] analysis The analysis. Unchanged if it is not known yet.
+ * @return @c true if the analysis is known and up to date.
+ */
+bool AudioAnalyzer::get_analysis(const QString& path, Analysis& analysis) {
+
+  const qint64 last_modified =
+      quest.get_file_info_cache().get_last_modified(path).toMSecsSinceEpoch();
+  const auto& it = results.constFind(path);
+  if (it != results.constEnd() && it->last_modified == last_modified) {
+    analysis = it->analysis;
+    return true;
+  }
+
+  request_analysis(QStringList() << path);
+  return false;
+}
+
+/**
+ * @brief Schedules the analysis of audio files.
+ *
+ * Files already analyzed and not modified since are skipped.
+ *
+ * @param paths Paths of audio files of the quest.
+ */
+void AudioAnalyzer::request_analysis(const QStringList& paths) {
+
+  for (const QString& path : paths) {
+    if (queued_paths.contains(path)) {
+      continue;
+    }
+    const auto& it = results.constFind(path);
+    if (it != results.constEnd() &&
+        it->last_modified == quest.get_file_info_cache().get_last_modified(path).toMSecsSinceEpoch()) {
+      continue;
+    }
+    pending_paths << path;
+    queued_paths << path;
+  }
+
+  start_job();
+}
+
+/**
+ * @brief Returns whether some analyses are still in progress.
+ * @return @c true if files are waiting to be analyzed.
+ */
+bool AudioAnalyzer::is_busy() const {
+  return !queued_paths.isEmpty();
+}
+
+/**
+ * @brief Cancels analyses in progress and forgets all results.
+ *
+ * Call this before the quest changes.
+ */
+void AudioAnalyzer::clear() {
+
+  job.cancel();
+  job.waitForFinished();
+  results.clear();
+  pending_paths.clear();
+  queued_paths.clear();
+}
+
+/**
+ * @brief Starts analyzing pending files unless a job is already running.
+ */
+void AudioAnalyzer::start_job() {
+
+  if (job.isRunning() || pending_paths.isEmpty()) {
+    return;
+  }
+
+  QList<Request> requests;
+  for (const QString& path : pending_paths) {
+    requests << Request{ &quest, path };
+  }
+  pending_paths.clear();
+
+  job.setFuture(QtConcurrent::mapped(requests, &AudioAnalyzer::analyze));
+}
+
+/**
+ * @brief Slot called when the analysis of a file is finished.
+ * @param index Index of the result in the job.
+ */
+void AudioAnalyzer::result_ready(int index) {
+
+  const Result& result = job.resultAt(index);
+  if (!queued_paths.remove(result.path)) {
+    // Obsolete result from before clear().
+    return;
+  }
+
+  results.insert(result.path, result);
+  emit analysis_ready(result.path);
+}
+
+/**
+ * @brief Slot called when a job is finished.
+ *
+ * Starts the next one if files were requested in the meantime.
+ */
+void AudioAnalyzer::job_finished() {
+
+  if (!pending_paths.isEmpty()) {
+    start_job();
+    return;
+  }
+
+  emit all_analyses_ready();
+}
+
+/**
+ * @brief Analyzes an audio file.
+ *
+ * This function is called from a worker thread.
+ * The result is read from the cache of the quest if it is up to date,
+ * and written to it otherwise.
+ *
+ * @param request The file to analyze.
+ * @return The analysis.
+ */
+AudioAnalyzer::Result AudioAnalyzer::analyze(const Request& request) {
+
+  Result result;
+  result.path = request.path;
+  result.last_modified = QFileInfo(request.path).lastModified().toMSecsSinceEpoch();
+  result.analysis = Analysis();
+  Analysis& analysis = result.analysis;
+  analysis.loop_start = -1;
+  analysis.loop_end = -1;
+
+  if (load_cached_analysis(*request.quest, request.path, analysis)) {
+    return result;
+  }
+
+  QFile file(request.path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return result;
+  }
+  const QByteArray& data = file.readAll();
+  analysis.file_size = data.size();
+
+  // Measure samples as they are decoded rather than keeping them.
+  int peak = 0;
+  double sum_squares = 0.0;
+  qint64 num_samples = 0;
+  AudioDecoder::SampleCallback measure = [&](const qint16* samples, int count) {
+    for (int i = 0; i < count; ++i) {
+      const int value = std::abs(static_cast<int>(samples[i]));
+      peak = std::max(peak, value);
+      sum_squares += static_cast<double>(value) * value;
+    }
+    num_samples += count;
+  };
+
+  AudioDecoder::DecodedAudio audio;
+  const QString& extension = QFileInfo(request.path).suffix().toLower();
+  if (extension == "ogg") {
+    analysis.format = "Ogg Vorbis";
+    analysis.decoded = AudioDecoder::decode_ogg(data, audio, measure);
+  }
+  else if (extension == "it") {
+    analysis.format = "Impulse Tracker";
+    analysis.decoded = AudioDecoder::decode_it(data, audio, measure);
+  }
+  else {
+    analysis.format = extension.toUpper();
+    analysis.decoded = false;
+  }
+
+  if (analysis.decoded && audio.sample_rate > 0 && audio.num_channels > 0) {
+    analysis.sample_rate = audio.sample_rate;
+    analysis.num_channels = audio.num_channels;
+    analysis.decoded_size = num_samples * 2;
+    analysis.duration = num_samples / audio.num_channels * 1000 / audio.sample_rate;
+    analysis.loop_start = audio.loop_start;
+    analysis.loop_end = audio.loop_end;
+    analysis.peak = to_level(peak / 32768.0);
+    analysis.rms = num_samples > 0 ?
+          to_level(std::sqrt(sum_squares / num_samples) / 32768.0) :
+          min_level;
+  }
+  else {
+    analysis.decoded = false;
+  }
+
+  save_cached_analysis(*request.quest, request.path, analysis);
+  return result;
+}
+
+/**
+ * @brief Returns the memory used by an audio file when the game runs.
+ *
+ * Sounds are entirely decoded when the engine loads them, while musics
+ * are streamed from their file data kept in memory.
+ *
+ * @param resource_type SOUND or MUSIC.
+ * @param analysis Analysis of the file.
+ * @return The memory size in bytes.
+ */
+qint64 AudioAnalyzer::get_memory_size(ResourceType resource_type, const Analysis& analysis) {
+
+  if (resource_type == ResourceType::SOUND) {
+    return analysis.decoded_size;
+  }
+  return analysis.file_size;
+}
+
+/**
+ * @brief Returns a human-readable description of an analysis.
+ * @param resource_type SOUND or MUSIC.
+ * @param analysis Analysis of the file.
+ * @return The description, possibly on several lines.
+ */
+QString AudioAnalyzer::get_summary(ResourceType resource_type, const Analysis& analysis) {
+
+  if (!analysis.decoded) {
+    return tr("%1, %2 (not decoded)").arg(analysis.format, FileTools::format_size(analysis.file_size));
+  }
+
+  QString summary = tr("%1, %2, %3 Hz, %4\nPeak: %5, RMS: %6\nMemory in game: %7").
+      arg(analysis.format).
+      arg(format_duration(analysis.duration)).
+      arg(analysis.sample_rate).
+      arg(analysis.num_channels == 1 ? tr("mono") : tr("stereo")).
+      arg(format_level(analysis.peak)).
+      arg(format_level(analysis.rms)).
+      arg(FileTools::format_size(get_memory_size(resource_type, analysis)));
+
+  const QString& loop = format_loop(analysis);
+  if (!loop.isEmpty()) {
+    summary += '\n' + tr("Loop: %1").arg(loop);
+  }
+  return summary;
+}
+
+/**
+ * @brief Formats a duration like 1:05.250.
+ * @param duration A duration in milliseconds.
+ * @return The formatted duration.
+ */
+QString AudioAnalyzer::format_duration(qint64 duration) {
+
+  return QString("%1:%2.%3").
+      arg(duration / 60000).
+      arg((duration / 1000) % 60, 2, 10, QChar('0')).
+      arg(duration % 1000, 3, 10, QChar('0'));
+}
+
+/**
+ * @brief Formats a level in dBFS.
+ * @param level A level in dBFS.
+ * @return The formatted level.
+ */
+QString AudioAnalyzer::format_level(double level) {
+
+  return tr("%1 dBFS").arg(level, 0, 'f', 1);
+}
+
+/**
+ * @brief Formats the loop points of an analysis like 0:01.500 - 0:30.000.
+ *
+ * The engine loops musics from LOOPSTART to LOOPEND, or to the end of
+ * the file when there is no LOOPEND.
+ *
+ * @param analysis Analysis of a decoded file.
+ * @return The formatted loop points, or an empty string if the file has
+ * no LOOPSTART.
+ */
+QString AudioAnalyzer::format_loop(const Analysis& analysis) {
+
+  if (!analysis.decoded || analysis.sample_rate <= 0 || analysis.loop_start < 0) {
+    return QString();
+  }
+
+  const QString& start = format_duration(analysis.loop_start * 1000 / analysis.sample_rate);
+  if (analysis.loop_end < 0) {
+    return tr("%1 - end").arg(start);
+  }
+  const QString& end = format_duration(analysis.loop_end * 1000 / analysis.sample_rate);
+  return tr("%1 - %2").arg(start, end);
+}
+
+}
@@ -0,0 +1,331 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "audio_decoder.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cstring>
+#include <modplug.h>
+#include <vorbis/vorbisfile.h>
+
+namespace SolarusEditor {
+
+namespace AudioDecoder {
+
+namespace {
+
+/**
+ * @brief Number of samples decoded at once.
+ */
+constexpr int chunk_size = 8192;
+
+/**
+ * @brief Sample rate of decoded Impulse Tracker files, like the engine.
+ */
+constexpr int it_sample_rate = 44100;
+
+/**
+ * @brief Serializes the use of ModPlug, whose settings and mixing buffers
+ * are global.
+ */
+QMutex modplug_mutex;
+
+/**
+ * @brief Applies the settings used to decode Impulse Tracker files here
+ * and restores the previous ModPlug settings when destroyed.
+ *
+ * The engine streams musics with its own ModPlug settings, so they must
+ * be left unchanged.
+ * The ModPlug mutex must be locked during the whole lifetime of this object.
+ */
+class ModPlugSettingsScope {
+
+public:
+
+  ModPlugSettingsScope() :
+    previous_settings() {
+
+    ModPlug_GetSettings(&previous_settings);
+
+    ModPlug_Settings settings = previous_settings;
+    settings.mFlags = MODPLUG_ENABLE_OVERSAMPLING;
+    settings.mChannels = 2;
+    settings.mBits = 16;
+    settings.mFrequency = it_sample_rate;
+    settings.mResamplingMode = MODPLUG_RESAMPLE_LINEAR;
+    settings.mLoopCount = 0;
+    ModPlug_SetSettings(&settings);
+  }
+
+  ~ModPlugSettingsScope() {
+    ModPlug_SetSettings(&previous_settings);
+  }
+
+private:
+
+  ModPlug_Settings previous_settings;      /**< Settings to restore. */
+
+};
+
+/**
+ * @brief Ogg data being read from memory.
+ */
+struct OggMemory {
+  const QByteArray* data;        /**< The whole file. */
+  qint64 position;               /**< Current reading position. */
+};
+
+/**
+ * @brief Reads Ogg data from memory.
+ *
+ * This function has the signature of fread() as expected by vorbisfile.
+ */
+size_t ogg_read(void* ptr, size_t size, size_t nb_bytes, void* datasource) {
+
+  OggMemory& memory = *static_cast<OggMemory*>(datasource);
+  const qint64 remaining = memory.data->size() - memory.position;
+  const qint64 total = std::min(static_cast<qint64>(size * nb_bytes), remaining);
+  if (total <= 0) {
+    return 0;
+  }
+  std::memcpy(ptr, memory.data->constData() + memory.position, static_cast<size_t>(total));
+  memory.position += total;
+  return static_cast<size_t>(total) / size;
+}
+
+/**
+ * @brief Changes the reading position in Ogg data from memory.
+ *
+ * This function has the signature of fseek() as expected by vorbisfile.
+ */
+int ogg_seek(void* datasource, ogg_int64_t offset, int whence) {
+
+  OggMemory& memory = *static_cast<OggMemory*>(datasource);
+  qint64 position = 0;
+  switch (whence) {
+
+  case SEEK_SET:
+    position = offset;
+    break;
+
+  case SEEK_CUR:
+    position = memory.position + offset;
+    break;
+
+  case SEEK_END:
+    position = memory.data->size() + offset;
+    break;
+
+  default:
+    return -1;
+  }
+
+  if (position < 0 || position > memory.data->size()) {
+    return -1;
+  }
+  memory.position = position;
+  return 0;
+}
+
+/**
+ * @brief Returns the value of a numeric comment of an Ogg file.
+ * @param comment Comments of the file, or nullptr.
+ * @param name Name of the comment like "LOOPSTART". Names are case insensitive.
+ * @return The value, or -1 if there is no such comment or if it is not
+ * a positive number.
+ */
+qint64 get_ogg_comment_number(const vorbis_comment* comment, const QByteArray& name) {
+
+  if (comment == nullptr) {
+    return -1;
+  }
+
+  const QByteArray prefix = name.toUpper() + '=';
+  for (int i = 0; i < comment->comments; ++i) {
+    const QByteArray entry(comment->user_comments[i], comment->comment_lengths[i]);
+    if (entry.left(prefix.size()).toUpper() != prefix) {
+      continue;
+    }
+    bool ok = false;
+    const qint64 value = entry.mid(prefix.size()).trimmed().toLongLong(&ok);
+    return (ok && value >= 0) ? value : -1;
+  }
+  return -1;
+}
+
+/**
+ * @brief Returns the reading position in Ogg data from memory.
+ *
+ * This function has the signature of ftell() as expected by vorbisfile.
+ */
+long ogg_tell(void* datasource) {
+
+  OggMemory& memory = *static_cast<OggMemory*>(datasource);
+  return static_cast<long>(memory.position);
+}
+
+}
+
+/**
+ * @brief Creates an empty decoded audio.
+ */
+DecodedAudio::DecodedAudio() :
+  samples(),
+  num_channels(0),
+  sample_rate(0),
+  loop_start(-1),
+  loop_end(-1) {
+
+}
+
+/**
+ * @brief Returns the lock that serializes the use of ModPlug.
+ *
+ * ModPlug settings and mixing state are global: anything that loads, reads
+ * or unloads Impulse Tracker files with ModPlug, including the engine when
+ * it streams a music, must hold this lock.
+ *
+ * @return The ModPlug lock.
+ */
+QMutex& get_modplug_mutex() {
+  return modplug_mutex;
+}
+
+/**
+ * @brief Decodes a whole Ogg Vorbis file.
+ *
+ * Its LOOPSTART and LOOPEND comments are also read.
+ *
+ * @param[in] data Content of the file.
+ * @param[out] audio The decoded samples. Unchanged in case of failure.
+ * @param[in] callback If set, decoded samples are passed to this function
+ * chunk by chunk instead of being stored in @c audio.samples.
+ * @return @c true in case of success.
+ */
+bool decode_ogg(const QByteArray& data, DecodedAudio& audio, const SampleCallback& callback) {
+
+  OggMemory memory = { &data, 0 };
+  ov_callbacks callbacks = { ogg_read, ogg_seek, nullptr, ogg_tell };
+  OggVorbis_File file;
+  if (ov_open_callbacks(&memory, &file, nullptr, 0, callbacks) != 0) {
+    return false;
+  }
+
+  vorbis_info* info = ov_info(&file, -1);
+  if (info == nullptr || info->channels < 1 || info->channels > 2) {
+    ov_clear(&file);
+    return false;
+  }
+
+  DecodedAudio result;
+  result.num_channels = info->channels;
+  result.sample_rate = static_cast<int>(info->rate);
+
+  const vorbis_comment* comment = ov_comment(&file, -1);
+  result.loop_start = get_ogg_comment_number(comment, "LOOPSTART");
+  result.loop_end = get_ogg_comment_number(comment, "LOOPEND");
+
+  // Reserve the exact size when the length is known.
+  const ogg_int64_t num_samples = ov_pcm_total(&file, -1);
+  if (!callback && num_samples > 0) {
+    result.samples.reserve(static_cast<int>(num_samples * result.num_channels * 2));
+  }
+
+  const int big_endian = (Q_BYTE_ORDER == Q_BIG_ENDIAN) ? 1 : 0;
+  qint16 buffer[chunk_size];
+  int bitstream = 0;
+  long bytes_read = 0;
+  do {
+    bytes_read = ov_read(&file, reinterpret_cast<char*>(buffer), sizeof(buffer),
+                         big_endian, 2, 1, &bitstream);
+    if (bytes_read < 0) {
+      ov_clear(&file);
+      return false;
+    }
+    if (callback) {
+      callback(buffer, static_cast<int>(bytes_read / 2));
+    }
+    else {
+      result.samples.append(reinterpret_cast<const char*>(buffer), static_cast<int>(bytes_read));
+    }
+  } while (bytes_read > 0);
+
+  ov_clear(&file);
+  audio = result;
+  return true;
+}
+
+/**
+ * @brief Decodes a whole Impulse Tracker file, without looping.
+ *
+ * Samples are produced in stereo at 44100 Hz like the engine does.
+ * ModPlug is locked chunk by chunk rather than during the whole decoding,
+ * so that a music streamed by the engine at the same time keeps playing.
+ *
+ * @param[in] data Content of the file.
+ * @param[out] audio The decoded samples. Unchanged in case of failure.
+ * @param[in] callback If set, decoded samples are passed to this function
+ * chunk by chunk instead of being stored in @c audio.samples.
+ * @return @c true in case of success.
+ */
+bool decode_it(const QByteArray& data, DecodedAudio& audio, const SampleCallback& callback) {
+
+  ModPlugFile* file = nullptr;
+  {
+    // The loop count is stored in the file when loading it.
+    QMutexLocker locker(&modplug_mutex);
+    ModPlugSettingsScope settings_scope;
+    file = ModPlug_Load(data.constData(), data.size());
+  }
+  if (file == nullptr) {
+    return false;
+  }
+
+  DecodedAudio result;
+  result.num_channels = 2;
+  result.sample_rate = it_sample_rate;
+
+  qint16 buffer[chunk_size];
+  while (true) {
+    int bytes_read = 0;
+    {
+      QMutexLocker locker(&modplug_mutex);
+      ModPlugSettingsScope settings_scope;
+      bytes_read = ModPlug_Read(file, buffer, sizeof(buffer));
+    }
+    if (bytes_read <= 0) {
+      break;
+    }
+    if (callback) {
+      callback(buffer, bytes_read / 2);
+    }
+    else {
+      result.samples.append(reinterpret_cast<const char*>(buffer), bytes_read);
+    }
+  }
+
+  {
+    QMutexLocker locker(&modplug_mutex);
+    ModPlug_Unload(file);
+  }
+  audio = result;
+  return true;
+}
+
+}
+
+}
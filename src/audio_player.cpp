@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "audio_decoder.h"
+#include "audio_player.h"
+#include <solarus/audio/Music.h>
+#include <solarus/audio/Sound.h>
+#include <solarus/core/Arguments.h>
+#include <solarus/core/QuestFiles.h>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QTimer>
+#include <al.h>
+
+namespace SolarusEditor {
+
+namespace {
+
+/**
+ * @brief Maximum total size in bytes of decoded sounds kept in memory.
+ */
+constexpr int sound_cache_max_size = 32 * 1024 * 1024;
+
+/**
+ * @brief Number of sounds that can be played at the same time.
+ */
+constexpr int num_sources = 16;
+
+/**
+ * @brief Interval in milliseconds between two updates of the sound system.
+ */
+constexpr int update_interval = 10;
+
+}
+
+/**
+ * @brief Creates an audio player.
+ *
+ * Call initialize() from the player's thread before playing anything.
+ *
+ * @param parent The parent object or nullptr.
+ */
+AudioPlayer::AudioPlayer(QObject* parent) :
+  QObject(parent),
+  update_timer(new QTimer(this)),
+  program_name(),
+  mounted_root_path(),
+  sounds(sound_cache_max_size),
+  sources(),
+  next_source_index(0) {
+
+  QStringList arguments = QCoreApplication::arguments();
+  program_name = arguments.isEmpty() ? QString() : arguments.first();
+
+  update_timer->setSingleShot(false);
+  connect(update_timer, &QTimer::timeout, this, &AudioPlayer::update_sound_system);
+}
+
+/**
+ * @brief Initializes the sound features.
+ */
+void AudioPlayer::initialize() {
+
+  Solarus::Sound::initialize(Solarus::Arguments());
+
+  sources.resize(num_sources);
+  alGenSources(num_sources, sources.data());
+
+  update_timer->start(update_interval);
+}
+
+/**
+ * @brief Stops everything and cleans up the sound system.
+ */
+void AudioPlayer::quit() {
+
+  update_timer->stop();
+  stop_music();
+  close_quest();
+
+  for (ALuint source : sources) {
+    alSourceStop(source);
+  }
+  alDeleteSources(static_cast<ALsizei>(sources.size()), sources.data());
+  sources.clear();
+
+  Solarus::Sound::quit();
+}
+
+/**
+ * @brief Plays a sound of a quest.
+ * @param root_path Root path of the quest.
+ * @param sound_id Id of the sound to play: filename without extension,
+ * relative to the sounds directory.
+ */
+void AudioPlayer::play_sound(const QString& root_path, const QString& sound_id) {
+
+  if (!mount_quest(root_path)) {
+    qWarning() << "Failed to open quest " << root_path;
+    return;
+  }
+
+  CachedSound* sound = get_sound(sound_id);
+  if (sound == nullptr) {
+    // Not decoded here or too big for the cache: let the engine play it.
+    if (!Solarus::Sound::exists(sound_id.toStdString())) {
+      qWarning() << "Cannot open sound file " << sound_id;
+      return;
+    }
+    Solarus::Sound::play(sound_id.toStdString());
+    return;
+  }
+
+  ALuint source = get_free_source();
+  if (source == AL_NONE) {
+    return;
+  }
+  alSourceStop(source);
+  alSourcei(source, AL_BUFFER, static_cast<ALint>(sound->buffer));
+  alSourcePlay(source);
+}
+
+/**
+ * @brief Plays a music of a quest.
+ *
+ * The music is then streamed from this thread.
+ *
+ * @param root_path Root path of the quest.
+ * @param music_id Id of the music to play: filename without extension,
+ * relative to the musics directory.
+ */
+void AudioPlayer::play_music(const QString& root_path, const QString& music_id) {
+
+  if (!mount_quest(root_path)) {
+    qWarning() << "Failed to open quest " << root_path;
+    return;
+  }
+
+  if (!Solarus::Music::exists(music_id.toStdString())) {
+    qWarning() << "Cannot open music file " << music_id;
+    return;
+  }
+
+  QMutexLocker locker(&AudioDecoder::get_modplug_mutex());
+  Solarus::Music::play(music_id.toStdString(), true);
+}
+
+/**
+ * @brief Stops playing any music.
+ */
+void AudioPlayer::stop_music() {
+
+  QMutexLocker locker(&AudioDecoder::get_modplug_mutex());
+  Solarus::Music::stop_playing();
+}
+
+/**
+ * @brief Updates the Solarus sound system, which decodes the next part
+ * of the current music if any.
+ */
+void AudioPlayer::update_sound_system() {
+
+  QMutexLocker locker(&AudioDecoder::get_modplug_mutex());
+  Solarus::Sound::update();
+}
+
+/**
+ * @brief Unmounts the current quest if any and forgets its sounds.
+ */
+void AudioPlayer::close_quest() {
+
+  sounds.clear();
+
+  if (!mounted_root_path.isEmpty()) {
+    Solarus::QuestFiles::close_quest();
+    mounted_root_path.clear();
+  }
+}
+
+/**
+ * @brief Makes sure that a quest is the one mounted on the engine's side.
+ *
+ * Does nothing if it is already mounted.
+ *
+ * @param root_path Root path of the quest.
+ * @return @c true in case of success.
+ */
+bool AudioPlayer::mount_quest(const QString& root_path) {
+
+  if (root_path == mounted_root_path) {
+    return true;
+  }
+
+  close_quest();
+  if (!Solarus::QuestFiles::open_quest(program_name.toStdString(),
+                                       root_path.toStdString())) {
+    return false;
+  }
+  mounted_root_path = root_path;
+  return true;
+}
+
+/**
+ * @brief Returns a decoded sound of the mounted quest.
+ *
+ * The sound is decoded if it is not in the cache yet or if its file has
+ * changed since.
+ *
+ * @param sound_id Id of a sound.
+ * @return The decoded sound, or nullptr if it cannot be decoded or is too
+ * big for the cache.
+ */
+AudioPlayer::CachedSound* AudioPlayer::get_sound(const QString& sound_id) {
+
+  const QString file_name = "sounds/" + sound_id + ".ogg";
+  const QDateTime last_modified = QFileInfo(mounted_root_path + "/data/" + file_name).lastModified();
+
+  CachedSound* sound = sounds.object(sound_id);
+  if (sound != nullptr && sound->last_modified == last_modified) {
+    return sound;
+  }
+
+  const std::string std_file_name = file_name.toStdString();
+  if (!Solarus::QuestFiles::data_file_exists(std_file_name)) {
+    return nullptr;
+  }
+
+  const std::string& content = Solarus::QuestFiles::data_file_read(std_file_name);
+  AudioDecoder::DecodedAudio audio;
+  if (!AudioDecoder::decode_ogg(
+        QByteArray::fromRawData(content.data(), static_cast<int>(content.size())), audio)) {
+    return nullptr;
+  }
+
+  const int cost = audio.samples.size();
+  if (cost > sounds.maxCost()) {
+    return nullptr;
+  }
+
+  alGetError();
+  ALuint buffer = AL_NONE;
+  alGenBuffers(1, &buffer);
+  alBufferData(buffer,
+               audio.num_channels == 2 ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16,
+               audio.samples.constData(),
+               audio.samples.size(),
+               audio.sample_rate);
+  if (alGetError() != AL_NO_ERROR) {
+    alDeleteBuffers(1, &buffer);
+    return nullptr;
+  }
+
+  sound = new CachedSound(buffer, sources);
+  sound->last_modified = last_modified;
+  sounds.insert(sound_id, sound, cost);  // May evict older sounds.
+  return sound;
+}
+
+/**
+ * @brief Returns a source to play a new sound.
+ *
+ * If all sources are busy, one of them is interrupted, in turn.
+ *
+ * @return A source, or AL_NONE if the player is not initialized.
+ */
+unsigned AudioPlayer::get_free_source() {
+
+  if (sources.empty()) {
+    return AL_NONE;
+  }
+
+  for (ALuint source : sources) {
+    ALint state = AL_STOPPED;
+    alGetSourcei(source, AL_SOURCE_STATE, &state);
+    if (state != AL_PLAYING) {
+      return source;
+    }
+  }
+
+  ALuint source = sources[next_source_index];
+  next_source_index = (next_source_index + 1) % sources.size();
+  return source;
+}
+
+/**
+ * @brief Creates a cached sound.
+ * @param buffer OpenAL buffer with the decoded samples.
+ * The cached sound takes ownership of it.
+ * @param sources Sources that may play the buffer.
+ */
+AudioPlayer::CachedSound::CachedSound(unsigned buffer, const std::vector<unsigned>& sources) :
+  buffer(buffer),
+  sources(sources),
+  last_modified() {
+
+}
+
+/**
+ * @brief Destroys a cached sound, stopping any source that plays it.
+ */
+AudioPlayer::CachedSound::~CachedSound() {
+
+  for (ALuint source : sources) {
+    ALint source_buffer = AL_NONE;
+    alGetSourcei(source, AL_BUFFER, &source_buffer);
+    if (static_cast<ALuint>(source_buffer) == buffer) {
+      alSourceStop(source);
+      alSourcei(source, AL_BUFFER, AL_NONE);
+    }
+  }
+  alDeleteBuffers(1, &buffer);
+}
+
+}
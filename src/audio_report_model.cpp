@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "audio_report_model.h"
+#include "file_tools.h"
+#include "quest.h"
+
+namespace SolarusEditor {
+
+/**
+ * @brief Creates an audio report model.
+ *
+ * Call reload() to fill it.
+ *
+ * @param quest The quest.
+ * @param parent The parent object or nullptr.
+ */
+AudioReportModel::AudioReportModel(Quest& quest, QObject* parent) :
+  QAbstractTableModel(parent),
+  quest(quest),
+  rows(),
+  rows_by_path() {
+
+  connect(&quest.get_audio_analyzer(), SIGNAL(analysis_ready(QString)),
+          this, SLOT(analysis_ready(QString)));
+}
+
+/**
+ * @brief Lists again all sounds and musics and requests their analysis.
+ *
+ * Files already analyzed and not modified since are not decoded again.
+ */
+void AudioReportModel::reload() {
+
+  beginResetModel();
+  rows.clear();
+  rows_by_path.clear();
+
+  AudioAnalyzer& analyzer = quest.get_audio_analyzer();
+  QStringList paths;
+  for (ResourceType resource_type : { ResourceType::SOUND, ResourceType::MUSIC }) {
+    for (const QString& element_id : quest.get_database().get_elements(resource_type)) {
+      Row row;
+      row.resource_type = resource_type;
+      row.element_id = element_id;
+      row.path = quest.get_resource_element_path(resource_type, element_id);
+      row.analysis = AudioAnalyzer::Analysis();
+      row.analyzed = analyzer.get_analysis(row.path, row.analysis);
+      if (!row.analyzed) {
+        paths << row.path;
+      }
+      rows_by_path.insert(row.path, rows.size());
+      rows << row;
+    }
+  }
+  endResetModel();
+
+  analyzer.request_analysis(paths);
+}
+
+/**
+ * @brief Returns the resource type of a row.
+ * @param row A row.
+ * @return SOUND or MUSIC.
+ */
+ResourceType AudioReportModel::get_resource_type(int row) const {
+  return rows.value(row).resource_type;
+}
+
+/**
+ * @brief Returns the resource element id of a row.
+ * @param row A row.
+ * @return The sound or music id.
+ */
+QString AudioReportModel::get_element_id(int row) const {
+  return rows.value(row).element_id;
+}
+
+/**
+ * @brief Returns the number of files whose analysis is not known yet.
+ * @return The number of rows still being analyzed.
+ */
+int AudioReportModel::get_num_pending() const {
+
+  int num_pending = 0;
+  for (const Row& row : rows) {
+    if (!row.analyzed) {
+      ++num_pending;
+    }
+  }
+  return num_pending;
+}
+
+/**
+ * @brief Returns the memory used in game by all sounds or all musics.
+ *
+ * Only files already analyzed are counted.
+ *
+ * @param resource_type SOUND or MUSIC.
+ * @return The total size in bytes.
+ */
+qint64 AudioReportModel::get_total_memory_size(ResourceType resource_type) const {
+
+  qint64 total = 0;
+  for (const Row& row : rows) {
+    if (row.analyzed && row.resource_type == resource_type) {
+      total += AudioAnalyzer::get_memory_size(row.resource_type, row.analysis);
+    }
+  }
+  return total;
+}
+
+/**
+ * @brief Returns the number of rows.
+ * @param parent Parent index.
+ * @return The number of sounds and musics.
+ */
+int AudioReportModel::rowCount(const QModelIndex& parent) const {
+
+  if (parent.isValid()) {
+    return 0;
+  }
+  return rows.size();
+}
+
+/**
+ * @brief Returns the number of columns.
+ * @param parent Parent index.
+ * @return The number of columns.
+ */
+int AudioReportModel::columnCount(const QModelIndex& parent) const {
+
+  if (parent.isValid()) {
+    return 0;
+  }
+  return NUM_COLUMNS;
+}
+
+/**
+ * @brief Returns the data of a cell.
+ * @param index Index of the cell.
+ * @param role The data role.
+ * @return The data.
+ */
+QVariant AudioReportModel::data(const QModelIndex& index, int role) const {
+
+  if (!index.isValid() || index.row() >= rows.size()) {
+    return QVariant();
+  }
+
+  const Row& row = rows[index.row()];
+  const AudioAnalyzer::Analysis& analysis = row.analysis;
+  const int column = index.column();
+
+  if (role == Qt::TextAlignmentRole) {
+    if (column >= DURATION_COLUMN) {
+      return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    return QVariant();
+  }
+
+  if (role != Qt::DisplayRole && role != Qt::UserRole) {
+    return QVariant();
+  }
+  const bool sort_value = role == Qt::UserRole;
+
+  switch (column) {
+
+  case TYPE_COLUMN:
+    return row.resource_type == ResourceType::SOUND ? tr("Sound") : tr("Music");
+
+  case ID_COLUMN:
+    return row.element_id;
+
+  case FORMAT_COLUMN:
+    return row.analyzed ? analysis.format : QString();
+
+  case FILE_SIZE_COLUMN:
+    if (!row.analyzed) {
+      return sort_value ? QVariant(-1) : QVariant(tr("..."));
+    }
+    return sort_value ? QVariant(analysis.file_size) :
+                        QVariant(FileTools::format_size(analysis.file_size));
+
+  default:
+    break;
+  }
+
+  // Other columns need decoded samples.
+  if (!row.analyzed || !analysis.decoded) {
+    if (sort_value) {
+      return -1;
+    }
+    return row.analyzed ? QString() : tr("...");
+  }
+
+  switch (column) {
+
+  case DURATION_COLUMN:
+    return sort_value ? QVariant(analysis.duration) :
+                        QVariant(AudioAnalyzer::format_duration(analysis.duration));
+
+  case LOOP_COLUMN:
+    if (sort_value) {
+      // Sort by loop start time.
+      return analysis.loop_start < 0 ? QVariant(-1) :
+                                       QVariant(analysis.loop_start * 1000 / analysis.sample_rate);
+    }
+    return AudioAnalyzer::format_loop(analysis);
+
+  case SAMPLE_RATE_COLUMN:
+    return sort_value ? QVariant(analysis.sample_rate) :
+                        QVariant(tr("%1 Hz").arg(analysis.sample_rate));
+
+  case CHANNELS_COLUMN:
+    return analysis.num_channels;
+
+  case PEAK_COLUMN:
+    return sort_value ? QVariant(analysis.peak) :
+                        QVariant(AudioAnalyzer::format_level(analysis.peak));
+
+  case RMS_COLUMN:
+    return sort_value ? QVariant(analysis.rms) :
+                        QVariant(AudioAnalyzer::format_level(analysis.rms));
+
+  case MEMORY_COLUMN:
+  {
+    const qint64 size = AudioAnalyzer::get_memory_size(row.resource_type, analysis);
+    return sort_value ? QVariant(size) : QVariant(FileTools::format_size(size));
+  }
+
+  default:
+    return QVariant();
+  }
+}
+
+/**
+ * @brief Returns the header of a column.
+ * @param section A column or row.
+ * @param orientation The header orientation.
+ * @param role The data role.
+ * @return The header data.
+ */
+QVariant AudioReportModel::headerData(
+    int section, Qt::Orientation orientation, int role) const {
+
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+    return QVariant();
+  }
+
+  switch (section) {
+  case TYPE_COLUMN:         return tr("Type");
+  case ID_COLUMN:           return tr("Id");
+  case FORMAT_COLUMN:       return tr("Format");
+  case DURATION_COLUMN:     return tr("Duration");
+  case LOOP_COLUMN:         return tr("Loop");
+  case SAMPLE_RATE_COLUMN:  return tr("Sample rate");
+  case CHANNELS_COLUMN:     return tr("Channels");
+  case PEAK_COLUMN:         return tr("Peak");
+  case RMS_COLUMN:          return tr("RMS");
+  case FILE_SIZE_COLUMN:    return tr("File size");
+  case MEMORY_COLUMN:       return tr("Memory in game");
+  default:                  return QVariant();
+  }
+}
+
+/**
+ * @brief Slot called when the analysis of an audio file becomes available.
+ * @param path Path of the audio file.
+ */
+void AudioReportModel::analysis_ready(const QString& path) {
+
+  const auto& it = rows_by_path.constFind(path);
+  if (it == rows_by_path.constEnd()) {
+    return;
+  }
+
+  Row& row = rows[it.value()];
+  row.analyzed = quest.get_audio_analyzer().get_analysis(path, row.analysis);
+  emit dataChanged(index(it.value(), 0), index(it.value(), NUM_COLUMNS - 1));
+}
+
+}
@@ -0,0 +1,440 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "data_file_cache.h"
+#include "data_file_parser.h"
+#include "quest.h"
+#include "version.h"
+#include <solarus/core/MapData.h>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace SolarusEditor {
+
+namespace DataFileCache {
+
+namespace {
+
+/**
+ * @brief Identifies snapshot files.
+ */
+constexpr quint32 magic_number = 0x53514543;  // "SQEC"
+
+/**
+ * @brief Version of the snapshot format.
+ *
+ * Increment it whenever the content written changes.
+ */
+constexpr quint32 format_version = 1;
+
+/**
+ * @brief Type tags of entity fields in snapshots.
+ */
+enum FieldTag : quint8 {
+  FIELD_STRING = 0,
+  FIELD_INTEGER = 1,
+  FIELD_BOOLEAN = 2
+};
+
+/**
+ * @brief Returns the path of the snapshot of a data file.
+ * @param quest The quest.
+ * @param path Path of the data file.
+ * @param kind Kind of data, used as subdirectory.
+ * @return Path of the snapshot file.
+ */
+QString get_snapshot_path(const Quest& quest, const QString& path, const QString& kind) {
+
+  const QByteArray& hash = QCryptographicHash::hash(
+        path.toUtf8(), QCryptographicHash::Sha1).toHex();
+  return quest.get_root_path() + "/.editor-cache/" + kind + "/" +
+      QString::fromLatin1(hash) + ".bin";
+}
+
+/**
+ * @brief Writes the header identifying the source of a snapshot.
+ * @param stream The stream to write to.
+ * @param source_info The data file.
+ */
+void write_header(QDataStream& stream, const QFileInfo& source_info) {
+
+  stream << magic_number
+         << format_version
+         << QString(SOLARUSEDITOR_VERSION)
+         << source_info.absoluteFilePath()
+         << static_cast<qint64>(source_info.size())
+         << static_cast<qint64>(source_info.lastModified().toMSecsSinceEpoch());
+}
+
+/**
+ * @brief Reads the header of a snapshot and checks that it is up to date.
+ * @param stream The stream to read from.
+ * @param source_info The data file.
+ * @return @c true if the snapshot matches the current data file.
+ */
+bool check_header(QDataStream& stream, const QFileInfo& source_info) {
+
+  quint32 magic = 0;
+  quint32 version = 0;
+  QString editor_version;
+  QString source_path;
+  qint64 source_size = 0;
+  qint64 source_date = 0;
+  stream >> magic >> version >> editor_version >> source_path >> source_size >> source_date;
+
+  return stream.status() == QDataStream::Ok &&
+      magic == magic_number &&
+      version == format_version &&
+      editor_version == SOLARUSEDITOR_VERSION &&
+      source_path == source_info.absoluteFilePath() &&
+      source_size == source_info.size() &&
+      source_date == source_info.lastModified().toMSecsSinceEpoch();
+}
+
+/**
+ * @brief Writes a UTF-8 string from the Solarus API.
+ * @param stream The stream to write to.
+ * @param string The string.
+ */
+void write_string(QDataStream& stream, const std::string& string) {
+
+  stream << QByteArray::fromRawData(string.data(), static_cast<int>(string.size()));
+}
+
+/**
+ * @brief Reads a UTF-8 string for the Solarus API.
+ * @param stream The stream to read from.
+ * @return The string.
+ */
+std::string read_string(QDataStream& stream) {
+
+  QByteArray bytes;
+  stream >> bytes;
+  return bytes.toStdString();
+}
+
+/**
+ * @brief Writes an entity to a snapshot.
+ * @param stream The stream to write to.
+ * @param entity The entity.
+ */
+void write_entity(QDataStream& stream, const Solarus::EntityData& entity) {
+
+  stream << static_cast<qint32>(entity.get_type());
+  write_string(stream, entity.get_name());
+  stream << static_cast<qint32>(entity.get_xy().x)
+         << static_cast<qint32>(entity.get_xy().y);
+
+  // Only fields that are set: others keep their default value when loading.
+  QList<std::string> keys;
+  for (const auto& kvp : entity.get_specific_properties()) {
+    if (!entity.is_specific_property_unset(kvp.first)) {
+      keys << kvp.first;
+    }
+  }
+  stream << static_cast<qint32>(keys.size());
+  for (const std::string& key : keys) {
+    write_string(stream, key);
+    if (entity.is_string(key)) {
+      stream << static_cast<quint8>(FIELD_STRING);
+      write_string(stream, entity.get_string(key));
+    }
+    else if (entity.is_integer(key)) {
+      stream << static_cast<quint8>(FIELD_INTEGER) << static_cast<qint32>(entity.get_integer(key));
+    }
+    else {
+      stream << static_cast<quint8>(FIELD_BOOLEAN) << entity.get_boolean(key);
+    }
+  }
+
+  stream << static_cast<qint32>(entity.get_user_property_count());
+  for (int i = 0; i < entity.get_user_property_count(); ++i) {
+    const Solarus::EntityData::UserProperty& property = entity.get_user_property(i);
+    write_string(stream, property.first);
+    write_string(stream, property.second);
+  }
+}
+
+/**
+ * @brief Reads an entity from a snapshot.
+ * @param[in] stream The stream to read from.
+ * @param[in] layer Layer of the entity.
+ * @param[out] entity The entity read.
+ * @return @c true in case of success.
+ */
+bool read_entity(QDataStream& stream, int layer, Solarus::EntityData& entity) {
+
+  qint32 type = 0;
+  stream >> type;
+  const std::string& name = read_string(stream);
+  qint32 x = 0;
+  qint32 y = 0;
+  stream >> x >> y;
+  if (stream.status() != QDataStream::Ok) {
+    return false;
+  }
+
+  entity = Solarus::EntityData(static_cast<Solarus::EntityType>(type));
+  if (!name.empty()) {
+    entity.set_name(name);
+  }
+  entity.set_layer(layer);
+  entity.set_xy(Solarus::Point(x, y));
+
+  qint32 num_fields = 0;
+  stream >> num_fields;
+  for (int i = 0; i < num_fields && stream.status() == QDataStream::Ok; ++i) {
+    const std::string& key = read_string(stream);
+    quint8 tag = 0;
+    stream >> tag;
+    if (tag == FIELD_STRING && entity.is_string(key)) {
+      entity.set_string(key, read_string(stream));
+    }
+    else if (tag == FIELD_INTEGER && entity.is_integer(key)) {
+      qint32 value = 0;
+      stream >> value;
+      entity.set_integer(key, value);
+    }
+    else if (tag == FIELD_BOOLEAN && entity.is_boolean(key)) {
+      bool value = false;
+      stream >> value;
+      entity.set_boolean(key, value);
+    }
+    else {
+      return false;
+    }
+  }
+
+  qint32 num_user_properties = 0;
+  stream >> num_user_properties;
+  for (int i = 0; i < num_user_properties && stream.status() == QDataStream::Ok; ++i) {
+    Solarus::EntityData::UserProperty property;
+    property.first = read_string(stream);
+    property.second = read_string(stream);
+    if (!entity.add_user_property(property)) {
+      return false;
+    }
+  }
+
+  return stream.status() == QDataStream::Ok;
+}
+
+}  // Anonymous namespace.
+
+/**
+ * @brief Loads a map from its snapshot if it is up to date.
+ * @param[in] quest The quest.
+ * @param[in] path Path of the map data file.
+ * @param[out] map The map to fill. Unchanged in case of failure.
+ * @return @c true if the map was loaded from the cache.
+ */
+bool load_map(const Quest& quest, const QString& path, Solarus::MapData& map) {
+
+  QFile file(get_snapshot_path(quest, path, "maps"));
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  // Map the snapshot rather than reading it.
+  const qint64 size = file.size();
+  const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+  if (data == nullptr) {
+    return false;
+  }
+  const QByteArray& bytes = QByteArray::fromRawData(
+        reinterpret_cast<const char*>(data), static_cast<int>(size));
+  QDataStream stream(bytes);
+  stream.setVersion(QDataStream::Qt_5_0);
+
+  if (!check_header(stream, QFileInfo(path))) {
+    return false;
+  }
+
+  qint32 x = 0, y = 0, width = 0, height = 0, min_layer = 0, max_layer = 0;
+  QByteArray world, tileset_id, music_id;
+  bool has_floor = false;
+  qint32 floor = 0;
+  stream >> x >> y >> width >> height >> min_layer >> max_layer
+         >> world >> has_floor >> floor >> tileset_id >> music_id;
+  if (stream.status() != QDataStream::Ok) {
+    return false;
+  }
+
+  Solarus::MapData result;
+  result.set_location(Solarus::Point(x, y));
+  result.set_size(Solarus::Size(width, height));
+  result.set_min_layer(min_layer);
+  result.set_max_layer(max_layer);
+  if (!world.isEmpty()) {
+    result.set_world(world.toStdString());
+  }
+  if (has_floor) {
+    result.set_floor(floor);
+  }
+  result.set_tileset_id(tileset_id.toStdString());
+  result.set_music_id(music_id.toStdString());
+
+  for (int layer = min_layer; layer <= max_layer; ++layer) {
+    qint32 num_entities = 0;
+    stream >> num_entities;
+    for (int i = 0; i < num_entities; ++i) {
+      Solarus::EntityData entity;
+      if (!read_entity(stream, layer, entity) ||
+          !result.add_entity(entity).is_valid()) {
+        return false;
+      }
+    }
+  }
+
+  if (stream.status() != QDataStream::Ok) {
+    return false;
+  }
+
+  map = std::move(result);
+  return true;
+}
+
+/**
+ * @brief Loads the data of a map without creating a MapModel.
+ *
+ * The snapshot of the map is used if it is up to date.
+ * Otherwise, the map is parsed and its snapshot is written.
+ * This function can be called from worker threads.
+ *
+ * @param[in] quest The quest.
+ * @param[in] path Path of the map data file.
+ * @param[out] map The map data.
+ * @return @c true in case of success.
+ */
+bool load_map_data(const Quest& quest, const QString& path, Solarus::MapData& map) {
+
+  if (load_map(quest, path, map)) {
+    return true;
+  }
+
+  if (!DataFileParser::import_map(path, map) &&
+      !map.import_from_file(path.toStdString())) {
+    return false;
+  }
+  save_map(quest, path, map);
+  return true;
+}
+
+/**
+ * @brief Writes the snapshot of a map that was just loaded or saved.
+ * @param quest The quest.
+ * @param path Path of the map data file, which must be up to date with the map.
+ * @param map The map.
+ */
+void save_map(const Quest& quest, const QString& path, const Solarus::MapData& map) {
+
+  write_snapshot(quest, path, "maps", [&map](QDataStream& stream) {
+
+    stream << static_cast<qint32>(map.get_location().x)
+           << static_cast<qint32>(map.get_location().y)
+           << static_cast<qint32>(map.get_size().width)
+           << static_cast<qint32>(map.get_size().height)
+           << static_cast<qint32>(map.get_min_layer())
+           << static_cast<qint32>(map.get_max_layer());
+    write_string(stream, map.has_world() ? map.get_world() : std::string());
+    stream << map.has_floor()
+           << static_cast<qint32>(map.has_floor() ? map.get_floor() : 0);
+    write_string(stream, map.get_tileset_id());
+    write_string(stream, map.get_music_id());
+
+    for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
+      const int num_entities = map.get_num_entities(layer);
+      stream << static_cast<qint32>(num_entities);
+      for (int i = 0; i < num_entities; ++i) {
+        write_entity(stream, map.get_entity(Solarus::EntityIndex(layer, i)));
+      }
+    }
+  });
+}
+
+/**
+ * @brief Reads a snapshot if it is up to date with its data file.
+ * @param quest The quest.
+ * @param path Path of the data file.
+ * @param kind Kind of snapshot, like "thumbnails".
+ * @param read_content Function that reads the content after the header.
+ * It should read into temporary variables: they are only valid if this
+ * function returns @c true.
+ * @return @c true if the snapshot was read successfully.
+ */
+bool read_snapshot(
+    const Quest& quest,
+    const QString& path,
+    const QString& kind,
+    const SnapshotFunction& read_content
+) {
+  QFile file(get_snapshot_path(quest, path, kind));
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+
+  if (!check_header(stream, QFileInfo(path))) {
+    return false;
+  }
+
+  read_content(stream);
+  return stream.status() == QDataStream::Ok;
+}
+
+/**
+ * @brief Writes a snapshot of a data file.
+ * @param quest The quest.
+ * @param path Path of the data file, which must be up to date with the content.
+ * @param kind Kind of snapshot, like "thumbnails".
+ * @param write_content Function that writes the content after the header.
+ */
+void write_snapshot(
+    const Quest& quest,
+    const QString& path,
+    const QString& kind,
+    const SnapshotFunction& write_content
+) {
+  const QString& snapshot_path = get_snapshot_path(quest, path, kind);
+  if (!QDir().mkpath(QFileInfo(snapshot_path).path())) {
+    return;
+  }
+
+  QSaveFile file(snapshot_path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    return;
+  }
+
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+  write_header(stream, QFileInfo(path));
+  write_content(stream);
+
+  if (stream.status() == QDataStream::Ok) {
+    file.commit();
+  }
+}
+
+}
+
+}
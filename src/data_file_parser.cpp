@@ -0,0 +1,986 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "data_file_parser.h"
+#include <solarus/core/DialogResources.h>
+#include <solarus/core/MapData.h>
+#include <solarus/core/QuestDatabase.h>
+#include <solarus/core/StringResources.h>
+#include <solarus/entities/EntityTypeInfo.h>
+#include <QFile>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace SolarusEditor {
+
+namespace DataFileParser {
+
+namespace {
+
+using EntityType = Solarus::EntityType;
+using ResourceType = Solarus::ResourceType;
+
+/**
+ * @brief Whether the native parser is enabled in this build.
+ */
+#ifdef SOLARUSEDITOR_NATIVE_DATA_PARSER
+constexpr bool native_parser_enabled = true;
+#else
+constexpr bool native_parser_enabled = false;
+#endif
+
+struct Value;
+
+/**
+ * @brief Fields of a Lua table constructor, in file order.
+ *
+ * Positional items have an empty key.
+ */
+using Table = std::vector<std::pair<std::string, Value>>;
+
+/**
+ * @brief A literal value of a data file.
+ */
+struct Value {
+
+  /**
+   * @brief Types of values supported.
+   */
+  enum class Type {
+    STRING,
+    INTEGER,
+    BOOLEAN,
+    TABLE
+  };
+
+  Type type;                     /**< Type of this value. */
+  std::string string;            /**< The value if this is a string. */
+  int integer;                   /**< The value if this is an integer. */
+  bool boolean;                  /**< The value if this is a boolean. */
+  std::shared_ptr<Table> table;  /**< The value if this is a table. */
+};
+
+/**
+ * @brief Function called for each top-level block <tt>name{ ... }</tt>.
+ *
+ * It should return @c false if the block is not supported.
+ */
+using BlockHandler = std::function<bool (const std::string&, const Table&)>;
+
+/**
+ * @brief Single-pass reader of the restricted data file grammar.
+ *
+ * Any syntax error or unsupported construction makes parsing fail:
+ * the Lua loader will then report errors properly.
+ */
+class Parser {
+
+public:
+
+  Parser(const char* begin, const char* end) :
+    current(begin),
+    end(end) {
+  }
+
+  /**
+   * @brief Parses the whole buffer.
+   * @param handler Function to call for each block.
+   * @return @c true in case of success.
+   */
+  bool parse(const BlockHandler& handler) {
+
+    while (true) {
+      if (!skip_spaces_and_comments()) {
+        return false;
+      }
+      if (current == end) {
+        return true;
+      }
+
+      std::string name;
+      if (!read_name(name)) {
+        return false;
+      }
+
+      // Accept both name{ ... } and name({ ... }).
+      skip_spaces_and_comments();
+      const bool parenthesis = accept('(');
+      Table table;
+      if (!expect('{') || !read_table_content(table)) {
+        return false;
+      }
+      if (parenthesis && !expect(')')) {
+        return false;
+      }
+
+      if (!handler(name, table)) {
+        return false;
+      }
+
+      skip_spaces_and_comments();
+      accept(';');
+    }
+  }
+
+private:
+
+  /**
+   * @brief Skips whitespaces and Lua comments.
+   * @return @c false if a comment is not terminated.
+   */
+  bool skip_spaces_and_comments() {
+
+    while (current != end) {
+      const char c = *current;
+      if (c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+          c == '\f' || c == '\v') {
+        ++current;
+      }
+      else if (c == '-' && end - current >= 2 && current[1] == '-') {
+        current += 2;
+        int level = 0;
+        if (read_long_bracket_open(level)) {
+          std::string ignored;
+          if (!read_long_bracket_content(level, ignored)) {
+            return false;
+          }
+        }
+        else {
+          while (current != end && *current != '\n') {
+            ++current;
+          }
+        }
+      }
+      else {
+        break;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Consumes a character if it is the next one.
+   * @param c The character expected.
+   * @return @c true if it was there.
+   */
+  bool accept(char c) {
+
+    if (current != end && *current == c) {
+      ++current;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Skips spaces and consumes a mandatory character.
+   * @param c The character expected.
+   * @return @c true if it was there.
+   */
+  bool expect(char c) {
+
+    return skip_spaces_and_comments() && accept(c);
+  }
+
+  static bool is_name_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+  }
+
+  static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+  }
+
+  /**
+   * @brief Reads an identifier.
+   * @param[out] name The identifier read.
+   * @return @c true in case of success.
+   */
+  bool read_name(std::string& name) {
+
+    if (current == end || !is_name_start(*current)) {
+      return false;
+    }
+    const char* start = current;
+    while (current != end && (is_name_start(*current) || is_digit(*current))) {
+      ++current;
+    }
+    name.assign(start, current);
+    return true;
+  }
+
+  /**
+   * @brief Reads the content of a table constructor after its opening brace.
+   * @param[out] table The fields read.
+   * @return @c true in case of success.
+   */
+  bool read_table_content(Table& table) {
+
+    while (true) {
+      if (!skip_spaces_and_comments()) {
+        return false;
+      }
+      if (accept('}')) {
+        return true;
+      }
+
+      std::string key;
+      if (current != end && is_name_start(*current)) {
+        read_name(key);
+        if (!expect('=')) {
+          // A name that is not a key: a variable or a keyword like nil.
+          return false;
+        }
+        if (key == "true" || key == "false" || key == "nil") {
+          return false;
+        }
+      }
+
+      Value value;
+      if (!read_value(value)) {
+        return false;
+      }
+      table.emplace_back(std::move(key), std::move(value));
+
+      if (!skip_spaces_and_comments()) {
+        return false;
+      }
+      if (accept('}')) {
+        return true;
+      }
+      if (!accept(',') && !accept(';')) {
+        return false;
+      }
+    }
+  }
+
+  /**
+   * @brief Reads a literal value.
+   * @param[out] value The value read.
+   * @return @c true in case of success.
+   */
+  bool read_value(Value& value) {
+
+    if (!skip_spaces_and_comments() || current == end) {
+      return false;
+    }
+
+    const char c = *current;
+    if (c == '"' || c == '\'') {
+      value.type = Value::Type::STRING;
+      return read_quoted_string(value.string);
+    }
+
+    int level = 0;
+    if (c == '[' && read_long_bracket_open(level)) {
+      value.type = Value::Type::STRING;
+      return read_long_bracket_content(level, value.string);
+    }
+
+    if (c == '-' || is_digit(c)) {
+      value.type = Value::Type::INTEGER;
+      return read_integer(value.integer);
+    }
+
+    if (c == '{') {
+      ++current;
+      value.type = Value::Type::TABLE;
+      value.table = std::make_shared<Table>();
+      return read_table_content(*value.table);
+    }
+
+    std::string name;
+    if (!read_name(name)) {
+      return false;
+    }
+    if (name == "true" || name == "false") {
+      value.type = Value::Type::BOOLEAN;
+      value.boolean = (name == "true");
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Reads a decimal integer, possibly negative.
+   *
+   * Floating-point and hexadecimal numbers are not supported.
+   *
+   * @param[out] integer The value read.
+   * @return @c true in case of success.
+   */
+  bool read_integer(int& integer) {
+
+    const bool negative = accept('-');
+    if (current == end || !is_digit(*current)) {
+      return false;
+    }
+
+    long long result = 0;
+    while (current != end && is_digit(*current)) {
+      result = result * 10 + (*current - '0');
+      if (result > std::numeric_limits<int>::max()) {
+        return false;
+      }
+      ++current;
+    }
+
+    if (current != end &&
+        (*current == '.' || *current == 'x' || *current == 'X' ||
+         *current == 'e' || *current == 'E' || is_name_start(*current))) {
+      return false;
+    }
+
+    integer = static_cast<int>(negative ? -result : result);
+    return true;
+  }
+
+  /**
+   * @brief Reads a string between single or double quotes.
+   * @param[out] string The string read, with escape sequences resolved.
+   * @return @c true in case of success.
+   */
+  bool read_quoted_string(std::string& string) {
+
+    const char quote = *current++;
+    string.clear();
+    while (current != end) {
+      const char c = *current++;
+      if (c == quote) {
+        return true;
+      }
+      if (c == '\n' || c == '\r') {
+        // Unfinished string.
+        return false;
+      }
+      if (c != '\\') {
+        string += c;
+        continue;
+      }
+
+      if (current == end) {
+        return false;
+      }
+      const char escaped = *current++;
+      switch (escaped) {
+      case 'n': string += '\n'; break;
+      case 't': string += '\t'; break;
+      case 'r': string += '\r'; break;
+      case 'a': string += '\a'; break;
+      case 'b': string += '\b'; break;
+      case 'f': string += '\f'; break;
+      case 'v': string += '\v'; break;
+      case '\\': string += '\\'; break;
+      case '"': string += '"'; break;
+      case '\'': string += '\''; break;
+      case '\n': string += '\n'; break;
+
+      default:
+        if (is_digit(escaped)) {
+          int code = escaped - '0';
+          for (int i = 0; i < 2 && current != end && is_digit(*current); ++i) {
+            code = code * 10 + (*current++ - '0');
+          }
+          if (code > 255) {
+            return false;
+          }
+          string += static_cast<char>(code);
+          break;
+        }
+        // Other escape sequences depend on the Lua version.
+        return false;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Reads the opening of a long bracket like <tt>[[</tt> or
+   * <tt>[==[</tt> if there is one.
+   * @param[out] level Number of equal signs.
+   * @return @c true if a long bracket was read. Otherwise nothing is consumed.
+   */
+  bool read_long_bracket_open(int& level) {
+
+    const char* position = current;
+    if (position == end || *position != '[') {
+      return false;
+    }
+    ++position;
+    level = 0;
+    while (position != end && *position == '=') {
+      ++level;
+      ++position;
+    }
+    if (position == end || *position != '[') {
+      return false;
+    }
+    current = position + 1;
+    return true;
+  }
+
+  /**
+   * @brief Reads the content of a long bracket string until its closing.
+   *
+   * Like Lua, a newline immediately following the opening is skipped.
+   *
+   * @param level Number of equal signs of the opening bracket.
+   * @param[out] string The content read.
+   * @return @c true in case of success.
+   */
+  bool read_long_bracket_content(int level, std::string& string) {
+
+    if (current != end && (*current == '\r' || *current == '\n')) {
+      const char first = *current++;
+      if (current != end && (*current == '\r' || *current == '\n') && *current != first) {
+        ++current;
+      }
+    }
+
+    const char* start = current;
+    while (current != end) {
+      if (*current == ']') {
+        const char* position = current + 1;
+        int closing_level = 0;
+        while (position != end && *position == '=') {
+          ++closing_level;
+          ++position;
+        }
+        if (closing_level == level && position != end && *position == ']') {
+          string.assign(start, current);
+          current = position + 1;
+          return normalize_newlines(string);
+        }
+      }
+      ++current;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Converts the newline sequences of a long string like Lua does.
+   * @param string The string to modify.
+   * @return @c true.
+   */
+  static bool normalize_newlines(std::string& string) {
+
+    if (string.find('\r') == std::string::npos) {
+      return true;
+    }
+
+    std::string result;
+    result.reserve(string.size());
+    for (size_t i = 0; i < string.size(); ++i) {
+      const char c = string[i];
+      if (c == '\r' || c == '\n') {
+        if (i + 1 < string.size() &&
+            (string[i + 1] == '\r' || string[i + 1] == '\n') &&
+            string[i + 1] != c) {
+          ++i;
+        }
+        result += '\n';
+      }
+      else {
+        result += c;
+      }
+    }
+    string = std::move(result);
+    return true;
+  }
+
+  const char* current;   /**< Current position in the buffer. */
+  const char* end;       /**< End of the buffer. */
+
+};
+
+/**
+ * @brief Reads a whole data file and parses it.
+ * @param path Path of the file.
+ * @param handler Function to call for each block.
+ * @return @c true in case of success.
+ */
+bool parse_file(const QString& path, const BlockHandler& handler) {
+
+  if (!native_parser_enabled) {
+    return false;
+  }
+
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  const qint64 size = file.size();
+  const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+  if (data != nullptr) {
+    const char* begin = reinterpret_cast<const char*>(data);
+    return Parser(begin, begin + size).parse(handler);
+  }
+
+  const QByteArray& content = file.readAll();
+  return Parser(content.constData(), content.constData() + content.size()).parse(handler);
+}
+
+/**
+ * @brief Returns the last value of a key in a table.
+ * @param table The table to search.
+ * @param key The key to find.
+ * @return The value or nullptr.
+ */
+const Value* find_field(const Table& table, const std::string& key) {
+
+  for (auto it = table.rbegin(); it != table.rend(); ++it) {
+    if (it->first == key) {
+      return &it->second;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Checks that a table only contains keys among the given ones.
+ * @param table The table to check.
+ * @param allowed_keys The allowed keys.
+ * @return @c true if all fields have one of these keys.
+ */
+bool has_only_keys(const Table& table, std::initializer_list<const char*> allowed_keys) {
+
+  for (const auto& field : table) {
+    bool allowed = false;
+    for (const char* key : allowed_keys) {
+      if (field.first == key) {
+        allowed = true;
+        break;
+      }
+    }
+    if (!allowed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Gets a mandatory string field.
+ * @param[in] table The table.
+ * @param[in] key Key of the field.
+ * @param[out] string The value.
+ * @return @c true if the field exists and is a string.
+ */
+bool get_string(const Table& table, const std::string& key, std::string& string) {
+
+  const Value* value = find_field(table, key);
+  if (value == nullptr || value->type != Value::Type::STRING) {
+    return false;
+  }
+  string = value->string;
+  return true;
+}
+
+/**
+ * @brief Gets an optional string field.
+ * @param[in] table The table.
+ * @param[in] key Key of the field.
+ * @param[out] string The value, or an empty string if the field is missing.
+ * @return @c false if the field exists but is not a string.
+ */
+bool get_optional_string(const Table& table, const std::string& key, std::string& string) {
+
+  const Value* value = find_field(table, key);
+  if (value == nullptr) {
+    string.clear();
+    return true;
+  }
+  if (value->type != Value::Type::STRING) {
+    return false;
+  }
+  string = value->string;
+  return true;
+}
+
+/**
+ * @brief Gets a mandatory integer field.
+ * @param[in] table The table.
+ * @param[in] key Key of the field.
+ * @param[out] integer The value.
+ * @return @c true if the field exists and is an integer.
+ */
+bool get_integer(const Table& table, const std::string& key, int& integer) {
+
+  const Value* value = find_field(table, key);
+  if (value == nullptr || value->type != Value::Type::INTEGER) {
+    return false;
+  }
+  integer = value->integer;
+  return true;
+}
+
+/**
+ * @brief Reads the user properties of an entity.
+ * @param value The value of the "properties" field.
+ * @param entity The entity to fill.
+ * @return @c true in case of success.
+ */
+bool read_user_properties(const Value& value, Solarus::EntityData& entity) {
+
+  if (value.type != Value::Type::TABLE) {
+    return false;
+  }
+
+  for (const auto& item : *value.table) {
+    if (!item.first.empty() || item.second.type != Value::Type::TABLE) {
+      return false;
+    }
+    const Table& property_table = *item.second.table;
+    Solarus::EntityData::UserProperty property;
+    if (!has_only_keys(property_table, { "key", "value" }) ||
+        !get_string(property_table, "key", property.first) ||
+        !get_string(property_table, "value", property.second)) {
+      return false;
+    }
+    if (!Solarus::EntityData::is_user_property_key_valid(property.first) ||
+        entity.has_user_property(property.first) ||
+        !entity.add_user_property(property)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Builds an entity from a block of a map data file.
+ * @param[in] type Type of entity.
+ * @param[in] table Fields of the block.
+ * @param[out] entity The entity built.
+ * @return @c true in case of success.
+ */
+bool read_entity(EntityType type, const Table& table, Solarus::EntityData& entity) {
+
+  entity = Solarus::EntityData(type);
+
+  int layer = 0;
+  int x = 0;
+  int y = 0;
+  if (!get_integer(table, "layer", layer) ||
+      !get_integer(table, "x", x) ||
+      !get_integer(table, "y", y)) {
+    return false;
+  }
+  entity.set_layer(layer);
+  entity.set_xy(Solarus::Point(x, y));
+
+  std::set<std::string> specified_keys;
+  for (const auto& field : table) {
+    const std::string& key = field.first;
+    const Value& value = field.second;
+    if (key == "layer" || key == "x" || key == "y") {
+      continue;
+    }
+
+    if (key == "name") {
+      if (value.type != Value::Type::STRING) {
+        return false;
+      }
+      entity.set_name(value.string);
+    }
+    else if (key == "properties") {
+      if (!read_user_properties(value, entity)) {
+        return false;
+      }
+    }
+    else if (entity.is_string(key) && value.type == Value::Type::STRING) {
+      entity.set_string(key, value.string);
+    }
+    else if (entity.is_integer(key) && value.type == Value::Type::INTEGER) {
+      entity.set_integer(key, value.integer);
+    }
+    else if (entity.is_boolean(key) && value.type == Value::Type::BOOLEAN) {
+      entity.set_boolean(key, value.boolean);
+    }
+    else {
+      // Unknown field or unexpected type.
+      return false;
+    }
+    specified_keys.insert(key);
+  }
+
+  // Mandatory fields must be present.
+  for (const auto& kvp : entity.get_specific_properties()) {
+    if (specified_keys.find(kvp.first) == specified_keys.end() &&
+        !entity.is_specific_property_optional(kvp.first)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Returns the entity types that can appear in map files, by Lua name.
+ * @return The entity types.
+ */
+const std::map<std::string, EntityType>& get_map_entity_types() {
+
+  static const std::map<std::string, EntityType> types = []() {
+    std::map<std::string, EntityType> types;
+    for (EntityType type : Solarus::EnumInfo<EntityType>::enums()) {
+      if (Solarus::EntityTypeInfo::can_be_stored_in_map_file(type)) {
+        types.emplace(Solarus::enum_to_name(type), type);
+      }
+    }
+    return types;
+  }();
+  return types;
+}
+
+/**
+ * @brief Returns the resource types by Lua name.
+ * @return The resource types.
+ */
+const std::map<std::string, ResourceType>& get_resource_types() {
+
+  static const std::map<std::string, ResourceType> types = []() {
+    std::map<std::string, ResourceType> types;
+    for (ResourceType type : Solarus::EnumInfo<ResourceType>::enums()) {
+      types.emplace(Solarus::enum_to_name(type), type);
+    }
+    return types;
+  }();
+  return types;
+}
+
+}  // Anonymous namespace.
+
+/**
+ * @brief Loads a map data file without Lua.
+ * @param[in] path Path of the map data file.
+ * @param[out] map The map to fill. Unchanged in case of failure.
+ * @return @c true in case of success, @c false if the Lua loader should be used.
+ */
+bool import_map(const QString& path, Solarus::MapData& map) {
+
+  Solarus::MapData result;
+  bool properties_found = false;
+  const std::map<std::string, EntityType>& entity_types = get_map_entity_types();
+
+  const bool success = parse_file(path, [&](const std::string& name, const Table& table) {
+
+    if (name == "properties") {
+      if (properties_found ||
+          !has_only_keys(table, { "x", "y", "width", "height", "min_layer", "max_layer",
+                                  "world", "floor", "tileset", "music" })) {
+        return false;
+      }
+
+      int x = 0, y = 0, width = 0, height = 0, min_layer = 0, max_layer = 0;
+      std::string tileset_id, music_id;
+      if (!get_integer(table, "x", x) ||
+          !get_integer(table, "y", y) ||
+          !get_integer(table, "width", width) ||
+          !get_integer(table, "height", height) ||
+          !get_integer(table, "min_layer", min_layer) ||
+          !get_integer(table, "max_layer", max_layer) ||
+          !get_string(table, "tileset", tileset_id) ||
+          !get_string(table, "music", music_id) ||
+          min_layer > max_layer) {
+        return false;
+      }
+
+      result.set_location(Solarus::Point(x, y));
+      result.set_size(Solarus::Size(width, height));
+      result.set_min_layer(min_layer);
+      result.set_max_layer(max_layer);
+      result.set_tileset_id(tileset_id);
+      result.set_music_id(music_id);
+
+      const Value* world = find_field(table, "world");
+      if (world != nullptr) {
+        if (world->type != Value::Type::STRING) {
+          return false;
+        }
+        result.set_world(world->string);
+      }
+
+      const Value* floor = find_field(table, "floor");
+      if (floor != nullptr) {
+        if (floor->type != Value::Type::INTEGER) {
+          return false;
+        }
+        result.set_floor(floor->integer);
+      }
+
+      properties_found = true;
+      return true;
+    }
+
+    // Entities need the layers defined in the properties.
+    const auto it = entity_types.find(name);
+    if (!properties_found || it == entity_types.end()) {
+      return false;
+    }
+
+    Solarus::EntityData entity;
+    if (!read_entity(it->second, table, entity) ||
+        !result.is_valid_layer(entity.get_layer())) {
+      return false;
+    }
+    return result.add_entity(entity).is_valid();
+  });
+
+  if (!success || !properties_found) {
+    return false;
+  }
+
+  map = std::move(result);
+  return true;
+}
+
+/**
+ * @brief Loads a strings data file without Lua.
+ * @param[in] path Path of the strings data file.
+ * @param[out] strings The strings to fill. Unchanged in case of failure.
+ * @return @c true in case of success, @c false if the Lua loader should be used.
+ */
+bool import_strings(const QString& path, Solarus::StringResources& strings) {
+
+  Solarus::StringResources result;
+  const bool success = parse_file(path, [&](const std::string& name, const Table& table) {
+
+    std::string key, value;
+    if (name != "text" ||
+        !has_only_keys(table, { "key", "value" }) ||
+        !get_string(table, "key", key) ||
+        !get_string(table, "value", value) ||
+        result.has_string(key)) {
+      return false;
+    }
+    result.add_string(key, value);
+    return true;
+  });
+
+  if (!success) {
+    return false;
+  }
+
+  strings = std::move(result);
+  return true;
+}
+
+/**
+ * @brief Loads a dialogs data file without Lua.
+ * @param[in] path Path of the dialogs data file.
+ * @param[out] dialogs The dialogs to fill. Unchanged in case of failure.
+ * @return @c true in case of success, @c false if the Lua loader should be used.
+ */
+bool import_dialogs(const QString& path, Solarus::DialogResources& dialogs) {
+
+  Solarus::DialogResources result;
+  const bool success = parse_file(path, [&](const std::string& name, const Table& table) {
+
+    if (name != "dialog") {
+      return false;
+    }
+
+    std::string id, text;
+    if (!get_string(table, "id", id) ||
+        !get_string(table, "text", text) ||
+        result.has_dialog(id)) {
+      return false;
+    }
+
+    // Like the Lua loader, remove the final newline so that texts can be
+    // written as long strings ending on their own line.
+    if (!text.empty() && text.back() == '\n') {
+      text.pop_back();
+    }
+
+    Solarus::DialogData dialog;
+    dialog.set_text(text);
+    for (const auto& field : table) {
+      if (field.first == "id" || field.first == "text") {
+        continue;
+      }
+      if (field.first.empty() || field.second.type != Value::Type::STRING) {
+        return false;
+      }
+      dialog.set_property(field.first, field.second.string);
+    }
+    result.add_dialog(id, dialog);
+    return true;
+  });
+
+  if (!success) {
+    return false;
+  }
+
+  dialogs = std::move(result);
+  return true;
+}
+
+/**
+ * @brief Loads a quest resource list file without Lua.
+ * @param[in] path Path of the project_db.dat file.
+ * @param[out] database The resource list to fill. Unchanged in case of failure.
+ * @return @c true in case of success, @c false if the Lua loader should be used.
+ */
+bool import_quest_database(const QString& path, Solarus::QuestDatabase& database) {
+
+  Solarus::QuestDatabase result;
+  const std::map<std::string, ResourceType>& resource_types = get_resource_types();
+
+  const bool success = parse_file(path, [&](const std::string& name, const Table& table) {
+
+    if (name == "file") {
+      Solarus::QuestDatabase::FileInfo info;
+      std::string file_path;
+      if (!has_only_keys(table, { "path", "author", "license" }) ||
+          !get_string(table, "path", file_path) ||
+          !get_optional_string(table, "author", info.author) ||
+          !get_optional_string(table, "license", info.license)) {
+        return false;
+      }
+      result.set_file_info(file_path, info);
+      return true;
+    }
+
+    const auto it = resource_types.find(name);
+    if (it == resource_types.end()) {
+      return false;
+    }
+
+    std::string id, description;
+    return has_only_keys(table, { "id", "description" }) &&
+        get_string(table, "id", id) &&
+        get_string(table, "description", description) &&
+        result.add(it->second, id, description);
+  });
+
+  if (!success) {
+    return false;
+  }
+
+  database = std::move(result);
+  return true;
+}
+
+}
+
+}
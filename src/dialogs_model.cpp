@@ -14,6 +14,7 @@
  * You should have received a copy of the GNU General Public License along
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
+#include "data_file_parser.h"
 #include "editor_exception.h"
 #include "quest.h"
 #include "dialogs_model.h"
@@ -42,7 +43,8 @@ DialogsModel::DialogsModel(
 
   // Load the strings data file.
   QString path = quest.get_dialogs_path(language_id);
-  if (!resources.import_from_file(path.toStdString())) {
+  if (!DataFileParser::import_dialogs(path, resources) &&
+      !resources.import_from_file(path.toStdString())) {
     throw EditorException(tr("Cannot open dialogs data file '%1'").arg(path));
   }
 
@@ -860,8 +862,7 @@ void DialogsModel::clear_translation() {
   }
 
   translation_id = "";
-  clear_translation_from_tree();
-  translation_resources.clear();
+  set_translation_resources(Solarus::DialogResources());
 }
 
 /**
@@ -869,24 +870,37 @@ void DialogsModel::clear_translation() {
  */
 void DialogsModel::reload_translation() {
 
-  clear_translation_from_tree();
-
   QString path = quest.get_dialogs_path(translation_id);
-  translation_resources.clear();
-  if (!translation_resources.import_from_file(path.toStdString())) {
+  Solarus::DialogResources translation;
+  if (!DataFileParser::import_dialogs(path, translation) &&
+      !translation.import_from_file(path.toStdString())) {
     translation_id = "";
+    set_translation_resources(Solarus::DialogResources());
     throw EditorException(tr("Cannot open dialogs data file '%1'").arg(path));
   }
 
-  for (const auto& kvp : translation_resources.get_dialogs()) {
-    QString id = QString::fromStdString(kvp.first);
-    QString parent_id;
-    int index;
-    if (dialog_tree.add_ref(id, parent_id, index)) {
-      beginInsertRows(id_to_index(parent_id), index, index);
-      endInsertRows();
-    }
-  }
+  set_translation_resources(std::move(translation));
+}
+
+/**
+ * @brief Replaces the translated dialogs.
+ *
+ * The tree is rebuilt at once and views are reset only once instead of
+ * being notified of each translated dialog.
+ * The selected dialog stays selected.
+ *
+ * @param translation The new translated dialogs.
+ */
+void DialogsModel::set_translation_resources(Solarus::DialogResources translation) {
+
+  const QString& selected_id = get_selected_id();
+
+  beginResetModel();
+  translation_resources = std::move(translation);
+  build_dialog_tree();
+  endResetModel();
+
+  set_selected_id(selected_id);
 }
 
 /**
@@ -1000,28 +1014,9 @@ void DialogsModel::build_dialog_tree() {
     QString id = QString::fromStdString(kvp.first);
     dialog_tree.add_key(id);
   }
-}
-
-/**
- * @brief Removes all translated dialogs from the indexed tree.
- */
-void DialogsModel::clear_translation_from_tree() {
-
   for (const auto& kvp : translation_resources.get_dialogs()) {
     QString id = QString::fromStdString(kvp.first);
-    QString parent_id;
-    int index;
-    if (dialog_tree.can_remove_ref(id, parent_id, index)) {
-      if (!dialog_exists(id)) {
-        beginRemoveRows(id_to_index(parent_id), index, index);
-        dialog_tree.remove_ref(id, false);
-        endRemoveRows();
-      } else {
-        dialog_tree.remove_ref(id, true);
-      }
-    } else {
-      dialog_tree.remove_ref(id, dialog_exists(id));
-    }
+    dialog_tree.add_ref(id);
   }
 }
 
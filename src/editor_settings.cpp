@@ -31,6 +31,7 @@ const QString EditorSettings::restore_last_files = "restore_last_files";
 const QString EditorSettings::save_files_before_running = "save_files_before_running";
 const QString EditorSettings::no_audio = "no_audio";
 const QString EditorSettings::quest_size = "quest_size";
+const QString EditorSettings::texture_budget = "texture_budget";
 
 // Import dialog keys.
 const QString EditorSettings::import_last_source_quest = "import_last_source_quest";
@@ -54,6 +55,8 @@ const QString EditorSettings::map_grid_show_at_opening =
 const QString EditorSettings::map_grid_size = "map_editor/grid_size";
 const QString EditorSettings::map_grid_style = "map_editor/grid_style";
 const QString EditorSettings::map_grid_color = "map_editor/grid_color";
+const QString EditorSettings::map_lod_enabled = "map_editor/lod_enabled";
+const QString EditorSettings::map_lod_zoom = "map_editor/lod_zoom";
 const QString EditorSettings::map_tileset_background =
   "map_editor/tileset_background";
 const QString EditorSettings::map_tileset_zoom = "map_editor/tileset_zoom";
@@ -97,6 +100,7 @@ QMap<QString, QVariant> EditorSettings::default_values = {
   { EditorSettings::save_files_before_running, "ask" },
   { EditorSettings::no_audio, false },
   { EditorSettings::quest_size, QSize() },
+  { EditorSettings::texture_budget, 64 },
 
   // Import dialog.
   { EditorSettings::import_last_source_quest, "" },
@@ -117,6 +121,8 @@ QMap<QString, QVariant> EditorSettings::default_values = {
   { EditorSettings::map_grid_size, QSize(16, 16) },
   { EditorSettings::map_grid_style, static_cast<int>(GridStyle::DASHED) },
   { EditorSettings::map_grid_color, "#000000" },
+  { EditorSettings::map_lod_enabled, true },
+  { EditorSettings::map_lod_zoom, 0.5 },
   { EditorSettings::map_tileset_background, "#888888" },
   { EditorSettings::map_tileset_zoom, 2.0 },
 
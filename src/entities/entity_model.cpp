@@ -65,6 +65,7 @@ EntityModel::EntityModel(
     EntityType type) :
   map(&map),
   index(index),
+  selected(false),
   stub(type),
   name(),
   origin(0, 0),
@@ -386,6 +387,7 @@ void EntityModel::about_to_be_removed_from_map() {
 
   stub = map->get_internal_entity(index);  // Save the data.
   index = EntityIndex();  // Set an invalid index.
+  selected = false;
 }
 
 /**
@@ -403,6 +405,26 @@ void EntityModel::index_changed(const EntityIndex& index) {
   Q_ASSERT(&map->get_entity(index) == this);
 }
 
+/**
+ * @brief Returns whether this entity is selected.
+ *
+ * The selection is stored here rather than in graphic items
+ * because the map scene only creates items for visible entities.
+ *
+ * @return @c true if the entity is selected.
+ */
+bool EntityModel::is_selected() const {
+  return selected;
+}
+
+/**
+ * @brief Sets whether this entity is selected.
+ * @param selected @c true to select the entity.
+ */
+void EntityModel::set_selected(bool selected) {
+  this->selected = selected;
+}
+
 /**
  * @brief Returns the Solarus entity wrapped.
  * @return The entity from the map, or the entity stub if it does not belong
@@ -1570,6 +1592,28 @@ void EntityModel::draw(QPainter& painter) const {
   draw_as_icon(painter);
 }
 
+/**
+ * @brief Draws this entity in a simplified way when zoomed out.
+ *
+ * Entities that would only cover a few pixels on screen are drawn as a
+ * marker whose color depends on their type (see EntityTraits::get_marker_color()).
+ * Larger ones are drawn normally.
+ *
+ * @param painter The painter to draw.
+ * @param level_of_detail Scale factor of the painter.
+ */
+void EntityModel::draw_low_detail(QPainter& painter, double level_of_detail) const {
+
+  const int marker_max_size = 8;  // In screen pixels.
+  const QSize& size = get_size();
+  if (qMax(size.width(), size.height()) * level_of_detail > marker_max_size) {
+    draw(painter);
+    return;
+  }
+
+  painter.fillRect(QRect(QPoint(0, 0), size), EntityTraits::get_marker_color(get_type()));
+}
+
 /**
  * @brief Attempts to draw this entity using its sprite if any.
  *
@@ -1626,7 +1670,7 @@ bool EntityModel::draw_as_sprite(
     return false;
   }
 
-  if (!quest.exists(quest.get_sprite_path(sprite_id))) {
+  if (!quest.get_file_info_cache().exists(quest.get_sprite_path(sprite_id))) {
     // The sprite file does not exist.
     return false;
   }
@@ -149,6 +149,76 @@ QIcon EnumTraits<EntityType>::get_icon(EntityType value) {
   return QIcon(":/images/entity_" + get_lua_name(value) + ".png");
 }
 
+/**
+ * @brief Returns the color of the marker that represents a value
+ * in low detail map views.
+ *
+ * Entities with a similar role have similar colors.
+ *
+ * @param value A value.
+ * @return The corresponding color.
+ */
+QColor EnumTraits<EntityType>::get_marker_color(EntityType value) {
+
+  // Use a switch to ensure we don't forget a value.
+  switch (value) {
+
+  case EntityType::TILE:
+  case EntityType::DYNAMIC_TILE:
+    return QColor(160, 128, 96);
+
+  case EntityType::WALL:
+  case EntityType::SEPARATOR:
+    return QColor(128, 128, 128);
+
+  case EntityType::DESTINATION:
+  case EntityType::TELETRANSPORTER:
+  case EntityType::STAIRS:
+    return QColor(64, 160, 224);
+
+  case EntityType::SENSOR:
+  case EntityType::SWITCH:
+  case EntityType::CRYSTAL:
+  case EntityType::CRYSTAL_BLOCK:
+    return QColor(224, 192, 64);
+
+  case EntityType::CHEST:
+  case EntityType::PICKABLE:
+  case EntityType::SHOP_TREASURE:
+    return QColor(240, 160, 32);
+
+  case EntityType::ENEMY:
+    return QColor(224, 64, 64);
+
+  case EntityType::NPC:
+  case EntityType::HERO:
+    return QColor(64, 192, 96);
+
+  case EntityType::BLOCK:
+  case EntityType::DESTRUCTIBLE:
+  case EntityType::DOOR:
+  case EntityType::JUMPER:
+  case EntityType::STREAM:
+    return QColor(160, 96, 192);
+
+  case EntityType::CUSTOM:
+    return QColor(224, 96, 192);
+
+  case EntityType::ARROW:
+  case EntityType::BOMB:
+  case EntityType::BOOMERANG:
+  case EntityType::CAMERA:
+  case EntityType::CARRIED_OBJECT:
+  case EntityType::EXPLOSION:
+  case EntityType::FIRE:
+  case EntityType::HOOKSHOT:
+    return QColor(192, 192, 192);
+
+  }
+
+  return QColor(192, 192, 192);
+}
+
 /**
  * @brief Returns the Lua name of a value.
  * @param value A value.
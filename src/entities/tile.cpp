@@ -130,8 +130,9 @@ void Tile::update_pattern() {
     }
   }
 
-  // Invalidate the cached image.
+  // Invalidate the cached images.
   pattern_image = QPixmap();
+  pattern_mipmaps.fill(QPixmap());
 }
 
 /**
@@ -192,6 +193,50 @@ void Tile::draw(QPainter& painter) const {
   painter.drawTiledPixmap(0, 0, get_width(), get_height(), pattern_image);
 }
 
+/**
+ * @brief Draws this tile from a downsampled image of its pattern.
+ *
+ * Tiles are never drawn as markers because they make the map readable.
+ *
+ * @param painter The painter to draw.
+ * @param level_of_detail Scale factor of the painter.
+ */
+void Tile::draw_low_detail(QPainter& painter, double level_of_detail) const {
+
+  // Pick the smallest mipmap that still has at least one pixel per screen pixel.
+  // Patterns have sizes multiple of 8 so levels up to 3 are exact.
+  int level = 0;
+  double scale = 1.0;
+  while (level < max_mipmap_level && scale / 2.0 >= level_of_detail) {
+    scale /= 2.0;
+    ++level;
+  }
+
+  if (level == 0) {
+    draw(painter);
+    return;
+  }
+
+  QPixmap& mipmap = pattern_mipmaps[level - 1];
+  if (mipmap.isNull()) {
+    // Lazily get the image from the tileset.
+    const TilesetModel* tileset = get_tileset();
+    const int pattern_index = tileset != nullptr ? tileset->id_to_index(get_pattern_id()) : -1;
+    if (pattern_index != -1) {
+      mipmap = tileset->get_pattern_mipmap(pattern_index, level);
+    }
+  }
+  if (mipmap.isNull()) {
+    draw(painter);
+    return;
+  }
+
+  painter.save();
+  painter.scale(1.0 / scale, 1.0 / scale);
+  painter.drawTiledPixmap(QRectF(0, 0, get_width() * scale, get_height() * scale), mipmap);
+  painter.restore();
+}
+
 /**
  * @copydoc EntityModel::notify_tileset_changed
  */
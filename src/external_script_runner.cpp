@@ -0,0 +1,560 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "external_script_runner.h"
+#include <lua.hpp>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+namespace SolarusEditor {
+
+namespace {
+
+/**
+ * @brief Registry key of the runner of a Lua state.
+ */
+const char* runner_registry_key = "sqe.external_script_runner";
+
+/**
+ * @brief Number of Lua instructions between two cancellation checks.
+ */
+constexpr int hook_instruction_count = 1000;
+
+/**
+ * @brief Custom loader for Lua to require() files from the script's directory.
+ *
+ * It also works if the script is inside Qt resources.
+ *
+ * This function expects an upvalue of type string indicating the path of the
+ * current script (necessary to know its directory).
+ *
+ * @param l A Lua state.
+ * @return Number of values to return to Lua.
+ */
+int l_loader_from_current_dir(lua_State* l) {
+
+  QString current_script_path = QString::fromUtf8(lua_tostring(l, lua_upvalueindex(1)));
+  QString required_name = QString::fromUtf8(luaL_checkstring(l, 1));
+
+  if (QFileInfo(required_name).isAbsolute()) {
+    // An absolute path was specified: not our job here (and it is not an error).
+    lua_pushnil(l);
+    return 1;
+  }
+
+  QDir parent_dir(current_script_path);
+  if (!parent_dir.cdUp()) {
+    // Something must be wrong in this C++ code.
+    qCritical() << ExternalScriptRunner::tr("Cannot determine the directory of script '%1'").arg(current_script_path);
+    lua_pushnil(l);
+    return 1;
+  }
+
+  QString required_path = parent_dir.absolutePath() + "/" + required_name + ".lua";
+
+  QFile required_file(required_path);
+  if (!required_file.open(QFileDevice::ReadOnly)) {
+    // File was not found by this loader.
+    // This is not an error, but we should give information about what was
+    // searched, like standard loaders.
+
+    // Note that the information is not translated because Lua uses it
+    // to build a larger diagnostic in English.
+    QByteArray message;
+    if (required_path.startsWith(":/")) {
+      // Qt resource that was searched in the script's directory.
+      message = QString("\n\tno Qt resource file '%1'").arg(required_path).toUtf8();
+    }
+    else {
+      // Regular file that was searched in the script's directory.
+      message = QString("\n\tno file '%1'").arg(required_path).toUtf8();
+    }
+    lua_pushstring(l, message.constData());
+    return 1;
+  }
+
+  QByteArray buffer = required_file.readAll();
+  QByteArray required_path_utf8 = required_path.toUtf8();
+  luaL_loadbuffer(l, buffer.constData(), buffer.size(), required_path_utf8);
+  return 1;
+}
+
+}
+
+/**
+ * @brief Creates a runner for a script.
+ *
+ * Call start() to run the script.
+ *
+ * @param script_path The script to run, without extension.
+ * @param script_arg An argument to pass to the script, or an empty string.
+ * @param parent The parent object or nullptr.
+ */
+ExternalScriptRunner::ExternalScriptRunner(
+    const QString& script_path,
+    const QString& script_arg,
+    QObject* parent) :
+  QThread(parent),
+  script_path(script_path),
+  script_arg(script_arg),
+  successful(0),
+  cancel_requested(0) {
+
+}
+
+/**
+ * @brief Destructor.
+ *
+ * Interrupts the script if it is still running.
+ */
+ExternalScriptRunner::~ExternalScriptRunner() {
+
+  cancel();
+  wait();
+}
+
+/**
+ * @brief Returns whether the script is successfully finished.
+ * @return @c true if the script is finished and was successful.
+ */
+bool ExternalScriptRunner::is_successful() const {
+  return successful.load() != 0;
+}
+
+/**
+ * @brief Returns whether the script was asked to stop.
+ * @return @c true if cancel() was called.
+ */
+bool ExternalScriptRunner::is_canceled() const {
+  return cancel_requested.load() != 0;
+}
+
+/**
+ * @brief Asks the script to stop as soon as possible.
+ *
+ * This function returns immediately.
+ * The thread finishes after the next cancellation check.
+ */
+void ExternalScriptRunner::cancel() {
+  cancel_requested.store(1);
+}
+
+/**
+ * @brief Returns the output produced since the last call and clears it.
+ *
+ * This function can be called from any thread.
+ *
+ * @return The new output.
+ */
+QString ExternalScriptRunner::take_output() {
+
+  QMutexLocker locker(&output_mutex);
+  QString text = output.join("");
+  output.clear();
+  return text;
+}
+
+/**
+ * @brief Adds some text to the output queue.
+ *
+ * Emits output_available() if the queue was empty, so that the receiver
+ * is notified only once for several consecutive writes.
+ *
+ * @param text The text to add.
+ */
+void ExternalScriptRunner::append_output(const QString& text) {
+
+  bool was_empty = false;
+  {
+    QMutexLocker locker(&output_mutex);
+    was_empty = output.isEmpty();
+    output.append(text);
+  }
+
+  if (was_empty) {
+    emit output_available();
+  }
+}
+
+/**
+ * @brief Returns the runner associated to a Lua state.
+ * @param l A Lua state created by a runner.
+ * @return The runner.
+ */
+ExternalScriptRunner& ExternalScriptRunner::get_runner(lua_State* l) {
+
+  lua_getfield(l, LUA_REGISTRYINDEX, runner_registry_key);
+  ExternalScriptRunner* runner = static_cast<ExternalScriptRunner*>(lua_touserdata(l, -1));
+  lua_pop(l, 1);
+  return *runner;
+}
+
+/**
+ * @brief Replacement of io.write() that sends text to the output queue.
+ * @param l A Lua state.
+ * @return Number of values to return to Lua.
+ */
+int ExternalScriptRunner::l_write(lua_State* l) {
+
+  QString text;
+  const int num_arguments = lua_gettop(l);
+  for (int i = 1; i <= num_arguments; ++i) {
+    text += QString::fromUtf8(luaL_checkstring(l, i));
+  }
+
+  get_runner(l).append_output(text);
+  return 0;
+}
+
+/**
+ * @brief Replacement of print() that sends text to the output queue.
+ * @param l A Lua state.
+ * @return Number of values to return to Lua.
+ */
+int ExternalScriptRunner::l_print(lua_State* l) {
+
+  QString text;
+  const int num_arguments = lua_gettop(l);
+  for (int i = 1; i <= num_arguments; ++i) {
+    lua_getglobal(l, "tostring");
+    lua_pushvalue(l, i);
+    lua_call(l, 1, 1);
+    const char* value = lua_tostring(l, -1);
+    if (value == nullptr) {
+      return luaL_error(l, "'tostring' must return a string to 'print'");
+    }
+    if (i > 1) {
+      text += '\t';
+    }
+    text += QString::fromUtf8(value);
+    lua_pop(l, 1);
+  }
+  text += '\n';
+
+  get_runner(l).append_output(text);
+  return 0;
+}
+
+/**
+ * @brief Replacement of io.flush().
+ *
+ * Does nothing since the output queue is not buffered.
+ *
+ * @param l A Lua state.
+ * @return Number of values to return to Lua.
+ */
+int ExternalScriptRunner::l_flush(lua_State* l) {
+
+  Q_UNUSED(l);
+  return 0;
+}
+
+/**
+ * @brief Lua hook that interrupts the script if cancel() was called.
+ * @param l A Lua state.
+ * @param ar Debug information.
+ */
+void ExternalScriptRunner::l_hook(lua_State* l, lua_Debug* ar) {
+
+  Q_UNUSED(ar);
+  if (get_runner(l).is_canceled()) {
+    luaL_error(l, "Script canceled");
+  }
+}
+
+/**
+ * @brief Implementation of run_tasks(tasks).
+ *
+ * Each task is a table with fields stage, label, module and args.
+ * args is an array of strings or nil values, with an optional n field
+ * giving the number of arguments.
+ *
+ * @param l A Lua state.
+ * @return Number of values to return to Lua.
+ */
+int ExternalScriptRunner::l_run_tasks(lua_State* l) {
+
+  luaL_checktype(l, 1, LUA_TTABLE);
+
+  ExternalScriptRunner& runner = get_runner(l);
+  QList<Task> tasks;
+  const int num_tasks = static_cast<int>(lua_objlen(l, 1));
+  for (int i = 1; i <= num_tasks; ++i) {
+    lua_rawgeti(l, 1, i);
+    if (!lua_istable(l, -1)) {
+      return luaL_error(l, "Bad task #%d: table expected", i);
+    }
+
+    Task task;
+    task.runner = &runner;
+    lua_getfield(l, -1, "stage");
+    task.stage = QString::fromUtf8(lua_tostring(l, -1));
+    lua_getfield(l, -2, "label");
+    task.label = QString::fromUtf8(lua_tostring(l, -1));
+    lua_getfield(l, -3, "module");
+    if (!lua_isstring(l, -1)) {
+      return luaL_error(l, "Bad task #%d: missing module name", i);
+    }
+    task.module = lua_tostring(l, -1);
+    lua_pop(l, 3);
+
+    lua_getfield(l, -1, "args");
+    if (lua_istable(l, -1)) {
+      lua_getfield(l, -1, "n");
+      const int num_args = lua_isnumber(l, -1) ?
+            static_cast<int>(lua_tointeger(l, -1)) :
+            static_cast<int>(lua_objlen(l, -2));
+      lua_pop(l, 1);
+      for (int j = 1; j <= num_args; ++j) {
+        lua_rawgeti(l, -1, j);
+        if (lua_isnil(l, -1)) {
+          task.args << QByteArray();
+        }
+        else {
+          size_t size = 0;
+          const char* arg = lua_tolstring(l, -1, &size);
+          if (arg == nullptr) {
+            return luaL_error(l, "Bad task #%d: argument %d is not a string", i, j);
+          }
+          task.args << QByteArray(arg, static_cast<int>(size));
+        }
+        lua_pop(l, 1);
+      }
+    }
+    lua_pop(l, 2);
+    tasks << task;
+  }
+
+  lua_pushinteger(l, runner.run_tasks(tasks));
+  return 1;
+}
+
+/**
+ * @brief Creates a Lua state for the script or for one of its tasks.
+ *
+ * The state has the standard libraries, the output redirected to our queue,
+ * the cancellation hook and a loader for files of the script's directory.
+ *
+ * @return The new Lua state. The caller has to close it.
+ */
+lua_State* ExternalScriptRunner::create_state() {
+
+  lua_State* l = luaL_newstate();
+  luaL_openlibs(l);
+
+  lua_pushlightuserdata(l, this);
+  lua_setfield(l, LUA_REGISTRYINDEX, runner_registry_key);
+
+  // Redirect the output to our queue.
+  lua_pushcfunction(l, l_print);
+  lua_setglobal(l, "print");
+  lua_getglobal(l, "io");
+  lua_pushcfunction(l, l_write);
+  lua_setfield(l, -2, "write");
+  lua_pushcfunction(l, l_flush);
+  lua_setfield(l, -2, "flush");
+  lua_pop(l, 1);
+
+  lua_pushcfunction(l, l_run_tasks);
+  lua_setglobal(l, "run_tasks");
+
+  lua_sethook(l, l_hook, LUA_MASKCOUNT, hook_instruction_count);
+#ifdef LUAJIT_VERSION
+  // LuaJIT does not call count hooks from compiled code,
+  // so a loop compiled into a trace could never be canceled.
+  luaJIT_setmode(l, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_OFF);
+#endif
+
+  // Make require able to find files relative to the script's directory.
+  QByteArray path_utf8 = QString(script_path + ".lua").toUtf8();
+  lua_pushstring(l, path_utf8.constData());
+  lua_pushcclosure(l, l_loader_from_current_dir, 1);
+  lua_setglobal(l, "loader_from_current_dir");
+  luaL_dostring(l, "table.insert(package.loaders, 2, loader_from_current_dir)");  // TODO clean this
+
+  return l;
+}
+
+/**
+ * @brief Runs one task in a new Lua state.
+ *
+ * This is executed in a thread of the global thread pool.
+ *
+ * @param task The task to run.
+ * @return The outcome of the task.
+ */
+ExternalScriptRunner::TaskResult ExternalScriptRunner::run_task(const Task& task) {
+
+  ExternalScriptRunner& runner = *task.runner;
+  TaskResult result = { false, QString(), 0 };
+  QElapsedTimer timer;
+  timer.start();
+
+  if (runner.is_canceled()) {
+    result.error = "Script canceled";
+    return result;
+  }
+
+  lua_State* l = runner.create_state();
+  lua_getglobal(l, "require");
+  lua_pushstring(l, task.module.constData());
+  if (lua_pcall(l, 1, 1, 0) == 0) {
+    lua_getfield(l, -1, "convert");
+    for (const QByteArray& arg : task.args) {
+      if (arg.isNull()) {
+        lua_pushnil(l);
+      }
+      else {
+        lua_pushlstring(l, arg.constData(), arg.size());
+      }
+    }
+    result.successful = lua_pcall(l, task.args.size(), 0, 0) == 0;
+  }
+  if (!result.successful) {
+    result.error = QString::fromUtf8(lua_tostring(l, -1));
+  }
+  lua_close(l);
+
+  result.elapsed_ms = timer.elapsed();
+  if (result.successful) {
+    runner.append_output(QString("    %1 (%2 ms)\n").arg(task.label).arg(result.elapsed_ms));
+  }
+  else {
+    runner.append_output(tr("    %1: failed\n").arg(task.label));
+  }
+  return result;
+}
+
+/**
+ * @brief Runs tasks in parallel and reports their failures and timings.
+ *
+ * This is executed in the worker thread, which waits for all tasks.
+ *
+ * @param tasks The tasks to run.
+ * @return The number of tasks that failed.
+ */
+int ExternalScriptRunner::run_tasks(const QList<Task>& tasks) {
+
+  struct StageStats {
+    int num_tasks;
+    int num_failures;
+    qint64 total_ms;
+    qint64 slowest_ms;
+    QString slowest_label;
+  };
+
+  QElapsedTimer timer;
+  timer.start();
+  append_output(tr("  Converting %1 files with %2 threads...\n")
+                .arg(tasks.size()).arg(QThreadPool::globalInstance()->maxThreadCount()));
+
+  const QList<TaskResult> results =
+      QtConcurrent::blockingMapped<QList<TaskResult>>(tasks, &ExternalScriptRunner::run_task);
+
+  // Gather statistics per stage, keeping the order of the stages.
+  QStringList stages;
+  QMap<QString, StageStats> stats;
+  QStringList failures;
+  for (int i = 0; i < tasks.size(); ++i) {
+    const Task& task = tasks[i];
+    const TaskResult& result = results[i];
+    if (!stats.contains(task.stage)) {
+      stages << task.stage;
+      stats.insert(task.stage, StageStats{ 0, 0, 0, -1, QString() });
+    }
+    StageStats& stage_stats = stats[task.stage];
+    ++stage_stats.num_tasks;
+    stage_stats.total_ms += result.elapsed_ms;
+    if (result.elapsed_ms > stage_stats.slowest_ms) {
+      stage_stats.slowest_ms = result.elapsed_ms;
+      stage_stats.slowest_label = task.label;
+    }
+    if (!result.successful) {
+      ++stage_stats.num_failures;
+      failures << QString("    %1: %2\n").arg(task.label, result.error);
+    }
+  }
+
+  for (const QString& stage : stages) {
+    const StageStats& stage_stats = stats[stage];
+    append_output(tr("  %1: %2 files, %3 failed, %4 ms in total, slowest: %5 (%6 ms)\n")
+                  .arg(stage)
+                  .arg(stage_stats.num_tasks)
+                  .arg(stage_stats.num_failures)
+                  .arg(stage_stats.total_ms)
+                  .arg(stage_stats.slowest_label)
+                  .arg(stage_stats.slowest_ms));
+  }
+  if (!failures.isEmpty()) {
+    append_output(tr("  %1 files could not be converted:\n").arg(failures.size()) +
+                  failures.join(""));
+  }
+  append_output(tr("  Conversion finished in %1 ms\n").arg(timer.elapsed()));
+
+  return failures.size();
+}
+
+/**
+ * @brief Runs the script. This is executed in the worker thread.
+ *
+ * This function does not throw exceptions, it outputs any error to the
+ * output queue.
+ */
+void ExternalScriptRunner::run() {
+
+  successful.store(0);
+
+  lua_State* l = create_state();
+
+  QString path = script_path + ".lua";
+  QFile script_file(path);
+  if (!script_file.open(QFileDevice::ReadOnly)) {
+    append_output(tr("Cannot open file '%1'").arg(path));
+  }
+  else {
+    QByteArray buffer = script_file.readAll();
+    QByteArray path_utf8 = path.toUtf8();
+    if (luaL_loadbuffer(l, buffer.constData(), buffer.size(), path_utf8.constData()) != 0) {
+      // Loading the script failed.
+      append_output(QString::fromUtf8(lua_tostring(l, -1)));
+    }
+    else {
+      int num_arguments = 0;
+      if (!script_arg.isEmpty()) {
+        num_arguments = 1;
+        lua_pushstring(l, script_arg.toUtf8().constData());
+      }
+
+      // Run the script.
+      if (lua_pcall(l, num_arguments, 0, 0) == 0) {
+        successful.store(1);
+      }
+      else {
+        append_output(QString::fromUtf8(lua_tostring(l, -1)) + '\n');
+      }
+    }
+  }
+
+  lua_close(l);
+}
+
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "file_info_cache.h"
+#include <QFileInfo>
+
+namespace SolarusEditor {
+
+/**
+ * @brief Creates an empty file information cache.
+ * @param parent The parent object or nullptr.
+ */
+FileInfoCache::FileInfoCache(QObject* parent) :
+  QObject(parent) {
+
+  connect(&watcher, SIGNAL(directoryChanged(QString)),
+          this, SLOT(directory_changed(QString)));
+}
+
+/**
+ * @brief Returns whether a file or directory exists.
+ * @param path The path to test.
+ * @return @c true if it exists.
+ */
+bool FileInfoCache::exists(const QString& path) const {
+
+  return get_entry(path).exists;
+}
+
+/**
+ * @brief Returns whether a path exists and is a directory.
+ * @param path The path to test.
+ * @return @c true if this is a directory.
+ */
+bool FileInfoCache::is_dir(const QString& path) const {
+
+  return get_entry(path).is_dir;
+}
+
+/**
+ * @brief Returns the size of a file.
+ * @param path Path of a file.
+ * @return Its size in bytes, or 0 if it does not exist.
+ */
+qint64 FileInfoCache::get_size(const QString& path) const {
+
+  return get_entry(path).size;
+}
+
+/**
+ * @brief Returns the last modification date of a file or directory.
+ * @param path The path to get.
+ * @return Its last modification date, or an invalid date if it does not exist.
+ */
+QDateTime FileInfoCache::get_last_modified(const QString& path) const {
+
+  return get_entry(path).last_modified;
+}
+
+/**
+ * @brief Returns the information about a path, reading it if necessary.
+ * @param path The path to get.
+ * @return The information about this path.
+ */
+FileInfoCache::Entry FileInfoCache::get_entry(const QString& path) const {
+
+  const auto it = entries.constFind(path);
+  if (it != entries.constEnd()) {
+    return it.value();
+  }
+
+  const QFileInfo info(path);
+  Entry entry;
+  entry.exists = info.exists();
+  entry.is_dir = entry.exists && info.isDir();
+  entry.size = entry.exists ? info.size() : 0;
+  if (entry.exists) {
+    entry.last_modified = info.lastModified();
+  }
+
+  // Only keep information that will be invalidated when it changes.
+  // Files are not watched individually: their parent directory is enough
+  // to detect files created, removed or replaced.
+  // If the parent directory does not exist either, the nearest existing
+  // ancestor changes when the missing directories get created.
+  QString dir_path = info.path();
+  while (!QFileInfo(dir_path).isDir()) {
+    const QString& ancestor_path = QFileInfo(dir_path).path();
+    if (ancestor_path == dir_path) {
+      return entry;
+    }
+    dir_path = ancestor_path;
+  }
+  if (!watch(dir_path)) {
+    return entry;
+  }
+
+  entry.watched_dir = dir_path;
+  entries.insert(path, entry);
+  children_by_dir[dir_path].insert(path);
+  return entry;
+}
+
+/**
+ * @brief Starts watching a directory if not already done.
+ * @param path The directory to watch.
+ * @return @c true if the directory is watched.
+ */
+bool FileInfoCache::watch(const QString& path) const {
+
+  if (watched_paths.contains(path)) {
+    return true;
+  }
+
+  if (!QFileInfo(path).isDir() || !watcher.addPath(path)) {
+    return false;
+  }
+
+  watched_paths.insert(path);
+  return true;
+}
+
+/**
+ * @brief Forgets the information about a path.
+ * @param path The path to remove from the cache.
+ */
+void FileInfoCache::remove_entry(const QString& path) {
+
+  const auto entry_it = entries.find(path);
+  if (entry_it == entries.end()) {
+    return;
+  }
+  const QString watched_dir = entry_it.value().watched_dir;
+  entries.erase(entry_it);
+
+  auto it = children_by_dir.find(watched_dir);
+  if (it != children_by_dir.end()) {
+    it.value().remove(path);
+    if (it.value().isEmpty()) {
+      children_by_dir.erase(it);
+    }
+  }
+}
+
+/**
+ * @brief Forgets the information about a path and everything under it.
+ *
+ * Call this function after modifying a file or directory
+ * to avoid waiting for the filesystem watcher notification.
+ *
+ * @param path The path that was modified.
+ */
+void FileInfoCache::invalidate(const QString& path) {
+
+  remove_entry(path);
+
+  const QString& prefix = path + '/';
+  for (const QString& cached_path : entries.keys()) {
+    if (cached_path.startsWith(prefix)) {
+      remove_entry(cached_path);
+    }
+  }
+}
+
+/**
+ * @brief Forgets all information and stops watching files.
+ */
+void FileInfoCache::clear() {
+
+  entries.clear();
+  children_by_dir.clear();
+  if (!watched_paths.isEmpty()) {
+    watcher.removePaths(watched_paths.toList());
+  }
+  watched_paths.clear();
+}
+
+/**
+ * @brief Slot called when the content of a watched directory has changed.
+ *
+ * Forgets the paths it invalidates, which are its direct children and
+ * missing paths below it, and the directory itself if it was cached too.
+ *
+ * @param path Path of the directory.
+ */
+void FileInfoCache::directory_changed(const QString& path) {
+
+  remove_entry(path);
+  for (const QString& child_path : children_by_dir.value(path)) {
+    remove_entry(child_path);
+  }
+
+  if (!QFileInfo(path).exists()) {
+    watcher.removePath(path);
+    watched_paths.remove(path);
+  }
+}
+
+}
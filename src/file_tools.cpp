@@ -18,21 +18,141 @@
 #include "file_tools.h"
 #include <solarus/core/Common.h>
 #include <QApplication>
+#include <QAtomicInt>
 #include <QDebug>
 #include <QDir>
+#include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
-#include <QTextStream>
-
-#include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace SolarusEditor {
 
 namespace FileTools {
 
 namespace {
-  bool assets_path_initialized = false;
-  QString assets_path;
+
+bool assets_path_initialized = false;
+QString assets_path;
+
+/**
+ * @brief Interval in milliseconds between two progress notifications.
+ */
+constexpr int progress_interval = 50;
+
+/**
+ * @brief State shared by the tasks of a parallel copy.
+ */
+struct CopyState {
+  QAtomicInt num_copied;        /**< Number of files already copied. */
+  QMutex errors_mutex;          /**< Protects the error list. */
+  QStringList errors;           /**< Errors that happened during the copy. */
+};
+
+/**
+ * @brief Makes a copy-on-write clone of a file if the filesystem supports it.
+ *
+ * A clone shares the data blocks of the original file until one of them is
+ * modified, so it is created almost instantly whatever the file size.
+ * Unlike a hard link, modifying the clone later does not change the
+ * original file.
+ *
+ * @param src The file to clone.
+ * @param dst The destination file path. It must not exist.
+ * @return @c true in case of success, @c false if files cannot be cloned
+ * here. In this case, nothing was created.
+ */
+bool clone_file(const QString& src, const QString& dst) {
+
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+  const QByteArray src_path = QFile::encodeName(src);
+  const QByteArray dst_path = QFile::encodeName(dst);
+
+  const int src_fd = ::open(src_path.constData(), O_RDONLY | O_CLOEXEC);
+  if (src_fd < 0) {
+    return false;
+  }
+  struct stat src_stat;
+  if (::fstat(src_fd, &src_stat) != 0) {
+    ::close(src_fd);
+    return false;
+  }
+  const int dst_fd = ::open(dst_path.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, src_stat.st_mode & 0777);
+  if (dst_fd < 0) {
+    ::close(src_fd);
+    return false;
+  }
+
+  const bool cloned = ::ioctl(dst_fd, FICLONE, src_fd) == 0;
+  ::close(dst_fd);
+  ::close(src_fd);
+  if (!cloned) {
+    ::unlink(dst_path.constData());
+  }
+  return cloned;
+#else
+  Q_UNUSED(src);
+  Q_UNUSED(dst);
+  return false;
+#endif
+}
+
+/**
+ * @brief Task that copies one file in a worker thread.
+ *
+ * Regular files are cloned when the filesystem supports it and copied
+ * otherwise.
+ */
+class CopyFileTask : public QRunnable {
+
+public:
+
+  CopyFileTask(const QString& src, const QString& dst, CopyState& state) :
+    src(src),
+    dst(dst),
+    state(state) {
+  }
+
+  void run() override {
+
+    const bool resource = src.startsWith(":/");
+    if ((resource || !clone_file(src, dst)) && !QFile::copy(src, dst)) {
+      QMutexLocker locker(&state.errors_mutex);
+      state.errors << QApplication::tr("Cannot copy file '%1' to '%2'").arg(src, dst);
+      return;
+    }
+
+    if (resource) {
+      // Files from Qt resources are read-only. Set usual permissions now.
+      QFile::setPermissions(dst,
+                            QFile::ReadUser | QFile::WriteUser | QFile::ExeUser |
+                            QFile::ReadGroup| QFile::ExeGroup |
+                            QFile::ReadOther| QFile::ExeOther);
+    }
+    state.num_copied.fetchAndAddRelaxed(1);
+  }
+
+private:
+
+  QString src;                  /**< The file to copy. */
+  QString dst;                  /**< The destination file path. */
+  CopyState& state;             /**< State of the whole copy. */
+};
+
 }
 
 /**
@@ -90,13 +210,29 @@ QString get_assets_path() {
 
 /**
  * @brief Utility function to copy a file or directory with its content.
+ *
+ * Directories are created first, then files are copied in parallel
+ * by a pool of worker threads. On filesystems that support it,
+ * files are cloned instead of copied, which shares their data blocks
+ * until they are modified.
+ *
+ * Symbolic links are followed: the copy contains the files and directories
+ * they point to rather than the links themselves.
+ *
  * @param src The file or directory to copy.
  * @param dst The destination file path. It should be the name of the file
  * or directory to create.
+ * @param progress_callback Optional function called regularly from the
+ * calling thread with the number of files copied and the total number of
+ * files to copy.
  * @throws EditorException if the copy failed. In this case, files already
  * successfully copied are left.
  */
-void copy_recursive(const QString& src, const QString& dst) {
+void copy_recursive(
+    const QString& src,
+    const QString& dst,
+    const ProgressCallback& progress_callback
+) {
 
   if (src == dst) {
     throw EditorException(QApplication::tr("Source and destination are the same: '%1'").arg(src));
@@ -117,6 +253,8 @@ void copy_recursive(const QString& src, const QString& dst) {
     throw EditorException(QApplication::tr("Destination already exists: '%1'").arg(dst));
   }
 
+  QList<QPair<QString, QString>> files_to_copy;
+
   if (src_info.isDir()) {
 
     QDir dst_dir(dst);
@@ -137,27 +275,50 @@ void copy_recursive(const QString& src, const QString& dst) {
       throw EditorException(QApplication::tr("Cannot create folder '%1'").arg(dst));
     }
 
-    QDir src_dir(src);
-    const QStringList& file_names = src_dir.entryList(
-          QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
-    for (const QString& file_name : file_names) {
-      QString next_src = src + '/' + file_name;
-      QString next_dst = dst + '/' + file_name;
-      copy_recursive(next_src, next_dst);
+    // Create the directory tree and list files to copy.
+    QDirIterator it(
+          src,
+          QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System,
+          QDirIterator::Subdirectories | QDirIterator::FollowSymlinks
+    );
+    while (it.hasNext()) {
+      const QString next_src = it.next();
+      const QString next_dst = dst + next_src.mid(src.size());
+      if (it.fileInfo().isDir()) {
+        if (!QDir().mkdir(next_dst)) {
+          throw EditorException(QApplication::tr("Cannot create folder '%1'").arg(next_dst));
+        }
+      }
+      else {
+        files_to_copy << qMakePair(next_src, next_dst);
+      }
     }
   }
   else {
-    if (!QFile::copy(src, dst)) {
-      throw EditorException(QApplication::tr("Cannot copy file '%1' to '%2'").arg(src, dst));
-    }
+    files_to_copy << qMakePair(src, dst);
+  }
 
-    if (src.startsWith(":/")) {
-      // Files from Qt resources are read-only. Set usual permissions now.
-      QFile::setPermissions(dst,
-                            QFile::ReadUser | QFile::WriteUser | QFile::ExeUser |
-                            QFile::ReadGroup| QFile::ExeGroup |
-                            QFile::ReadOther| QFile::ExeOther);
+  // Copy files in parallel.
+  const int total = files_to_copy.size();
+  CopyState state;
+  QThreadPool pool;
+  for (const QPair<QString, QString>& file : files_to_copy) {
+    pool.start(new CopyFileTask(file.first, file.second, state));
+  }
+
+  if (progress_callback) {
+    progress_callback(0, total);
+    while (!pool.waitForDone(progress_interval)) {
+      progress_callback(state.num_copied.load(), total);
     }
+    progress_callback(state.num_copied.load(), total);
+  }
+  else {
+    pool.waitForDone();
+  }
+
+  if (!state.errors.isEmpty()) {
+    throw EditorException(state.errors.first());
   }
 }
 
@@ -210,6 +371,15 @@ void create_directories(const QString& path) {
 
 /**
  * @brief Replaces all occurences of the given pattern in a file.
+ *
+ * The file is memory-mapped and first searched for the pattern:
+ * files without any match are neither copied nor rewritten.
+ *
+ * Windows line breaks are converted to Unix ones before matching,
+ * so line breaks in the pattern match both kinds.
+ * If the file contains Windows line breaks, they are restored afterwards
+ * on every line, including the replaced ones.
+ *
  * @param path Path of the file to modify.
  * @param regexp The pattern to replace.
  * @param replacement The string to put instead of the pattern.
@@ -223,32 +393,73 @@ bool replace_in_file(
 ) {
   QFile file(path);
 
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+  if (!file.open(QIODevice::ReadOnly)) {
     throw EditorException(QApplication::tr("Cannot open file '%1'").arg(file.fileName()));
   }
-  QTextStream in(&file);
-  in.setCodec("UTF-8");
-  QString content = in.readAll();
-  file.close();
 
-  QString old_content = content;
-  content.replace(regex, replacement);
+  const qint64 size = file.size();
+  QByteArray buffer;
+  const char* data = nullptr;
+  if (size > 0) {
+    data = reinterpret_cast<const char*>(file.map(0, size));
+    if (data == nullptr) {
+      // Mapping is not supported for this file: read it instead.
+      buffer = file.readAll();
+      data = buffer.constData();
+    }
+  }
+
+  QString content = QString::fromUtf8(data, static_cast<int>(size));
+  const bool windows_line_breaks = content.contains("\r\n");
+  if (windows_line_breaks) {
+    content.replace("\r\n", "\n");
+  }
 
-  if (content == old_content) {
+  if (!regex.match(content).hasMatch()) {
     // No change.
     return false;
   }
 
-  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-    throw EditorException(QApplication::tr("Cannot open file '%1' for writing").arg(file.fileName()));
+  content.replace(regex, replacement);
+  if (windows_line_breaks) {
+    content.replace("\n", "\r\n");
+  }
+
+  const QByteArray new_data = content.toUtf8();
+  if (new_data.size() == size &&
+      (size == 0 || std::memcmp(new_data.constData(), data, static_cast<size_t>(size)) == 0)) {
+    // Matches were replaced by the same text.
+    return false;
   }
-  QTextStream out(&file);
-  out.setCodec("UTF-8");
-  out << content;
   file.close();
+
+  QSaveFile output(path);
+  if (!output.open(QIODevice::WriteOnly)) {
+    throw EditorException(QApplication::tr("Cannot open file '%1' for writing").arg(file.fileName()));
+  }
+  output.write(new_data);
+  if (!output.commit()) {
+    throw EditorException(QApplication::tr("Cannot save file '%1'").arg(file.fileName()));
+  }
   return true;
 }
 
+/**
+ * @brief Formats a size in bytes with an appropriate unit.
+ * @param size A size in bytes.
+ * @return The formatted size.
+ */
+QString format_size(qint64 size) {
+
+  if (size < 1024) {
+    return QApplication::tr("%1 B").arg(size);
+  }
+  if (size < 1024 * 1024) {
+    return QApplication::tr("%1 KiB").arg(size / 1024.0, 0, 'f', 1);
+  }
+  return QApplication::tr("%1 MiB").arg(size / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
 }  // namespace FileTools
 
 }  // namespace SolarusEditor
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "image_store.h"
+#include <QFileInfo>
+#include <algorithm>
+
+namespace SolarusEditor {
+
+namespace {
+
+/**
+ * @brief Total size in bytes of images kept while nobody uses them.
+ */
+constexpr qint64 max_unused_size = 32 * 1024 * 1024;
+
+}
+
+/**
+ * @brief Creates an empty image store.
+ */
+ImageStore::ImageStore() :
+  entries(),
+  num_requests(0),
+  num_hits(0) {
+
+}
+
+/**
+ * @brief Returns the image of a file, decoding it only if necessary.
+ * @param path Path of an image file.
+ * @return The image, or a null image if it cannot be read.
+ */
+QImage ImageStore::get_image(const QString& path) {
+
+  ++num_requests;
+
+  const QFileInfo file_info(path);
+  const auto& it = entries.find(path);
+  if (it != entries.end() &&
+      it->last_modified == file_info.lastModified() &&
+      it->file_size == file_info.size()) {
+    ++num_hits;
+    it->last_used = num_requests;
+    return it->image;
+  }
+
+  Entry entry;
+  entry.last_modified = file_info.lastModified();
+  entry.file_size = file_info.size();
+  entry.image = QImage(path);
+  entry.last_used = num_requests;
+  entries.insert(path, entry);
+
+  release_unused_images();
+  return entry.image;
+}
+
+/**
+ * @brief Returns the current memory usage of the store.
+ * @return The statistics.
+ */
+ImageStore::Statistics ImageStore::get_statistics() const {
+
+  Statistics statistics;
+  statistics.num_images = entries.size();
+  statistics.num_used_images = 0;
+  statistics.memory_size = 0;
+  statistics.num_requests = static_cast<int>(num_requests);
+  statistics.num_hits = static_cast<int>(num_hits);
+
+  for (const Entry& entry : entries) {
+    if (!entry.image.isNull() && !entry.image.isDetached()) {
+      ++statistics.num_used_images;
+    }
+    statistics.memory_size += get_memory_size(entry.image);
+  }
+  return statistics;
+}
+
+/**
+ * @brief Releases all images of the store.
+ *
+ * Images still used elsewhere remain valid.
+ */
+void ImageStore::clear() {
+
+  entries.clear();
+  num_requests = 0;
+  num_hits = 0;
+}
+
+/**
+ * @brief Returns the memory used by the pixels of an image.
+ * @param image An image.
+ * @return The size in bytes.
+ */
+qint64 ImageStore::get_memory_size(const QImage& image) {
+
+  return static_cast<qint64>(image.bytesPerLine()) * image.height();
+}
+
+/**
+ * @brief Releases the least recently used images that nobody else uses
+ * until their total size is under the limit.
+ */
+void ImageStore::release_unused_images() {
+
+  QList<QPair<quint64, QString>> unused_images;
+  qint64 unused_size = 0;
+  for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+    if (it->image.isDetached()) {
+      unused_images << qMakePair(it->last_used, it.key());
+      unused_size += get_memory_size(it->image);
+    }
+  }
+
+  if (unused_size <= max_unused_size) {
+    return;
+  }
+
+  std::sort(unused_images.begin(), unused_images.end());
+  for (const QPair<quint64, QString>& unused_image : unused_images) {
+    if (unused_size <= max_unused_size) {
+      break;
+    }
+    unused_size -= get_memory_size(entries.value(unused_image.second).image);
+    entries.remove(unused_image.second);
+  }
+}
+
+}
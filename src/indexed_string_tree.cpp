@@ -16,6 +16,7 @@
  */
 #include "indexed_string_tree.h"
 #include "editor_exception.h"
+#include <algorithm>
 
 namespace SolarusEditor {
 
@@ -25,7 +26,8 @@ namespace SolarusEditor {
  */
 IndexedStringTree::IndexedStringTree(const QString& separator) :
   separator(separator),
-  root(new Node()) {
+  root(new Node()),
+  nodes() {
 }
 
 /**
@@ -99,9 +101,7 @@ QString IndexedStringTree::get_row_key(
     return "";
   }
 
-  auto it = node->children.begin();
-  std::advance(it, index);
-  return it->second->key;
+  return node->children[index]->key;
 }
 
 /**
@@ -191,6 +191,18 @@ bool IndexedStringTree::add_ref(
   return add_child(key, REF_KEY, parent_key, index);
 }
 
+/**
+ * @brief Add a ref in the tree.
+ * @param key The key of the ref to add.
+ * @return @c true in case of success, @c false if already exists.
+ */
+bool IndexedStringTree::add_ref(const QString &key) {
+
+  QString parent_key;
+  int index;
+  return add_ref(key, parent_key, index);
+}
+
 /**
  * @brief Check if can remove a ref from the tree.
  * @param key[in] The key of the ref to remove.
@@ -229,20 +241,11 @@ void IndexedStringTree::clear() {
  */
 IndexedStringTree::Node* IndexedStringTree::get_child(const QString& key) const {
 
-  Node* node = root;
-
   if (key.isEmpty()) {
-    return node;
+    return root;
   }
 
-  QStringList key_list = key.split(separator);
-  while (node != nullptr && !key_list.isEmpty()) {
-
-    QString sub_key = key_list.front();
-    node = get_sub_child(node, sub_key);
-    key_list.pop_front();
-  }
-  return node;
+  return nodes.value(key, nullptr);
 }
 
 /**
@@ -254,11 +257,10 @@ IndexedStringTree::Node* IndexedStringTree::get_child(const QString& key) const
 IndexedStringTree::Node* IndexedStringTree::get_sub_child(
     const Node *node, const QString& sub_key) const {
 
-  auto it = node->children.find(sub_key);
-  if (it == node->children.end()) {
-    return nullptr;
+  if (node->key.isEmpty()) {
+    return nodes.value(sub_key, nullptr);
   }
-  return it->second;
+  return nodes.value(node->key + separator + sub_key, nullptr);
 }
 
 /**
@@ -308,7 +310,7 @@ bool IndexedStringTree::add_child(
     QString sub_key = key_list.front();
 
     // Create the new node.
-    node = new Node();
+    node = new Node(sub_key);
     node->parent = parent;
     if (!parent->key.isEmpty()) {
       node->key = parent->key + separator + sub_key;
@@ -316,9 +318,15 @@ bool IndexedStringTree::add_child(
       node->key = sub_key;
     }
 
-    // Add the node and rebuild the index map.
-    parent->children.emplace(sub_key, node);
-    build_index_map(parent);
+    // Insert the node at its sorted position and update the next indexes.
+    auto it = std::lower_bound(
+          parent->children.begin(), parent->children.end(), node,
+          [](const Node* lhs, const Node* rhs) {
+      return lhs->sub_key < rhs->sub_key;
+    });
+    it = parent->children.insert(it, node);
+    nodes.insert(node->key, node);
+    build_index_map(parent, it - parent->children.begin());
 
     // Set the index of the first added child.
     if (index == -1) {
@@ -407,15 +415,16 @@ bool IndexedStringTree::remove_child(const QString& key, int type, bool keep_key
     return true;
   }
 
-  // Get the parent and the iterator of the node.
+  // Get the parent and the node.
   Node* parent = get_child(parent_key);
-  auto it = parent->children.begin();
-  std::advance(it, index);
-
-  // Remove the node and rebuild the index map.
-  delete it->second;
-  parent->children.erase(it);
-  build_index_map(parent);
+  Node* node = parent->children[index];
+
+  // Remove the node and update the next indexes.
+  clear_children(node);
+  nodes.remove(node->key);
+  delete node;
+  parent->children.erase(parent->children.begin() + index);
+  build_index_map(parent, index);
   return true;
 }
 
@@ -427,12 +436,13 @@ bool IndexedStringTree::remove_child(const QString& key, int type, bool keep_key
  * so we need an additional integer index.
  *
  * @param node The node where to rebuild the index.
+ * @param first_index Index of the first child whose index may have changed.
  */
-void IndexedStringTree::build_index_map(const Node* node) const {
+void IndexedStringTree::build_index_map(const Node* node, int first_index) const {
 
-  int index = 0;
-  for (auto& kvp : node->children) {
-    kvp.second->index = index++;
+  const int num_children = node->children.size();
+  for (int index = first_index; index < num_children; ++index) {
+    node->children[index]->index = index;
   }
 }
 
@@ -442,11 +452,10 @@ void IndexedStringTree::build_index_map(const Node* node) const {
  */
 void IndexedStringTree::clear_children(Node* node) {
 
-  auto it = node->children.begin();
-  while (it != node->children.end()) {
-    clear_children(it->second);
-    delete it->second;
-    it++;
+  for (Node* child : node->children) {
+    clear_children(child);
+    nodes.remove(child->key);
+    delete child;
   }
   node->children.clear();
 }
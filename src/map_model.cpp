@@ -15,6 +15,8 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "entities/entity_model.h"
+#include "data_file_cache.h"
+#include "data_file_parser.h"
 #include "editor_exception.h"
 #include "map_model.h"
 #include "quest.h"
@@ -47,8 +49,12 @@ MapModel::MapModel(
   // Load the map data file.
   QString path = quest.get_map_data_file_path(map_id);
 
-  if (!map.import_from_file(path.toStdString())) {
-    throw EditorException(tr("Cannot open map data file '%1'").arg(path));
+  if (!DataFileCache::load_map(quest, path, map)) {
+    if (!DataFileParser::import_map(path, map) &&
+        !map.import_from_file(path.toStdString())) {
+      throw EditorException(tr("Cannot open map data file '%1'").arg(path));
+    }
+    DataFileCache::save_map(quest, path, map);
   }
 
   // Create the tileset object.
@@ -101,6 +107,7 @@ void MapModel::save() const {
   if (!map.export_to_file(path.toStdString())) {
     throw EditorException(tr("Cannot save map data file '%1'").arg(path));
   }
+  DataFileCache::save_map(quest, path, map);
 }
 
 /**
@@ -47,6 +47,22 @@ const QMap<ResourceType, QString> resource_dirs = {
   { ResourceType::SHADER,   "shaders"   },
 };
 
+/**
+ * @brief File extensions of each resource type whose elements are files.
+ */
+const QMap<ResourceType, QStringList> resource_extensions = {
+  { ResourceType::MAP,      { ".dat" }                         },
+  { ResourceType::TILESET,  { ".dat" }                         },
+  { ResourceType::SPRITE,   { ".dat" }                         },
+  { ResourceType::MUSIC,    { ".ogg", ".it", ".spc" }          },
+  { ResourceType::SOUND,    { ".ogg" }                         },
+  { ResourceType::ITEM,     { ".lua" }                         },
+  { ResourceType::ENEMY,    { ".lua" }                         },
+  { ResourceType::ENTITY,   { ".lua" }                         },
+  { ResourceType::FONT,     { ".png", ".ttf", ".ttc", ".fon" } },
+  { ResourceType::SHADER,   { ".dat" }                         },
+};
+
 }
 
 /**
@@ -54,8 +70,12 @@ const QMap<ResourceType, QString> resource_dirs = {
  */
 Quest::Quest():
   root_path(),
+  data_path_prefix(),
   properties(*this),
-  database(*this) {
+  database(*this),
+  file_info_cache(),
+  audio_analyzer(*this),
+  image_store() {
 }
 
 /**
@@ -64,8 +84,12 @@ Quest::Quest():
  */
 Quest::Quest(const QString& root_path):
   root_path(),
+  data_path_prefix(),
   properties(*this),
-  database(*this) {
+  database(*this),
+  file_info_cache(),
+  audio_analyzer(*this),
+  image_store() {
   set_root_path(root_path);
 }
 
@@ -84,6 +108,17 @@ QString Quest::get_root_path() const {
  */
 void Quest::set_root_path(const QString& root_path) {
 
+  // Write pending resource list changes before leaving the old quest.
+  try {
+    database.flush();
+  }
+  catch (const EditorException& ex) {
+    qWarning() << ex.get_message();
+  }
+
+  audio_analyzer.clear();
+  image_store.clear();
+
   QFileInfo file_info(root_path);
   if (file_info.exists()) {
     this->root_path = file_info.canonicalFilePath();
@@ -91,6 +126,8 @@ void Quest::set_root_path(const QString& root_path) {
   else {
     this->root_path = root_path;
   }
+  data_path_prefix = is_valid() ? get_data_path() + '/' : QString();
+  file_info_cache.clear();
 
   emit root_path_changed(root_path);
 }
@@ -189,6 +226,39 @@ QuestDatabase& Quest::get_database() {
   return database;
 }
 
+/**
+ * @brief Returns the cached metadata of files.
+ *
+ * Use this instead of exists() or is_dir() in code that is called very often
+ * and can tolerate information updated asynchronously,
+ * like painting or item views.
+ *
+ * @return The file information cache.
+ */
+const FileInfoCache& Quest::get_file_info_cache() const {
+  return file_info_cache;
+}
+
+/**
+ * @brief Returns the analyzer of sound and music files of this quest.
+ * @return The audio analyzer.
+ */
+AudioAnalyzer& Quest::get_audio_analyzer() const {
+  return audio_analyzer;
+}
+
+/**
+ * @brief Returns the decoded images of this quest.
+ *
+ * Use it to load PNG files of the quest so that each one is decoded once
+ * and shared.
+ *
+ * @return The image store.
+ */
+ImageStore& Quest::get_image_store() const {
+  return image_store;
+}
+
 /**
  * @brief Returns the name of this quest.
  *
@@ -634,14 +704,9 @@ bool Quest::is_resource_list_path(const QString& path) const {
  */
 bool Quest::is_resource_path(const QString& path, ResourceType& resource_type) const {
 
-  for (auto it = resource_dirs.begin(); it != resource_dirs.end(); ++it) {
-    if (path == get_resource_path(it.key())) {
-      resource_type = it.key();
-      return true;
-    }
-  }
-
-  return false;
+  int relative_index = 0;
+  return find_resource_dir(path, resource_type, relative_index) &&
+      relative_index > path.size();
 }
 
 /**
@@ -653,9 +718,42 @@ bool Quest::is_resource_path(const QString& path, ResourceType& resource_type) c
  */
 bool Quest::is_in_resource_path(const QString& path, ResourceType& resource_type) const {
 
+  int relative_index = 0;
+  return find_resource_dir(path, resource_type, relative_index) &&
+      relative_index <= path.size();
+}
+
+/**
+ * @brief Finds the resource directory of a path.
+ *
+ * This only looks at the first directory under the data path,
+ * without building any intermediate string.
+ *
+ * @param[in] path The path to test.
+ * @param[out] resource_type The resource type found if any.
+ * @param[out] relative_index Index in the path where the part relative to
+ * the resource directory starts. Greater than the path size if the path
+ * is the resource directory itself.
+ * @return @c true if this path is a resource directory or is under one.
+ */
+bool Quest::find_resource_dir(
+    const QString& path, ResourceType& resource_type, int& relative_index) const {
+
+  if (data_path_prefix.isEmpty() || !path.startsWith(data_path_prefix)) {
+    return false;
+  }
+
+  const int dir_start = data_path_prefix.size();
+  int dir_end = path.indexOf('/', dir_start);
+  if (dir_end == -1) {
+    dir_end = path.size();
+  }
+  const QStringRef& dir_name = path.midRef(dir_start, dir_end - dir_start);
+
   for (auto it = resource_dirs.begin(); it != resource_dirs.end(); ++it) {
-    if (path.startsWith(get_resource_path(it.key()) + "/")) {
+    if (dir_name == it.value()) {
       resource_type = it.key();
+      relative_index = dir_end + 1;
       return true;
     }
   }
@@ -663,6 +761,29 @@ bool Quest::is_in_resource_path(const QString& path, ResourceType& resource_type
   return false;
 }
 
+/**
+ * @brief Returns the part of a path relative to a resource directory.
+ * @param[in] path The path to test.
+ * @param[in] resource_type The expected resource type.
+ * @param[out] path_from_resource The path relative to the resource directory
+ * if the path is under it.
+ * @return @c true if this path is under the directory of this resource type.
+ */
+bool Quest::get_path_from_resource_dir(
+    const QString& path, ResourceType resource_type, QStringRef& path_from_resource) const {
+
+  ResourceType found_resource_type;
+  int relative_index = 0;
+  if (!find_resource_dir(path, found_resource_type, relative_index) ||
+      found_resource_type != resource_type ||
+      relative_index > path.size()) {
+    return false;
+  }
+
+  path_from_resource = path.midRef(relative_index);
+  return true;
+}
+
 /**
  * @brief Determines if a path can be valid for a resource element like a map,
  * a tileset, etc.
@@ -679,60 +800,30 @@ bool Quest::is_in_resource_path(const QString& path, ResourceType& resource_type
 bool Quest::is_potential_resource_element(
     const QString& path, ResourceType& resource_type, QString& element_id) const {
 
-  if (!is_in_resource_path(path, resource_type)) {
+  int relative_index = 0;
+  if (!find_resource_dir(path, resource_type, relative_index)) {
     // We are not in a resource directory.
     return false;
   }
 
-  if (is_resource_path(path, resource_type)) {
+  if (relative_index > path.size()) {
     // The top-level resource directory itself.
     return false;
   }
 
-  // We are under a resource directory. Check if a resource element with this id is declared.
-  QString resource_path = get_resource_path(resource_type);
-  QString path_from_resource = path.right(path.size() - resource_path.size() - 1);
-  QStringList extensions;
-
-  switch (resource_type) {
-  case ResourceType::MAP:
-  case ResourceType::TILESET:
-  case ResourceType::SPRITE:
-  case ResourceType::SHADER:
-    extensions << ".dat";
-    break;
-
-  case ResourceType::MUSIC:
-    extensions << ".ogg" << ".it" << ".spc";
-    break;
-
-  case ResourceType::SOUND:
-    extensions << ".ogg";
-    break;
-
-  case ResourceType::ITEM:
-  case ResourceType::ENEMY:
-  case ResourceType::ENTITY:
-    extensions << ".lua";
-    break;
-
-  case ResourceType::FONT:
-    extensions << ".png" << ".ttf" << ".ttc" << ".fon";
-    break;
-
-  case ResourceType::LANGUAGE:
-    // No extension.
-    break;
-  }
+  // We are under a resource directory. Determine the element id.
+  const QStringRef& path_from_resource = path.midRef(relative_index);
+  element_id.clear();
 
   if (resource_type == ResourceType::LANGUAGE) {
-    element_id = path_from_resource;
+    // No extension.
+    element_id = path_from_resource.toString();
   }
   else {
-    for (const QString& extension : extensions) {
+    for (const QString& extension : resource_extensions.value(resource_type)) {
       if (path_from_resource.endsWith(extension)) {
         // Remove the extension.
-        element_id = path_from_resource.section('.', 0, -2);
+        element_id = path_from_resource.left(path_from_resource.lastIndexOf('.')).toString();
         break;
       }
     }
@@ -790,14 +881,13 @@ bool Quest::is_resource_element(
 bool Quest::has_resource_element(
     const QString& path, ResourceType& resource_type) const {
 
-  if (!is_resource_path(path, resource_type) &&
-      !is_in_resource_path(path, resource_type)) {
+  int relative_index = 0;
+  if (!find_resource_dir(path, resource_type, relative_index)) {
     // Not in a resource directory.
     return false;
   }
 
-  QString resource_path = get_resource_path(resource_type);
-  QString prefix = path.right(path.size() - resource_path.size());
+  QString prefix = path.mid(relative_index);
   if (!prefix.isEmpty() && !prefix.endsWith('/')) {
     prefix = prefix + '/';
   }
@@ -858,8 +948,8 @@ bool Quest::is_in_resource_element(
  */
 bool Quest::is_map_script(const QString& path, QString& map_id) const {
 
-  QString maps_path = get_resource_path(ResourceType::MAP);
-  if (!path.startsWith(maps_path + "/")) {
+  QStringRef path_from_maps;
+  if (!get_path_from_resource_dir(path, ResourceType::MAP, path_from_maps)) {
     // We are not in the maps directory.
     return false;
   }
@@ -869,10 +959,8 @@ bool Quest::is_map_script(const QString& path, QString& map_id) const {
     return false;
   }
 
-  QString path_from_maps = path.right(path.size() - maps_path.size() - 1);
-
   // Remove the extension.
-  map_id = path_from_maps.section('.', 0, -2);
+  map_id = path_from_maps.left(path_from_maps.lastIndexOf('.')).toString();
   if (!database.exists(ResourceType::MAP, map_id)) {
     // Valid map id, but not declared in the resource list.
     return false;
@@ -895,20 +983,19 @@ bool Quest::is_map_script(const QString& path, QString& map_id) const {
  */
 bool Quest::is_tileset_tiles_file(const QString& path, QString& tileset_id) const {
 
-  QString tilesets_path = get_resource_path(ResourceType::TILESET);
-  if (!path.startsWith(tilesets_path + "/")) {
+  QStringRef path_from_tileset;
+  if (!get_path_from_resource_dir(path, ResourceType::TILESET, path_from_tileset)) {
     // We are not in the tileset directory.
     return false;
   }
 
-  if (!path.endsWith(".tiles.png")) {
+  const QString extension = ".tiles.png";
+  if (!path_from_tileset.endsWith(extension)) {
     return false;
   }
 
-  QString path_from_tileset = path.right(path.size() - tilesets_path.size() - 1);
-
   // Remove the extension.
-  tileset_id = path_from_tileset.section('.', 0, -3);
+  tileset_id = path_from_tileset.left(path_from_tileset.size() - extension.size()).toString();
   if (!database.exists(ResourceType::TILESET, tileset_id)) {
     // Valid tileset id, but not declared in the resource list.
     return false;
@@ -931,20 +1018,19 @@ bool Quest::is_tileset_tiles_file(const QString& path, QString& tileset_id) cons
  */
 bool Quest::is_tileset_entities_file(const QString& path, QString& tileset_id) const {
 
-  QString tilesets_path = get_resource_path(ResourceType::TILESET);
-  if (!path.startsWith(tilesets_path + "/")) {
+  QStringRef path_from_tileset;
+  if (!get_path_from_resource_dir(path, ResourceType::TILESET, path_from_tileset)) {
     // We are not in the tileset directory.
     return false;
   }
 
-  if (!path.endsWith(".entities.png")) {
+  const QString extension = ".entities.png";
+  if (!path_from_tileset.endsWith(extension)) {
     return false;
   }
 
-  QString path_from_tileset = path.right(path.size() - tilesets_path.size() - 1);
-
   // Remove the extension.
-  tileset_id = path_from_tileset.section('.', 0, -3);
+  tileset_id = path_from_tileset.left(path_from_tileset.size() - extension.size()).toString();
   if (!database.exists(ResourceType::TILESET, tileset_id)) {
     // Valid tileset id, but not declared in the resource list.
     return false;
@@ -965,22 +1051,20 @@ bool Quest::is_tileset_entities_file(const QString& path, QString& tileset_id) c
  */
 bool Quest::is_dialogs_file(const QString& path, QString& language_id) const {
 
-  QString languages_path = get_resource_path(ResourceType::LANGUAGE);
-  if (!path.startsWith(languages_path + "/")) {
+  QStringRef path_from_languages;
+  if (!get_path_from_resource_dir(path, ResourceType::LANGUAGE, path_from_languages)) {
     // We are not in the languages directory.
     return false;
   }
 
-  QString expected_path_end = "/text/dialogs.dat";
-  if (!path.endsWith(expected_path_end)) {
+  const QString expected_path_end = "/text/dialogs.dat";
+  if (!path_from_languages.endsWith(expected_path_end)) {
     // Not a dialogs file.
     return false;
   }
 
-  QString path_from_languages = path.right(path.size() - languages_path.size() - 1);
-
   // Remove "/text/dialogs.dat" to determine the language id.
-  language_id = path_from_languages.left(path_from_languages.size() - expected_path_end.size());
+  language_id = path_from_languages.left(path_from_languages.size() - expected_path_end.size()).toString();
   if (!database.exists(ResourceType::LANGUAGE, language_id)) {
     // Language id not declared in the resource list.
     return false;
@@ -1001,22 +1085,20 @@ bool Quest::is_dialogs_file(const QString& path, QString& language_id) const {
  */
 bool Quest::is_strings_file(const QString& path, QString& language_id) const {
 
-  QString languages_path = get_resource_path(ResourceType::LANGUAGE);
-  if (!path.startsWith(languages_path + "/")) {
+  QStringRef path_from_languages;
+  if (!get_path_from_resource_dir(path, ResourceType::LANGUAGE, path_from_languages)) {
     // We are not in the languages directory.
     return false;
   }
 
-  QString expected_path_end = "/text/strings.dat";
-  if (!path.endsWith(expected_path_end)) {
+  const QString expected_path_end = "/text/strings.dat";
+  if (!path_from_languages.endsWith(expected_path_end)) {
     // Not a dialogs file.
     return false;
   }
 
-  QString path_from_languages = path.right(path.size() - languages_path.size() - 1);
-
   // Remove "/text/strings.dat" to determine the language id.
-  language_id = path_from_languages.left(path_from_languages.size() - expected_path_end.size());
+  language_id = path_from_languages.left(path_from_languages.size() - expected_path_end.size()).toString();
   if (!database.exists(ResourceType::LANGUAGE, language_id)) {
     // Language id not declared in the resource list.
     return false;
@@ -1292,6 +1374,7 @@ void Quest::create_file(const QString& path) {
   if (!QFile(path).open(QIODevice::WriteOnly)) {
     throw EditorException(tr("Cannot create file '%1'").arg(path));
   }
+  file_info_cache.invalidate(path);
   emit file_created(path);
 }
 
@@ -1330,6 +1413,7 @@ void Quest::create_file_from_template(
   out << content;
   output_file.close();
 
+  file_info_cache.invalidate(output_file_path);
   emit file_created(output_file_path);
 }
 
@@ -1589,6 +1673,7 @@ void Quest::create_dir(const QString& path) {
   if (!parent_dir.mkdir(dir_name)) {
     throw EditorException(tr("Cannot create folder '%1'").arg(path));
   }
+  file_info_cache.invalidate(path);
 }
 
 /**
@@ -1626,6 +1711,7 @@ void Quest::create_dir(const QString& parent_path, const QString& dir_name) {
   if (!QDir(parent_path).mkdir(dir_name)) {
     throw EditorException(tr("Cannot create folder '%1'").arg(dir_name));
   }
+  file_info_cache.invalidate(parent_path + '/' + dir_name);
 }
 
 /**
@@ -1759,6 +1845,8 @@ void Quest::rename_file(const QString& old_path, const QString& new_path) {
   if (!QFile(old_path).rename(new_path)) {
     throw EditorException(tr("Cannot rename file '%1'").arg(old_path));
   }
+  file_info_cache.invalidate(old_path);
+  file_info_cache.invalidate(new_path);
   emit file_renamed(old_path, new_path);
 }
 
@@ -1870,6 +1958,7 @@ void Quest::delete_file(const QString& path) {
   if (!QFile(path).remove()) {
     throw EditorException(tr("Cannot delete file '%1'").arg(path));
   }
+  file_info_cache.invalidate(path);
   emit file_deleted(path);
 }
 
@@ -1904,6 +1993,7 @@ void Quest::delete_dir(const QString& path) {
   if (!parent_dir.rmdir(QDir(path).dirName())) {
     throw EditorException(tr("Cannot delete folder '%1'").arg(path));
   }
+  file_info_cache.invalidate(path);
 }
 
 /**
@@ -1932,7 +2022,10 @@ void Quest::delete_dir_recursive(const QString& path) {
 
   check_is_dir(path);
 
-  if (!QDir(path).removeRecursively()) {
+  // Even on failure, some of the content may have been removed.
+  const bool success = QDir(path).removeRecursively();
+  file_info_cache.invalidate(path);
+  if (!success) {
     throw EditorException(tr("Cannot delete folder '%1'").arg(path));
   }
 }
@@ -14,20 +14,67 @@
  * You should have received a copy of the GNU General Public License along
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
+#include "data_file_parser.h"
 #include "editor_exception.h"
 #include "quest.h"
 #include "quest_database.h"
+#include <QDebug>
 #include <QFile>
+#include <QSaveFile>
 #include <QTextStream>
 
 namespace SolarusEditor {
 
+namespace {
+
+/**
+ * @brief Delay in milliseconds before pending changes are written.
+ */
+constexpr int save_delay = 500;
+
+}
+
+/**
+ * @brief Starts a transaction on a database.
+ * @param database The database that will be modified.
+ */
+QuestDatabase::Transaction::Transaction(QuestDatabase& database) :
+  database(database) {
+
+  ++database.transaction_depth;
+}
+
+/**
+ * @brief Ends the transaction.
+ *
+ * If this was the outermost transaction and the database was saved during
+ * the transaction, the write is scheduled now.
+ */
+QuestDatabase::Transaction::~Transaction() {
+
+  --database.transaction_depth;
+  if (database.transaction_depth == 0 && database.save_pending) {
+    database.save_timer.start();
+  }
+}
+
 /**
  * @brief Creates an empty resource list for the specified quest.
  * @param quest The quest.
  */
 QuestDatabase::QuestDatabase(Quest& quest):
-  quest(quest) {
+  quest(quest),
+  element_prefixes(),
+  element_prefixes_dirty(true),
+  transaction_depth(0),
+  save_pending(false),
+  save_timer() {
+
+  save_timer.setSingleShot(true);
+  save_timer.setInterval(save_delay);
+  connect(&save_timer, SIGNAL(timeout()),
+          this, SLOT(save_timer_expired()));
+
 
   // Friendly names are set dynamically because they are translated.
   resource_type_friendly_names = {
@@ -93,23 +140,50 @@ QuestDatabase::QuestDatabase(Quest& quest):
   reload();
 }
 
+/**
+ * @brief Destroys the database, writing any pending change.
+ */
+QuestDatabase::~QuestDatabase() {
+
+  try {
+    flush();
+  }
+  catch (const EditorException& ex) {
+    qWarning() << ex.get_message();
+  }
+}
+
 /**
  * @brief Reads project_db.dat and rebuilds the model.
+ *
+ * Changes not written yet are lost.
  */
 void QuestDatabase::reload() {
 
+  save_timer.stop();
+  save_pending = false;
   database.clear();
+  element_prefixes_dirty = true;
 
   // TODO don't try this if the quest format is obsolete
   if (quest.exists()) {
-    database.import_from_file(quest.get_resource_list_path().toStdString());
+    const QString& path = quest.get_resource_list_path();
+    if (!DataFileParser::import_quest_database(path, database)) {
+      database.import_from_file(path.toStdString());
+    }
     // TODO throw an exception in case of error
   }
 }
 
 /**
- * @brief Saves the resource list to the project_db.dat file of the quest.
- * @throws EditorException If the save operation failed.
+ * @brief Schedules a save of the resource list to the project_db.dat file of
+ * the quest.
+ *
+ * The file is written after a short delay, or after the current transaction
+ * if any, so that consecutive changes are written only once.
+ * Call flush() to write it immediately.
+ *
+ * @throws EditorException If there is no quest.
  */
 void QuestDatabase::save() const {
 
@@ -117,12 +191,78 @@ void QuestDatabase::save() const {
     throw EditorException(tr("No quest"));
   }
 
-  QString file_name = quest.get_resource_list_path();
-  if (!database.export_to_file(file_name.toStdString())) {
+  save_pending = true;
+  if (transaction_depth == 0) {
+    save_timer.start();
+  }
+}
+
+/**
+ * @brief Writes pending changes to the project_db.dat file now if any.
+ * @throws EditorException If the write operation failed.
+ * Changes are then still pending.
+ */
+void QuestDatabase::flush() const {
+
+  save_timer.stop();
+  if (!save_pending) {
+    return;
+  }
+
+  write();
+  save_pending = false;
+}
+
+/**
+ * @brief Returns whether some changes are not written to project_db.dat yet.
+ * @return @c true if a save is pending.
+ */
+bool QuestDatabase::has_pending_save() const {
+  return save_pending;
+}
+
+/**
+ * @brief Writes the resource list to the project_db.dat file of the quest.
+ *
+ * The file is replaced atomically: if writing fails,
+ * the previous file is left intact.
+ *
+ * @throws EditorException If the write operation failed.
+ */
+void QuestDatabase::write() const {
+
+  if (!quest.is_valid()) {
+    throw EditorException(tr("No quest"));
+  }
+
+  const QString& file_name = quest.get_resource_list_path();
+  std::string buffer;
+  if (!database.export_to_buffer(buffer)) {
+    throw EditorException(tr("Cannot write file '%1'").arg(file_name));
+  }
+
+  QSaveFile file(file_name);
+  if (!file.open(QIODevice::WriteOnly) ||
+      file.write(buffer.data(), static_cast<qint64>(buffer.size())) !=
+          static_cast<qint64>(buffer.size()) ||
+      !file.commit()) {
     throw EditorException(tr("Cannot write file '%1'").arg(file_name));
   }
 }
 
+/**
+ * @brief Slot called when the delay before writing pending changes expires.
+ */
+void QuestDatabase::save_timer_expired() {
+
+  try {
+    flush();
+  }
+  catch (const EditorException& ex) {
+    ex.show_dialog();
+  }
+}
+
 /**
  * @brief Returns whether a resource element exists.
  * @param type A type of resource.
@@ -136,12 +276,27 @@ bool QuestDatabase::exists(ResourceType type, const QString& id) const {
 
 /**
  * @brief Returns whether a resource element exists with the specified prefix.
+ *
+ * Directory prefixes (empty or ending with a slash) are answered with a
+ * single lookup. Other prefixes need to check every element.
+ *
  * @param type A type of resource.
  * @param prefix The prefix of ids to look for.
  * @return @c true if at least such an element exists in the resource.
  */
 bool QuestDatabase::exists_with_prefix(ResourceType type, const QString& prefix) const {
 
+  if (prefix.isEmpty()) {
+    return !database.get_resource_elements(type).empty();
+  }
+
+  if (prefix.endsWith('/')) {
+    if (element_prefixes_dirty) {
+      build_element_prefixes();
+    }
+    return element_prefixes.value(type).contains(prefix);
+  }
+
   for (const auto& kvp : database.get_resource_elements(type)) {
     const QString& id = QString::fromStdString(kvp.first);
     if (id.startsWith(prefix)) {
@@ -152,6 +307,29 @@ bool QuestDatabase::exists_with_prefix(ResourceType type, const QString& prefix)
   return false;
 }
 
+/**
+ * @brief Builds the directory prefixes of all element ids.
+ *
+ * For example, the map "dungeons/1/entrance" produces the prefixes
+ * "dungeons/" and "dungeons/1/".
+ */
+void QuestDatabase::build_element_prefixes() const {
+
+  element_prefixes.clear();
+  for (ResourceType type : Solarus::EnumInfo<ResourceType>::enums()) {
+    QSet<QString>& prefixes = element_prefixes[type];
+    for (const auto& element : database.get_resource_elements(type)) {
+      const QString& id = QString::fromStdString(element.first);
+      int slash_index = id.indexOf('/');
+      while (slash_index != -1) {
+        prefixes.insert(id.left(slash_index + 1));
+        slash_index = id.indexOf('/', slash_index + 1);
+      }
+    }
+  }
+  element_prefixes_dirty = false;
+}
+
 /**
  * @brief Returns the ids of all elements of a resource type.
  * @param type A type of resource.
@@ -184,6 +362,7 @@ bool QuestDatabase::add(
   if (!database.add(resource_type, id.toStdString(), description.toStdString())) {
     return false;
   }
+  element_prefixes_dirty = true;
   emit element_added(resource_type, id, description);
   return true;
 }
@@ -203,6 +382,7 @@ bool QuestDatabase::remove(
   if (!database.remove(resource_type, id.toStdString())) {
     return false;
   }
+  element_prefixes_dirty = true;
 
   emit element_removed(resource_type, id);
   return true;
@@ -226,6 +406,7 @@ bool QuestDatabase::rename(
                         new_id.toStdString())) {
     return false;
   }
+  element_prefixes_dirty = true;
   emit element_renamed(resource_type, old_id, new_id);
   return true;
 }
@@ -55,6 +55,10 @@ QuestFilesModel::QuestFilesModel(Quest& quest):
           SLOT(source_model_rows_inserted(QModelIndex, int, int)));
   connect(source_model, SIGNAL(rowsAboutToBeRemoved(QModelIndex, int, int)),
           SLOT(source_model_rows_about_to_be_removed(QModelIndex, int, int)));
+
+  // Tooltips of sounds and musics show their analysis when it is ready.
+  connect(&quest.get_audio_analyzer(), SIGNAL(analysis_ready(QString)),
+          this, SLOT(audio_analysis_ready(QString)));
 }
 
 /**
@@ -659,7 +663,7 @@ QIcon QuestFilesModel::get_quest_file_icon(const QModelIndex& index) const {
   else if (quest.is_resource_element(file_path, resource_type, element_id)) {
 
     QString resource_type_name = quest.get_database().get_lua_name(resource_type);
-    if (quest.exists(quest.get_resource_element_path(resource_type, element_id))) {
+    if (quest.get_file_info_cache().exists(quest.get_resource_element_path(resource_type, element_id))) {
       // Resource declared and present on the filesystem.
       icon_file_name = "icon_resource_" + resource_type_name + ".png";
     }
@@ -680,7 +684,7 @@ QIcon QuestFilesModel::get_quest_file_icon(const QModelIndex& index) const {
   }
 
   // Directory icon.
-  else if (quest.is_dir(file_path)) {
+  else if (quest.get_file_info_cache().is_dir(file_path)) {
 
     if (quest.is_resource_path(file_path, resource_type)) {
       QString resource_type_name = quest.get_database().get_lua_name(resource_type);
@@ -754,8 +758,15 @@ QString QuestFilesModel::get_quest_file_tooltip(const QModelIndex& index) const
     QString file_name = QFileInfo(path).fileName();
     if (quest.get_database().exists(resource_type, element_id)) {
       // Declared in the resource list.
-      if (quest.exists(quest.get_resource_element_path(resource_type, element_id))) {
+      if (quest.get_file_info_cache().exists(quest.get_resource_element_path(resource_type, element_id))) {
         // Declared in the resource list and existing on the filesystem.
+        if (resource_type == ResourceType::SOUND || resource_type == ResourceType::MUSIC) {
+          // Also show the properties of audio files once they are known.
+          AudioAnalyzer::Analysis analysis;
+          if (quest.get_audio_analyzer().get_analysis(path, analysis)) {
+            return file_name + '\n' + AudioAnalyzer::get_summary(resource_type, analysis);
+          }
+        }
         return file_name;
       }
       else {
@@ -1272,6 +1283,20 @@ void QuestFilesModel::source_model_rows_about_to_be_removed(const QModelIndex& s
   }
 }
 
+/**
+ * @brief Slot called when the analysis of an audio file becomes available.
+ * @param path Path of the audio file.
+ */
+void QuestFilesModel::audio_analysis_ready(const QString& path) {
+
+  const QModelIndex& index = get_file_index(path);
+  if (!index.isValid()) {
+    return;
+  }
+
+  emit dataChanged(index, index, { Qt::ToolTipRole });
+}
+
 /**
  * @brief If the specified path does not exist as an extra path yet, inserts it in the model.
  * @param parent Parent directory where to insert the path.
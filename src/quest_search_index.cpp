@@ -0,0 +1,545 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "quest.h"
+#include "quest_search_index.h"
+#include <QDirIterator>
+#include <QFile>
+#include <QTextStream>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace SolarusEditor {
+
+namespace {
+
+/**
+ * @brief Packs three characters into a trigram key.
+ * @param text A case-folded text.
+ * @param index Index of the first character of the trigram.
+ * @return The trigram key.
+ */
+quint64 make_trigram(const QString& text, int index) {
+
+  return (static_cast<quint64>(text.at(index).unicode()) << 32) |
+      (static_cast<quint64>(text.at(index + 1).unicode()) << 16) |
+      static_cast<quint64>(text.at(index + 2).unicode());
+}
+
+}
+
+/**
+ * @brief Creates a search index for a quest.
+ *
+ * The index is built in background each time the quest is opened.
+ *
+ * @param quest The quest to index.
+ */
+QuestSearchIndex::QuestSearchIndex(Quest& quest) :
+  QObject(),
+  quest(quest),
+  next_file_id(0) {
+
+  connect(&job, SIGNAL(resultReadyAt(int)),
+          this, SLOT(file_loaded(int)));
+  connect(&job, SIGNAL(finished()),
+          this, SLOT(job_finished()));
+
+  connect(&quest, SIGNAL(root_path_changed(QString)),
+          this, SLOT(root_path_changed()));
+  connect(&quest, SIGNAL(file_created(QString)),
+          this, SLOT(file_created(QString)));
+  connect(&quest, SIGNAL(file_renamed(QString, QString)),
+          this, SLOT(file_renamed(QString, QString)));
+  connect(&quest, SIGNAL(file_deleted(QString)),
+          this, SLOT(file_deleted(QString)));
+
+  root_path_changed();
+}
+
+/**
+ * @brief Destructor.
+ *
+ * Waits for worker threads to finish.
+ */
+QuestSearchIndex::~QuestSearchIndex() {
+
+  cancel_job();
+}
+
+/**
+ * @brief Returns whether a file of the quest is part of the index.
+ * @param path Path of a file.
+ * @return @c true if this is a Lua script, a dialogs file or a strings file.
+ */
+bool QuestSearchIndex::is_indexable(const QString& path) const {
+
+  QString language_id;
+  return quest.is_script(path) ||
+      quest.is_dialogs_file(path, language_id) ||
+      quest.is_strings_file(path, language_id);
+}
+
+/**
+ * @brief Returns whether files are currently being indexed.
+ * @return @c true if the index is not up-to-date yet.
+ */
+bool QuestSearchIndex::is_building() const {
+
+  return job.isRunning() || !pending_paths.isEmpty();
+}
+
+/**
+ * @brief Returns the number of files currently indexed.
+ * @return The number of files.
+ */
+int QuestSearchIndex::get_num_files() const {
+
+  return files.size();
+}
+
+/**
+ * @brief Reads a file and computes its trigrams.
+ *
+ * This function is called from worker threads.
+ *
+ * @param request The file to read, with its path and generation.
+ * @return The file loaded.
+ */
+QuestSearchIndex::IndexedFile QuestSearchIndex::load_file(const IndexedFile& request) {
+
+  IndexedFile file;
+  file.path = request.path;
+  file.generation = request.generation;
+  file.valid = false;
+
+  QFile input(file.path);
+  if (!input.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return file;
+  }
+
+  QTextStream in(&input);
+  in.setCodec("UTF-8");
+  file.text = in.readAll();
+  file.valid = true;
+
+  file.line_starts.append(0);
+  for (int i = 0; i < file.text.size(); ++i) {
+    if (file.text.at(i) == '\n') {
+      file.line_starts.append(i + 1);
+    }
+  }
+
+  file.trigrams = get_trigrams(file.text.toCaseFolded());
+  return file;
+}
+
+/**
+ * @brief Returns the distinct trigrams of a text.
+ *
+ * Trigrams containing a line break are ignored since a search
+ * is always on a single line.
+ *
+ * @param folded_text A case-folded text.
+ * @return The sorted distinct trigrams.
+ */
+QVector<quint64> QuestSearchIndex::get_trigrams(const QString& folded_text) {
+
+  QVector<quint64> trigrams;
+  const int size = folded_text.size();
+  trigrams.reserve(qMax(0, size - 2));
+
+  int line_break_index = -1;  // Index of the last line break seen.
+  for (int i = 0; i < size; ++i) {
+    if (folded_text.at(i) == '\n') {
+      line_break_index = i;
+    }
+    const int start = i - 2;
+    if (start > line_break_index) {
+      trigrams.append(make_trigram(folded_text, start));
+    }
+  }
+
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+  trigrams.squeeze();
+  return trigrams;
+}
+
+/**
+ * @brief Stops loading files in worker threads.
+ */
+void QuestSearchIndex::cancel_job() {
+
+  job.cancel();
+  job.waitForFinished();
+}
+
+/**
+ * @brief Slot called when the quest is opened or closed.
+ *
+ * Clears the index and rebuilds it in background.
+ */
+void QuestSearchIndex::root_path_changed() {
+
+  cancel_job();
+  pending_paths.clear();
+  files.clear();
+  file_ids.clear();
+  postings.clear();
+
+  if (quest.exists()) {
+    schedule_dir(quest.get_data_path());
+  }
+  emit index_changed();
+}
+
+/**
+ * @brief Slot called when a file or directory was created in the quest.
+ * @param path Path of the new file or directory.
+ */
+void QuestSearchIndex::file_created(const QString& path) {
+
+  if (quest.is_dir(path)) {
+    schedule_dir(path);
+  }
+  else {
+    schedule_file(path);
+  }
+}
+
+/**
+ * @brief Slot called when a file or directory of the quest was renamed.
+ *
+ * Indexed files are kept and simply renamed in the index.
+ *
+ * @param old_path Old path of the file or directory.
+ * @param new_path New path of the file or directory.
+ */
+void QuestSearchIndex::file_renamed(const QString& old_path, const QString& new_path) {
+
+  bump_generation(old_path);
+  bump_generation(new_path);
+
+  if (file_ids.contains(old_path)) {
+    rename_indexed_file(old_path, new_path);
+  }
+  else if (quest.is_dir(new_path)) {
+    const QString old_prefix = old_path + '/';
+    for (const QString& path : file_ids.keys()) {
+      if (path.startsWith(old_prefix)) {
+        rename_indexed_file(path, new_path + path.mid(old_path.size()));
+      }
+    }
+    // Some files may have become indexable in their new location.
+    schedule_dir(new_path);
+  }
+  else {
+    schedule_file(new_path);
+  }
+  emit index_changed();
+}
+
+/**
+ * @brief Slot called when a file or directory of the quest was deleted.
+ * @param path Path of the deleted file or directory.
+ */
+void QuestSearchIndex::file_deleted(const QString& path) {
+
+  pending_paths.remove(path);
+  bump_generation(path);
+  remove_file(path);
+
+  const QString prefix = path + '/';
+  for (const QString& indexed_path : file_ids.keys()) {
+    if (indexed_path.startsWith(prefix)) {
+      remove_file(indexed_path);
+    }
+  }
+  emit index_changed();
+}
+
+/**
+ * @brief Slot called when a file of the quest was saved.
+ *
+ * Reindexes the file in background.
+ *
+ * @param path Path of the saved file.
+ */
+void QuestSearchIndex::file_saved(const QString& path) {
+
+  bump_generation(path);
+  schedule_file(path);
+}
+
+/**
+ * @brief Adds a file to the queue of files to load if it should be indexed.
+ * @param path Path of a file.
+ */
+void QuestSearchIndex::schedule_file(const QString& path) {
+
+  if (!is_indexable(path)) {
+    return;
+  }
+
+  pending_paths.insert(path);
+  start_next_job();
+}
+
+/**
+ * @brief Adds all indexable files of a directory to the queue of files to load.
+ * @param path Path of a directory.
+ */
+void QuestSearchIndex::schedule_dir(const QString& path) {
+
+  QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    const QString file_path = it.next();
+    if (is_indexable(file_path)) {
+      pending_paths.insert(file_path);
+    }
+  }
+  start_next_job();
+}
+
+/**
+ * @brief Starts loading pending files in worker threads.
+ *
+ * Does nothing if files are already being loaded:
+ * pending files will be loaded when the current job is finished.
+ */
+void QuestSearchIndex::start_next_job() {
+
+  if (job.isRunning() || pending_paths.isEmpty()) {
+    return;
+  }
+
+  QList<IndexedFile> requests;
+  for (const QString& path : pending_paths) {
+    IndexedFile request;
+    request.path = path;
+    request.generation = generations.value(path);
+    request.valid = false;
+    // Make sure that a later change of a parent directory bumps it.
+    generations.insert(path, request.generation);
+    requests << request;
+  }
+  pending_paths.clear();
+  job.setFuture(QtConcurrent::mapped(requests, &QuestSearchIndex::load_file));
+}
+
+/**
+ * @brief Slot called when a worker thread has finished loading a file.
+ * @param index Index of the file in the current job.
+ */
+void QuestSearchIndex::file_loaded(int index) {
+
+  const IndexedFile& file = job.resultAt(index);
+  if (!quest.is_in_root_path(file.path)) {
+    // Obsolete result from a previous quest.
+    return;
+  }
+
+  if (generations.value(file.path) != file.generation) {
+    // The file was deleted, renamed or saved again while being read.
+    return;
+  }
+
+  remove_file(file.path);
+  if (file.valid) {
+    add_file(file);
+  }
+}
+
+/**
+ * @brief Slot called when all files of the current job are loaded.
+ */
+void QuestSearchIndex::job_finished() {
+
+  emit index_changed();
+  start_next_job();
+}
+
+/**
+ * @brief Adds a loaded file to the index.
+ * @param file The file to add. It must not be indexed yet.
+ */
+void QuestSearchIndex::add_file(const IndexedFile& file) {
+
+  const int id = next_file_id++;
+  files.insert(id, file);
+  file_ids.insert(file.path, id);
+
+  for (quint64 trigram : file.trigrams) {
+    postings[trigram].insert(id);
+  }
+}
+
+/**
+ * @brief Removes a file from the index if it is there.
+ * @param path Path of the file to remove.
+ */
+void QuestSearchIndex::remove_file(const QString& path) {
+
+  const auto it = file_ids.find(path);
+  if (it == file_ids.end()) {
+    return;
+  }
+
+  const int id = it.value();
+  file_ids.erase(it);
+
+  const auto file_it = files.find(id);
+  for (quint64 trigram : file_it.value().trigrams) {
+    auto posting_it = postings.find(trigram);
+    if (posting_it == postings.end()) {
+      continue;
+    }
+    posting_it.value().remove(id);
+    if (posting_it.value().isEmpty()) {
+      postings.erase(posting_it);
+    }
+  }
+  files.erase(file_it);
+}
+
+/**
+ * @brief Invalidates the files of a path being loaded.
+ *
+ * Files loaded from this path or under it with a previous generation
+ * are then ignored.
+ *
+ * @param path Path of a file or directory.
+ */
+void QuestSearchIndex::bump_generation(const QString& path) {
+
+  ++generations[path];
+
+  const QString prefix = path + '/';
+  for (auto it = generations.begin(); it != generations.end(); ++it) {
+    if (it.key().startsWith(prefix)) {
+      ++it.value();
+    }
+  }
+}
+
+/**
+ * @brief Changes the path of an indexed file without reloading it.
+ *
+ * The file is removed from the index if it is no longer indexable.
+ *
+ * @param old_path Old path of an indexed file.
+ * @param new_path New path of the file.
+ */
+void QuestSearchIndex::rename_indexed_file(
+    const QString& old_path, const QString& new_path) {
+
+  if (!is_indexable(new_path)) {
+    remove_file(old_path);
+    return;
+  }
+
+  const int id = file_ids.take(old_path);
+  files[id].path = new_path;
+  file_ids.insert(new_path, id);
+}
+
+/**
+ * @brief Searches a text in all indexed files.
+ *
+ * The search is case-insensitive.
+ * Only files containing all trigrams of the text are scanned.
+ *
+ * @param text The text to search. It cannot contain line breaks.
+ * @param max_results Maximum number of matches to return.
+ * @return The matches sorted by file path and position.
+ */
+QList<QuestSearchIndex::Match> QuestSearchIndex::find(
+    const QString& text, int max_results) const {
+
+  QList<Match> matches;
+  if (text.isEmpty()) {
+    return matches;
+  }
+
+  // Determine candidate files from the trigrams of the text.
+  QList<int> candidate_ids;
+  const QVector<quint64> trigrams = get_trigrams(text.toCaseFolded());
+  if (trigrams.isEmpty()) {
+    // Too short to use the index: all files are candidates.
+    candidate_ids = files.keys();
+  }
+  else {
+    QList<const QSet<int>*> sets;
+    for (quint64 trigram : trigrams) {
+      const auto it = postings.find(trigram);
+      if (it == postings.end()) {
+        return matches;
+      }
+      sets.append(&it.value());
+    }
+
+    std::sort(sets.begin(), sets.end(), [](const QSet<int>* set_1, const QSet<int>* set_2) {
+      return set_1->size() < set_2->size();
+    });
+
+    for (int id : *sets.first()) {
+      bool in_all = true;
+      for (int i = 1; i < sets.size() && in_all; ++i) {
+        in_all = sets[i]->contains(id);
+      }
+      if (in_all) {
+        candidate_ids.append(id);
+      }
+    }
+  }
+
+  std::sort(candidate_ids.begin(), candidate_ids.end(), [this](int id_1, int id_2) {
+    return files.constFind(id_1)->path < files.constFind(id_2)->path;
+  });
+
+  // Find the exact occurrences in candidate files.
+  for (int id : candidate_ids) {
+    const IndexedFile& file = *files.constFind(id);
+    int index = file.text.indexOf(text, 0, Qt::CaseInsensitive);
+    while (index != -1) {
+      if (matches.size() >= max_results) {
+        return matches;
+      }
+
+      const auto line_it = std::upper_bound(
+            file.line_starts.begin(), file.line_starts.end(), index) - 1;
+      const int line_start = *line_it;
+      int line_end = file.text.indexOf('\n', line_start);
+      if (line_end == -1) {
+        line_end = file.text.size();
+      }
+
+      Match match;
+      match.path = file.path;
+      match.line = (line_it - file.line_starts.begin()) + 1;
+      match.column = index - line_start;
+      match.line_text = file.text.mid(line_start, line_end - line_start);
+      matches.append(match);
+
+      index = file.text.indexOf(text, index + text.size(), Qt::CaseInsensitive);
+    }
+  }
+
+  return matches;
+}
+
+}
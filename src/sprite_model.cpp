@@ -15,6 +15,7 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "editor_exception.h"
+#include "natural_comparator.h"
 #include "quest.h"
 #include "sprite_model.h"
 #include "size.h"
@@ -22,6 +23,10 @@
 #include "rectangle.h"
 #include <QIcon>
 #include <QFont>
+#include <QSet>
+#include <QVector>
+#include <algorithm>
+#include <vector>
 
 namespace SolarusEditor {
 
@@ -55,8 +60,11 @@ SpriteModel::SpriteModel(
   build_index_map();
 
   // Create animations and directions models.
-  for (const auto& kvp : names_to_indexes) {
-    const QString& animation_name = kvp.first;
+  QVector<QString> animation_names(names_to_indexes.size());
+  for (auto it = names_to_indexes.constBegin(); it != names_to_indexes.constEnd(); ++it) {
+    animation_names[it.value()] = it.key();
+  }
+  for (const QString& animation_name : animation_names) {
     AnimationModel animation(animation_name);
     int num_dir = get_animation(animation_name).get_num_directions();
     for (int nb = 0; nb < num_dir; nb++) {
@@ -368,11 +376,7 @@ QVariant SpriteModel::data(const QModelIndex& model_index, int role) const {
  */
 int SpriteModel::get_animation_nb(const Index& index) const {
 
-  auto it = names_to_indexes.find(index.animation_name);
-  if (it == names_to_indexes.end()) {
-    return -1;
-  }
-  return it->second;
+  return names_to_indexes.value(index.animation_name, -1);
 }
 
 /**
@@ -383,7 +387,7 @@ int SpriteModel::get_animation_nb(const Index& index) const {
  */
 SpriteModel::Index SpriteModel::get_animation_index(int animation_nb) const {
 
-  if (animation_nb < animations.size()) {
+  if (animation_nb < 0 || animation_nb >= animations.size()) {
     return Index();
   }
 
@@ -1366,17 +1370,41 @@ QImage SpriteModel::get_animation_image(const Index& index) const {
 
   if (animation.image.isNull()) {
     // Lazily load image.
+    // Animations using the same file share the same decoded image.
+    ImageStore& image_store = quest.get_image_store();
     if (is_animation_image_is_tileset(index)) {
-      animation.image = QImage(quest.get_tileset_entities_image_path(tileset_id));
+      animation.image = image_store.get_image(quest.get_tileset_entities_image_path(tileset_id));
     } else {
       QString src_image = get_animation_source_image(index);
-      animation.image = QImage(quest.get_sprite_image_path(src_image));
+      animation.image = image_store.get_image(quest.get_sprite_image_path(src_image));
     }
   }
 
   return animation.image;
 }
 
+/**
+ * @brief Returns the distinct images used by all animations.
+ *
+ * Animations using the same file share the same image,
+ * which is only returned once.
+ *
+ * @return The images that could be loaded.
+ */
+QList<QImage> SpriteModel::get_images() const {
+
+  QList<QImage> images;
+  QSet<qint64> keys;
+  for (const AnimationModel& animation : animations) {
+    const QImage& image = get_animation_image(*animation.index);
+    if (!image.isNull() && !keys.contains(image.cacheKey())) {
+      keys.insert(image.cacheKey());
+      images << image;
+    }
+  }
+  return images;
+}
+
 /**
  * @brief Returns alls images representing frames of a specified direction.
  * @param index A direction index.
@@ -1615,17 +1643,19 @@ void SpriteModel::build_index_map() {
 
   const std::map<std::string, SpriteAnimationData>& animation_map =
       sprite.get_animations();
-  // First, put the string keys to have natural sort.
+  // First, sort the names in natural order.
+  std::vector<NaturalKey> sorted_names;
+  sorted_names.reserve(animation_map.size());
   for (const auto& kvp : animation_map) {
-    QString animation_name = QString::fromStdString(kvp.first);
-    names_to_indexes.insert(std::make_pair(animation_name, 0));
+    sorted_names.emplace_back(QString::fromStdString(kvp.first));
   }
+  std::sort(sorted_names.begin(), sorted_names.end());
 
-  // Then, we can put the integer value.
+  // Then, lookups only need a hash of the indexes.
+  names_to_indexes.reserve(static_cast<int>(sorted_names.size()));
   int index = 0;
-  for (const auto& kvp : names_to_indexes) {
-    QString animation_name = kvp.first;
-    names_to_indexes[animation_name] = index;
+  for (const NaturalKey& animation_name : sorted_names) {
+    names_to_indexes.insert(animation_name.get_string(), index);
     ++index;
   }
 }
@@ -0,0 +1,417 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sprite_packer.h"
+#include <QMap>
+#include <QPainter>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SolarusEditor {
+
+namespace SpritePacker {
+
+namespace {
+
+/**
+ * @brief Width above which no atlas width is tried,
+ * unless a single block of frames is wider.
+ */
+constexpr int max_atlas_width = 4096;
+
+/**
+ * @brief Maximum number of atlas widths tried.
+ */
+constexpr int max_num_widths = 64;
+
+/**
+ * @brief A group of frames of the source image packed together.
+ */
+struct Block {
+  QString src_image;             /**< Source image of the frames. */
+  QList<QRect> frames;           /**< Frames in the source image. */
+  int num_columns;               /**< Number of columns of the frames. */
+  QRect trimmed_rect;            /**< Visible part of each frame,
+                                  * relative to the frame. */
+};
+
+/**
+ * @brief Returns the texture memory needed by an image in the engine.
+ *
+ * Images are converted to 32-bit textures at runtime,
+ * whatever their format in the PNG file.
+ *
+ * @param size Size of the image.
+ * @return The size in bytes.
+ */
+qint64 get_texture_size(const QSize& size) {
+  return static_cast<qint64>(size.width()) * size.height() * 4;
+}
+
+/**
+ * @brief Returns the bounding box of the non-transparent pixels in a
+ * rectangle of an image.
+ * @param image An image in ARGB32 format.
+ * @param rect The rectangle to analyze, possibly outside the image.
+ * @return The bounding box, or a null rectangle if all pixels
+ * are transparent.
+ */
+QRect get_visible_rect(const QImage& image, const QRect& rect) {
+
+  const QRect clipped_rect = rect.intersected(image.rect());
+  int min_x = std::numeric_limits<int>::max();
+  int min_y = std::numeric_limits<int>::max();
+  int max_x = -1;
+  int max_y = -1;
+  for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y) {
+    const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+    for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x) {
+      if (qAlpha(line[x]) != 0) {
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = y;
+      }
+    }
+  }
+
+  if (max_x == -1) {
+    return QRect();
+  }
+  return QRect(QPoint(min_x, min_y), QPoint(max_x, max_y));
+}
+
+/**
+ * @brief Returns the size of all frames of a block once trimmed.
+ * @param block A block of frames.
+ * @return The size of the block in the atlas.
+ */
+QSize get_block_size(const Block& block) {
+
+  const int num_frames = block.frames.size();
+  const int num_columns = std::min(block.num_columns, num_frames);
+  const int num_rows = (num_frames + block.num_columns - 1) / block.num_columns;
+  return QSize(num_columns * block.trimmed_rect.width(),
+               num_rows * block.trimmed_rect.height());
+}
+
+/**
+ * @brief Removes a newly placed rectangle from the free rectangles.
+ *
+ * Each free rectangle intersecting the placed one is replaced by the
+ * maximal free rectangles around it, and free rectangles contained in
+ * another one are removed.
+ *
+ * @param free_rects The free rectangles to update.
+ * @param placed_rect The placed rectangle.
+ */
+void split_free_rects(QList<QRect>& free_rects, const QRect& placed_rect) {
+
+  QList<QRect> new_rects;
+  for (auto it = free_rects.begin(); it != free_rects.end();) {
+
+    const QRect free_rect = *it;
+    if (!free_rect.intersects(placed_rect)) {
+      ++it;
+      continue;
+    }
+    it = free_rects.erase(it);
+
+    if (placed_rect.left() > free_rect.left()) {
+      new_rects << QRect(free_rect.left(), free_rect.top(),
+                         placed_rect.left() - free_rect.left(), free_rect.height());
+    }
+    if (placed_rect.right() < free_rect.right()) {
+      new_rects << QRect(placed_rect.right() + 1, free_rect.top(),
+                         free_rect.right() - placed_rect.right(), free_rect.height());
+    }
+    if (placed_rect.top() > free_rect.top()) {
+      new_rects << QRect(free_rect.left(), free_rect.top(),
+                         free_rect.width(), placed_rect.top() - free_rect.top());
+    }
+    if (placed_rect.bottom() < free_rect.bottom()) {
+      new_rects << QRect(free_rect.left(), placed_rect.bottom() + 1,
+                         free_rect.width(), free_rect.bottom() - placed_rect.bottom());
+    }
+  }
+  free_rects << new_rects;
+
+  for (int i = 0; i < free_rects.size(); ++i) {
+    for (int j = i + 1; j < free_rects.size(); ++j) {
+      if (free_rects[j].contains(free_rects[i])) {
+        free_rects.removeAt(i);
+        --i;
+        break;
+      }
+      if (free_rects[i].contains(free_rects[j])) {
+        free_rects.removeAt(j);
+        --j;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Packs rectangles in a bin of fixed width and unlimited height.
+ *
+ * Rectangles are placed with the MaxRects algorithm, using the
+ * bottom-left rule to keep the bin as low as possible.
+ *
+ * @param sizes Sizes of the rectangles to place.
+ * All of them must fit in the width.
+ * @param order Indexes of rectangles in the order to place them.
+ * @param bin_width Width of the bin.
+ * @param used_size Returns the size of the bounding box of placed rectangles.
+ * @return The position of each rectangle, in the order of @c sizes.
+ */
+QVector<QPoint> pack_in_width(
+    const QList<QSize>& sizes,
+    const QList<int>& order,
+    int bin_width,
+    QSize& used_size) {
+
+  QList<QRect> free_rects;
+  free_rects << QRect(0, 0, bin_width, std::numeric_limits<int>::max() / 2);
+  QVector<QPoint> positions(sizes.size());
+  used_size = QSize(0, 0);
+
+  for (int i : order) {
+    const QSize& size = sizes[i];
+    QPoint best_position;
+    int best_bottom = std::numeric_limits<int>::max();
+    for (const QRect& free_rect : free_rects) {
+      if (free_rect.width() < size.width() ||
+          free_rect.height() < size.height()) {
+        continue;
+      }
+      const int bottom = free_rect.top() + size.height();
+      if (bottom < best_bottom ||
+          (bottom == best_bottom && free_rect.left() < best_position.x())) {
+        best_bottom = bottom;
+        best_position = free_rect.topLeft();
+      }
+    }
+
+    const QRect placed_rect(best_position, size);
+    split_free_rects(free_rects, placed_rect);
+    positions[i] = best_position;
+    used_size = used_size.expandedTo(
+          QSize(placed_rect.right() + 1, placed_rect.bottom() + 1));
+  }
+
+  return positions;
+}
+
+}  // Anonymous namespace.
+
+/**
+ * @brief Creates an empty packing result.
+ */
+PackedSprite::PackedSprite() :
+  num_packed_rects(0),
+  memory_size_before(0),
+  memory_size_after(0) {
+}
+
+/**
+ * @brief Packs rectangles into the smallest atlas found.
+ *
+ * Several atlas widths are tried and the one giving the smallest area wins.
+ *
+ * @param sizes Sizes of the rectangles to pack. They must not be empty.
+ * @param atlas_size Returns the size of the atlas.
+ * @return The position of each rectangle in the atlas.
+ */
+QList<QPoint> pack_rectangles(const QList<QSize>& sizes, QSize& atlas_size) {
+
+  atlas_size = QSize();
+  if (sizes.isEmpty()) {
+    return QList<QPoint>();
+  }
+
+  // Place big rectangles first.
+  QList<int> order;
+  int min_width = 0;
+  int total_width = 0;
+  qint64 total_area = 0;
+  for (int i = 0; i < sizes.size(); ++i) {
+    order << i;
+    min_width = std::max(min_width, sizes[i].width());
+    total_width += sizes[i].width();
+    total_area += static_cast<qint64>(sizes[i].width()) * sizes[i].height();
+  }
+  std::stable_sort(order.begin(), order.end(), [&sizes](int i, int j) {
+    if (sizes[i].height() != sizes[j].height()) {
+      return sizes[i].height() > sizes[j].height();
+    }
+    return sizes[i].width() > sizes[j].width();
+  });
+
+  const int square_width = static_cast<int>(std::ceil(std::sqrt(total_area)));
+  const int max_width = std::max(
+        min_width,
+        std::min({ total_width, 2 * square_width + min_width, max_atlas_width }));
+  const int step = std::max(1, (max_width - min_width) / max_num_widths);
+
+  QVector<QPoint> best_positions;
+  qint64 best_area = std::numeric_limits<qint64>::max();
+  for (int width = min_width; width <= max_width; width += step) {
+    QSize used_size;
+    const QVector<QPoint>& positions = pack_in_width(sizes, order, width, used_size);
+    const qint64 area = static_cast<qint64>(used_size.width()) * used_size.height();
+    if (area < best_area ||
+        (area == best_area &&
+         std::max(used_size.width(), used_size.height()) <
+         std::max(atlas_size.width(), atlas_size.height()))) {
+      best_area = area;
+      best_positions = positions;
+      atlas_size = used_size;
+    }
+  }
+
+  return best_positions.toList();
+}
+
+/**
+ * @brief Packs all frames of a sprite into a single image.
+ *
+ * The sprite is not modified: the caller should save the atlas and
+ * apply the new geometry of directions.
+ * Animations whose image is the tileset or is missing are not packed.
+ *
+ * @param model The sprite to pack.
+ * @return The atlas and the new geometry of packed directions.
+ */
+PackedSprite pack_sprite(const SpriteModel& model) {
+
+  PackedSprite packed_sprite;
+  QMap<QString, QImage> images;
+  QList<Block> blocks;
+  QMap<QString, int> block_indexes;
+  QList<int> direction_blocks;
+  QList<QPoint> direction_origins;
+
+  const int num_animations = model.rowCount();
+  for (int animation_nb = 0; animation_nb < num_animations; ++animation_nb) {
+
+    const SpriteModel::Index& animation_index = model.get_animation_index(animation_nb);
+    if (model.is_animation_image_is_tileset(animation_index)) {
+      continue;
+    }
+    const QString& src_image = model.get_animation_source_image(animation_index);
+    if (!images.contains(src_image)) {
+      const QImage& image = model.get_animation_image(animation_index);
+      if (image.isNull()) {
+        continue;
+      }
+      images.insert(src_image, image.convertToFormat(QImage::Format_ARGB32));
+      packed_sprite.memory_size_before += get_texture_size(image.size());
+    }
+    const QImage& image = images.value(src_image);
+    packed_sprite.animations << animation_index.animation_name;
+
+    const int num_directions = model.get_animation_num_directions(animation_index);
+    for (int direction_nb = 0; direction_nb < num_directions; ++direction_nb) {
+
+      const SpriteModel::Index index(animation_index.animation_name, direction_nb);
+      const QList<QRect>& frames = model.get_direction_frames(index);
+      const int num_columns = std::max(1, model.get_direction_num_columns(index));
+      const QRect& first_frame = frames.isEmpty() ? QRect() : frames.first();
+      const QString key = QString("%1|%2,%3,%4x%5|%6|%7").
+          arg(src_image).
+          arg(first_frame.x()).arg(first_frame.y()).
+          arg(first_frame.width()).arg(first_frame.height()).
+          arg(frames.size()).arg(num_columns);
+
+      if (!block_indexes.contains(key)) {
+        // Trim the transparent borders common to all frames.
+        QRect trimmed_rect;
+        for (const QRect& frame : frames) {
+          const QRect& visible_rect = get_visible_rect(image, frame);
+          if (!visible_rect.isNull()) {
+            trimmed_rect |= visible_rect.translated(-frame.topLeft());
+          }
+        }
+        if (trimmed_rect.isNull()) {
+          trimmed_rect = QRect(0, 0, 1, 1);
+        }
+
+        Block block;
+        block.src_image = src_image;
+        block.frames = frames;
+        block.num_columns = num_columns;
+        block.trimmed_rect = trimmed_rect;
+        block_indexes.insert(key, blocks.size());
+        blocks << block;
+      }
+      direction_blocks << block_indexes.value(key);
+
+      PackedDirection direction;
+      direction.index = index;
+      packed_sprite.directions << direction;
+      direction_origins << model.get_direction_origin(index);
+    }
+  }
+
+  if (blocks.isEmpty()) {
+    return packed_sprite;
+  }
+
+  QList<QSize> sizes;
+  for (const Block& block : blocks) {
+    sizes << get_block_size(block);
+  }
+  QSize atlas_size;
+  const QList<QPoint>& positions = pack_rectangles(sizes, atlas_size);
+
+  // Copy the trimmed frames into the atlas.
+  packed_sprite.atlas = QImage(atlas_size, QImage::Format_ARGB32);
+  packed_sprite.atlas.fill(Qt::transparent);
+  QPainter painter(&packed_sprite.atlas);
+  painter.setCompositionMode(QPainter::CompositionMode_Source);
+  for (int i = 0; i < blocks.size(); ++i) {
+    const Block& block = blocks[i];
+    const QImage& image = images.value(block.src_image);
+    const QSize& frame_size = block.trimmed_rect.size();
+    for (int frame_nb = 0; frame_nb < block.frames.size(); ++frame_nb) {
+      const QRect src_rect(block.frames[frame_nb].topLeft() + block.trimmed_rect.topLeft(),
+                           frame_size);
+      const QPoint dst_position = positions[i] + QPoint(
+            (frame_nb % block.num_columns) * frame_size.width(),
+            (frame_nb / block.num_columns) * frame_size.height());
+      painter.drawImage(dst_position, image.copy(src_rect));
+    }
+  }
+  painter.end();
+
+  for (int i = 0; i < packed_sprite.directions.size(); ++i) {
+    const Block& block = blocks[direction_blocks[i]];
+    PackedDirection& direction = packed_sprite.directions[i];
+    direction.position = positions[direction_blocks[i]];
+    direction.size = block.trimmed_rect.size();
+    direction.origin = direction_origins[i] - block.trimmed_rect.topLeft();
+  }
+
+  packed_sprite.num_packed_rects = blocks.size();
+  packed_sprite.memory_size_after = get_texture_size(atlas_size);
+  return packed_sprite;
+}
+
+}
+
+}
@@ -14,6 +14,7 @@
  * You should have received a copy of the GNU General Public License along
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
+#include "data_file_parser.h"
 #include "editor_exception.h"
 #include "quest.h"
 #include "strings_model.h"
@@ -41,7 +42,8 @@ StringsModel::StringsModel(
 
   // Load the strings data file.
   QString path = quest.get_strings_path(language_id);
-  if (!resources.import_from_file(path.toStdString())) {
+  if (!DataFileParser::import_strings(path, resources) &&
+      !resources.import_from_file(path.toStdString())) {
     throw EditorException(tr("Cannot open strings data file '%1'").arg(path));
   }
 
@@ -772,9 +774,7 @@ void StringsModel::clear_translation() {
   }
 
   translation_id = "";
-  clear_translation_from_tree();
-  translation_resources.clear();
-  headerDataChanged(Qt::Horizontal, 2, 2);
+  set_translation_resources(Solarus::StringResources());
 }
 
 /**
@@ -782,29 +782,38 @@ void StringsModel::clear_translation() {
  */
 void StringsModel::reload_translation() {
 
-  clear_translation_from_tree();
-
   QString path = quest.get_strings_path(translation_id);
-  translation_resources.clear();
-  if (!translation_resources.import_from_file(path.toStdString())) {
+  Solarus::StringResources translation;
+  if (!DataFileParser::import_strings(path, translation) &&
+      !translation.import_from_file(path.toStdString())) {
     translation_id = "";
+    set_translation_resources(Solarus::StringResources());
     throw EditorException(tr("Cannot open strings data file '%1'").arg(path));
   }
 
-  for (const auto& kvp : translation_resources.get_strings()) {
-    QString key = QString::fromStdString(kvp.first);
-    QString parent_key;
-    int index;
-    if (string_tree.add_ref(key, parent_key, index)) {
-      beginInsertRows(key_to_index(parent_key), index, index);
-      endInsertRows();
-    } else {
-      QModelIndex model_index = key_to_index(key, 2);
-      dataChanged(model_index, model_index);
-    }
-  }
+  set_translation_resources(std::move(translation));
+}
+
+/**
+ * @brief Replaces the translated strings.
+ *
+ * The tree is rebuilt at once and views are reset only once instead of
+ * being notified of each translated string.
+ * The selected string stays selected.
+ *
+ * @param translation The new translated strings.
+ */
+void StringsModel::set_translation_resources(Solarus::StringResources translation) {
+
+  const QString& selected_key = get_selected_key();
+
+  beginResetModel();
+  translation_resources = std::move(translation);
+  build_string_tree();
+  endResetModel();
 
   headerDataChanged(Qt::Horizontal, 2, 2);
+  set_selected_key(selected_key);
 }
 
 /**
@@ -879,30 +888,9 @@ void StringsModel::build_string_tree() {
     QString key = QString::fromStdString(kvp.first);
     string_tree.add_key(key);
   }
-}
-
-/**
- * @brief Removes all translated string from the indexed string tree.
- */
-void StringsModel::clear_translation_from_tree() {
-
   for (const auto& kvp : translation_resources.get_strings()) {
     QString key = QString::fromStdString(kvp.first);
-    QString parent_key;
-    int index;
-    if (string_tree.can_remove_ref(key, parent_key, index)) {
-      if (!string_exists(key)) {
-        beginRemoveRows(key_to_index(parent_key), index, index);
-        string_tree.remove_ref(key, false);
-        endRemoveRows();
-      } else if (string_tree.remove_ref(key, true)) {
-        QModelIndex model_index = key_to_index(key, 2);
-        dataChanged(model_index, model_index);
-      }
-    } else if (string_tree.remove_ref(key, string_exists(key))) {
-      QModelIndex model_index = key_to_index(key, 2);
-      dataChanged(model_index, model_index);
-    }
+    string_tree.add_ref(key);
   }
 }
 
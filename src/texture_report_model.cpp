@@ -0,0 +1,777 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "data_file_cache.h"
+#include "file_tools.h"
+#include "quest.h"
+#include "quest_database.h"
+#include "texture_report_model.h"
+#include <solarus/core/MapData.h>
+#include <solarus/graphics/SpriteData.h>
+#include <QBrush>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QHash>
+#include <QImageReader>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QStringList>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace SolarusEditor {
+
+namespace {
+
+/**
+ * @brief Maximum number of images listed in tooltips.
+ */
+constexpr int max_tooltip_images = 10;
+
+/**
+ * @brief Files that a map or a sprite needs to be drawn in game.
+ */
+struct TextureReferences {
+  QString world;                    /**< World of a map or an empty string. */
+  QStringList tilesets;             /**< Tilesets used by a map. */
+  QStringList sprites;              /**< Sprites used by the entities of a map. */
+  QStringList images;               /**< Source images of a sprite, as written
+                                     * in the sprite ("tileset" included). */
+};
+
+/**
+ * @brief Loads the texture references of a map or sprite from the cache
+ * if they are up to date.
+ * @param[in] quest The quest.
+ * @param[in] path Path of the map or sprite data file.
+ * @param[out] references The references to fill. Unchanged in case of failure.
+ * @return @c true if the references were loaded from the cache.
+ */
+bool load_cached_references(
+    const Quest& quest, const QString& path, TextureReferences& references) {
+
+  TextureReferences result;
+  const bool success = DataFileCache::read_snapshot(
+        quest, path, "textures", [&result](QDataStream& stream) {
+    stream >> result.world >> result.tilesets >> result.sprites >> result.images;
+  });
+  if (!success) {
+    return false;
+  }
+
+  references = result;
+  return true;
+}
+
+/**
+ * @brief Writes the texture references of a map or sprite to the cache.
+ * @param quest The quest.
+ * @param path Path of the map or sprite data file, which must be up to date
+ * with the references.
+ * @param references The references.
+ */
+void save_cached_references(
+    const Quest& quest, const QString& path, const TextureReferences& references) {
+
+  DataFileCache::write_snapshot(quest, path, "textures", [&references](QDataStream& stream) {
+    stream << references.world << references.tilesets << references.sprites << references.images;
+  });
+}
+
+/**
+ * @brief Returns the sprites that an entity shows in game.
+ *
+ * Besides the sprite field that many types of entities have,
+ * some types always show the same sprite.
+ *
+ * @param entity An entity.
+ * @return Ids of its sprites.
+ */
+QStringList get_entity_sprites(const Solarus::EntityData& entity) {
+
+  QStringList sprites;
+  if (entity.is_string("sprite") && !entity.get_string("sprite").empty()) {
+    sprites << QString::fromStdString(entity.get_string("sprite"));
+  }
+
+  switch (entity.get_type()) {
+
+  case Solarus::EntityType::ENEMY:
+    if (entity.is_string("breed") && !entity.get_string("breed").empty()) {
+      sprites << QString("enemies/") + QString::fromStdString(entity.get_string("breed"));
+    }
+    break;
+
+  case Solarus::EntityType::PICKABLE:
+  case Solarus::EntityType::SHOP_TREASURE:
+    sprites << "entities/items";
+    break;
+
+  case Solarus::EntityType::CRYSTAL:
+    sprites << "entities/crystal";
+    break;
+
+  case Solarus::EntityType::CRYSTAL_BLOCK:
+    sprites << "entities/crystal_block";
+    break;
+
+  default:
+    break;
+  }
+
+  return sprites;
+}
+
+/**
+ * @brief Returns the tilesets and sprites used by a map.
+ * @param map A map.
+ * @return Its texture references.
+ */
+TextureReferences get_map_references(const Solarus::MapData& map) {
+
+  QSet<QString> tilesets;
+  QSet<QString> sprites;
+  tilesets.insert(QString::fromStdString(map.get_tileset_id()));
+
+  for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
+    for (int i = 0; i < map.get_num_entities(layer); ++i) {
+
+      const Solarus::EntityData& entity = map.get_entity(Solarus::EntityIndex(layer, i));
+      if (entity.get_type() == Solarus::EntityType::TILE ||
+          entity.get_type() == Solarus::EntityType::DYNAMIC_TILE) {
+        // Tiles may use another tileset than the one of the map.
+        if (entity.is_string("tileset") && !entity.get_string("tileset").empty()) {
+          tilesets.insert(QString::fromStdString(entity.get_string("tileset")));
+        }
+        continue;
+      }
+
+      for (const QString& sprite_id : get_entity_sprites(entity)) {
+        sprites.insert(sprite_id);
+      }
+    }
+  }
+
+  TextureReferences references;
+  references.world = map.has_world() ? QString::fromStdString(map.get_world()) : QString();
+  references.tilesets = tilesets.toList();
+  references.sprites = sprites.toList();
+  std::sort(references.tilesets.begin(), references.tilesets.end());
+  std::sort(references.sprites.begin(), references.sprites.end());
+  return references;
+}
+
+}  // Anonymous namespace.
+
+/**
+ * @brief Sprites and images resolved by worker threads.
+ *
+ * Maps often use the same sprites and images, so each one is only
+ * read once per analysis.
+ */
+class TextureReportModel::TextureStore {
+
+public:
+
+  bool get_sprite_images(const Quest& quest, const QString& sprite_id, QStringList& images);
+  qint64 get_image_size(const QString& path);
+
+private:
+
+  QMutex mutex;                             /**< Protects the tables below. */
+  QHash<QString, QStringList> sprites;      /**< Source images of each sprite found. */
+  QSet<QString> missing_sprites;            /**< Sprites that could not be loaded. */
+  QHash<QString, qint64> image_sizes;       /**< Memory size of each image, -1 if missing. */
+
+};
+
+/**
+ * @brief Returns the source images of a sprite.
+ *
+ * This function can be called from worker threads.
+ *
+ * @param[in] quest The quest.
+ * @param[in] sprite_id Id of the sprite.
+ * @param[out] images The source images as written in the sprite.
+ * @return @c false if the sprite could not be loaded.
+ */
+bool TextureReportModel::TextureStore::get_sprite_images(
+    const Quest& quest, const QString& sprite_id, QStringList& images) {
+
+  {
+    QMutexLocker locker(&mutex);
+    if (missing_sprites.contains(sprite_id)) {
+      return false;
+    }
+    auto it = sprites.constFind(sprite_id);
+    if (it != sprites.constEnd()) {
+      images = it.value();
+      return true;
+    }
+  }
+
+  // Load it without locking: other workers may load it too.
+  const QString& path = quest.get_sprite_path(sprite_id);
+  TextureReferences references;
+  bool valid = load_cached_references(quest, path, references);
+  if (!valid) {
+    Solarus::SpriteData sprite;
+    valid = QFileInfo(path).isFile() && sprite.import_from_file(path.toStdString());
+    if (valid) {
+      QSet<QString> src_images;
+      for (const auto& kvp : sprite.get_animations()) {
+        src_images.insert(QString::fromStdString(kvp.second.get_src_image()));
+      }
+      references.images = src_images.toList();
+      std::sort(references.images.begin(), references.images.end());
+      save_cached_references(quest, path, references);
+    }
+  }
+
+  QMutexLocker locker(&mutex);
+  if (!valid) {
+    missing_sprites.insert(sprite_id);
+    return false;
+  }
+  sprites.insert(sprite_id, references.images);
+  images = references.images;
+  return true;
+}
+
+/**
+ * @brief Returns the texture memory needed by an image file.
+ *
+ * Only the header of the file is read.
+ * Images are converted to 32-bit textures at runtime,
+ * whatever their format in the PNG file.
+ * This function can be called from worker threads.
+ *
+ * @param path Path of the image file.
+ * @return The size in bytes, or -1 if the image cannot be read.
+ */
+qint64 TextureReportModel::TextureStore::get_image_size(const QString& path) {
+
+  {
+    QMutexLocker locker(&mutex);
+    auto it = image_sizes.constFind(path);
+    if (it != image_sizes.constEnd()) {
+      return it.value();
+    }
+  }
+
+  const QSize& size = QImageReader(path).size();
+  const qint64 memory_size = size.isValid() ?
+        static_cast<qint64>(size.width()) * size.height() * 4 : -1;
+
+  QMutexLocker locker(&mutex);
+  image_sizes.insert(path, memory_size);
+  return memory_size;
+}
+
+/**
+ * @brief Creates a texture report model.
+ *
+ * Call reload() to fill it.
+ *
+ * @param quest The quest.
+ * @param parent The parent object or nullptr.
+ */
+TextureReportModel::TextureReportModel(Quest& quest, QObject* parent) :
+  QAbstractTableModel(parent),
+  quest(quest),
+  rows(),
+  map_rows(),
+  budget(0),
+  job() {
+
+  connect(&job, SIGNAL(resultReadyAt(int)),
+          this, SLOT(map_ready(int)));
+  connect(&job, SIGNAL(finished()),
+          this, SLOT(job_finished()));
+}
+
+/**
+ * @brief Destroys the model.
+ */
+TextureReportModel::~TextureReportModel() {
+
+  job.cancel();
+  job.waitForFinished();
+}
+
+/**
+ * @brief Lists again all maps and analyzes them in worker threads.
+ *
+ * Maps, tilesets and sprites not modified since the last analysis are not
+ * parsed again. Worlds are added when all maps are analyzed.
+ */
+void TextureReportModel::reload() {
+
+  job.cancel();
+  job.waitForFinished();
+
+  beginResetModel();
+  rows.clear();
+  map_rows.clear();
+
+  QList<MapRequest> requests;
+  std::shared_ptr<TextureStore> store = std::make_shared<TextureStore>();
+  for (const QString& map_id : quest.get_database().get_elements(ResourceType::MAP)) {
+    Row row;
+    row.is_world = false;
+    row.id = map_id;
+    row.analyzed = false;
+    row.valid = false;
+    row.memory_size = 0;
+    map_rows.insert(map_id, rows.size());
+    rows << row;
+
+    MapRequest request;
+    request.quest = &quest;
+    request.map_id = map_id;
+    request.store = store;
+    requests << request;
+  }
+  endResetModel();
+
+  job.setFuture(QtConcurrent::mapped(requests, &TextureReportModel::analyze_map));
+}
+
+/**
+ * @brief Returns whether maps are being analyzed.
+ * @return @c true if the analysis is in progress.
+ */
+bool TextureReportModel::is_loading() const {
+  return job.isRunning();
+}
+
+/**
+ * @brief Returns the map id of a row.
+ * @param row A row.
+ * @return The map id, or an empty string if this is a world.
+ */
+QString TextureReportModel::get_map_id(int row) const {
+
+  if (row < 0 || row >= rows.size() || rows[row].is_world) {
+    return QString();
+  }
+  return rows[row].id;
+}
+
+/**
+ * @brief Returns the number of maps not analyzed yet.
+ * @return The number of maps being analyzed.
+ */
+int TextureReportModel::get_num_pending() const {
+
+  int num_pending = 0;
+  for (const Row& row : rows) {
+    if (!row.is_world && !row.analyzed) {
+      ++num_pending;
+    }
+  }
+  return num_pending;
+}
+
+/**
+ * @brief Returns the number of maps that need more memory than the budget.
+ * @return The number of maps over budget.
+ */
+int TextureReportModel::get_num_maps_over_budget() const {
+
+  int num_maps = 0;
+  for (const Row& row : rows) {
+    if (!row.is_world && row.analyzed && budget > 0 && row.memory_size > budget) {
+      ++num_maps;
+    }
+  }
+  return num_maps;
+}
+
+/**
+ * @brief Returns the texture memory budget of a map.
+ * @return The budget in bytes, 0 means no budget.
+ */
+qint64 TextureReportModel::get_budget() const {
+  return budget;
+}
+
+/**
+ * @brief Sets the texture memory budget of a map.
+ * @param budget The budget in bytes, 0 means no budget.
+ */
+void TextureReportModel::set_budget(qint64 budget) {
+
+  if (budget == this->budget) {
+    return;
+  }
+
+  this->budget = budget;
+  if (!rows.isEmpty()) {
+    emit dataChanged(index(0, 0), index(rows.size() - 1, NUM_COLUMNS - 1));
+  }
+}
+
+/**
+ * @brief Returns the number of rows.
+ * @param parent Parent index.
+ * @return The number of maps and worlds.
+ */
+int TextureReportModel::rowCount(const QModelIndex& parent) const {
+
+  if (parent.isValid()) {
+    return 0;
+  }
+  return rows.size();
+}
+
+/**
+ * @brief Returns the number of columns.
+ * @param parent Parent index.
+ * @return The number of columns.
+ */
+int TextureReportModel::columnCount(const QModelIndex& parent) const {
+
+  if (parent.isValid()) {
+    return 0;
+  }
+  return NUM_COLUMNS;
+}
+
+/**
+ * @brief Returns the data of a cell.
+ * @param index Index of the cell.
+ * @param role The data role.
+ * @return The data.
+ */
+QVariant TextureReportModel::data(const QModelIndex& index, int role) const {
+
+  if (!index.isValid() || index.row() >= rows.size()) {
+    return QVariant();
+  }
+
+  const Row& row = rows[index.row()];
+  const int column = index.column();
+
+  switch (role) {
+
+  case Qt::TextAlignmentRole:
+    if (column >= TILESETS_COLUMN) {
+      return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    return QVariant();
+
+  case Qt::BackgroundRole:
+    if (row.analyzed && budget > 0 && row.memory_size > budget) {
+      return QBrush(QColor(255, 200, 200));
+    }
+    if (row.analyzed && (!row.valid || !row.textures.missing_files.isEmpty())) {
+      return QBrush(QColor(255, 230, 170));
+    }
+    return QVariant();
+
+  case Qt::ToolTipRole:
+    return row.analyzed ? QVariant(get_tooltip(row)) : QVariant();
+
+  case Qt::DisplayRole:
+  case Qt::UserRole:
+    break;
+
+  default:
+    return QVariant();
+  }
+
+  const bool sort_value = role == Qt::UserRole;
+
+  switch (column) {
+
+  case TYPE_COLUMN:
+    return row.is_world ? tr("World") : tr("Map");
+
+  case ID_COLUMN:
+    return row.id;
+
+  case WORLD_COLUMN:
+    return row.is_world ? QString() : row.textures.world;
+
+  default:
+    break;
+  }
+
+  if (!row.analyzed || !row.valid) {
+    if (sort_value) {
+      return -1;
+    }
+    return row.analyzed ? tr("Error") : tr("...");
+  }
+
+  switch (column) {
+
+  case TILESETS_COLUMN:
+    return row.textures.tilesets.size();
+
+  case SPRITES_COLUMN:
+    return row.textures.sprites.size();
+
+  case IMAGES_COLUMN:
+    return row.textures.images.size();
+
+  case MEMORY_COLUMN:
+    return sort_value ? QVariant(row.memory_size) : QVariant(FileTools::format_size(row.memory_size));
+
+  default:
+    return QVariant();
+  }
+}
+
+/**
+ * @brief Returns the header of a column.
+ * @param section A column or row.
+ * @param orientation The header orientation.
+ * @param role The data role.
+ * @return The header data.
+ */
+QVariant TextureReportModel::headerData(
+    int section, Qt::Orientation orientation, int role) const {
+
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+    return QVariant();
+  }
+
+  switch (section) {
+  case TYPE_COLUMN:         return tr("Type");
+  case ID_COLUMN:           return tr("Id");
+  case WORLD_COLUMN:        return tr("World");
+  case TILESETS_COLUMN:     return tr("Tilesets");
+  case SPRITES_COLUMN:      return tr("Sprites");
+  case IMAGES_COLUMN:       return tr("Images");
+  case MEMORY_COLUMN:       return tr("Texture memory");
+  default:                  return QVariant();
+  }
+}
+
+/**
+ * @brief Slot called when a map has been analyzed.
+ * @param index Index of the result in the job.
+ */
+void TextureReportModel::map_ready(int index) {
+
+  const MapTextures& result = job.resultAt(index);
+  auto it = map_rows.constFind(result.map_id);
+  if (it == map_rows.constEnd()) {
+    return;
+  }
+
+  const int row_nb = it.value();
+  Row& row = rows[row_nb];
+  row.analyzed = true;
+  row.valid = result.valid;
+  row.textures = result.textures;
+  row.memory_size = get_memory_size(row.textures);
+  emit dataChanged(this->index(row_nb, 0), this->index(row_nb, NUM_COLUMNS - 1));
+}
+
+/**
+ * @brief Slot called when all maps are analyzed.
+ */
+void TextureReportModel::job_finished() {
+
+  if (job.isCanceled()) {
+    return;
+  }
+
+  add_world_rows();
+  emit loading_finished();
+}
+
+/**
+ * @brief Adds a row for each world, gathering the textures of its maps.
+ */
+void TextureReportModel::add_world_rows() {
+
+  QMap<QString, Row> worlds;
+  for (const Row& map_row : rows) {
+    if (map_row.is_world || !map_row.valid || map_row.textures.world.isEmpty()) {
+      continue;
+    }
+
+    const QString& world = map_row.textures.world;
+    if (!worlds.contains(world)) {
+      Row row;
+      row.is_world = true;
+      row.id = world;
+      row.analyzed = true;
+      row.valid = true;
+      row.memory_size = 0;
+      worlds.insert(world, row);
+    }
+    Row& row = worlds[world];
+    Textures& textures = row.textures;
+    textures.tilesets = (textures.tilesets.toSet() + map_row.textures.tilesets.toSet()).toList();
+    textures.sprites = (textures.sprites.toSet() + map_row.textures.sprites.toSet()).toList();
+    textures.missing_files = (textures.missing_files.toSet() + map_row.textures.missing_files.toSet()).toList();
+    for (auto it = map_row.textures.images.constBegin(); it != map_row.textures.images.constEnd(); ++it) {
+      textures.images.insert(it.key(), it.value());
+    }
+    if (row.largest_map.isEmpty() ||
+        map_row.memory_size > rows[map_rows.value(row.largest_map)].memory_size) {
+      row.largest_map = map_row.id;
+    }
+  }
+
+  if (worlds.isEmpty()) {
+    return;
+  }
+
+  beginInsertRows(QModelIndex(), rows.size(), rows.size() + worlds.size() - 1);
+  for (Row& row : worlds) {
+    std::sort(row.textures.tilesets.begin(), row.textures.tilesets.end());
+    std::sort(row.textures.sprites.begin(), row.textures.sprites.end());
+    std::sort(row.textures.missing_files.begin(), row.textures.missing_files.end());
+    row.memory_size = get_memory_size(row.textures);
+    rows << row;
+  }
+  endInsertRows();
+}
+
+/**
+ * @brief Returns the total memory size of some textures.
+ * @param textures The textures.
+ * @return The size in bytes.
+ */
+qint64 TextureReportModel::get_memory_size(const Textures& textures) {
+
+  qint64 memory_size = 0;
+  for (qint64 image_size : textures.images) {
+    memory_size += image_size;
+  }
+  return memory_size;
+}
+
+/**
+ * @brief Returns the details shown in the tooltip of a row.
+ * @param row An analyzed row.
+ * @return The tooltip text.
+ */
+QString TextureReportModel::get_tooltip(const Row& row) const {
+
+  if (!row.valid) {
+    return tr("Cannot open map '%1'").arg(row.id);
+  }
+
+  QStringList lines;
+  if (row.is_world) {
+    lines << tr("Images of all maps of this world, each one counted once.");
+    lines << tr("Largest map: %1 (%2)").
+             arg(row.largest_map).
+             arg(FileTools::format_size(rows[map_rows.value(row.largest_map)].memory_size));
+  }
+  lines << tr("Tilesets: %1").arg(row.textures.tilesets.join(", "));
+
+  // Biggest images first.
+  QList<QPair<qint64, QString>> images;
+  for (auto it = row.textures.images.constBegin(); it != row.textures.images.constEnd(); ++it) {
+    images << qMakePair(it.value(), it.key());
+  }
+  std::sort(images.begin(), images.end(), [](const QPair<qint64, QString>& a,
+                                             const QPair<qint64, QString>& b) {
+    return a.first > b.first;
+  });
+  const int data_path_length = quest.get_data_path().length() + 1;
+  for (int i = 0; i < images.size() && i < max_tooltip_images; ++i) {
+    lines << QString("%1: %2").
+             arg(images[i].second.mid(data_path_length)).
+             arg(FileTools::format_size(images[i].first));
+  }
+  if (images.size() > max_tooltip_images) {
+    lines << tr("... and %1 other images").arg(images.size() - max_tooltip_images);
+  }
+
+  if (!row.textures.missing_files.isEmpty()) {
+    lines << tr("Missing: %1").arg(row.textures.missing_files.join(", "));
+  }
+  return lines.join("\n");
+}
+
+/**
+ * @brief Finds the textures needed by a map.
+ *
+ * This function can be called from worker threads.
+ *
+ * @param request The map to analyze.
+ * @return The textures of the map.
+ */
+TextureReportModel::MapTextures TextureReportModel::analyze_map(const MapRequest& request) {
+
+  const Quest& quest = *request.quest;
+  TextureStore& store = *request.store;
+  MapTextures result;
+  result.map_id = request.map_id;
+  result.valid = false;
+
+  const QString& path = quest.get_map_data_file_path(request.map_id);
+  TextureReferences references;
+  if (!load_cached_references(quest, path, references)) {
+    Solarus::MapData map;
+    if (!DataFileCache::load_map_data(quest, path, map)) {
+      return result;
+    }
+    references = get_map_references(map);
+    save_cached_references(quest, path, references);
+  }
+
+  Textures& textures = result.textures;
+  textures.world = references.world;
+  textures.tilesets = references.tilesets;
+  textures.sprites = references.sprites;
+
+  const int data_path_length = quest.get_data_path().length() + 1;
+  const auto& add_image = [&](const QString& image_path, bool required) {
+    const qint64 image_size = store.get_image_size(image_path);
+    if (image_size >= 0) {
+      textures.images.insert(image_path, image_size);
+    }
+    else if (required && !textures.missing_files.contains(image_path.mid(data_path_length))) {
+      textures.missing_files << image_path.mid(data_path_length);
+    }
+  };
+
+  // Sprites whose source image is "tileset" use the entities image
+  // of the tileset of the map, which is always counted.
+  for (const QString& tileset_id : textures.tilesets) {
+    add_image(quest.get_tileset_tiles_image_path(tileset_id), true);
+    add_image(quest.get_tileset_entities_image_path(tileset_id), false);
+  }
+
+  for (const QString& sprite_id : textures.sprites) {
+    QStringList src_images;
+    if (!store.get_sprite_images(quest, sprite_id, src_images)) {
+      textures.missing_files << quest.get_sprite_path(sprite_id).mid(data_path_length);
+      continue;
+    }
+    for (const QString& src_image : src_images) {
+      if (src_image != "tileset") {
+        add_image(quest.get_sprite_image_path(src_image), true);
+      }
+    }
+  }
+
+  result.valid = true;
+  return result;
+}
+
+}
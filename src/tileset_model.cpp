@@ -16,11 +16,15 @@
  */
 #include "color.h"
 #include "editor_exception.h"
+#include "natural_comparator.h"
 #include "quest.h"
 #include "rectangle.h"
 #include "pattern_animation_traits.h"
 #include "tileset_model.h"
 #include <QIcon>
+#include <QVector>
+#include <algorithm>
+#include <vector>
 
 namespace SolarusEditor {
 
@@ -52,8 +56,11 @@ TilesetModel::TilesetModel(
   }
 
   build_index_map();
-  for (const auto& kvp : ids_to_indexes) {
-    const QString& pattern_id = kvp.first;
+  QVector<QString> pattern_ids(ids_to_indexes.size());
+  for (auto it = ids_to_indexes.constBegin(); it != ids_to_indexes.constEnd(); ++it) {
+    pattern_ids[it.value()] = it.key();
+  }
+  for (const QString& pattern_id : pattern_ids) {
     patterns.append(PatternModel(pattern_id));
   }
 
@@ -197,11 +204,7 @@ bool TilesetModel::pattern_exists(const QString& pattern_id) const {
  */
 int TilesetModel::id_to_index(const QString& pattern_id) const {
 
-  auto it = ids_to_indexes.find(pattern_id);
-  if (it == ids_to_indexes.end()) {
-    return -1;
-  }
-  return it->second;
+  return ids_to_indexes.value(pattern_id, -1);
 }
 
 /**
@@ -237,17 +240,19 @@ void TilesetModel::build_index_map() {
 
   const std::map<std::string, TilePatternData>& pattern_map =
       tileset.get_patterns();
-  // First, put the string keys to have natural sort.
+  // First, sort the ids in natural order.
+  std::vector<NaturalKey> sorted_ids;
+  sorted_ids.reserve(pattern_map.size());
   for (const auto& kvp : pattern_map) {
-    QString pattern_id = QString::fromStdString(kvp.first);
-    ids_to_indexes.insert(std::make_pair(pattern_id, 0));
+    sorted_ids.emplace_back(QString::fromStdString(kvp.first));
   }
+  std::sort(sorted_ids.begin(), sorted_ids.end());
 
-  // Then, we can put the integer value.
+  // Then, lookups only need a hash of the indexes.
+  ids_to_indexes.reserve(static_cast<int>(sorted_ids.size()));
   int index = 0;
-  for (const auto& kvp : ids_to_indexes) {
-    QString pattern_id = kvp.first;
-    ids_to_indexes[pattern_id] = index;
+  for (const NaturalKey& pattern_id : sorted_ids) {
+    ids_to_indexes.insert(pattern_id.get_string(), index);
     ++index;
   }
 }
@@ -1234,6 +1239,47 @@ QPixmap TilesetModel::get_pattern_image_all_frames(int index) const {
   return pattern.image_all_frames;
 }
 
+/**
+ * @brief Returns a downsampled image of the specified pattern.
+ *
+ * Each level halves the size of the previous one and is computed from it,
+ * so that zoomed out views can draw tiles without scaling them on the fly.
+ * Only the first frame of multi-frame patterns is represented.
+ *
+ * @param index Index of a tile pattern.
+ * @param level Mipmap level (0 is the full-size image).
+ * @return The corresponding image.
+ * Returns a null pixmap if the tileset image is not loaded.
+ */
+QPixmap TilesetModel::get_pattern_mipmap(int index, int level) const {
+
+  if (level <= 0) {
+    return get_pattern_image(index);
+  }
+
+  if (!pattern_exists(index)) {
+    // No such pattern.
+    return QPixmap();
+  }
+
+  const PatternModel& pattern = patterns.at(index);
+  auto it = pattern.mipmaps.find(level);
+  if (it != pattern.mipmaps.end()) {
+    // Image already created.
+    return it.value();
+  }
+
+  // Lazily create the image from the previous level.
+  const QPixmap& previous = get_pattern_mipmap(index, level - 1);
+  if (previous.isNull()) {
+    return QPixmap();
+  }
+  const QSize size(qMax(1, previous.width() / 2), qMax(1, previous.height() / 2));
+  const QPixmap& mipmap = previous.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+  pattern.mipmaps.insert(level, mipmap);
+  return mipmap;
+}
+
 /**
  * @brief Returns a 32x32 icon representing the specified pattern.
  * @param index Index of a tile pattern.
@@ -1290,7 +1336,7 @@ QImage TilesetModel::get_patterns_image() const {
  */
 void TilesetModel::reload_patterns_image() {
 
-  patterns_image = QImage(quest.get_tileset_tiles_image_path(tileset_id));
+  patterns_image = quest.get_image_store().get_image(quest.get_tileset_tiles_image_path(tileset_id));
 
   for (PatternModel& pattern : patterns) {
     pattern.set_image_dirty();
@@ -0,0 +1,636 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "data_file_parser.h"
+#include "natural_comparator.h"
+#include "quest.h"
+#include "quest_database.h"
+#include "translation_matrix_model.h"
+#include <solarus/core/DialogResources.h>
+#include <solarus/core/StringResources.h>
+#include <QBrush>
+#include <QFont>
+#include <QtConcurrent>
+#include <algorithm>
+#include <vector>
+
+namespace SolarusEditor {
+
+namespace {
+
+/**
+ * @brief Converts a text from the Solarus API.
+ *
+ * Null strings mean missing texts, so empty texts must not be null.
+ *
+ * @param text A text.
+ * @return The corresponding non-null string.
+ */
+QString to_text(const std::string& text) {
+
+  if (text.empty()) {
+    return QString("");
+  }
+  return QString::fromStdString(text);
+}
+
+}
+
+/**
+ * @brief Creates an empty translation matrix model.
+ *
+ * Call load() to load the languages.
+ *
+ * @param quest The quest.
+ * @param parent The parent object or nullptr.
+ */
+TranslationMatrixModel::TranslationMatrixModel(Quest& quest, QObject* parent) :
+  QAbstractTableModel(parent),
+  quest(quest),
+  kind(Kind::DIALOGS),
+  reference_language(),
+  keys(),
+  key_rows(),
+  languages(),
+  outdated_keys(),
+  job() {
+
+  connect(&job, SIGNAL(finished()),
+          this, SLOT(job_finished()));
+}
+
+/**
+ * @brief Destroys the model.
+ */
+TranslationMatrixModel::~TranslationMatrixModel() {
+
+  job.cancel();
+  job.waitForFinished();
+}
+
+/**
+ * @brief Returns the kind of language files shown.
+ * @return The kind of files.
+ */
+TranslationMatrixModel::Kind TranslationMatrixModel::get_kind() const {
+  return kind;
+}
+
+/**
+ * @brief Loads the dialogs or strings of all languages of the quest.
+ *
+ * Files are loaded in worker threads.
+ * loading_finished() is emitted when the model is ready.
+ *
+ * @param kind The kind of files to load.
+ */
+void TranslationMatrixModel::load(Kind kind) {
+
+  job.cancel();
+  job.waitForFinished();
+
+  this->kind = kind;
+  QList<LanguageRequest> requests;
+  for (const QString& language_id : quest.get_database().get_elements(ResourceType::LANGUAGE)) {
+    requests << make_request(language_id);
+  }
+  job.setFuture(QtConcurrent::mapped(requests, &TranslationMatrixModel::load_language));
+}
+
+/**
+ * @brief Returns whether languages are being loaded.
+ * @return @c true if the loading is in progress.
+ */
+bool TranslationMatrixModel::is_loading() const {
+  return job.isRunning();
+}
+
+/**
+ * @brief Returns the language other languages are compared to.
+ * @return The reference language id.
+ */
+QString TranslationMatrixModel::get_reference_language() const {
+  return reference_language;
+}
+
+/**
+ * @brief Sets the language other languages are compared to.
+ *
+ * Outdated flags are forgotten since they were relative to the previous
+ * reference language.
+ *
+ * @param language_id The new reference language id.
+ */
+void TranslationMatrixModel::set_reference_language(const QString& language_id) {
+
+  if (language_id == reference_language) {
+    return;
+  }
+
+  reference_language = language_id;
+  outdated_keys.clear();
+  for (int row = 0; row < keys.size(); ++row) {
+    update_flags(row);
+  }
+
+  if (languages.isEmpty()) {
+    return;
+  }
+  if (!keys.isEmpty()) {
+    emit dataChanged(index(0, 0), index(keys.size() - 1, languages.size() - 1));
+  }
+  emit headerDataChanged(Qt::Horizontal, 0, languages.size() - 1);
+}
+
+/**
+ * @brief Returns the key of a row.
+ * @param row A row.
+ * @return The dialog id or string key.
+ */
+QString TranslationMatrixModel::get_key(int row) const {
+  return keys.value(row);
+}
+
+/**
+ * @brief Returns the language of a column.
+ * @param column A column.
+ * @return The language id.
+ */
+QString TranslationMatrixModel::get_language(int column) const {
+
+  if (column < 0 || column >= languages.size()) {
+    return QString();
+  }
+  return languages[column].id;
+}
+
+/**
+ * @brief Returns the text of a cell.
+ * @param row A row.
+ * @param column A column.
+ * @return The text, or a null string if this language has no such key.
+ */
+QString TranslationMatrixModel::get_text(int row, int column) const {
+
+  if (column < 0 || column >= languages.size()) {
+    return QString();
+  }
+  return languages[column].texts.value(row);
+}
+
+/**
+ * @brief Returns the flags of a cell.
+ * @param row A row.
+ * @param column A column.
+ * @return A combination of Flag values.
+ */
+int TranslationMatrixModel::get_flags(int row, int column) const {
+
+  if (column < 0 || column >= languages.size()) {
+    return 0;
+  }
+  return languages[column].flags.value(row);
+}
+
+/**
+ * @brief Returns the flags of all cells of a row.
+ * @param row A row.
+ * @return A combination of Flag values.
+ */
+int TranslationMatrixModel::get_row_flags(int row) const {
+
+  int flags = 0;
+  for (const Language& language : languages) {
+    flags |= language.flags.value(row);
+  }
+  return flags;
+}
+
+/**
+ * @brief Returns the number of rows.
+ * @param parent Parent index.
+ * @return The number of keys.
+ */
+int TranslationMatrixModel::rowCount(const QModelIndex& parent) const {
+
+  if (parent.isValid()) {
+    return 0;
+  }
+  return keys.size();
+}
+
+/**
+ * @brief Returns the number of columns.
+ * @param parent Parent index.
+ * @return The number of languages.
+ */
+int TranslationMatrixModel::columnCount(const QModelIndex& parent) const {
+
+  if (parent.isValid()) {
+    return 0;
+  }
+  return languages.size();
+}
+
+/**
+ * @brief Returns the data of a cell.
+ * @param index Index of the cell.
+ * @param role The data role.
+ * @return The data.
+ */
+QVariant TranslationMatrixModel::data(const QModelIndex& index, int role) const {
+
+  if (!index.isValid()) {
+    return QVariant();
+  }
+
+  const QString& text = get_text(index.row(), index.column());
+  const int flags = get_flags(index.row(), index.column());
+
+  switch (role) {
+
+  case Qt::DisplayRole:
+    if (text.contains('\n')) {
+      // Only show the first line.
+      return text.section('\n', 0, 0) + "...";
+    }
+    return text;
+
+  case Qt::ToolTipRole:
+    if (flags & MISSING) {
+      return tr("Missing translation");
+    }
+    if (flags & UNUSED) {
+      return tr("Not in the reference language\n\n%1").arg(text);
+    }
+    if (flags & OUTDATED) {
+      return tr("The reference text changed since this translation\n\n%1").arg(text);
+    }
+    return text;
+
+  case Qt::BackgroundRole:
+    if (flags & MISSING) {
+      return QBrush(QColor(255, 200, 200));
+    }
+    if (flags & OUTDATED) {
+      return QBrush(QColor(255, 230, 170));
+    }
+    if (flags & UNUSED) {
+      return QBrush(QColor(220, 220, 220));
+    }
+    return QVariant();
+
+  default:
+    return QVariant();
+  }
+}
+
+/**
+ * @brief Returns the header data of a row or column.
+ * @param section Row or column.
+ * @param orientation Horizontal for languages and vertical for keys.
+ * @param role The data role.
+ * @return The header data.
+ */
+QVariant TranslationMatrixModel::headerData(
+    int section, Qt::Orientation orientation, int role) const {
+
+  if (orientation == Qt::Vertical) {
+    if (role == Qt::DisplayRole) {
+      return get_key(section);
+    }
+    return QVariant();
+  }
+
+  const QString& language_id = get_language(section);
+  switch (role) {
+
+  case Qt::DisplayRole:
+    return language_id;
+
+  case Qt::ToolTipRole:
+    if (section < languages.size() && !languages[section].valid) {
+      return tr("Cannot load language '%1'").arg(language_id);
+    }
+    return QString();
+
+  case Qt::FontRole:
+    if (language_id == reference_language) {
+      QFont font;
+      font.setBold(true);
+      return font;
+    }
+    return QVariant();
+
+  default:
+    return QVariant();
+  }
+}
+
+/**
+ * @brief Slot called when a file of the quest is saved.
+ *
+ * If this is a language file of the kind shown, only this language is
+ * loaded again and flags are updated for the texts that changed.
+ *
+ * @param path Path of the saved file.
+ */
+void TranslationMatrixModel::file_saved(const QString& path) {
+
+  if (is_loading()) {
+    // It will be loaded anyway.
+    return;
+  }
+
+  QString language_id;
+  const bool is_language_file = (kind == Kind::DIALOGS) ?
+        quest.is_dialogs_file(path, language_id) :
+        quest.is_strings_file(path, language_id);
+  if (!is_language_file) {
+    return;
+  }
+
+  if (get_column(language_id) == -1) {
+    // New language.
+    load(kind);
+    return;
+  }
+
+  update_language(load_language(make_request(language_id)));
+}
+
+/**
+ * @brief Slot called when all languages are loaded.
+ */
+void TranslationMatrixModel::job_finished() {
+
+  if (job.isCanceled()) {
+    return;
+  }
+
+  outdated_keys.clear();
+  build_table(job.future().results());
+  emit loading_finished();
+}
+
+/**
+ * @brief Loads the texts of a language file.
+ *
+ * This function can be called from worker threads.
+ *
+ * @param request The language file to load.
+ * @return The texts.
+ */
+TranslationMatrixModel::LanguageTexts TranslationMatrixModel::load_language(
+    const LanguageRequest& request) {
+
+  LanguageTexts result;
+  result.language_id = request.language_id;
+  result.valid = false;
+
+  if (request.kind == Kind::DIALOGS) {
+    Solarus::DialogResources resources;
+    if (!DataFileParser::import_dialogs(request.path, resources) &&
+        !resources.import_from_file(request.path.toStdString())) {
+      return result;
+    }
+    for (const auto& kvp : resources.get_dialogs()) {
+      result.texts.insert(QString::fromStdString(kvp.first),
+                          to_text(kvp.second.get_text()));
+    }
+  }
+  else {
+    Solarus::StringResources resources;
+    if (!DataFileParser::import_strings(request.path, resources) &&
+        !resources.import_from_file(request.path.toStdString())) {
+      return result;
+    }
+    for (const auto& kvp : resources.get_strings()) {
+      result.texts.insert(QString::fromStdString(kvp.first),
+                          to_text(kvp.second));
+    }
+  }
+
+  result.valid = true;
+  return result;
+}
+
+/**
+ * @brief Creates the request to load a language file of the current kind.
+ * @param language_id Id of the language.
+ * @return The request.
+ */
+TranslationMatrixModel::LanguageRequest TranslationMatrixModel::make_request(
+    const QString& language_id) const {
+
+  LanguageRequest request;
+  request.language_id = language_id;
+  request.path = (kind == Kind::DIALOGS) ?
+        quest.get_dialogs_path(language_id) :
+        quest.get_strings_path(language_id);
+  request.kind = kind;
+  return request;
+}
+
+/**
+ * @brief Rebuilds the whole matrix from loaded languages.
+ * @param loaded Texts of each language.
+ */
+void TranslationMatrixModel::build_table(const QList<LanguageTexts>& loaded) {
+
+  beginResetModel();
+
+  // Build the shared key table.
+  QSet<QString> all_keys;
+  for (const LanguageTexts& texts : loaded) {
+    for (auto it = texts.texts.constBegin(); it != texts.texts.constEnd(); ++it) {
+      all_keys.insert(it.key());
+    }
+  }
+  std::vector<NaturalKey> sorted_keys;
+  sorted_keys.reserve(all_keys.size());
+  for (const QString& key : all_keys) {
+    sorted_keys.emplace_back(key);
+  }
+  std::sort(sorted_keys.begin(), sorted_keys.end());
+
+  keys.clear();
+  key_rows.clear();
+  for (const NaturalKey& key : sorted_keys) {
+    key_rows.insert(key.get_string(), keys.size());
+    keys << key.get_string();
+  }
+
+  // Store the texts of each language by row.
+  languages.clear();
+  for (const LanguageTexts& texts : loaded) {
+    Language language;
+    language.id = texts.language_id;
+    language.valid = texts.valid;
+    language.texts.resize(keys.size());
+    language.flags.resize(keys.size());
+    for (auto it = texts.texts.constBegin(); it != texts.texts.constEnd(); ++it) {
+      language.texts[key_rows.value(it.key())] = it.value();
+    }
+    languages << language;
+  }
+
+  if (get_column(reference_language) == -1 && !languages.isEmpty()) {
+    reference_language = languages.first().id;
+  }
+
+  for (int row = 0; row < keys.size(); ++row) {
+    update_flags(row);
+  }
+
+  endResetModel();
+}
+
+/**
+ * @brief Replaces the texts of a language that was loaded again.
+ *
+ * Flags are only updated for rows whose text changed.
+ * Texts that changed in the reference language make the existing
+ * translations outdated, and texts that changed in another language
+ * are no longer outdated.
+ *
+ * @param loaded The new texts of the language.
+ */
+void TranslationMatrixModel::update_language(const LanguageTexts& loaded) {
+
+  const int column = get_column(loaded.language_id);
+  if (column == -1) {
+    return;
+  }
+
+  // New keys change the rows: rebuild everything.
+  for (auto it = loaded.texts.constBegin(); it != loaded.texts.constEnd(); ++it) {
+    if (!key_rows.contains(it.key())) {
+      QList<LanguageTexts> all_texts;
+      for (const Language& language : languages) {
+        if (language.id == loaded.language_id) {
+          all_texts << loaded;
+          continue;
+        }
+        LanguageTexts texts;
+        texts.language_id = language.id;
+        texts.valid = language.valid;
+        for (int row = 0; row < keys.size(); ++row) {
+          if (!language.texts[row].isNull()) {
+            texts.texts.insert(keys[row], language.texts[row]);
+          }
+        }
+        all_texts << texts;
+      }
+      build_table(all_texts);
+      return;
+    }
+  }
+
+  Language& language = languages[column];
+  language.valid = loaded.valid;
+  const bool is_reference = language.id == reference_language;
+
+  int first_changed_row = -1;
+  int last_changed_row = -1;
+  for (int row = 0; row < keys.size(); ++row) {
+
+    const QString& key = keys[row];
+    const QString& text = loaded.texts.value(key);
+    const QString& old_text = language.texts[row];
+    if (text == old_text && text.isNull() == old_text.isNull()) {
+      continue;
+    }
+    language.texts[row] = text;
+
+    if (is_reference) {
+      for (const Language& other_language : languages) {
+        if (other_language.id != language.id && !other_language.texts[row].isNull()) {
+          outdated_keys[other_language.id].insert(key);
+        }
+      }
+    }
+    else {
+      outdated_keys[language.id].remove(key);
+    }
+
+    update_flags(row);
+    if (first_changed_row == -1) {
+      first_changed_row = row;
+    }
+    last_changed_row = row;
+  }
+
+  if (first_changed_row != -1) {
+    emit dataChanged(index(first_changed_row, 0),
+                     index(last_changed_row, languages.size() - 1));
+  }
+}
+
+/**
+ * @brief Computes the flags of a cell.
+ * @param row A row.
+ * @param column A column.
+ * @return A combination of Flag values.
+ */
+quint8 TranslationMatrixModel::compute_flags(int row, int column) const {
+
+  const int reference_column = get_column(reference_language);
+  if (reference_column == -1 || column == reference_column) {
+    return 0;
+  }
+
+  const QString& text = languages[column].texts[row];
+  const QString& reference_text = languages[reference_column].texts[row];
+  if (text.isNull()) {
+    return reference_text.isNull() ? 0 : MISSING;
+  }
+  if (reference_text.isNull()) {
+    return UNUSED;
+  }
+  if (outdated_keys.value(languages[column].id).contains(keys[row])) {
+    return OUTDATED;
+  }
+  return 0;
+}
+
+/**
+ * @brief Updates the flags of all cells of a row.
+ * @param row A row.
+ */
+void TranslationMatrixModel::update_flags(int row) {
+
+  for (int column = 0; column < languages.size(); ++column) {
+    languages[column].flags[row] = compute_flags(row, column);
+  }
+}
+
+/**
+ * @brief Returns the column of a language.
+ * @param language_id Id of a language.
+ * @return The column, or -1 if there is no such language.
+ */
+int TranslationMatrixModel::get_column(const QString& language_id) const {
+
+  for (int column = 0; column < languages.size(); ++column) {
+    if (languages[column].id == language_id) {
+      return column;
+    }
+  }
+  return -1;
+}
+
+}
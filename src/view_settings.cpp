@@ -29,6 +29,8 @@ ViewSettings::ViewSettings(QObject* parent) :
   grid_size(16, 16),
   grid_style(GridStyle::DASHED),
   grid_color(Qt::black),
+  lod_enabled(true),
+  lod_zoom(0.5),
   min_layer(0),
   max_layer(-1),
   locked_layers(),
@@ -183,6 +185,68 @@ void ViewSettings::set_grid_color(const QColor& color) {
   }
 }
 
+/**
+ * @brief Returns whether simplified rendering is used when zoomed out.
+ * @return @c true if level of detail rendering is enabled.
+ */
+bool ViewSettings::is_lod_enabled() const {
+
+  return lod_enabled;
+}
+
+/**
+ * @brief Enables or disables simplified rendering when zoomed out.
+ *
+ * Emits lod_changed() if there is a change.
+ *
+ * @param lod_enabled @c true to enable level of detail rendering.
+ */
+void ViewSettings::set_lod_enabled(bool lod_enabled) {
+
+  if (lod_enabled == this->lod_enabled) {
+    return;
+  }
+
+  this->lod_enabled = lod_enabled;
+  emit lod_changed();
+}
+
+/**
+ * @brief Returns the zoom factor below which simplified rendering is used.
+ * @return The threshold zoom factor.
+ */
+double ViewSettings::get_lod_zoom() const {
+
+  return lod_zoom;
+}
+
+/**
+ * @brief Sets the zoom factor below which simplified rendering is used.
+ *
+ * Emits lod_changed() if there is a change.
+ *
+ * @param lod_zoom The threshold zoom factor.
+ */
+void ViewSettings::set_lod_zoom(double lod_zoom) {
+
+  if (lod_zoom == this->lod_zoom || lod_zoom <= 0.0) {
+    return;
+  }
+
+  this->lod_zoom = lod_zoom;
+  emit lod_changed();
+}
+
+/**
+ * @brief Returns whether simplified rendering should be used at a zoom factor.
+ * @param zoom A zoom factor, or the level of detail of a painter.
+ * @return @c true if it is enabled and the zoom is below the threshold.
+ */
+bool ViewSettings::is_low_detail(double zoom) const {
+
+  return lod_enabled && zoom < lod_zoom;
+}
+
 /**
  * @brief Returns the range of layers supported for visibility.
  *
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "widgets/audio_report_dialog.h"
+#include "audio.h"
+#include "file_tools.h"
+#include "quest.h"
+#include <QHeaderView>
+
+namespace SolarusEditor {
+
+/**
+ * @brief Creates an audio report dialog.
+ * @param quest The quest.
+ * @param parent The parent object or nullptr.
+ */
+AudioReportDialog::AudioReportDialog(Quest& quest, QWidget* parent) :
+  QDialog(parent),
+  ui(),
+  quest(quest),
+  model(quest),
+  sort_model() {
+
+  ui.setupUi(this);
+
+  sort_model.setSourceModel(&model);
+  sort_model.setSortRole(Qt::UserRole);
+  ui.table_view->setModel(&sort_model);
+  ui.table_view->setSortingEnabled(true);
+  ui.table_view->sortByColumn(AudioReportModel::MEMORY_COLUMN, Qt::DescendingOrder);
+  ui.table_view->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  ui.table_view->horizontalHeader()->setSectionResizeMode(
+        AudioReportModel::ID_COLUMN, QHeaderView::Stretch);
+  ui.table_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+  connect(ui.table_view, SIGNAL(doubleClicked(QModelIndex)),
+          this, SLOT(row_activated(QModelIndex)));
+  connect(&model, SIGNAL(modelReset()),
+          this, SLOT(update_status()));
+  connect(&model, SIGNAL(dataChanged(QModelIndex, QModelIndex)),
+          this, SLOT(update_status()));
+
+  reload();
+}
+
+/**
+ * @brief Analyzes again the files that changed and updates the report.
+ */
+void AudioReportDialog::reload() {
+
+  model.reload();
+}
+
+/**
+ * @brief Slot called when the user double-clicks a row.
+ *
+ * Plays the sound or music of this row.
+ *
+ * @param index Index of a cell in the row.
+ */
+void AudioReportDialog::row_activated(const QModelIndex& index) {
+
+  const int row = sort_model.mapToSource(index).row();
+  const QString& element_id = model.get_element_id(row);
+  if (element_id.isEmpty()) {
+    return;
+  }
+
+  if (model.get_resource_type(row) == ResourceType::SOUND) {
+    Audio::play_sound(quest, element_id);
+  }
+  else {
+    Audio::play_music(quest, element_id);
+  }
+}
+
+/**
+ * @brief Updates the status text.
+ */
+void AudioReportDialog::update_status() {
+
+  QString status = tr("Memory in game: %1 for sounds, %2 for musics").
+      arg(FileTools::format_size(model.get_total_memory_size(ResourceType::SOUND))).
+      arg(FileTools::format_size(model.get_total_memory_size(ResourceType::MUSIC)));
+
+  const int num_pending = model.get_num_pending();
+  if (num_pending > 0) {
+    status += tr(" (analyzing %1 files...)").arg(num_pending);
+  }
+  ui.status_label->setText(status);
+}
+
+}
@@ -97,6 +97,47 @@ void DialogsTreeView::set_model(DialogsModel* model) {
   DialogsTreeView::setModel(model);
   selectionModel()->deleteLater();
   setSelectionModel(&model->get_selection_model());
+
+  connect(model, SIGNAL(modelAboutToBeReset()),
+          this, SLOT(save_expanded_items()));
+  connect(model, SIGNAL(modelReset()),
+          this, SLOT(restore_expanded_items()));
+}
+
+/**
+ * @brief Slot called before the model is reset.
+ *
+ * Remembers the expanded items to restore them after the reset.
+ */
+void DialogsTreeView::save_expanded_items() {
+
+  expanded_ids.clear();
+
+  QModelIndexList parents;
+  parents << QModelIndex();
+  while (!parents.isEmpty()) {
+    const QModelIndex parent = parents.takeLast();
+    for (int row = 0; row < model->rowCount(parent); ++row) {
+      const QModelIndex& index = model->index(row, 0, parent);
+      if (isExpanded(index)) {
+        expanded_ids << model->index_to_id(index);
+        parents << index;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Slot called after the model is reset.
+ *
+ * Expands again the items that were expanded before the reset.
+ */
+void DialogsTreeView::restore_expanded_items() {
+
+  for (const QString& id : expanded_ids) {
+    setExpanded(model->id_to_index(id), true);
+  }
+  expanded_ids.clear();
 }
 
 }
@@ -457,6 +457,7 @@ bool EditorTabs::save_file_requested(int index) {
     editor->save();
     editor->get_undo_stack().setClean();
     modification_state_changed(index, true);
+    emit file_saved(editor->get_file_path());
   }
   catch (const EditorException& ex) {
     ex.show_dialog();
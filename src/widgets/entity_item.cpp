@@ -72,20 +72,30 @@ QRectF EntityItem::boundingRect() const {
 }
 
 /**
- * @brief Shows or hides this entity item according to view settings.
+ * @brief Returns whether an entity is shown with the given view settings.
+ * @param entity The entity to check.
  * @param view_settings The settings to apply.
+ * @return @c true if the entity is visible.
  */
-void EntityItem::update_visibility(const ViewSettings& view_settings) {
+bool EntityItem::is_entity_visible(const EntityModel& entity, const ViewSettings& view_settings) {
 
   int layer = entity.get_layer();
-  EntityType type = get_entity_type();
+  EntityType type = entity.get_type();
   bool traversable = entity.is_traversable();
 
-  const bool visible = view_settings.is_layer_visible(layer) &&
+  return view_settings.is_layer_visible(layer) &&
       view_settings.is_entity_type_visible(type) &&
       ((traversable && view_settings.are_traversables_visible()) ||
        (!traversable && view_settings.are_obstacles_visible()));
-  setVisible(visible);
+}
+
+/**
+ * @brief Shows or hides this entity item according to view settings.
+ * @param view_settings The settings to apply.
+ */
+void EntityItem::update_visibility(const ViewSettings& view_settings) {
+
+  setVisible(is_entity_visible(entity, view_settings));
 }
 
 /**
@@ -107,6 +117,24 @@ void EntityItem::update_size() {
   this->size = entity.get_size();  // TODO this is not true for entities whose sprite is larger, like NPCs
 }
 
+/**
+ * @brief Keeps the selection state of the entity up to date with this item.
+ * @param change What changes in the item.
+ * @param value The new value.
+ * @return The value to apply.
+ */
+QVariant EntityItem::itemChange(GraphicsItemChange change, const QVariant& value) {
+
+  if (change == ItemSelectedHasChanged) {
+    entity.set_selected(value.toBool());
+    MapScene* map_scene = qobject_cast<MapScene*>(scene());
+    if (map_scene != nullptr) {
+      map_scene->update_entity_selection(entity);
+    }
+  }
+  return QGraphicsItem::itemChange(change, value);
+}
+
 /**
  * @brief Paints the pattern item.
  *
@@ -125,7 +153,17 @@ void EntityItem::paint(QPainter* painter,
   const bool selected = option->state & QStyle::State_Selected;
   QStyleOptionGraphicsItem option_deselected = *option;
   option_deselected.state &= ~QStyle::State_Selected;
-  entity.draw(*painter);
+
+  // Simplify the rendering when zoomed out if the view settings ask so.
+  const MapScene* map_scene = qobject_cast<const MapScene*>(scene());
+  const double level_of_detail = QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+        painter->worldTransform());
+  if (map_scene != nullptr && map_scene->is_low_detail(level_of_detail)) {
+    entity.draw_low_detail(*painter, level_of_detail);
+  }
+  else {
+    entity.draw(*painter);
+  }
 
   // Add our selection marker.
   if (selected) {
@@ -15,79 +15,13 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "widgets/external_script_dialog.h"
-#include <lua.hpp>
-#include <QDebug>
-#include <QDir>
-#include <QFileInfo>
+#include "external_script_runner.h"
+#include <QCloseEvent>
 #include <QPushButton>
-#include <QTemporaryFile>
-#include <QTimer>
+#include <QTextCursor>
 
 namespace SolarusEditor {
 
-namespace {
-
-/**
- * @brief Custom loader for Lua to require() files from the script's directory.
- *
- * It also works if the script is inside Qt resources.
- *
- * This function expects an upvalue of type string indicating the path of the
- * current script (necessary to know its directory).
- *
- * @param l A Lua state.
- * @return Number of values to return to Lua.
- */
-int l_loader_from_current_dir(lua_State* l) {
-
-  QString current_script_path = QString::fromUtf8(lua_tostring(l, lua_upvalueindex(1)));
-  QString required_name = QString::fromUtf8(luaL_checkstring(l, 1));
-
-  if (QFileInfo(required_name).isAbsolute()) {
-    // An absolute path was specified: not our job here (and it is not an error).
-    lua_pushnil(l);
-    return 1;
-  }
-
-  QDir parent_dir(current_script_path);
-  if (!parent_dir.cdUp()) {
-    // Something must be wrong in this C++ code.
-    qCritical() << ExternalScriptDialog::tr("Cannot determine the directory of script '%1'").arg(current_script_path);
-    lua_pushnil(l);
-    return 1;
-  }
-
-  QString required_path = parent_dir.absolutePath() + "/" + required_name + ".lua";
-
-  QFile required_file(required_path);
-  if (!required_file.open(QFileDevice::ReadOnly)) {
-    // File was not found by this loader.
-    // This is not an error, but we should give information about what was
-    // searched, like standard loaders.
-
-    // Note that the information is not translated because Lua uses it
-    // to build a larger diagnostic in English.
-    QByteArray message;
-    if (required_path.startsWith(":/")) {
-      // Qt resource that was searched in the script's directory.
-      message = QString("\n\tno Qt resource file '%1'").arg(required_path).toUtf8();
-    }
-    else {
-      // Regular file that was searched in the script's directory.
-      message = QString("\n\tno file '%1'").arg(required_path).toUtf8();
-    }
-    lua_pushstring(l, message.constData());
-    return 1;
-  }
-
-  QByteArray buffer = required_file.readAll();
-  QByteArray required_path_utf8 = required_path.toUtf8();
-  luaL_loadbuffer(l, buffer.constData(), buffer.size(), required_path_utf8);
-  return 1;
-}
-
-}
-
 /**
  * Creates a script dialog.
  * @param title Title describing the operation.
@@ -101,8 +35,7 @@ ExternalScriptDialog::ExternalScriptDialog(
     const QString& script_arg,
     QWidget* parent) :
   QDialog(parent),
-  script_path(script_path),
-  script_arg(script_arg),
+  runner(new ExternalScriptRunner(script_path, script_arg, this)),
   finished(false),
   successful(false) {
 
@@ -111,6 +44,26 @@ ExternalScriptDialog::ExternalScriptDialog(
   set_finished(false);
   setWindowTitle(title);
   ui.description_label->setText(title + "... ");
+
+  connect(runner, SIGNAL(output_available()),
+          this, SLOT(output_available()));
+  connect(runner, SIGNAL(finished()),
+          this, SLOT(script_finished()));
+
+  elapsed_time_update_timer.setInterval(100);
+  connect(&elapsed_time_update_timer, SIGNAL(timeout()),
+          this, SLOT(update_elapsed_time()));
+}
+
+/**
+ * @brief Destructor.
+ *
+ * Interrupts the script if it is still running.
+ */
+ExternalScriptDialog::~ExternalScriptDialog() {
+
+  runner->cancel();
+  runner->wait();
 }
 
 /**
@@ -134,6 +87,12 @@ void ExternalScriptDialog::set_finished(bool finished) {
   if (button != nullptr) {
     button->setEnabled(finished);
   }
+
+  // The Cancel button is only useful while the script is running.
+  button = ui.button_box->button(QDialogButtonBox::Cancel);
+  if (button != nullptr) {
+    button->setVisible(!finished);
+  }
 }
 
 /**
@@ -168,87 +127,83 @@ int ExternalScriptDialog::exec() {
   ui.status_label->setText(tr("In progress"));
   ui.status_label->setStyleSheet("font-weight: bold; color: orange");
 
-  // Use a timer to show the window before running the script.
-  // The script will start at the next event loop iteration.
-  // A thread could be used to show the output in real time,
-  // but the timer solution is enough for us.
-  QTimer* timer = new QTimer(this);
-  timer->setSingleShot(true);
-  connect(timer, SIGNAL(timeout()), this, SLOT(run_script()));
-  timer->start();
+  elapsed_timer.start();
+  elapsed_time_update_timer.start();
+  runner->start();
 
   return QDialog::exec();
 }
 
 /**
- * @brief Runs the script. Returns when the script is finished.
- *
- * This function does not throw exceptions, it outputs any error to the
- * text widget.
+ * @brief Closes the dialog, or cancels the script if it is still running.
  */
-void ExternalScriptDialog::run_script() {
+void ExternalScriptDialog::reject() {
 
-  successful = false;
-  QString output;
+  if (!is_finished()) {
+    // The dialog will be closable once the script is interrupted.
+    runner->cancel();
+    ui.status_label->setText(tr("Canceling..."));
+    return;
+  }
 
-  lua_State* l = luaL_newstate();
-  luaL_openlibs(l);
+  QDialog::reject();
+}
+
+/**
+ * @brief Slot called when the script has written some output.
+ */
+void ExternalScriptDialog::output_available() {
 
-  QString path = script_path + ".lua";
-  QFile script_file(path);
-  if (!script_file.open(QFileDevice::ReadOnly)) {
-    output = tr("Cannot open file '%1'").arg(path);
+  const QString& output = runner->take_output();
+  if (output.isEmpty()) {
+    return;
+  }
+
+  // Insert the text as is since the script controls its own line breaks.
+  QTextCursor cursor(ui.output_field->document());
+  cursor.movePosition(QTextCursor::End);
+  cursor.insertText(output);
+  ui.output_field->ensureCursorVisible();
+}
+
+/**
+ * @brief Shows the time elapsed since the script was started.
+ */
+void ExternalScriptDialog::update_elapsed_time() {
+
+  const QString& elapsed_time = tr("%1 s").arg(elapsed_timer.elapsed() / 1000.0, 0, 'f', 1);
+  if (is_finished()) {
+    ui.elapsed_time_label->setText(tr("Finished in %1").arg(elapsed_time));
   }
   else {
-    QByteArray buffer = script_file.readAll();
-    QByteArray path_utf8 = path.toUtf8();
-    if (luaL_loadbuffer(l, buffer.constData(), buffer.size(), path_utf8.constData()) != 0) {
-      // Loading the script failed.
-      output = QString::fromStdString(std::string(lua_tostring(l, -1)));
-    }
-    else {
-      // Make require able to find files relative to the script's directory.
-      lua_pushstring(l, path_utf8.constData());
-      lua_pushcclosure(l, l_loader_from_current_dir, 1);
-      lua_setglobal(l, "loader_from_current_dir");
-      luaL_dostring(l, "table.insert(package.loaders, 2, loader_from_current_dir)");  // TODO clean this
-
-      int num_arguments = 0;
-      if (!script_arg.isEmpty()) {
-        num_arguments = 1;
-        lua_pushstring(l, script_arg.toUtf8().constData());
-      }
-
-      // Redirect io.write() calls to a temporary file.
-      QTemporaryFile log_file;
-      log_file.open();   // Necessary to generate a name for the temporary file.
-      log_file.close();  // But close it: is it actually Lua that will write it
-                         // (we just wanted its name).
-      QByteArray lua_instruction_utf8 = ("io.output(\"" + log_file.fileName() + "\")").toUtf8();
-      luaL_dostring(l, lua_instruction_utf8.constData());
-
-      // Run the script.
-      if (lua_pcall(l, num_arguments, 0, 0) == 0) {
-        successful = true;
-      }
-
-      log_file.open();
-      output = QString::fromUtf8(log_file.readAll());
-    }
+    ui.elapsed_time_label->setText(elapsed_time);
   }
+}
 
-  lua_close(l);
-  ui.output_field->appendPlainText(output);
+/**
+ * @brief Slot called when the worker thread has finished running the script.
+ */
+void ExternalScriptDialog::script_finished() {
+
+  elapsed_time_update_timer.stop();
+  output_available();
+
+  successful = runner->is_successful();
   if (successful) {
     ui.status_label->setText(tr("Successful!"));
     ui.status_label->setStyleSheet("font-weight: bold; color: green");
   }
+  else if (runner->is_canceled()) {
+    ui.status_label->setText(tr("Canceled"));
+    ui.status_label->setStyleSheet("font-weight: bold; color: red");
+  }
   else {
     ui.status_label->setText(tr("Failure"));
     ui.status_label->setStyleSheet("font-weight: bold; color: red");
   }
 
   set_finished(true);
+  update_elapsed_time();
 }
 
 }
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "widgets/find_in_quest_dialog.h"
+#include "quest.h"
+#include "quest_search_index.h"
+#include <QElapsedTimer>
+#include <QSet>
+
+namespace SolarusEditor {
+
+namespace {
+
+/**
+ * @brief Maximum number of results shown.
+ */
+constexpr int max_results = 1000;
+
+}
+
+/**
+ * @brief Creates a find in quest dialog.
+ * @param quest The quest to search in.
+ * @param index The search index of this quest.
+ * @param parent The parent object or nullptr.
+ */
+FindInQuestDialog::FindInQuestDialog(
+    Quest& quest, QuestSearchIndex& index, QWidget* parent) :
+  QDialog(parent),
+  ui(),
+  quest(quest),
+  index(index) {
+
+  ui.setupUi(this);
+  ui.results_tree->setColumnWidth(0, 200);
+  ui.results_tree->setColumnWidth(1, 50);
+
+  connect(ui.find_field, SIGNAL(textChanged(QString)),
+          this, SLOT(update_results()));
+  connect(ui.results_tree, SIGNAL(itemActivated(QTreeWidgetItem*, int)),
+          this, SLOT(result_activated(QTreeWidgetItem*)));
+  connect(&index, SIGNAL(index_changed()),
+          this, SLOT(update_results()));
+}
+
+/**
+ * @brief Sets the text to search and updates the results.
+ * @param text The text to search.
+ */
+void FindInQuestDialog::set_text(const QString& text) {
+
+  ui.find_field->setText(text);
+  ui.find_field->selectAll();
+  ui.find_field->setFocus();
+}
+
+/**
+ * @brief Searches the current text and shows the results.
+ */
+void FindInQuestDialog::update_results() {
+
+  ui.results_tree->clear();
+
+  const QString& text = ui.find_field->text();
+  QString status;
+  if (!text.isEmpty()) {
+    QElapsedTimer timer;
+    timer.start();
+    const QList<QuestSearchIndex::Match> matches = index.find(text, max_results);
+    const qint64 elapsed = timer.elapsed();
+
+    QList<QTreeWidgetItem*> items;
+    QSet<QString> paths;
+    for (const QuestSearchIndex::Match& match : matches) {
+      QTreeWidgetItem* item = new QTreeWidgetItem();
+      item->setText(0, quest.get_path_relative_to_data_path(match.path));
+      item->setData(0, Qt::UserRole, match.path);
+      item->setText(1, QString::number(match.line));
+      item->setData(1, Qt::UserRole, match.line);
+      item->setText(2, match.line_text.trimmed());
+      items.append(item);
+      paths.insert(match.path);
+    }
+    ui.results_tree->addTopLevelItems(items);
+
+    if (matches.size() >= max_results) {
+      status = tr("More than %1 results (%2 ms)").arg(max_results).arg(elapsed);
+    }
+    else {
+      status = tr("%1 results in %2 files (%3 ms)").
+          arg(matches.size()).arg(paths.size()).arg(elapsed);
+    }
+  }
+
+  if (index.is_building()) {
+    status = tr("Indexing... %1").arg(status);
+  }
+  ui.status_label->setText(status);
+}
+
+/**
+ * @brief Slot called when the user activates a result.
+ * @param item The result activated.
+ */
+void FindInQuestDialog::result_activated(QTreeWidgetItem* item) {
+
+  if (item == nullptr) {
+    return;
+  }
+
+  emit open_file_requested(
+        item->data(0, Qt::UserRole).toString(),
+        item->data(1, Qt::UserRole).toInt());
+}
+
+}
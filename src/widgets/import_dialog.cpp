@@ -19,8 +19,18 @@
 #include "editor_exception.h"
 #include "editor_settings.h"
 #include "file_tools.h"
+#include <QCryptographicHash>
+#include <QDialogButtonBox>
+#include <QDirIterator>
 #include <QFileDialog>
+#include <QFutureWatcher>
+#include <QLabel>
+#include <QListWidget>
+#include <QProgressDialog>
+#include <QSet>
 #include <QTimer>
+#include <QVBoxLayout>
+#include <QtConcurrent>
 
 namespace SolarusEditor {
 
@@ -34,8 +44,7 @@ ImportDialog::ImportDialog(Quest& destination_quest, QWidget* parent) :
   QDialog(parent),
   ui(),
   source_quest(),
-  destination_quest(destination_quest),
-  last_confirm_overwrite_file(QMessageBox::No) {
+  destination_quest(destination_quest) {
 
   ui.setupUi(this);
 
@@ -175,9 +184,18 @@ void ImportDialog::find_missing_button_triggered() {
   QString selected_source_path = ui.source_quest_tree_view->get_selected_path();
   QString initial_source_path = !selected_source_path.isEmpty() ?
         selected_source_path : source_quest.get_data_path();
-  QStringList missing_source_paths;
   ui.source_quest_tree_view->expand_to_path(initial_source_path);  // TODO expand the directory
-  find_source_paths_not_in_destination_quest(initial_source_path, missing_source_paths);
+
+  QFuture<QStringList> future = QtConcurrent::run(
+        &ImportDialog::find_source_paths_not_in_destination_quest,
+        initial_source_path,
+        source_quest.get_root_path(),
+        destination_quest.get_root_path()
+  );
+  if (!wait_for_future(tr("Searching missing files..."), future)) {
+    return;
+  }
+  const QStringList& missing_source_paths = future.result();
 
   ui.source_quest_tree_view->set_selected_paths(missing_source_paths);
   ui.missing_files_count_label->setText(
@@ -188,46 +206,49 @@ void ImportDialog::find_missing_button_triggered() {
 }
 
 /**
- * @brief Checks if a path and its children exist in the destination quest.
+ * @brief Finds the paths of a source directory that don't exist in the
+ * destination quest.
  *
  * Only the existence of files is checked, not their content.
+ * This function is called from a worker thread.
  *
  * @param source_path The source path to check.
  * If it is a directory, it will be recursively explored.
- * @param[out] missing_source_paths List that will be appended with source
- * paths that have no equivalent in the destination quest.
+ * @param source_root_path Root path of the source quest.
+ * @param destination_root_path Root path of the destination quest.
+ * @return Source paths that have no equivalent in the destination quest.
  */
-void ImportDialog::find_source_paths_not_in_destination_quest(
+QStringList ImportDialog::find_source_paths_not_in_destination_quest(
     const QString& source_path,
-    QStringList& missing_source_paths
+    const QString& source_root_path,
+    const QString& destination_root_path
 ) {
+  QStringList missing_source_paths;
 
   QFileInfo source_info(source_path);
-  if (!source_info.exists()) {
-    return;
-  }
-  if (source_info.isSymLink()) {
-    return;
+  if (!source_info.exists() || source_info.isSymLink()) {
+    return missing_source_paths;
   }
 
-  QString destination_path = source_to_destination_path(source_path);
-  if (!QFileInfo(destination_path).exists()) {
-    // Found a missing one.
-    missing_source_paths << source_path;
+  QStringList source_paths;
+  source_paths << source_path;
+  if (source_info.isDir()) {
+    QDirIterator it(source_path,
+                    QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+      source_paths << it.next();
+    }
   }
 
-  if (source_info.isDir()) {
-    // Recursively explore the directory.
-    const QStringList& source_children_file_names = QDir(source_path).entryList();
-    for (const QString& source_child_file_name : source_children_file_names) {
-      if (source_child_file_name == "." ||
-          source_child_file_name == ".." ) {
-        continue;
-      }
-      QString source_child_path = QString("%1/%2").arg(source_path, source_child_file_name);
-      find_source_paths_not_in_destination_quest(source_child_path, missing_source_paths);
+  for (const QString& path : source_paths) {
+    const QString& destination_path = destination_root_path + path.mid(source_root_path.size());
+    if (!QFileInfo::exists(destination_path)) {
+      // Found a missing one.
+      missing_source_paths << path;
     }
   }
+  return missing_source_paths;
 }
 
 /**
@@ -239,194 +260,358 @@ void ImportDialog::update_import_button() {
 }
 
 /**
- * @brief Slot called when the user clicks the "Import" button.
+ * @brief Shows a progress dialog until a background operation is finished.
+ * @param label Text describing the operation.
+ * @param future The background operation.
+ * @return @c false if the user canceled the operation.
  */
-void ImportDialog::import_button_triggered() {
+template<typename T>
+bool ImportDialog::wait_for_future(const QString& label, QFuture<T> future) {
+
+  QProgressDialog progress_dialog(label, tr("Cancel"), 0, 0, this);
+  progress_dialog.setWindowModality(Qt::WindowModal);
+  progress_dialog.setAutoClose(false);
+  progress_dialog.setAutoReset(false);
+  progress_dialog.setMinimumDuration(0);
+
+  QFutureWatcher<T> watcher;
+  connect(&watcher, SIGNAL(progressRangeChanged(int, int)),
+          &progress_dialog, SLOT(setRange(int, int)));
+  connect(&watcher, SIGNAL(progressValueChanged(int)),
+          &progress_dialog, SLOT(setValue(int)));
+  connect(&watcher, SIGNAL(finished()),
+          &progress_dialog, SLOT(accept()));
+  connect(&progress_dialog, SIGNAL(canceled()),
+          &watcher, SLOT(cancel()));
+  watcher.setFuture(future);
+
+  progress_dialog.exec();
+  watcher.waitForFinished();
+  return !watcher.isCanceled();
+}
 
-  last_confirm_overwrite_file = QMessageBox::No;
-  paths_to_select.clear();
-  ui.missing_files_count_label->clear();
+/**
+ * @brief Lists the files and directories to import.
+ *
+ * This function is called from a worker thread.
+ *
+ * @param source_paths Paths selected in the source quest.
+ * @param source_root_path Root path of the source quest.
+ * @param destination_root_path Root path of the destination quest.
+ * @return The files and directories to import, parents first.
+ */
+QVector<ImportDialog::ImportEntry> ImportDialog::list_entries(
+    const QStringList& source_paths,
+    const QString& source_root_path,
+    const QString& destination_root_path
+) {
+  QVector<ImportEntry> entries;
+  QSet<QString> listed_paths;
 
-  try {
-    const QStringList& source_paths = ui.source_quest_tree_view->get_selected_paths();
-    for (const QString& source_path : source_paths) {
-      import_path(source_path);
+  const auto& add_entry = [&](const QFileInfo& source_info) {
+    const QString& source_path = source_info.filePath();
+    if (listed_paths.contains(source_path)) {
+      // Already listed as the child of another selected directory.
+      return;
     }
-  }
-  catch (const EditorException& ex) {
-    GuiTools::error_dialog(ex.get_message());
-  }
+    listed_paths.insert(source_path);
+
+    ImportEntry entry;
+    entry.source_path = source_path;
+    entry.destination_path = destination_root_path + source_path.mid(source_root_path.size());
+    entry.is_dir = source_info.isDir();
+    entry.exists = false;
+    entry.identical = false;
+    entry.overwrite = false;
+    entry.copied = false;
+    if (source_info.isSymLink()) {
+      entry.error = tr("Cannot import symbolic link '%1'").arg(source_path);
+    }
+    else if (!source_info.isReadable()) {
+      entry.error = tr("Source file cannot be read: '%1'").arg(source_path);
+    }
+    entries << entry;
+  };
 
-  destination_quest.get_database().save();
-  ui.destination_quest_tree_view->setFocus();
-  QTimer::singleShot(200, this, SLOT(select_recently_created_paths()));
+  for (const QString& source_path : source_paths) {
+    QFileInfo source_info(source_path);
+    if (!source_info.exists()) {
+      // Path in the tree but not on the filesystem:
+      // maybe a declared resource that is missing.
+      continue;
+    }
+    add_entry(source_info);
+
+    if (source_info.isDir() && !source_info.isSymLink()) {
+      QDirIterator it(source_path,
+                      QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
+                      QDirIterator::Subdirectories);
+      while (it.hasNext()) {
+        it.next();
+        add_entry(it.fileInfo());
+      }
+    }
+  }
+  return entries;
 }
 
 /**
- * @brief Imports the given file or directory into the destination quest.
- * @param source_path Path or the file or directory to import.
+ * @brief Compares a source file with its destination if it exists.
+ *
+ * Files of the same size are compared by hashing their content.
+ * This function is called from worker threads.
+ *
+ * @param entry The file or directory to compare.
  */
-void ImportDialog::import_path(const QString& source_path) {
+void ImportDialog::compare_entry(ImportEntry& entry) {
 
-  QFileInfo source_info(source_path);
-  if (source_info.isSymLink()) {
-    throw EditorException(tr("Cannot import symbolic link '%1'").arg(source_path));
+  if (!entry.error.isEmpty()) {
+    return;
   }
 
-  if (source_info.isDir()) {
-    import_dir(source_info);
+  QFileInfo destination_info(entry.destination_path);
+  entry.exists = destination_info.exists();
+  if (!entry.exists) {
+    return;
   }
-  else {
-    import_file(source_info);
+
+  if (entry.is_dir) {
+    if (!destination_info.isDir()) {
+      entry.error = tr("Destination path already exists and is not a directory: '%1'").arg(entry.destination_path);
+    }
+    return;
   }
-}
 
-/**
- * @brief Imports the given file into the destination quest.
- * @param source_file File to import.
- */
-void ImportDialog::import_file(const QFileInfo& source_info) {
+  if (destination_info.isDir()) {
+    entry.error = tr("Destination path already exists and is a folder: '%1'").arg(entry.destination_path);
+    return;
+  }
 
-  const QString& source_path = source_info.filePath();
-  if (!source_info.exists()) {
-    throw EditorException(QApplication::tr("Source file does not exist: '%1'").arg(source_path));
+  if (QFileInfo(entry.source_path).size() != destination_info.size()) {
+    return;
   }
 
-  if (source_info.isDir()) {
-    throw EditorException(QApplication::tr("Source path is a folder: '%1'").arg(source_path));
+  QFile source_file(entry.source_path);
+  QFile destination_file(entry.destination_path);
+  if (!source_file.open(QIODevice::ReadOnly) ||
+      !destination_file.open(QIODevice::ReadOnly)) {
+    return;
   }
 
-  if (source_info.isSymLink()) {
-    throw EditorException(QApplication::tr("Source file is a symbolic link: '%1'").arg(source_path));
+  QCryptographicHash source_hash(QCryptographicHash::Sha1);
+  QCryptographicHash destination_hash(QCryptographicHash::Sha1);
+  source_hash.addData(&source_file);
+  destination_hash.addData(&destination_file);
+  entry.identical = source_hash.result() == destination_hash.result();
+}
+
+/**
+ * @brief Copies a file to the destination quest.
+ *
+ * Does nothing if the file should not be copied.
+ * This function is called from worker threads.
+ *
+ * @param entry The file to copy.
+ */
+void ImportDialog::copy_entry(ImportEntry& entry) {
+
+  if (entry.is_dir ||
+      !entry.error.isEmpty() ||
+      entry.identical ||
+      (entry.exists && !entry.overwrite)) {
+    return;
   }
 
-  if (!source_info.isReadable()) {
-    throw EditorException(QApplication::tr("Source file cannot be read: '%1'").arg(source_path));
+  if (entry.exists && !QFile::remove(entry.destination_path)) {
+    entry.error = tr("Failed to remove existing file '%1'").arg(entry.destination_path);
+    return;
   }
 
-  QString destination_path = source_to_destination_path(source_path);
-  QFileInfo destination_info(destination_path);
-  if (destination_info.exists()) {
-    if (destination_info.isDir()) {
-      throw EditorException(tr("Destination path already exists and is a folder: '%1'").arg(destination_path));
-    }
+  if (!QFile::copy(entry.source_path, entry.destination_path)) {
+    entry.error = tr("Failed to copy file '%1' to '%2'").arg(entry.source_path, entry.destination_path);
+    return;
+  }
+  entry.copied = true;
+}
 
-    if (last_confirm_overwrite_file == QMessageBox::NoToAll) {
-      return;
-    }
+/**
+ * @brief Asks the user which existing destination files to overwrite.
+ *
+ * All files that exist with a different content are shown in a single
+ * dialog.
+ *
+ * @param entries The entries to import.
+ * Their overwrite flag is updated.
+ * @return @c false if the user canceled the whole import.
+ */
+bool ImportDialog::confirm_overwrites(QVector<ImportEntry>& entries) {
 
-    if (last_confirm_overwrite_file != QMessageBox::YesToAll) {
-      last_confirm_overwrite_file = QMessageBox::question(
-            this,
-            tr("Destination file already exists"),
-            tr("The destination file '%1' already exists.\nDo you want to overwrite it?").arg(destination_path),
-            QMessageBox::Yes | QMessageBox::YesToAll | QMessageBox::No | QMessageBox::NoToAll | QMessageBox::Cancel
-      );
-
-      if (last_confirm_overwrite_file != QMessageBox::Yes &&
-          last_confirm_overwrite_file != QMessageBox::YesToAll) {
-        return;
-      }
+  QList<int> conflicts;
+  for (int i = 0; i < entries.size(); ++i) {
+    const ImportEntry& entry = entries[i];
+    if (!entry.is_dir && entry.exists && !entry.identical && entry.error.isEmpty()) {
+      conflicts << i;
     }
+  }
 
-    if (!QFile::remove(destination_path)) {
-      throw EditorException(tr("Failed to remove existing file '%1'").arg(destination_path));
-    }
+  if (conflicts.isEmpty()) {
+    return true;
   }
 
-  // Copy author and license info.
-  import_path_meta_information(source_path, destination_path);
+  QDialog dialog(this);
+  dialog.setWindowTitle(tr("Destination files already exist"));
+  QVBoxLayout* layout = new QVBoxLayout(&dialog);
+  layout->addWidget(new QLabel(
+      tr("%1 files already exist in the destination quest with a different content.\n"
+         "Select the ones to overwrite:").arg(conflicts.size()), &dialog));
+
+  QListWidget* list = new QListWidget(&dialog);
+  for (int index : conflicts) {
+    QListWidgetItem* item = new QListWidgetItem(
+          destination_quest.get_path_relative_to_data_path(entries[index].destination_path), list);
+    item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+    item->setCheckState(Qt::Checked);
+  }
+  layout->addWidget(list);
 
-  // Ensure that the destination directory exists.
-  QString destination_parent_path = destination_info.path();  // Strip the file name part.
-  FileTools::create_directories(destination_parent_path);
+  QDialogButtonBox* button_box = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+  connect(button_box, SIGNAL(accepted()), &dialog, SLOT(accept()));
+  connect(button_box, SIGNAL(rejected()), &dialog, SLOT(reject()));
+  layout->addWidget(button_box);
+  dialog.resize(500, 400);
 
-  if (!QFile::copy(source_path, destination_path)) {
-    throw EditorException(tr("Failed to copy file '%1' to '%2'").arg(source_path, destination_path));
+  if (dialog.exec() != QDialog::Accepted) {
+    return false;
   }
 
-  // Handle declared resources.
-  ResourceType resource_type;
-  QString element_id;
-  if (source_quest.is_resource_element(source_path, resource_type, element_id)) {
-    const QString& description = source_quest.get_database().get_description(resource_type, element_id);
-    QuestDatabase& destination_database = destination_quest.get_database();
-    destination_database.add(resource_type, element_id, description);
+  for (int i = 0; i < conflicts.size(); ++i) {
+    entries[conflicts[i]].overwrite = list->item(i)->checkState() == Qt::Checked;
   }
-
-  paths_to_select << destination_path;
+  return true;
 }
 
 /**
- * @brief Imports the given directory into the destination quest.
- * @param source_dir The directory to import.
+ * @brief Slot called when the user clicks the "Import" button.
  */
-void ImportDialog::import_dir(const QFileInfo& source_info) {
+void ImportDialog::import_button_triggered() {
+
+  paths_to_select.clear();
+  ui.missing_files_count_label->clear();
+
+  const QStringList& source_paths = ui.source_quest_tree_view->get_selected_paths();
 
-  const QString& source_path = source_info.filePath();
-  if (!source_info.exists()) {
-    throw EditorException(QApplication::tr("Source folder does not exist: '%1'").arg(source_path));
+  // List files to import and compare them with existing ones.
+  QFuture<QVector<ImportEntry>> list_future = QtConcurrent::run(
+        &ImportDialog::list_entries,
+        source_paths,
+        source_quest.get_root_path(),
+        destination_quest.get_root_path()
+  );
+  if (!wait_for_future(tr("Listing files to import..."), list_future)) {
+    return;
   }
+  QVector<ImportEntry> entries = list_future.result();
 
-  if (!source_info.isDir()) {
-    throw EditorException(QApplication::tr("Source path is not a folder: '%1'").arg(source_path));
+  if (!wait_for_future(tr("Comparing files..."),
+                       QtConcurrent::map(entries, &ImportDialog::compare_entry))) {
+    return;
   }
 
-  if (!source_info.isReadable()) {
-    throw EditorException(QApplication::tr("Source folder cannot be read: '%1'").arg(source_path));
+  if (!confirm_overwrites(entries)) {
+    return;
   }
 
-  QString destination_path = source_to_destination_path(source_path);
-  QFileInfo destination_info(destination_path);
-  if (destination_info.exists()) {
-    if (!destination_info.isDir()) {
-      throw EditorException(tr("Destination path already exists and is not a directory: '%1'").arg(destination_path));
+  // Create directories first.
+  QSet<QString> directories;
+  for (const ImportEntry& entry : entries) {
+    if (!entry.error.isEmpty()) {
+      continue;
     }
+    directories.insert(entry.is_dir ?
+                         entry.destination_path :
+                         QFileInfo(entry.destination_path).path());
+  }
 
-    ui.destination_quest_tree_view->expand_to_path(destination_path);
-
-    if (last_confirm_overwrite_directory == QMessageBox::NoToAll) {
-      return;
+  try {
+    for (const QString& directory : directories) {
+      FileTools::create_directories(directory);
     }
+  }
+  catch (const EditorException& ex) {
+    GuiTools::error_dialog(ex.get_message());
+    return;
+  }
 
-    if (last_confirm_overwrite_directory != QMessageBox::YesToAll) {
-      last_confirm_overwrite_directory = QMessageBox::question(
-            this,
-            tr("Destination folder already exists"),
-            tr("The destination folder '%1' already exists.\nDo you want to merge it with the contents from the source folder?").arg(destination_path),
-            QMessageBox::Yes | QMessageBox::YesToAll | QMessageBox::No | QMessageBox::NoToAll | QMessageBox::Cancel
-      );
-
-      if (last_confirm_overwrite_directory != QMessageBox::Yes &&
-          last_confirm_overwrite_directory != QMessageBox::YesToAll) {
-        return;
-      }
+  // Copy files in parallel.
+  wait_for_future(tr("Importing files..."),
+                  QtConcurrent::map(entries, &ImportDialog::copy_entry));
+
+  // Declare new resources and save the resource list once.
+  register_imported_entries(entries);
+
+  QStringList errors;
+  for (const ImportEntry& entry : entries) {
+    if (!entry.error.isEmpty()) {
+      errors << entry.error;
     }
   }
+  if (!errors.isEmpty()) {
+    constexpr int max_errors_shown = 10;
+    QString message = QStringList(errors.mid(0, max_errors_shown)).join('\n');
+    if (errors.size() > max_errors_shown) {
+      message += '\n' + tr("(%1 more errors)").arg(errors.size() - max_errors_shown);
+    }
+    GuiTools::error_dialog(message);
+  }
+
+  for (const QString& source_path : source_paths) {
+    paths_to_select << source_to_destination_path(source_path);
+  }
+
+  ui.destination_quest_tree_view->setFocus();
+  QTimer::singleShot(200, this, SLOT(select_recently_created_paths()));
+}
 
-  // Copy author and license info.
-  import_path_meta_information(source_path, destination_path);
+/**
+ * @brief Updates the destination quest database after files were copied.
+ *
+ * Copies author and license information and declares resource elements
+ * in a single transaction, so that the resource list is written once.
+ *
+ * @param entries The entries that were imported.
+ */
+void ImportDialog::register_imported_entries(const QVector<ImportEntry>& entries) {
 
-  // Create the directory itself.
-  FileTools::create_directories(destination_path);
+  QuestDatabase& destination_database = destination_quest.get_database();
+  const QuestDatabase& source_database = source_quest.get_database();
+  QuestDatabase::Transaction transaction(destination_database);
 
-  // Copy children.
-  const QStringList& source_children_file_names = QDir(source_path).entryList();
-  for (const QString& source_child_file_name : source_children_file_names) {
-    if (source_child_file_name == "." ||
-        source_child_file_name == ".." ) {
+  for (const ImportEntry& entry : entries) {
+    // Identical files were not copied but are imported too.
+    if (!entry.error.isEmpty() || (!entry.is_dir && !entry.copied && !entry.identical)) {
       continue;
     }
-    QString source_child_path = QString("%1/%2").arg(source_path, source_child_file_name);
-    if (!QFileInfo(source_child_path).exists()) {
-      // Path in the tree but not on the filesystem:
-      // maybe a declared resource that is missing.
-      continue;
+
+    // Copy author and license info.
+    import_path_meta_information(entry.source_path, entry.destination_path);
+
+    // Handle declared resources.
+    ResourceType resource_type;
+    QString element_id;
+    if (!entry.is_dir &&
+        source_quest.is_resource_element(entry.source_path, resource_type, element_id)) {
+      const QString& description = source_database.get_description(resource_type, element_id);
+      destination_database.add(resource_type, element_id, description);
     }
-    import_path(source_child_path);
   }
 
-  paths_to_select << destination_path;
+  try {
+    destination_database.save();
+  }
+  catch (const EditorException& ex) {
+    GuiTools::error_dialog(ex.get_message());
+  }
 }
 
 /**
@@ -444,7 +629,7 @@ void ImportDialog::import_path_meta_information(
   destination_database.set_file_author(destination_relative_path,
                                        source_database.get_file_author(source_relative_path));
   destination_database.set_file_license(destination_relative_path,
-                                        source_database.get_file_license(destination_relative_path));
+                                        source_database.get_file_license(source_relative_path));
 }
 
 /**
@@ -15,82 +15,182 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "widgets/lua_syntax_highlighter.h"
-#include <QVariant>
+#include <QStringRef>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTimer>
 
 namespace SolarusEditor {
 
+namespace {
+
+/**
+ * @brief Number of lines highlighted per event loop iteration.
+ */
+constexpr int lines_per_slice = 500;
+
+/**
+ * @brief Lua keywords.
+ */
+const char* const keywords[] = {
+  "and", "break", "do", "else", "elseif", "end", "false", "for",
+  "function", "goto", "if", "in", "local", "nil", "not", "or",
+  "repeat", "return", "then", "true", "until", "while"
+};
+
+/**
+ * @brief Returns whether a word of a line is a Lua keyword.
+ * @param text The line.
+ * @param index Index of the word in the line.
+ * @param length Length of the word.
+ * @return @c true if this is a keyword.
+ */
+bool is_keyword(const QString& text, int index, int length) {
+
+  if (length < 2 || length > 8) {
+    return false;
+  }
+
+  const QStringRef word(&text, index, length);
+  for (const char* keyword : keywords) {
+    if (word == QLatin1String(keyword)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Returns whether a character can be part of a Lua identifier.
+ * @param c The character to test.
+ * @return @c true if it is a letter, a digit or an underscore.
+ */
+bool is_identifier_char(QChar c) {
+
+  return c.isLetterOrNumber() || c == '_';
+}
+
+/**
+ * @brief Parses an opening long bracket like [[ or [==[.
+ * @param text The line.
+ * @param index Index where the opening long bracket is expected.
+ * @return The level of the long bracket (number of '=' signs),
+ * or -1 if there is no opening long bracket at this index.
+ */
+int get_long_bracket_level(const QString& text, int index) {
+
+  const int length = text.length();
+  if (index >= length || text.at(index) != '[') {
+    return -1;
+  }
+
+  int level = 0;
+  ++index;
+  while (index < length && text.at(index) == '=') {
+    ++level;
+    ++index;
+  }
+
+  if (index >= length || text.at(index) != '[') {
+    return -1;
+  }
+  return level;
+}
+
+}
+
 /**
  * @brief Creates a Lua syntax highlighter.
  * @param document The text document to highlight.
  */
 LuaSyntaxHighlighter::LuaSyntaxHighlighter(QTextDocument* document) :
-    QSyntaxHighlighter(document) {
-
-  HighlightingRule rule;
+  QSyntaxHighlighter(document),
+  remaining_lines_in_slice(lines_per_slice),
+  slice_scheduled(false),
+  first_pending_block(-1),
+  priority_block_number(-1) {
 
-  // The following awful regexp beginning can be used to match things that are
-  // not in a string.
-  // To do that, we check that the number of quotes and double-quotes is even.
-  // (Keeping state information would probably be more readable.)
-  QString not_in_a_single_line_string = "^[^\"']*(?:\"[^\"]*\"[^\"'']*|\'[^\']*\'[^\"']*)*";
-
-  // Keywords.
   keyword_format.setForeground(Qt::darkRed);
   keyword_format.setFontWeight(QFont::Bold);
-  QStringList keyword_patterns;
-  keyword_patterns << "\\band\\b"
-                   << "\\bbreak\\b"
-                   << "\\bdo\\b"
-                   << "\\belse\\b"
-                   << "\\belseif\\b"
-                   << "\\bend\\b"
-                   << "\\bfalse\\b"
-                   << "\\bfor\\b"
-                   << "\\bfunction\\b"
-                   << "\\bif\\b"
-                   << "\\bin\\b"
-                   << "\\blocal\\b"
-                   << "\\bnil\\b"
-                   << "\\bnot\\b"
-                   << "\\bor\\b"
-                   << "\\brepeat\\b"
-                   << "\\breturn\\b"
-                   << "\\bthen\\b"
-                   << "\\btrue\\b"
-                   << "\\buntil\\b"
-                   << "\\bwhile\\b";
-
-  for (const QString& pattern : keyword_patterns) {
-    rule.pattern = QRegExp(pattern);
-    rule.format = keyword_format;
-    rules.append(rule);
-  }
-
-  // Strings.
+
   string_format.setForeground(Qt::blue);
-  rule.pattern = QRegExp("\"[^\"]*\"");
-  rule.format = string_format;
-  rules.append(rule);
-
-  rule.pattern = QRegExp("'[^']*'");
-  rule.format = string_format;
-  rules.append(rule);
-
-  // Comments.
-  single_line_comment_format.setForeground(Qt::darkGreen);
-  // Avoid to highlight comments in strings,
-  // and don't match --[[ or --]] markers.
-  rule.pattern = QRegExp(
-        not_in_a_single_line_string +
-        R"((--([^\[\]]|\[[^\[]|\][^\]])[^\n]*$)$)"
-  );
-  rule.format = single_line_comment_format;
-  rules.append(rule);
-
-  comment_start_pattern = QRegExp("--\\[\\[");
-  comment_end_pattern = QRegExp("--\\]\\]");
-  multi_line_comment_format.setForeground(
-        single_line_comment_format.foreground());
+
+  comment_format.setForeground(Qt::darkGreen);
+}
+
+/**
+ * @brief Builds a block state value.
+ * @param kind Kind of lexer state.
+ * @param level Level of the long bracket if inside a long comment or string.
+ * @return The corresponding block state.
+ */
+int LuaSyntaxHighlighter::make_state(LexerState kind, int level) {
+
+  if (kind == STATE_NORMAL || kind == STATE_PENDING) {
+    return kind;
+  }
+  return kind | (level << 2);
+}
+
+/**
+ * @brief Returns the kind of lexer state stored in a block state.
+ * @param state A block state.
+ * @return The kind of lexer state.
+ */
+LuaSyntaxHighlighter::LexerState LuaSyntaxHighlighter::get_state_kind(int state) {
+
+  if (state == STATE_PENDING) {
+    return STATE_PENDING;
+  }
+  if (state <= 0) {
+    return STATE_NORMAL;
+  }
+  return static_cast<LexerState>(state & 3);
+}
+
+/**
+ * @brief Returns the long bracket level stored in a block state.
+ * @param state A block state.
+ * @return The long bracket level.
+ */
+int LuaSyntaxHighlighter::get_state_level(int state) {
+
+  if (state <= 0) {
+    return 0;
+  }
+  return state >> 2;
+}
+
+/**
+ * @brief Finds the closing long bracket of the given level.
+ * @param text The line.
+ * @param index Index where to start the search.
+ * @param level Level of the long bracket.
+ * @return The index just after the closing long bracket,
+ * or -1 if it is not on this line.
+ */
+int LuaSyntaxHighlighter::find_long_bracket_end(
+    const QString& text, int index, int level) const {
+
+  const int length = text.length();
+  while (index < length) {
+    if (text.at(index) == ']') {
+      int i = index + 1;
+      int num_equals = 0;
+      while (i < length && text.at(i) == '=') {
+        ++num_equals;
+        ++i;
+      }
+      if (num_equals == level && i < length && text.at(i) == ']') {
+        return i + 1;
+      }
+      index = i;
+    }
+    else {
+      ++index;
+    }
+  }
+  return -1;
 }
 
 /**
@@ -99,41 +199,221 @@ LuaSyntaxHighlighter::LuaSyntaxHighlighter(QTextDocument* document) :
  */
 void LuaSyntaxHighlighter::highlightBlock(const QString& text) {
 
-  for (const HighlightingRule& rule : rules) {
-    QRegExp pattern(rule.pattern);
-    int index = pattern.indexIn(text);
-    if (pattern.captureCount() > 0) {
-      index = pattern.pos(1);
+  const int previous_state = previousBlockState();
+  const int block_number = currentBlock().blockNumber();
+
+  if (previous_state == STATE_PENDING ||
+      (remaining_lines_in_slice <= 0 && block_number > priority_block_number)) {
+    // Too much work for now: let the event loop run and come back later.
+    setCurrentBlockState(STATE_PENDING);
+    if (first_pending_block == -1 || block_number < first_pending_block) {
+      first_pending_block = block_number;
+    }
+    schedule_next_slice();
+    return;
+  }
+
+  --remaining_lines_in_slice;
+  schedule_next_slice();
+
+  const int length = text.length();
+  int index = 0;
+
+  // Continue a long comment or long string from the previous line.
+  const LexerState previous_kind = get_state_kind(previous_state);
+  if (previous_kind == STATE_LONG_COMMENT || previous_kind == STATE_LONG_STRING) {
+    const QTextCharFormat& format = previous_kind == STATE_LONG_COMMENT ?
+          comment_format : string_format;
+    const int end = find_long_bracket_end(text, 0, get_state_level(previous_state));
+    if (end == -1) {
+      setFormat(0, length, format);
+      setCurrentBlockState(previous_state);
+      return;
+    }
+    setFormat(0, end, format);
+    index = end;
+  }
+
+  while (index < length) {
+
+    const QChar c = text.at(index);
+
+    if (c == '-' && index + 1 < length && text.at(index + 1) == '-') {
+      // Comment.
+      const int level = get_long_bracket_level(text, index + 2);
+      if (level == -1) {
+        // Single-line comment.
+        setFormat(index, length - index, comment_format);
+        break;
+      }
+
+      const int end = find_long_bracket_end(text, index + level + 4, level);
+      if (end == -1) {
+        setFormat(index, length - index, comment_format);
+        setCurrentBlockState(make_state(STATE_LONG_COMMENT, level));
+        return;
+      }
+      setFormat(index, end - index, comment_format);
+      index = end;
+    }
+    else if (c == '"' || c == '\'') {
+      // Single-line string.
+      const int start = index;
+      ++index;
+      while (index < length) {
+        const QChar current = text.at(index);
+        if (current == '\\') {
+          index += 2;
+          continue;
+        }
+        ++index;
+        if (current == c) {
+          break;
+        }
+      }
+      index = qMin(index, length);
+      setFormat(start, index - start, string_format);
+    }
+    else if (c == '[') {
+      const int level = get_long_bracket_level(text, index);
+      if (level == -1) {
+        ++index;
+        continue;
+      }
+
+      // Long string.
+      const int end = find_long_bracket_end(text, index + level + 2, level);
+      if (end == -1) {
+        setFormat(index, length - index, string_format);
+        setCurrentBlockState(make_state(STATE_LONG_STRING, level));
+        return;
+      }
+      setFormat(index, end - index, string_format);
+      index = end;
+    }
+    else if (c.isLetter() || c == '_') {
+      // Identifier or keyword.
+      const int start = index;
+      while (index < length && is_identifier_char(text.at(index))) {
+        ++index;
+      }
+      if (is_keyword(text, start, index - start)) {
+        setFormat(start, index - start, keyword_format);
+      }
     }
-    while (index >= 0) {
-      int length = pattern.matchedLength();
-      if (pattern.captureCount() > 0) {
-        length = pattern.capturedTexts()[0].size();
+    else if (c.isDigit()) {
+      // Number: skip it entirely so that hexadecimal digits
+      // are not mistaken for the start of an identifier.
+      while (index < length &&
+             (is_identifier_char(text.at(index)) || text.at(index) == '.')) {
+        ++index;
       }
-      setFormat(index, length, rule.format);
-      index = pattern.indexIn(text, index + length);
     }
+    else {
+      ++index;
+    }
+  }
+
+  setCurrentBlockState(STATE_NORMAL);
+}
+
+/**
+ * @brief Schedules the next highlighting slice if not already done.
+ *
+ * The slice runs when the event loop becomes idle.
+ * It resets the number of lines allowed and continues highlighting
+ * pending lines if any.
+ */
+void LuaSyntaxHighlighter::schedule_next_slice() {
+
+  if (slice_scheduled) {
+    return;
   }
-  setCurrentBlockState(0);
 
-  int start_index = 0;
-  if (previousBlockState() != 1) {
-    start_index = comment_start_pattern.indexIn(text);
+  slice_scheduled = true;
+  QTimer::singleShot(0, this, SLOT(highlight_next_slice()));
+}
+
+/**
+ * @brief Returns the first block that is not highlighted yet.
+ * @return The first pending block, or an invalid block if there is none.
+ */
+QTextBlock LuaSyntaxHighlighter::find_first_pending_block() const {
+
+  QTextDocument* document = this->document();
+  if (document == nullptr || first_pending_block == -1) {
+    return QTextBlock();
   }
 
-  while (start_index >= 0) {
-    int end_index = comment_end_pattern.indexIn(text, start_index);
-    int comment_length;
-    if (end_index == -1) {
-      setCurrentBlockState(1);
-      comment_length = text.length() - start_index;
-    } else {
-      comment_length = end_index - start_index
-          + comment_end_pattern.matchedLength();
+  // The hint may be outdated if lines were added or removed since.
+  QTextBlock block = document->findBlockByNumber(first_pending_block);
+  if (!block.isValid() || block.userState() != STATE_PENDING) {
+    block = document->begin();
+    while (block.isValid() && block.userState() != STATE_PENDING) {
+      block = block.next();
+    }
+    if (!block.isValid()) {
+      return QTextBlock();
     }
-    setFormat(start_index, comment_length, multi_line_comment_format);
-    start_index = comment_start_pattern.indexIn(text, start_index + comment_length);
   }
+
+  while (block.previous().isValid() &&
+         block.previous().userState() == STATE_PENDING) {
+    block = block.previous();
+  }
+  return block;
+}
+
+/**
+ * @brief Starts a new highlighting slice.
+ *
+ * Called when the event loop is idle.
+ */
+void LuaSyntaxHighlighter::highlight_next_slice() {
+
+  slice_scheduled = false;
+  remaining_lines_in_slice = lines_per_slice;
+
+  const QTextBlock block = find_first_pending_block();
+  first_pending_block = -1;
+  if (!block.isValid()) {
+    return;
+  }
+
+  // Highlighting this block continues on next ones as long as
+  // their state changes, until the slice is over.
+  rehighlightBlock(block);
+}
+
+/**
+ * @brief Immediately highlights pending lines up to the given one.
+ *
+ * Call this function when lines become visible.
+ * Does nothing if the line is already highlighted.
+ *
+ * @param block_number Number of the last block to highlight.
+ */
+void LuaSyntaxHighlighter::highlight_until(int block_number) {
+
+  QTextDocument* document = this->document();
+  if (document == nullptr || first_pending_block == -1) {
+    return;
+  }
+
+  const QTextBlock last_block = document->findBlockByNumber(block_number);
+  if (!last_block.isValid() || last_block.userState() != STATE_PENDING) {
+    return;
+  }
+
+  const QTextBlock block = find_first_pending_block();
+  first_pending_block = -1;
+  if (!block.isValid()) {
+    return;
+  }
+
+  priority_block_number = block_number;
+  rehighlightBlock(block);
+  priority_block_number = -1;
 }
 
 }
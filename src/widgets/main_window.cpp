@@ -15,14 +15,20 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "entities/entity_traits.h"
+#include "widgets/audio_report_dialog.h"
 #include "widgets/change_resource_id_dialog.h"
 #include "widgets/editor.h"
 #include "widgets/enum_menus.h"
 #include "widgets/external_script_dialog.h"
+#include "widgets/find_in_quest_dialog.h"
 #include "widgets/gui_tools.h"
 #include "widgets/import_dialog.h"
 #include "widgets/main_window.h"
 #include "widgets/pair_spin_box.h"
+#include "widgets/text_editor.h"
+#include "widgets/texture_report_dialog.h"
+#include "widgets/translation_matrix_dialog.h"
+#include "widgets/world_view.h"
 #include "audio.h"
 #include "file_tools.h"
 #include "map_model.h"
@@ -41,6 +47,7 @@
 #include <QFileDialog>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QToolButton>
 #include <QUndoGroup>
 
@@ -55,6 +62,12 @@ using EntityType = Solarus::EntityType;
 MainWindow::MainWindow(QWidget* parent) :
   QMainWindow(parent),
   quest_runner(),
+  search_index(quest),
+  find_in_quest_dialog(nullptr),
+  world_view(nullptr),
+  translation_matrix_dialog(nullptr),
+  audio_report_dialog(nullptr),
+  texture_report_dialog(nullptr),
   recent_quests_menu(nullptr),
   zoom_menu(nullptr),
   zoom_button(nullptr),
@@ -176,6 +189,10 @@ MainWindow::MainWindow(QWidget* parent) :
   ui.action_select_all->setShortcut(QKeySequence::SelectAll);
   ui.action_unselect_all->setShortcut(QKeySequence::Deselect);
   ui.action_find->setShortcut(QKeySequence::Find);
+  ui.action_find_in_quest->setShortcut(QKeySequence(tr("Ctrl+Shift+F")));
+  ui.action_find_in_quest->setEnabled(false);
+  ui.action_audio_report->setEnabled(false);
+  ui.action_texture_report->setEnabled(false);
 
   // Workaround for broken window shortcuts with appmenu-qt on Ubuntu.
   addAction(ui.action_new_quest);
@@ -191,6 +208,7 @@ MainWindow::MainWindow(QWidget* parent) :
   addAction(ui.action_select_all);
   addAction(ui.action_unselect_all);
   addAction(ui.action_find);
+  addAction(ui.action_find_in_quest);
   addAction(ui.action_save_all);
   addAction(ui.action_close_all);
   addAction(ui.action_open_quest_properties);
@@ -212,6 +230,10 @@ MainWindow::MainWindow(QWidget* parent) :
           ui.tab_widget, SLOT(open_file_requested(Quest&, QString)));
   connect(ui.quest_tree_view, SIGNAL(rename_file_requested(Quest&, QString)),
           this, SLOT(rename_file_requested(Quest&, QString)));
+  connect(ui.quest_tree_view, SIGNAL(show_world_requested(Quest&, QString)),
+          this, SLOT(show_world_requested(Quest&, QString)));
+  connect(ui.quest_tree_view, SIGNAL(translation_matrix_requested(Quest&, QString)),
+          this, SLOT(translation_matrix_requested(Quest&, QString)));
   connect(ui.quest_tree_view, SIGNAL(selected_path_changed(QString)),
           this, SLOT(selected_path_changed(QString)));
 
@@ -223,6 +245,8 @@ MainWindow::MainWindow(QWidget* parent) :
           ui.action_copy, SLOT(setEnabled(bool)));
   connect(ui.tab_widget, SIGNAL(can_paste_changed(bool)),
           ui.action_paste, SLOT(setEnabled(bool)));
+  connect(ui.tab_widget, SIGNAL(file_saved(QString)),
+          &search_index, SLOT(file_saved(QString)));
   connect(ui.tab_widget, SIGNAL(refactoring_requested(Refactoring)),
           this, SLOT(refactoring_requested(Refactoring)));
 
@@ -558,6 +582,7 @@ Quest& MainWindow::get_quest() {
 void MainWindow::close_quest() {
 
   ui.tab_widget->close_without_confirmation();
+  flush_quest_database();
 
   if (quest.exists()) {
     disconnect(&quest, SIGNAL(file_renamed(QString, QString)),
@@ -567,9 +592,32 @@ void MainWindow::close_quest() {
   }
 
   quest.set_root_path("");
+  Audio::close_quest();
   update_title();
   ui.action_import->setEnabled(false);
   ui.action_run_quest->setEnabled(false);
+  ui.action_find_in_quest->setEnabled(false);
+  ui.action_audio_report->setEnabled(false);
+  ui.action_texture_report->setEnabled(false);
+  if (find_in_quest_dialog != nullptr) {
+    find_in_quest_dialog->hide();
+  }
+  if (world_view != nullptr) {
+    world_view->clear();
+    world_view->hide();
+  }
+  if (translation_matrix_dialog != nullptr) {
+    delete translation_matrix_dialog;
+    translation_matrix_dialog = nullptr;
+  }
+  if (audio_report_dialog != nullptr) {
+    delete audio_report_dialog;
+    audio_report_dialog = nullptr;
+  }
+  if (texture_report_dialog != nullptr) {
+    delete texture_report_dialog;
+    texture_report_dialog = nullptr;
+  }
   ui.quest_tree_view->set_quest(quest);
 
   EditorSettings settings;
@@ -609,6 +657,9 @@ bool MainWindow::open_quest(const QString& quest_path) {
 
     ui.action_import->setEnabled(true);
     ui.action_run_quest->setEnabled(true);
+    ui.action_find_in_quest->setEnabled(true);
+    ui.action_audio_report->setEnabled(true);
+    ui.action_texture_report->setEnabled(true);
 
     add_quest_to_recent_list();
     EditorSettings settings;
@@ -638,6 +689,9 @@ bool MainWindow::open_quest(const QString& quest_path) {
         quest.check_version();
         ui.action_import->setEnabled(true);
         ui.action_run_quest->setEnabled(true);
+        ui.action_find_in_quest->setEnabled(true);
+        ui.action_audio_report->setEnabled(true);
+        ui.action_texture_report->setEnabled(true);
         success = true;
       }
       catch (const EditorException& ex) {
@@ -673,7 +727,14 @@ void MainWindow::upgrade_quest() {
   QString backup_path = root_path + "/" + backup_dir_name;
 
   FileTools::delete_recursive(backup_path);  // Remove any previous backup.
-  FileTools::copy_recursive(quest.get_data_path(), backup_path);
+  QProgressDialog progress_dialog(tr("Backing up quest data files..."), QString(), 0, 0, this);
+  progress_dialog.setWindowModality(Qt::WindowModal);
+  progress_dialog.setMinimumDuration(500);
+  FileTools::copy_recursive(quest.get_data_path(), backup_path, [&progress_dialog](int done, int total) {
+    progress_dialog.setMaximum(total);
+    progress_dialog.setValue(done);
+  });
+  progress_dialog.reset();
 
   // Upgrade data files.
   ExternalScriptDialog dialog(
@@ -966,6 +1027,27 @@ void MainWindow::on_action_find_triggered() {
   }
 }
 
+/**
+ * @brief Slot called when the user triggers the "Find in quest" action.
+ */
+void MainWindow::on_action_find_in_quest_triggered() {
+
+  if (!quest.exists()) {
+    // No valid quest is currently open.
+    return;
+  }
+
+  if (find_in_quest_dialog == nullptr) {
+    find_in_quest_dialog = new FindInQuestDialog(quest, search_index, this);
+    connect(find_in_quest_dialog, SIGNAL(open_file_requested(QString, int)),
+            this, SLOT(open_file_at_line(QString, int)));
+  }
+
+  find_in_quest_dialog->show();
+  find_in_quest_dialog->raise();
+  find_in_quest_dialog->activateWindow();
+}
+
 /**
  * @brief Slot called when the user triggers the "Run quest" action.
  */
@@ -1003,6 +1085,7 @@ void MainWindow::on_action_run_quest_triggered() {
       }
     }
 
+    flush_quest_database();
     quest_runner.start(quest.get_root_path());
 
     // Automatically show the console when the quest starts.
@@ -1039,6 +1122,52 @@ void MainWindow::on_action_stop_music_triggered() {
   }
 }
 
+/**
+ * @brief Slot called when the user triggers the "Audio report" action.
+ */
+void MainWindow::on_action_audio_report_triggered() {
+
+  if (!quest.exists()) {
+    // No valid quest is currently open.
+    return;
+  }
+
+  if (audio_report_dialog == nullptr) {
+    audio_report_dialog = new AudioReportDialog(quest, this);
+  }
+  else {
+    audio_report_dialog->reload();
+  }
+
+  audio_report_dialog->show();
+  audio_report_dialog->raise();
+  audio_report_dialog->activateWindow();
+}
+
+/**
+ * @brief Slot called when the user triggers the "Texture report" action.
+ */
+void MainWindow::on_action_texture_report_triggered() {
+
+  if (!quest.exists()) {
+    // No valid quest is currently open.
+    return;
+  }
+
+  if (texture_report_dialog == nullptr) {
+    texture_report_dialog = new TextureReportDialog(quest, this);
+    connect(texture_report_dialog, SIGNAL(open_file_requested(Quest&, QString)),
+            ui.tab_widget, SLOT(open_file_requested(Quest&, QString)));
+  }
+  else {
+    texture_report_dialog->reload();
+  }
+
+  texture_report_dialog->show();
+  texture_report_dialog->raise();
+  texture_report_dialog->activateWindow();
+}
+
 /**
  * @brief Slot called when the user triggers the "Show grid" action.
  */
@@ -1696,6 +1825,21 @@ void MainWindow::open_file(Quest& quest, const QString& path) {
   ui.tab_widget->open_file_requested(quest, path);
 }
 
+/**
+ * @brief Opens a file and shows a line if it is open in a text editor.
+ * @param path Path of the file to open.
+ * @param line The line to show, starting at 1.
+ */
+void MainWindow::open_file_at_line(const QString& path, int line) {
+
+  open_file(quest, path);
+
+  TextEditor* text_editor = qobject_cast<TextEditor*>(get_current_editor());
+  if (text_editor != nullptr && text_editor->get_file_path() == path) {
+    text_editor->go_to_line(line);
+  }
+}
+
 /**
  * @brief Receives a window close event.
  * @param event The event to handle.
@@ -1703,6 +1847,7 @@ void MainWindow::open_file(Quest& quest, const QString& path) {
 void MainWindow::closeEvent(QCloseEvent* event) {
 
   if (confirm_before_closing()) {
+    flush_quest_database();
     event->accept();
   }
   else {
@@ -1710,6 +1855,21 @@ void MainWindow::closeEvent(QCloseEvent* event) {
   }
 }
 
+/**
+ * @brief Writes pending changes of the resource list now.
+ *
+ * Shows an error dialog in case of failure.
+ */
+void MainWindow::flush_quest_database() {
+
+  try {
+    quest.get_database().flush();
+  }
+  catch (const EditorException& ex) {
+    ex.show_dialog();
+  }
+}
+
 /**
  * @brief Function called when the user wants to exit the program.
  *
@@ -1837,6 +1997,46 @@ void MainWindow::rename_file_requested(Quest& quest, const QString& path) {
 
 }
 
+/**
+ * @brief Slot called when the user wants to see the world of a map.
+ * @param quest The quest that holds this map.
+ * @param map_id Id of the map.
+ */
+void MainWindow::show_world_requested(Quest& quest, const QString& map_id) {
+
+  if (world_view == nullptr) {
+    world_view = new WorldView(quest, this);
+    connect(world_view, SIGNAL(open_file_requested(Quest&, QString)),
+            ui.tab_widget, SLOT(open_file_requested(Quest&, QString)));
+  }
+
+  world_view->show_world_of_map(map_id);
+  world_view->show();
+  world_view->raise();
+  world_view->activateWindow();
+}
+
+/**
+ * @brief Slot called when the user wants to compare all languages to a language.
+ * @param quest The quest that holds this language.
+ * @param language_id Id of the reference language.
+ */
+void MainWindow::translation_matrix_requested(Quest& quest, const QString& language_id) {
+
+  if (translation_matrix_dialog == nullptr) {
+    translation_matrix_dialog = new TranslationMatrixDialog(quest, this);
+    connect(translation_matrix_dialog, SIGNAL(open_file_requested(Quest&, QString)),
+            ui.tab_widget, SLOT(open_file_requested(Quest&, QString)));
+    connect(ui.tab_widget, SIGNAL(file_saved(QString)),
+            translation_matrix_dialog, SLOT(file_saved(QString)));
+  }
+
+  translation_matrix_dialog->set_reference_language(language_id);
+  translation_matrix_dialog->show();
+  translation_matrix_dialog->raise();
+  translation_matrix_dialog->activateWindow();
+}
+
 /**
  * @brief Slot called when the user wants to perform some refactoring.
  *
@@ -1879,8 +2079,12 @@ void MainWindow::refactoring_requested(const Refactoring& refactoring) {
       }
     }
 
-    // Do the work.
-    QStringList modified_paths = refactoring.execute();
+    // Do the work, writing the resource list only once.
+    QStringList modified_paths;
+    {
+      QuestDatabase::Transaction transaction(quest.get_database());
+      modified_paths = refactoring.execute();
+    }
 
     // See if some of the impacted files was open.
     for (const QString& path : modified_paths) {
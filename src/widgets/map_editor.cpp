@@ -1395,6 +1395,10 @@ void MapEditor::reload_settings() {
     settings.get_value_int(EditorSettings::map_grid_style)));
   get_view_settings().set_grid_color(
     settings.get_value_color(EditorSettings::map_grid_color));
+  get_view_settings().set_lod_enabled(
+    settings.get_value_bool(EditorSettings::map_lod_enabled));
+  get_view_settings().set_lod_zoom(
+    settings.get_value_double(EditorSettings::map_lod_zoom));
 }
 
 /**
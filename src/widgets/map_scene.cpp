@@ -23,6 +23,30 @@
 
 namespace SolarusEditor {
 
+namespace {
+
+/**
+ * @brief Width and height in pixels of the cells of the entity grid.
+ */
+constexpr int grid_cell_size = 256;
+
+/**
+ * @brief Returns the column or row of the grid cell containing a coordinate.
+ * @param coordinate An x or y coordinate in map pixels.
+ * Entities may be outside the map so it can be negative.
+ * @return The column or row of the grid.
+ */
+int get_grid_coordinate(int coordinate) {
+
+  if (coordinate >= 0) {
+    return coordinate / grid_cell_size;
+  }
+  // Round towards negative infinity.
+  return (coordinate + 1) / grid_cell_size - 1;
+}
+
+}
+
 /**
  * @brief Creates a map scene.
  * @param map The map data to represent in the scene.
@@ -32,6 +56,11 @@ MapScene::MapScene(MapModel& map, QObject* parent) :
   QGraphicsScene(parent),
   map(map),
   entity_items(),
+  item_area(),
+  entities_with_item(),
+  selected_entities(),
+  grid(),
+  grid_boxes(),
   layer_parent_items(),
   view_settings(nullptr) {
 
@@ -95,7 +124,10 @@ QSize MapScene::get_margin_size() {
 }
 
 /**
- * @brief Create all entity items in the scene.
+ * @brief Initializes the scene.
+ *
+ * No entity item is created yet: they are created when the view
+ * sets its visible area.
  */
 void MapScene::build() {
 
@@ -103,16 +135,25 @@ void MapScene::build() {
   setBackgroundBrush(Qt::gray);
 
   entity_items.clear();
+  item_area = QRect();
+  entities_with_item.clear();
+  selected_entities.clear();
+  grid.clear();
+  grid_boxes.clear();
   for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
 
     // Create the parent item of everything that will be on this layer.
     create_layer_parent_item(layer);
 
-    // Create the items on this layer.
-    entity_items[layer].clear();
+    // Reserve a slot for each entity on this layer.
+    EntityItems& items = entity_items[layer];
+    items.clear();
+    items.reserve(map.get_num_entities(layer));
     for (int j = 0; j < map.get_num_entities(layer); ++j) {
+      items.append(nullptr);
       EntityModel& entity = map.get_entity(EntityIndex(layer, j));
-      create_entity_item(entity);
+      add_to_grid(entity);
+      update_entity_selection(entity);
     }
   }
 }
@@ -143,11 +184,208 @@ void MapScene::create_layer_parent_item(int layer) {
 
 }
 
+/**
+ * @brief Sets the area of the scene currently shown by the view.
+ *
+ * Items are created for entities that enter the neighborhood of this area
+ * and deleted for entities that leave it.
+ * Nothing is done as long as the area stays in the current neighborhood.
+ *
+ * @param visible_area The visible area in scene coordinates.
+ */
+void MapScene::set_visible_area(const QRectF& visible_area) {
+
+  QRect area = visible_area.toAlignedRect();
+  area.translate(-get_margin_top_left());
+
+  if (item_area.contains(area) &&
+      item_area.width() <= area.width() * 3 &&
+      item_area.height() <= area.height() * 3) {
+    // Still in the neighborhood and it was not zoomed in a lot.
+    return;
+  }
+
+  // Keep a margin to avoid rebuilding items at each small scrolling.
+  const int margin_x = area.width() / 2;
+  const int margin_y = area.height() / 2;
+  update_item_area(area.adjusted(-margin_x, -margin_y, margin_x, margin_y));
+}
+
+/**
+ * @brief Returns whether an entity is in the area where entities have items.
+ * @param entity A map entity.
+ * @return @c true if the entity should have an item.
+ */
+bool MapScene::is_in_item_area(const EntityModel& entity) const {
+
+  return item_area.intersects(entity.get_bounding_box());
+}
+
+/**
+ * @brief Returns whether an entity is shown with the current view settings.
+ * @param entity A map entity.
+ * @return @c true if the entity is visible or if there are no view settings yet.
+ */
+bool MapScene::is_entity_visible(const EntityModel& entity) const {
+
+  return view_settings == nullptr ||
+      EntityItem::is_entity_visible(entity, *view_settings);
+}
+
+/**
+ * @brief Returns the cells of the entity grid that overlap an area.
+ * @param area An area in map coordinates.
+ * @return The overlapped cells. Empty if the area is empty.
+ */
+QList<MapScene::GridCell> MapScene::get_grid_cells(const QRect& area) {
+
+  QList<GridCell> cells;
+  if (area.isEmpty()) {
+    return cells;
+  }
+
+  const int min_column = get_grid_coordinate(area.left());
+  const int max_column = get_grid_coordinate(area.right());
+  const int min_row = get_grid_coordinate(area.top());
+  const int max_row = get_grid_coordinate(area.bottom());
+  for (int column = min_column; column <= max_column; ++column) {
+    for (int row = min_row; row <= max_row; ++row) {
+      cells.append((static_cast<GridCell>(static_cast<quint32>(column)) << 32) |
+                   static_cast<quint32>(row));
+    }
+  }
+  return cells;
+}
+
+/**
+ * @brief Puts an entity in the cells of the grid overlapped by its
+ * bounding box.
+ * @param entity An entity that is not in the grid yet.
+ */
+void MapScene::add_to_grid(EntityModel& entity) {
+
+  const QRect& box = entity.get_bounding_box();
+  grid_boxes.insert(&entity, box);
+  for (GridCell cell : get_grid_cells(box)) {
+    grid[cell].insert(&entity);
+  }
+}
+
+/**
+ * @brief Removes an entity from the grid.
+ * @param entity An entity. Nothing happens if it is not in the grid.
+ */
+void MapScene::remove_from_grid(EntityModel& entity) {
+
+  auto it = grid_boxes.find(&entity);
+  if (it == grid_boxes.end()) {
+    return;
+  }
+
+  for (GridCell cell : get_grid_cells(it.value())) {
+    auto cell_it = grid.find(cell);
+    if (cell_it == grid.end()) {
+      continue;
+    }
+    cell_it.value().remove(&entity);
+    if (cell_it.value().isEmpty()) {
+      grid.erase(cell_it);
+    }
+  }
+  grid_boxes.erase(it);
+}
+
+/**
+ * @brief Moves an entity to the right cells of the grid after its position
+ * or its size has changed.
+ * @param entity An entity of the map.
+ */
+void MapScene::update_in_grid(EntityModel& entity) {
+
+  if (grid_boxes.value(&entity) == entity.get_bounding_box()) {
+    // No change.
+    return;
+  }
+
+  remove_from_grid(entity);
+  add_to_grid(entity);
+}
+
+/**
+ * @brief Returns the entities in the cells of the grid overlapped by an area.
+ *
+ * The result may contain entities that do not overlap the area itself
+ * but are close to it.
+ *
+ * @param area An area in map coordinates.
+ * @return The entities near this area.
+ */
+QSet<EntityModel*> MapScene::get_entities_near(const QRect& area) const {
+
+  QSet<EntityModel*> entities;
+  for (GridCell cell : get_grid_cells(area)) {
+    auto it = grid.find(cell);
+    if (it != grid.end()) {
+      entities.unite(it.value());
+    }
+  }
+  return entities;
+}
+
+/**
+ * @brief Creates and deletes entity items for a new item area.
+ *
+ * Only entities that have an item or that are in the grid cells of the
+ * new area are checked.
+ *
+ * @param area The new area in map coordinates.
+ */
+void MapScene::update_item_area(const QRect& area) {
+
+  item_area = area;
+
+  QSet<EntityModel*> entities = get_entities_near(area);
+  entities.unite(entities_with_item);
+  EntityIndexes indexes;
+  indexes.reserve(entities.size());
+  for (const EntityModel* entity : entities) {
+    indexes.append(entity->get_index());
+  }
+  qSort(indexes);
+
+  // Creating and deleting items does not change the selection.
+  const bool was_blocked = signalsBlocked();
+  blockSignals(true);
+
+  // Traverse the entities from the end so that the item above each
+  // new one is close.
+  for (auto it = indexes.end(); it != indexes.begin();) {
+    --it;
+
+    const EntityIndex& index = *it;
+    EntityModel& entity = map.get_entity(index);
+    EntityItem* item = get_entity_item(index);
+    if (is_in_item_area(entity)) {
+      if (item == nullptr) {
+        create_entity_item(entity, get_next_entity_item(index));
+      }
+    }
+    else if (item != nullptr) {
+      delete_entity_item(index);
+    }
+  }
+  blockSignals(was_blocked);
+}
+
 /**
  * @brief Creates a graphic item for the specified entity on the map.
+ *
+ * The entity must not have an item yet.
+ *
  * @param entity A map entity.
+ * @param item_above The next item on the same layer, or nullptr.
  */
-void MapScene::create_entity_item(EntityModel& entity) {
+void MapScene::create_entity_item(EntityModel& entity, EntityItem* item_above) {
 
   Q_ASSERT(entity.is_on_map());
 
@@ -155,21 +393,54 @@ void MapScene::create_entity_item(EntityModel& entity) {
   int layer = index.layer;
   int i = index.order;
 
+  Q_ASSERT(layer == entity.get_layer());
+  Q_ASSERT(i < entity_items[layer].size());
+  Q_ASSERT(entity_items[layer][i] == nullptr);
+
   QGraphicsItem* parent_item = layer_parent_items[layer];
   Q_ASSERT(parent_item != nullptr);
   EntityItem* item = new EntityItem(entity, parent_item);
 
-  if (i < entity_items[layer].size()) {
-    item->stackBefore(get_entity_item(index));
+  if (item_above != nullptr) {
+    item->stackBefore(item_above);
   }
 
-  Q_ASSERT(layer == entity.get_layer());
-
-  entity_items[layer].insert(i, item);
+  entity_items[layer][i] = item;
+  entities_with_item.insert(&entity);
 
   if (view_settings != nullptr) {
     item->update_visibility(*view_settings);
   }
+
+  if (entity.is_selected()) {
+    // The entity was already selected: this is not a selection change.
+    const bool was_blocked = signalsBlocked();
+    blockSignals(true);
+    item->setSelected(true);
+    blockSignals(was_blocked);
+  }
+}
+
+/**
+ * @brief Deletes the graphic item of an entity.
+ *
+ * The entity keeps its selection state.
+ *
+ * @param index Index of an entity that has an item.
+ */
+void MapScene::delete_entity_item(const EntityIndex& index) {
+
+  EntityItem* item = get_entity_item(index);
+  Q_ASSERT(item != nullptr);
+
+  EntityModel& entity = item->get_entity();
+  const bool selected = entity.is_selected();
+  removeItem(item);
+  entity_items[index.layer][index.order] = nullptr;
+  entities_with_item.remove(&entity);
+  delete item;
+  entity.set_selected(selected);
+  update_entity_selection(entity);
 }
 
 /**
@@ -192,10 +463,27 @@ EntityItem* MapScene::get_entity_item(const EntityIndex& index) {
   return items.at(index.order);
 }
 
+/**
+ * @brief Returns the first item above an entity on its layer.
+ * @param index Index of a map entity.
+ * @return The item of the next entity that has one, or nullptr.
+ */
+EntityItem* MapScene::get_next_entity_item(const EntityIndex& index) {
+
+  const EntityItems& items = get_entity_items(index.layer);
+  for (int i = index.order + 1; i < items.size(); ++i) {
+    if (items.at(i) != nullptr) {
+      return items.at(i);
+    }
+  }
+  return nullptr;
+}
+
 /**
  * @brief Returns the entity items on the specified layer.
  * @param layer A layer.
  * @return Items of entities on that layer.
+ * Entities that have no item yet are nullptr.
  */
 const MapScene::EntityItems& MapScene::get_entity_items(int layer) {
   return entity_items[layer];
@@ -224,8 +512,11 @@ void MapScene::update_layer_visibility(int layer, const ViewSettings& view_setti
   layer_range_changed(map.get_min_layer(), map.get_max_layer());
 
   for (EntityItem* item : get_entity_items(layer)) {
-    item->update_visibility(view_settings);
+    if (item != nullptr) {
+      item->update_visibility(view_settings);
+    }
   }
+  unselect_hidden_entities();
 }
 
 /**
@@ -248,9 +539,16 @@ void MapScene::update_layer_locking(int layer, const ViewSettings& view_settings
   }
 
   // Unselect entities on the newly locked layer.
-  for (EntityItem* item : get_entity_items(layer)) {
-    item->setSelected(false);
+  const bool was_blocked = signalsBlocked();
+  blockSignals(true);
+  for (const EntityIndex& index : get_selected_entities()) {
+    if (index.layer == layer) {
+      set_entity_selected(index, false);
+    }
   }
+  blockSignals(was_blocked);
+
+  emit selectionChanged();
 }
 
 /**
@@ -262,11 +560,12 @@ void MapScene::update_traversables_visibility(const ViewSettings& view_settings)
   this->view_settings = &view_settings;
   for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
     for (EntityItem* item : get_entity_items(layer)) {
-      if (item->get_entity().is_traversable()) {
+      if (item != nullptr && item->get_entity().is_traversable()) {
         item->update_visibility(view_settings);
       }
     }
   }
+  unselect_hidden_entities();
 }
 
 /**
@@ -278,11 +577,12 @@ void MapScene::update_obstacles_visibility(const ViewSettings& view_settings) {
   this->view_settings = &view_settings;
   for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
     for (EntityItem* item : get_entity_items(layer)) {
-      if (!item->get_entity().is_traversable()) {
+      if (item != nullptr && !item->get_entity().is_traversable()) {
         item->update_visibility(view_settings);
       }
     }
   }
+  unselect_hidden_entities();
 }
 
 /**
@@ -295,11 +595,61 @@ void MapScene::update_entity_type_visibility(EntityType type, const ViewSettings
   this->view_settings = &view_settings;
   for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
     for (EntityItem* item : get_entity_items(layer)) {
-      if (item->get_entity_type() == type) {
+      if (item != nullptr && item->get_entity_type() == type) {
         item->update_visibility(view_settings);
       }
     }
   }
+  unselect_hidden_entities();
+}
+
+/**
+ * @brief Redraws entities after the level of detail settings have changed.
+ * @param view_settings The new view settings to apply.
+ */
+void MapScene::update_level_of_detail(const ViewSettings& view_settings) {
+
+  this->view_settings = &view_settings;
+  update();
+}
+
+/**
+ * @brief Returns whether entities should be drawn in a simplified way.
+ * @param level_of_detail Scale factor of the painter.
+ * @return @c true if the view settings ask for simplified rendering
+ * at this scale.
+ */
+bool MapScene::is_low_detail(double level_of_detail) const {
+
+  return view_settings != nullptr &&
+      view_settings->is_low_detail(level_of_detail);
+}
+
+/**
+ * @brief Unselects entities without item that the view settings hide.
+ *
+ * Hiding an item already unselects it.
+ */
+void MapScene::unselect_hidden_entities() {
+
+  if (view_settings == nullptr) {
+    return;
+  }
+
+  bool changed = false;
+  const QSet<EntityModel*> entities = selected_entities;
+  for (EntityModel* entity : entities) {
+    if (get_entity_item(entity->get_index()) == nullptr &&
+        !EntityItem::is_entity_visible(*entity, *view_settings)) {
+      entity->set_selected(false);
+      update_entity_selection(*entity);
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    emit selectionChanged();
+  }
 }
 
 /**
@@ -416,7 +766,7 @@ void MapScene::layer_range_changed(int min_layer, int max_layer) {
 /**
  * @brief Slot called when entity have just been added to the map.
  *
- * Items on the scene is created accordingly.
+ * Items on the scene is created accordingly if they are in the item area.
  *
  * @param indexes Indexes of the new entities in ascending order of indexes.
  */
@@ -427,7 +777,12 @@ void MapScene::entities_added(const EntityIndexes& indexes) {
     Q_ASSERT(map.entity_exists(index));
     EntityModel& entity = map.get_entity(index);
     Q_ASSERT(entity.get_index() == index);
-    create_entity_item(entity);
+    entity_items[index.layer].insert(index.order, nullptr);
+    add_to_grid(entity);
+    update_entity_selection(entity);
+    if (is_in_item_area(entity)) {
+      create_entity_item(entity, get_next_entity_item(index));
+    }
   }
 }
 
@@ -446,15 +801,17 @@ void MapScene::entities_about_to_be_removed(const EntityIndexes& indexes) {
 
     const EntityIndex& index = *it;
     EntityItem* item = get_entity_item(index);
-    Q_ASSERT(item != nullptr);
 
     EntityModel& entity = map.get_entity(index);
-    Q_UNUSED(entity);
     Q_ASSERT(entity.get_index() == index);
-    Q_ASSERT(&item->get_entity() == &entity);
-    Q_ASSERT(entity_items[index.layer][index.order] == item);
-    removeItem(item);
+    Q_ASSERT(item == nullptr || &item->get_entity() == &entity);
+    if (item != nullptr) {
+      removeItem(item);
+    }
     entity_items[index.layer].removeAt(index.order);
+    entities_with_item.remove(&entity);
+    selected_entities.remove(&entity);
+    remove_from_grid(entity);
     delete item;
   }
 }
@@ -470,31 +827,37 @@ void MapScene::entities_about_to_be_removed(const EntityIndexes& indexes) {
 void MapScene::entity_layer_changed(const EntityIndex& index_before,
                                     const EntityIndex& index_after) {
 
-  // Get the graphic item.
+  // Get the graphic item if any.
   EntityItem* item = get_entity_item(index_before);
-  Q_ASSERT(item != nullptr);
 
   // Get the entity.
   EntityModel& entity = map.get_entity(index_after);
-  Q_UNUSED(entity);
   Q_ASSERT(entity.get_index() == index_after);
-  Q_ASSERT(&item->get_entity() == &entity);
-  Q_ASSERT(get_entity_item(index_before) == item);
+  Q_ASSERT(item == nullptr || &item->get_entity() == &entity);
 
   // Remove it from items of the old layer.
   entity_items[index_before.layer].removeAt(index_before.order);
-  removeItem(item);
+  int layer_after = index_after.layer;
+  int order_after = index_after.order;
+  entity_items[layer_after].insert(order_after, nullptr);
+
+  if (item == nullptr) {
+    if (is_in_item_area(entity)) {
+      create_entity_item(entity, get_next_entity_item(index_after));
+    }
+    return;
+  }
 
   // Add it to items of the new layer.
+  removeItem(item);
   addItem(item);
-  int layer_after = index_after.layer;
-  int order_after = index_after.order;
   item->setParentItem(layer_parent_items[layer_after]);
-  if (order_after < entity_items[layer_after].size()) {
-    item->stackBefore(get_entity_item(index_after));
+  EntityItem* item_above = get_next_entity_item(index_after);
+  if (item_above != nullptr) {
+    item->stackBefore(item_above);
   }
 
-  entity_items[layer_after].insert(order_after, item);
+  entity_items[layer_after][order_after] = item;
 
   // The visibility of the new layer may be different from the old one.
   if (view_settings != nullptr) {
@@ -514,23 +877,27 @@ void MapScene::entity_order_changed(const EntityIndex& index_before,
                                     int order_after) {
 
   EntityItem* item = get_entity_item(index_before);
-  Q_ASSERT(item != nullptr);
 
   int layer = index_before.layer;
   int order_before = index_before.order;
   EntityIndex index_after(layer, order_after);
   EntityModel& entity = map.get_entity(index_after);
-  Q_UNUSED(entity);
   Q_ASSERT(entity.get_index() == index_after);
-  Q_ASSERT(&item->get_entity() == &entity);
-  Q_ASSERT(entity_items[layer][order_before] == item);
+  Q_ASSERT(item == nullptr || &item->get_entity() == &entity);
 
   // Delete and recreate the item again.
   // Just removing and adding it does not seem to work when bringing entities
   // to the front.
+  const bool selected = entity.is_selected();
   entity_items[layer].removeAt(order_before);
+  entities_with_item.remove(&entity);
   delete item;
-  create_entity_item(entity);
+  entity.set_selected(selected);
+  update_entity_selection(entity);
+  entity_items[layer].insert(order_after, nullptr);
+  if (is_in_item_area(entity)) {
+    create_entity_item(entity, get_next_entity_item(index_after));
+  }
 }
 
 /**
@@ -545,8 +912,17 @@ void MapScene::entity_xy_changed(const EntityIndex& index, const QPoint& xy) {
 
   Q_UNUSED(xy);
 
+  EntityModel& entity = map.get_entity(index);
+  update_in_grid(entity);
+
   EntityItem* item = get_entity_item(index);
-  Q_ASSERT(item != nullptr);
+  if (item == nullptr) {
+    // The entity may have entered the item area.
+    if (is_in_item_area(entity)) {
+      create_entity_item(entity, get_next_entity_item(index));
+    }
+    return;
+  }
 
   item->update_xy();
 }
@@ -563,8 +939,17 @@ void MapScene::entity_size_changed(const EntityIndex& index, const QSize& size)
 
   Q_UNUSED(size);
 
+  EntityModel& entity = map.get_entity(index);
+  update_in_grid(entity);
+
   EntityItem* item = get_entity_item(index);
-  Q_ASSERT(item != nullptr);
+  if (item == nullptr) {
+    // The entity may have entered the item area.
+    if (is_in_item_area(entity)) {
+      create_entity_item(entity, get_next_entity_item(index));
+    }
+    return;
+  }
 
   item->update_size();
 }
@@ -576,19 +961,10 @@ void MapScene::entity_size_changed(const EntityIndex& index, const QSize& size)
 EntityIndexes MapScene::get_selected_entities() {
 
   EntityIndexes result;
-  const QList<QGraphicsItem*> selected_items = selectedItems();
-  for (QGraphicsItem* item : selected_items) {
-    EntityModel* entity = get_entity_from_item(*item);
-    if (entity == nullptr) {
-      continue;
-    }
-    EntityIndex index = entity->get_index();
-    if (!index.is_valid()) {
-      continue;
-    }
-    result.append(index);
+  result.reserve(selected_entities.size());
+  for (const EntityModel* entity : selected_entities) {
+    result.append(entity->get_index());
   }
-
   qSort(result);
   return result;
 }
@@ -600,42 +976,58 @@ EntityIndexes MapScene::get_selected_entities() {
 void MapScene::set_selected_entities(const EntityIndexes& indexes) {
 
   // Is there a change?
-  bool changed = false;
-  if (indexes.size() != selectedItems().size()) {
-    changed = true;
-  }
-  else {
-    for (const EntityIndex& index : indexes) {
-      EntityItem* item = get_entity_item(index);
-      Q_ASSERT(item != nullptr);
-      if (!item->isSelected()) {
-        changed = true;
-        break;
-      }
-    }
-  }
-
-  if (!changed) {
+  EntityIndexes sorted_indexes = indexes;
+  qSort(sorted_indexes);
+  const EntityIndexes& old_indexes = get_selected_entities();
+  if (sorted_indexes == old_indexes) {
     // Do nothing for better performance.
     return;
   }
 
-  clearSelection();
   const bool was_blocked = signalsBlocked();
   blockSignals(true);
+  for (const EntityIndex& index : old_indexes) {
+    set_entity_selected(index, false);
+  }
   for (const EntityIndex& index : indexes) {
-    EntityItem* item = get_entity_item(index);
-    Q_ASSERT(item != nullptr);
-    if (item == nullptr) {
+    Q_ASSERT(map.entity_exists(index));
+    if (!map.entity_exists(index)) {
       continue;
     }
-    item->setSelected(true);
+    set_entity_selected(index, true);
   }
   blockSignals(was_blocked);
 
   emit selectionChanged();
 }
 
+/**
+ * @brief Selects or unselects an entity, with or without graphic item.
+ *
+ * Does not emit selectionChanged() if the entity has no item.
+ *
+ * @param index Index of the entity to change.
+ * @param selected @c true to select it.
+ */
+void MapScene::set_entity_selected(const EntityIndex& index, bool selected) {
+
+  EntityItem* item = get_entity_item(index);
+  if (item != nullptr) {
+    // The item updates the entity.
+    item->setSelected(selected);
+    return;
+  }
+
+  // Like items, hidden entities cannot be selected.
+  EntityModel& entity = map.get_entity(index);
+  if (selected &&
+      view_settings != nullptr &&
+      !EntityItem::is_entity_visible(entity, *view_settings)) {
+    return;
+  }
+  entity.set_selected(selected);
+}
+
 /**
  * @brief Selects or unselects an entity.
  * @param entity The entity to change.
@@ -643,9 +1035,15 @@ void MapScene::set_selected_entities(const EntityIndexes& indexes) {
  */
 void MapScene::select_entity(const EntityIndex& index, bool selected) {
 
-  EntityItem* item = get_entity_item(index);
-  Q_ASSERT(item != nullptr);
-  item->setSelected(selected);
+  Q_ASSERT(map.entity_exists(index));
+  const EntityModel& entity = map.get_entity(index);
+  const bool was_selected = entity.is_selected();
+  set_entity_selected(index, selected);
+
+  if (get_entity_item(index) == nullptr &&
+      entity.is_selected() != was_selected) {
+    emit selectionChanged();
+  }
 }
 
 /**
@@ -655,12 +1053,9 @@ void MapScene::select_all() {
 
   const bool was_blocked = signalsBlocked();
   blockSignals(true);
-  for (const EntityItems& layer_items : get_entity_items()) {
-    for (EntityItem* item : layer_items) {
-      if (item == nullptr) {
-        continue;
-      }
-      item->setSelected(true);
+  for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
+    for (int i = 0; i < map.get_num_entities(layer); ++i) {
+      set_entity_selected(EntityIndex(layer, i), true);
     }
   }
   blockSignals(was_blocked);
@@ -675,15 +1070,12 @@ void MapScene::select_all_except_locked() {
 
   const bool was_blocked = signalsBlocked();
   blockSignals(true);
-  for (const EntityItems& layer_items : get_entity_items()) {
-    for (EntityItem* item : layer_items) {
-      if (item == nullptr) {
-        continue;
-      }
-      if (view_settings->is_layer_locked(item->get_index().layer)) {
-        break;
-      }
-      item->setSelected(true);
+  for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
+    if (view_settings->is_layer_locked(layer)) {
+      continue;
+    }
+    for (int i = 0; i < map.get_num_entities(layer); ++i) {
+      set_entity_selected(EntityIndex(layer, i), true);
     }
   }
   blockSignals(was_blocked);
@@ -698,19 +1090,32 @@ void MapScene::unselect_all() {
 
   const bool was_blocked = signalsBlocked();
   blockSignals(true);
-  for (const EntityItems& layer_items : get_entity_items()) {
-    for (EntityItem* item : layer_items) {
-      if (item == nullptr) {
-        continue;
-      }
-      item->setSelected(false);
-    }
+  for (const EntityIndex& index : get_selected_entities()) {
+    set_entity_selected(index, false);
   }
   blockSignals(was_blocked);
 
   emit selectionChanged();
 }
 
+/**
+ * @brief Updates the set of selected entities after the selection flag
+ * of an entity has been changed.
+ *
+ * Entity items call this function when they get selected or unselected.
+ *
+ * @param entity The entity whose selection flag may have changed.
+ */
+void MapScene::update_entity_selection(EntityModel& entity) {
+
+  if (entity.is_selected() && entity.is_on_map()) {
+    selected_entities.insert(&entity);
+  }
+  else {
+    selected_entities.remove(&entity);
+  }
+}
+
 /**
  * @brief Redraws the given entity.
  * @param index Index of the entity to redraw.
@@ -736,38 +1141,50 @@ void MapScene::redraw_entities(const EntityIndexes& indexes) {
 }
 
 
+/**
+ * @brief Returns the visible entities whose bounding box is inside a rectangle.
+ *
+ * Entities are found in the model, so this includes entities that
+ * have no graphic item.
+ *
+ * @param rectangle A rectangle in map coordinates.
+ * @return The entities in this rectangle, sorted in the order of the map.
+ */
+EntityIndexes MapScene::get_entities_in_rectangle(const QRect& rectangle) const {
+
+  EntityIndexes indexes;
+  for (const EntityModel* entity : get_entities_near(rectangle)) {
+    if (rectangle.contains(entity->get_bounding_box()) &&
+        is_entity_visible(*entity)) {
+      indexes.append(entity->get_index());
+    }
+  }
+  qSort(indexes);
+  return indexes;
+}
+
 /**
  * @brief Returns the highest layer where a specified rectangle overlaps an
  * existing visible entity.
+ *
+ * Entities are found in the model, so this includes entities that
+ * have no graphic item.
+ *
  * @param rectangle A rectangle in map coordinates.
- * If nullptr, all entities are considered visible.
  * @return The first layer from top where an entity exists in this rectangle,
  * or the lowest layer if there is nothing here.
  */
 int MapScene::get_layer_in_rectangle(const QRect& rectangle) const {
 
-  QRect scene_rectangle = rectangle;
-  scene_rectangle.translate(get_margin_top_left());
-  const QList<QGraphicsItem*>& items_in_rectangle = items(
-        scene_rectangle, Qt::IntersectsItemBoundingRect
-  );
-
   int max_layer = map.get_min_layer();
-  for (QGraphicsItem* item : items_in_rectangle) {
+  for (const EntityModel* entity : get_entities_near(rectangle)) {
 
-    if (item->zValue() > map.get_max_layer()) {
-      // This is the case of the selection rectangle and
-      // of entities being added.
-      continue;
-    }
-    const EntityModel* entity = get_entity_from_item(*item);
-    if (entity == nullptr) {
-      // Not a map entity.
+    if (!entity->get_bounding_box().intersects(rectangle)) {
       continue;
     }
 
-    if (!item->isVisible()) {
-      // The item is hidden by view settings.
+    if (!is_entity_visible(*entity)) {
+      // The entity is hidden by view settings.
       continue;
     }
 
@@ -85,7 +85,7 @@ private:
   QPoint current_point;                     /**< Point where the dragging currently is, in scene coordinates. */
   QGraphicsRectItem* current_area_item;     /**< Graphic item of the rectangle the user is drawing
                                              * (belongs to the scene). */
-  QList<QGraphicsItem*> initial_selection;  /**< Items that were selected before the drawing started. */
+  EntityIndexes initial_selection;          /**< Entities that were selected before the drawing started. */
 };
 
 /**
@@ -266,10 +266,18 @@ void MapView::set_map(MapModel* map) {
     // Enable useful features if there is an image.
     if (view_settings != nullptr) {
       view_settings->set_zoom(2.0);  // Initial zoom: x2.
+      update_level_of_detail();
     }
     horizontalScrollBar()->setValue(0);
     verticalScrollBar()->setValue(0);
 
+    // Entity items are only created around the visible area.
+    connect(horizontalScrollBar(), SIGNAL(valueChanged(int)),
+            this, SLOT(update_visible_area()), Qt::UniqueConnection);
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)),
+            this, SLOT(update_visible_area()), Qt::UniqueConnection);
+    update_visible_area();
+
     // Install panning and zooming helpers.
     new PanTool(this);
     new ZoomTool(this);
@@ -339,6 +347,10 @@ void MapView::set_view_settings(ViewSettings& view_settings) {
   connect(this->view_settings, SIGNAL(entity_type_visibility_changed(EntityType, bool)),
           this, SLOT(update_entity_type_visibility(EntityType)));
 
+  connect(this->view_settings, SIGNAL(lod_changed()),
+          this, SLOT(update_level_of_detail()));
+  update_level_of_detail();
+
   horizontalScrollBar()->setValue(0);
   verticalScrollBar()->setValue(0);
 }
@@ -886,9 +898,11 @@ void MapView::export_to_image(const QString& file_name) {
   QImage image(map->get_size(), QImage::Format_ARGB32);
   image.fill(Qt::transparent);
   QPainter painter(&image);
+  scene->set_visible_area(scene->sceneRect());  // Create all items.
   scene->render(&painter, image.rect(),
                 QRect(scene->get_margin_top_left(), map->get_size()));
   image.save(file_name);
+  update_visible_area();
 
   // Restore the selection.
   set_selected_entities(selected_indexes);
@@ -1006,6 +1020,7 @@ void MapView::update_zoom() {
   double scale_factor = zoom / this->zoom;
   scale(scale_factor, scale_factor);
   this->zoom = zoom;
+  update_visible_area();
 }
 
 /**
@@ -1127,6 +1142,18 @@ void MapView::update_entity_type_visibility(EntityType type) {
 
   scene->update_entity_type_visibility(type, *view_settings);
 }
+
+/**
+ * @brief Redraws entities according to the level of detail view settings.
+ */
+void MapView::update_level_of_detail() {
+
+  if (scene == nullptr || view_settings == nullptr) {
+    return;
+  }
+
+  scene->update_level_of_detail(*view_settings);
+}
 /**
 
  * @brief Function called when the pattern selection of the tileset is changed
@@ -1171,6 +1198,28 @@ void MapView::tileset_reloaded() {
   start_state_doing_nothing();
 }
 
+/**
+ * @brief Tells the scene which area is shown after the view changes.
+ */
+void MapView::update_visible_area() {
+
+  if (scene == nullptr) {
+    return;
+  }
+
+  scene->set_visible_area(mapToScene(viewport()->rect()).boundingRect());
+}
+
+/**
+ * @brief Receives a resize event.
+ * @param event The event to handle.
+ */
+void MapView::resizeEvent(QResizeEvent* event) {
+
+  QGraphicsView::resizeEvent(event);
+  update_visible_area();
+}
+
 /**
  * @brief Draws the map view.
  * @param event The paint event.
@@ -1325,8 +1374,13 @@ void MapView::contextMenuEvent(QContextMenuEvent* event) {
     where = event->pos() + QPoint(1, 1);
   }
   else {
-    QList<QGraphicsItem*> selected_items = scene->selectedItems();
-    where = mapFromScene(selected_items.first()->pos() + QPoint(8, 8));
+    // The selected entity may have no graphic item: use the model.
+    const EntityIndexes& selected_indexes = get_selected_entities();
+    if (selected_indexes.isEmpty()) {
+      return;
+    }
+    const EntityModel& entity = map->get_entity(selected_indexes.first());
+    where = mapFromScene(MapScene::get_margin_top_left() + entity.get_top_left() + QPoint(8, 8));
   }
 
   state->context_menu_requested(viewport()->mapToGlobal(where));
@@ -1342,7 +1396,7 @@ bool MapView::is_selection_empty() const {
     return true;
   }
 
-  return scene->selectedItems().isEmpty();
+  return scene->get_selected_entities().isEmpty();
 }
 
 /**
@@ -1355,7 +1409,7 @@ int MapView::get_num_selected_entities() const {
     return 0;
   }
 
-  return scene->selectedItems().size();
+  return scene->get_selected_entities().size();
 }
 
 /**
@@ -1795,7 +1849,7 @@ void DoingNothingState::mouse_pressed(const QMouseEvent& event) {
   }
 
   if (!keep_selected) {
-    scene.clearSelection();
+    scene.unselect_all();
   }
 
   if (event.button() == Qt::LeftButton) {
@@ -1951,7 +2005,7 @@ void DrawingRectangleState::start() {
   current_area_item->setZValue(get_map().get_max_layer() + 2);
   current_area_item->setPen(QPen(Qt::yellow));
   get_scene().addItem(current_area_item);
-  initial_selection = get_scene().selectedItems();
+  initial_selection = get_scene().get_selected_entities();
 }
 
 /**
@@ -1985,40 +2039,24 @@ void DrawingRectangleState::mouse_moved(const QMouseEvent& event) {
   QRect area = Rectangle::from_two_points(initial_point, current_point);
   current_area_item->setRect(area);
 
-  bool was_blocked = scene.signalsBlocked();
-  if (!initial_selection.isEmpty()) {
-    // Block QGraphicsScene::selectionChanged() signal for individual selects.
-    scene.blockSignals(true);
-  }
-
-  // Select items strictly in the rectangle.
-  scene.clearSelection();
-  QPainterPath path;
-  path.addRect(QRect(area.topLeft() - QPoint(1, 1),
-                     area.size() + QSize(2, 2)));
-  scene.setSelectionArea(path, Qt::ContainsItemBoundingRect);
+  // Select entities strictly in the rectangle, including the ones
+  // that have no graphic item.
+  QRect map_area(area.topLeft() - QPoint(1, 1),
+                 area.size() + QSize(2, 2));
+  map_area.translate(-MapScene::get_margin_top_left());
 
-  // But don't select entities on locked layers.
-  const EntityIndexes selected_indexes = scene.get_selected_entities();
+  // But don't select entities on locked layers, and keep the initial
+  // selection.
+  EntityIndexes selected_indexes = initial_selection;
   const ViewSettings& view_settings = *view.get_view_settings();
-  for (const EntityIndex& index : selected_indexes) {
-    if (view_settings.is_layer_locked(index.layer)) {
-      view.select_entity(index, false);
+  for (const EntityIndex& index : scene.get_entities_in_rectangle(map_area)) {
+    if (!view_settings.is_layer_locked(index.layer) &&
+        !initial_selection.contains(index)) {
+      selected_indexes.append(index);
     }
   }
 
-  // Also restore the initial selection.
-  for (int i = 0; i < initial_selection.size(); ++i) {
-    const EntityItem* entity_item = qgraphicsitem_cast<const EntityItem*>(initial_selection[i]);
-
-    // Unblock signals before the last select.
-    if (i == initial_selection.size() - 1 ) {
-      // Last element.
-      scene.blockSignals(was_blocked);
-    }
-
-    view.select_entity(entity_item->get_index(), true);
-  }
+  view.set_selected_entities(selected_indexes);
 }
 
 /**
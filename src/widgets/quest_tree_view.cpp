@@ -523,6 +523,15 @@ void QuestTreeView::build_context_menu_open(QMenu& menu, const QString& path) {
       connect(action, SIGNAL(triggered()),
               this, SLOT(open_map_script_action_triggered()));
       menu.addAction(action);
+
+      action = new QAction(
+            QIcon(":/images/icon_resource_map.png"),
+            tr("Show World"),
+            this
+      );
+      connect(action, SIGNAL(triggered()),
+              this, SLOT(show_world_action_triggered()));
+      menu.addAction(action);
       break;
 
     case ResourceType::LANGUAGE:
@@ -540,6 +549,15 @@ void QuestTreeView::build_context_menu_open(QMenu& menu, const QString& path) {
       connect(action, SIGNAL(triggered()),
               this, SLOT(open_language_strings_action_triggered()));
       menu.addAction(action);
+
+      action = new QAction(
+            QIcon(":/images/icon_resource_language.png"),
+            tr("Compare All Languages"),
+            this
+      );
+      connect(action, SIGNAL(triggered()),
+              this, SLOT(compare_languages_action_triggered()));
+      menu.addAction(action);
       break;
 
     case ResourceType::TILESET:
@@ -924,6 +942,27 @@ void QuestTreeView::open_map_script_action_triggered() {
   emit open_file_requested(quest, quest.get_map_script_path(element_id));
 }
 
+/**
+ * @brief Slot called when the user wants to see the world of a map.
+ */
+void QuestTreeView::show_world_action_triggered() {
+
+  QString path = get_selected_path();
+  if (path.isEmpty()) {
+    return;
+  }
+
+  Quest& quest = model->get_quest();
+  ResourceType resource_type;
+  QString element_id;
+  if (!quest.is_resource_element(path, resource_type, element_id) ||
+      resource_type != ResourceType::MAP) {
+    return;
+  }
+
+  emit show_world_requested(quest, element_id);
+}
+
 /**
  * @brief Slot called when the user wants to open the strings file of a
  * language.
@@ -950,6 +989,28 @@ void QuestTreeView::open_language_strings_action_triggered() {
   emit open_file_requested(quest, quest.get_strings_path(element_id));
 }
 
+/**
+ * @brief Slot called when the user wants to compare the translations of
+ * all languages to a language.
+ */
+void QuestTreeView::compare_languages_action_triggered() {
+
+  QString path = get_selected_path();
+  if (path.isEmpty()) {
+    return;
+  }
+
+  Quest& quest = model->get_quest();
+  ResourceType resource_type;
+  QString element_id;
+  if (!quest.is_resource_element(path, resource_type, element_id) ||
+      resource_type != ResourceType::LANGUAGE) {
+    return;
+  }
+
+  emit translation_matrix_requested(quest, element_id);
+}
+
 /**
  * @brief Slot called when the user wants to rename the selected file or
  * directory.
@@ -38,6 +38,7 @@ SettingsDialog::SettingsDialog(QWidget *parent) :
   ui.tileset_grid_size_field->config("x", 8, 99999, 8);
 
   initialize_zoom_field(ui.map_main_zoom_field);
+  initialize_zoom_field(ui.map_lod_zoom_field);
   initialize_zoom_field(ui.map_tileset_zoom_field);
   initialize_zoom_field(ui.sprite_main_zoom_field);
   initialize_zoom_field(ui.sprite_previewer_zoom_field);
@@ -91,6 +92,10 @@ SettingsDialog::SettingsDialog(QWidget *parent) :
           this, SLOT(change_map_grid_style()));
   connect(ui.map_grid_color_field, SIGNAL(color_changed(QColor)),
           this, SLOT(change_map_grid_color()));
+  connect(ui.map_lod_enabled_field, SIGNAL(clicked()),
+          this, SLOT(change_map_lod_enabled()));
+  connect(ui.map_lod_zoom_field, SIGNAL(currentIndexChanged(int)),
+          this, SLOT(change_map_lod_zoom()));
   connect(ui.map_tileset_background_field, SIGNAL(color_changed(QColor)),
           this, SLOT(change_map_tileset_background()));
   connect(ui.map_tileset_zoom_field, SIGNAL(currentIndexChanged(int)),
@@ -215,6 +220,8 @@ void SettingsDialog::update() {
   update_map_grid_size();
   update_map_grid_style();
   update_map_grid_color();
+  update_map_lod_enabled();
+  update_map_lod_zoom();
   update_map_tileset_background();
   update_map_tileset_zoom();
 
@@ -593,6 +600,46 @@ void SettingsDialog::change_map_grid_color() {
   update_buttons();
 }
 
+/**
+ * @brief Updates the map level of detail enabled field.
+ */
+void SettingsDialog::update_map_lod_enabled() {
+
+  ui.map_lod_enabled_field->setChecked(
+    settings.get_value_bool(EditorSettings::map_lod_enabled));
+  ui.map_lod_zoom_field->setEnabled(ui.map_lod_enabled_field->isChecked());
+}
+
+/**
+ * @brief Slot called when the user changes the map level of detail enabled.
+ */
+void SettingsDialog::change_map_lod_enabled() {
+
+  edited_settings[EditorSettings::map_lod_enabled] =
+    ui.map_lod_enabled_field->isChecked();
+  ui.map_lod_zoom_field->setEnabled(ui.map_lod_enabled_field->isChecked());
+  update_buttons();
+}
+
+/**
+ * @brief Updates the map level of detail zoom field.
+ */
+void SettingsDialog::update_map_lod_zoom() {
+
+  ui.map_lod_zoom_field->setCurrentIndex(ui.map_lod_zoom_field->findData(
+    settings.get_value_double(EditorSettings::map_lod_zoom)));
+}
+
+/**
+ * @brief Slot called when the user changes the map level of detail zoom.
+ */
+void SettingsDialog::change_map_lod_zoom() {
+
+  edited_settings[EditorSettings::map_lod_zoom] =
+    ui.map_lod_zoom_field->currentData().toDouble();
+  update_buttons();
+}
+
 /**
  * @brief Updates the map tileset background field.
  */
@@ -21,11 +21,14 @@
 #include "widgets/sprite_scene.h"
 #include "editor_exception.h"
 #include "editor_settings.h"
+#include "image_store.h"
 #include "point.h"
 #include "quest.h"
 #include "quest_database.h"
 #include "sprite_model.h"
+#include "sprite_packer.h"
 #include <QFileInfo>
+#include <QMessageBox>
 #include <QUndoStack>
 
 namespace SolarusEditor {
@@ -723,6 +726,69 @@ private:
   int num_columns_after;
 };
 
+/**
+ * @brief Use a packed image for all animations of the sprite.
+ */
+class PackImagesCommand : public SpriteEditorCommand {
+
+public:
+
+  PackImagesCommand(
+      SpriteEditor& editor,
+      const QString& src_image,
+      const SpritePacker::PackedSprite& packed_sprite) :
+    SpriteEditorCommand(editor, SpriteEditor::tr("Pack images")),
+    src_image_after(src_image),
+    animations(packed_sprite.animations),
+    directions_after(packed_sprite.directions) {
+
+    for (const QString& animation_name : animations) {
+      src_images_before << get_model().get_animation_source_image(animation_name);
+    }
+    for (const SpritePacker::PackedDirection& direction_after : directions_after) {
+      SpritePacker::PackedDirection direction_before;
+      direction_before.index = direction_after.index;
+      direction_before.position = get_model().get_direction_position(direction_after.index);
+      direction_before.size = get_model().get_direction_size(direction_after.index);
+      direction_before.origin = get_model().get_direction_origin(direction_after.index);
+      directions_before << direction_before;
+    }
+  }
+
+  virtual void undo() override {
+
+    for (int i = 0; i < animations.size(); ++i) {
+      get_model().set_animation_source_image(animations[i], src_images_before[i]);
+    }
+    set_directions(directions_before);
+  }
+
+  virtual void redo() override {
+
+    for (const QString& animation_name : animations) {
+      get_model().set_animation_source_image(animation_name, src_image_after);
+    }
+    set_directions(directions_after);
+  }
+
+private:
+
+  void set_directions(const QList<SpritePacker::PackedDirection>& directions) {
+
+    for (const SpritePacker::PackedDirection& direction : directions) {
+      get_model().set_direction_position(direction.index, direction.position);
+      get_model().set_direction_size(direction.index, direction.size);
+      get_model().set_direction_origin(direction.index, direction.origin);
+    }
+  }
+
+  QString src_image_after;
+  QList<QString> animations;
+  QList<QString> src_images_before;
+  QList<SpritePacker::PackedDirection> directions_before;
+  QList<SpritePacker::PackedDirection> directions_after;
+};
+
 }
 
 /**
@@ -813,6 +879,15 @@ SpriteEditor::SpriteEditor(Quest& quest, const QString& path, QWidget* parent) :
 
   connect(model, SIGNAL(animation_image_changed(Index,QString)),
           this, SLOT(update_animation_source_image_field()));
+  connect(model, SIGNAL(animation_image_changed(Index,QString)),
+          this, SLOT(update_images_field()));
+  connect(model, SIGNAL(animation_created(Index)),
+          this, SLOT(update_images_field()));
+  connect(model, SIGNAL(animation_deleted(Index)),
+          this, SLOT(update_images_field()));
+
+  connect(ui.pack_images_button, SIGNAL(clicked()),
+          this, SLOT(pack_images_requested()));
 
   connect(ui.src_image_button, SIGNAL(clicked()),
           this, SLOT(change_animation_source_image_requested()));
@@ -967,6 +1042,7 @@ void SpriteEditor::update() {
 
   update_sprite_id_field();
   update_description_to_gui();
+  update_images_field();
   update_selection();
 }
 
@@ -989,6 +1065,90 @@ void SpriteEditor::update_description_to_gui() {
   }
 }
 
+/**
+ * @brief Updates the memory used by the images of the sprite.
+ *
+ * The tooltip shows the memory used by all images of the quest.
+ */
+void SpriteEditor::update_images_field() {
+
+  qint64 memory_size = 0;
+  const QList<QImage>& images = model->get_images();
+  for (const QImage& image : images) {
+    memory_size += ImageStore::get_memory_size(image);
+  }
+  ui.images_field->setText(tr("%1 images, %2 KiB").
+                           arg(images.size()).
+                           arg(memory_size / 1024));
+
+  const ImageStore::Statistics& statistics = get_quest().get_image_store().get_statistics();
+  ui.images_field->setToolTip(
+        tr("Images of the quest: %1 decoded (%2 in use), %3 KiB\n"
+           "%4 of %5 image loads needed no decoding").
+        arg(statistics.num_images).
+        arg(statistics.num_used_images).
+        arg(statistics.memory_size / 1024).
+        arg(statistics.num_hits).
+        arg(statistics.num_requests));
+}
+
+/**
+ * @brief Slot called when the user wants to pack the images of the sprite.
+ *
+ * All frames are trimmed and packed into a new image.
+ * Memory needed by the images is shown before writing anything.
+ */
+void SpriteEditor::pack_images_requested() {
+
+  const SpritePacker::PackedSprite& packed_sprite = SpritePacker::pack_sprite(*model);
+  if (packed_sprite.num_packed_rects == 0) {
+    QMessageBox::information(
+          this,
+          tr("Pack images"),
+          tr("This sprite has no source image to pack."));
+    return;
+  }
+
+  // Never overwrite an existing image.
+  QString src_image = sprite_id + "_atlas.png";
+  int suffix = 2;
+  while (QFileInfo(quest.get_sprite_image_path(src_image)).exists()) {
+    src_image = QString("%1_atlas_%2.png").arg(sprite_id).arg(suffix);
+    ++suffix;
+  }
+
+  const qint64 memory_size_before = packed_sprite.memory_size_before;
+  const qint64 memory_size_after = packed_sprite.memory_size_after;
+  QMessageBox::StandardButton answer = QMessageBox::question(
+        this,
+        tr("Pack images"),
+        tr("%1 animations can use a single image of %2x%3 pixels "
+           "containing %4 groups of trimmed frames.\n"
+           "Texture memory: %5 KiB instead of %6 KiB (%7 KiB saved).\n\n"
+           "Create '%8' and use it in the sprite?").
+        arg(packed_sprite.animations.size()).
+        arg(packed_sprite.atlas.width()).
+        arg(packed_sprite.atlas.height()).
+        arg(packed_sprite.num_packed_rects).
+        arg(memory_size_after / 1024).
+        arg(memory_size_before / 1024).
+        arg((memory_size_before - memory_size_after) / 1024).
+        arg(src_image),
+        QMessageBox::Yes | QMessageBox::No);
+
+  if (answer != QMessageBox::Yes) {
+    return;
+  }
+
+  const QString& path = quest.get_sprite_image_path(src_image);
+  if (!packed_sprite.atlas.save(path, "PNG")) {
+    EditorException(tr("Cannot write file '%1'").arg(path)).show_dialog();
+    return;
+  }
+
+  try_command(new PackImagesCommand(*this, src_image, packed_sprite));
+}
+
 /**
  * @brief Modifies the sprite description in the quest resource list with
  * the new text entered by the user.
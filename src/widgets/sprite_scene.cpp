@@ -144,11 +144,10 @@ void SpriteScene::drawBackground(QPainter* painter, const QRectF& rect) {
   // Draw the background color.
   painter->fillRect(rect, backgroundBrush());
 
-  // Draw the full PNG image of the sprite animation.
-  const QImage& src_image = model.get_animation_image(animation_name);
-  if (!src_image.isNull()) {
-    painter->setOpacity(0.5);
-    painter->drawImage(0, 0, src_image);
+  // Draw the exposed part of the dimmed image of the sprite animation.
+  const QRect exposed_rect = rect.toAlignedRect().intersected(background.rect());
+  if (!exposed_rect.isEmpty()) {
+    painter->drawPixmap(exposed_rect, background, exposed_rect);
   }
 }
 
@@ -205,6 +204,18 @@ void SpriteScene::update_image() {
     }
   }
 
+  // Dim the image once here rather than at each repaint.
+  background = QPixmap();
+  if (!image.isNull()) {
+    QImage dimmed_image(image.size(), QImage::Format_ARGB32_Premultiplied);
+    dimmed_image.fill(Qt::transparent);
+    QPainter painter(&dimmed_image);
+    painter.setOpacity(0.5);
+    painter.drawImage(0, 0, image);
+    painter.end();
+    background = QPixmap::fromImage(dimmed_image);
+  }
+
   setSceneRect(QRectF(QPoint(0, 0), image.size()));
   invalidate();
 }
@@ -44,6 +44,8 @@ SpriteView::SpriteView(QWidget* parent) :
   zoom(1.0) {
 
   setAlignment(Qt::AlignTop | Qt::AlignLeft);
+  // The background only changes with the source image of the animation.
+  setCacheMode(QGraphicsView::CacheBackground);
   current_area_item.setZValue(2);
 
   delete_direction_action = new QAction(
@@ -97,6 +97,47 @@ void StringsTreeView::set_model(StringsModel* model) {
   StringsTreeView::setModel(model);
   selectionModel()->deleteLater();
   setSelectionModel(&model->get_selection_model());
+
+  connect(model, SIGNAL(modelAboutToBeReset()),
+          this, SLOT(save_expanded_items()));
+  connect(model, SIGNAL(modelReset()),
+          this, SLOT(restore_expanded_items()));
+}
+
+/**
+ * @brief Slot called before the model is reset.
+ *
+ * Remembers the expanded items to restore them after the reset.
+ */
+void StringsTreeView::save_expanded_items() {
+
+  expanded_keys.clear();
+
+  QModelIndexList parents;
+  parents << QModelIndex();
+  while (!parents.isEmpty()) {
+    const QModelIndex parent = parents.takeLast();
+    for (int row = 0; row < model->rowCount(parent); ++row) {
+      const QModelIndex& index = model->index(row, 0, parent);
+      if (isExpanded(index)) {
+        expanded_keys << model->index_to_key(index);
+        parents << index;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Slot called after the model is reset.
+ *
+ * Expands again the items that were expanded before the reset.
+ */
+void StringsTreeView::restore_expanded_items() {
+
+  for (const QString& key : expanded_keys) {
+    setExpanded(model->key_to_index(key), true);
+  }
+  expanded_keys.clear();
 }
 
 }
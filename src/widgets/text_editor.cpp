@@ -26,6 +26,7 @@
 #include <QList>
 #include <QPlainTextEdit>
 #include <QScrollBar>
+#include <QTextBlock>
 #include <QTextStream>
 
 namespace SolarusEditor {
@@ -38,7 +39,8 @@ namespace SolarusEditor {
  * @throws EditorException If the file could not be opened.
  */
 TextEditor::TextEditor(Quest& quest, const QString& file_path, QWidget* parent) :
-  Editor(quest, file_path, parent) {
+  Editor(quest, file_path, parent),
+  highlighter(nullptr) {
 
   set_title(create_title());
   set_icon(create_icon());
@@ -73,7 +75,9 @@ TextEditor::TextEditor(Quest& quest, const QString& file_path, QWidget* parent)
 
   // Activate syntax coloring for Lua scripts.
   if (quest.is_script(file_path)) {
-    new LuaSyntaxHighlighter(text_widget->document());
+    highlighter = new LuaSyntaxHighlighter(text_widget->document());
+    connect(text_widget, SIGNAL(updateRequest(const QRect&, int)),
+            this, SLOT(highlight_visible_text(const QRect&, int)));
   }
 
   text_widget->document()->setModified(false);
@@ -300,6 +304,22 @@ void TextEditor::replace_text_requested(const QString& text_search, const QStrin
   }
 }
 
+/**
+ * @brief Moves the cursor to the beginning of a line and shows it.
+ * @param line The line number, starting at 1.
+ */
+void TextEditor::go_to_line(int line) {
+
+  QTextBlock block = text_widget->document()->findBlockByNumber(line - 1);
+  if (!block.isValid()) {
+    return;
+  }
+
+  text_widget->setTextCursor(QTextCursor(block));
+  text_widget->centerCursor();
+  text_widget->setFocus();
+}
+
 /**
  * @brief Slot called when the user wants to open the map view of this script.
  */
@@ -311,5 +331,26 @@ void TextEditor::open_map_requested() {
   }
 }
 
+/**
+ * @brief Slot called when the visible part of the text may have changed.
+ *
+ * Makes sure that visible lines are syntax-highlighted right now
+ * even if the rest of a large script is still being highlighted.
+ * Partial updates like the cursor blinking are ignored: only scrolling
+ * and updates of the whole viewport can reveal other lines.
+ *
+ * @param rect Region to be redrawn.
+ * @param dy Number of pixels scrolled vertically.
+ */
+void TextEditor::highlight_visible_text(const QRect& rect, int dy) {
+
+  if (dy == 0 && !rect.contains(text_widget->viewport()->rect())) {
+    return;
+  }
+
+  if (highlighter != nullptr) {
+    highlighter->highlight_until(text_widget->get_last_visible_block_number());
+  }
 }
 
+}
@@ -184,6 +184,29 @@ int TextEditorWidget::get_line_number_area_width() {
   return space;
 }
 
+/**
+ * @brief Returns the number of the last block that is at least partially
+ * visible.
+ * @return The block number.
+ */
+int TextEditorWidget::get_last_visible_block_number() {
+
+  const int bottom = viewport()->rect().bottom();
+  QTextBlock block = firstVisibleBlock();
+  if (!block.isValid()) {
+    return blockCount() - 1;
+  }
+
+  QTextBlock next = block.next();
+  while (next.isValid() &&
+         blockBoundingGeometry(next).translated(contentOffset()).top() <= bottom) {
+    block = next;
+    next = block.next();
+  }
+
+  return block.blockNumber();
+}
+
 /**
  * @brief Slot called when the number of blocks has changed.
  *
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "widgets/texture_report_dialog.h"
+#include "editor_settings.h"
+#include "quest.h"
+#include <QHeaderView>
+
+namespace SolarusEditor {
+
+/**
+ * @brief Creates a texture report dialog.
+ * @param quest The quest.
+ * @param parent The parent object or nullptr.
+ */
+TextureReportDialog::TextureReportDialog(Quest& quest, QWidget* parent) :
+  QDialog(parent),
+  ui(),
+  quest(quest),
+  model(quest),
+  sort_model() {
+
+  ui.setupUi(this);
+
+  EditorSettings settings;
+  ui.budget_field->setValue(settings.get_value_int(EditorSettings::texture_budget));
+  model.set_budget(static_cast<qint64>(ui.budget_field->value()) * 1024 * 1024);
+
+  sort_model.setSourceModel(&model);
+  sort_model.setSortRole(Qt::UserRole);
+  ui.table_view->setModel(&sort_model);
+  ui.table_view->setSortingEnabled(true);
+  ui.table_view->sortByColumn(TextureReportModel::MEMORY_COLUMN, Qt::DescendingOrder);
+  ui.table_view->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  ui.table_view->horizontalHeader()->setSectionResizeMode(
+        TextureReportModel::ID_COLUMN, QHeaderView::Stretch);
+  ui.table_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+  connect(ui.table_view, SIGNAL(doubleClicked(QModelIndex)),
+          this, SLOT(row_activated(QModelIndex)));
+  connect(ui.budget_field, SIGNAL(editingFinished()),
+          this, SLOT(budget_changed()));
+  connect(&model, SIGNAL(modelReset()),
+          this, SLOT(update_status()));
+  connect(&model, SIGNAL(dataChanged(QModelIndex, QModelIndex)),
+          this, SLOT(update_status()));
+  connect(&model, SIGNAL(loading_finished()),
+          this, SLOT(update_status()));
+
+  reload();
+}
+
+/**
+ * @brief Analyzes again the maps that changed and updates the report.
+ */
+void TextureReportDialog::reload() {
+
+  model.reload();
+}
+
+/**
+ * @brief Slot called when the user double-clicks a row.
+ *
+ * Opens the map of this row.
+ *
+ * @param index Index of a cell in the row.
+ */
+void TextureReportDialog::row_activated(const QModelIndex& index) {
+
+  const QString& map_id = model.get_map_id(sort_model.mapToSource(index).row());
+  if (map_id.isEmpty()) {
+    return;
+  }
+
+  emit open_file_requested(quest, quest.get_map_data_file_path(map_id));
+}
+
+/**
+ * @brief Slot called when the user changes the memory budget.
+ */
+void TextureReportDialog::budget_changed() {
+
+  const int budget = ui.budget_field->value();
+  EditorSettings settings;
+  settings.set_value(EditorSettings::texture_budget, budget);
+  model.set_budget(static_cast<qint64>(budget) * 1024 * 1024);
+}
+
+/**
+ * @brief Updates the status text.
+ */
+void TextureReportDialog::update_status() {
+
+  QString status = tr("%1 maps over budget").arg(model.get_num_maps_over_budget());
+
+  const int num_pending = model.get_num_pending();
+  if (num_pending > 0) {
+    status += tr(" (analyzing %1 maps...)").arg(num_pending);
+  }
+  ui.status_label->setText(status);
+}
+
+}
@@ -18,51 +18,19 @@
 #include "widgets/tileset_scene.h"
 #include "quest.h"
 #include "tileset_model.h"
-#include <QDebug>
-#include <QGraphicsSceneMouseEvent>
-#include <QGraphicsPixmapItem>
 #include <QPainter>
-#include <QPalette>
-#include <QStyleOptionGraphicsItem>
-#include <memory>
+#include <algorithm>
 
 namespace SolarusEditor {
 
+namespace {
+
 /**
- * @brief Graphic item representing a tile pattern.
+ * @brief Size in pixels of a cell of the grid used to find patterns.
  */
-class PatternItem : public QGraphicsPixmapItem {
-
-public:
-
-  PatternItem(TilesetModel& model, int index);
-
-  // Enable the use of qgraphicsitem_cast with this item.
-  enum {
-    Type = UserType + 1
-  };
-
-  int type() const override {
-    return Type;
-  }
-
-  int get_index() const;
-  void set_index(int index);
-
-  void rebuild_pixmap();
-
-protected:
+constexpr int cell_size = 64;
 
-  void paint(QPainter* painter,
-             const QStyleOptionGraphicsItem* option,
-             QWidget* widget = nullptr) override;
-
-private:
-
-  TilesetModel& model;      /**< The tileset this pattern belongs to. */
-  int index;                /**< Index of the pattern in the tileset. */
-
-};
+}
 
 /**
  * @brief Creates a tileset scene.
@@ -71,15 +39,17 @@ private:
  */
 TilesetScene::TilesetScene(TilesetModel& model, QObject* parent) :
   QGraphicsScene(parent),
-  model(model) {
+  model(model),
+  pattern_cells_dirty(true),
+  num_columns(0),
+  num_rows(0),
+  pattern_cells() {
 
   build();
 
-  // Synchronize the scene selection with the tileset selection model.
+  // Redraw selection markers when the tileset selection changes.
   connect(&model.get_selection_model(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)),
           this, SLOT(update_selection_to_scene(QItemSelection, QItemSelection)));
-  connect(this, SIGNAL(selectionChanged()),
-          this, SLOT(set_selection_from_scene()));
 
   // Watch pattern geometry changes.
   connect(&model, SIGNAL(pattern_position_changed(int, QPoint)),
@@ -117,18 +87,100 @@ const Quest& TilesetScene::get_quest() const {
 }
 
 /**
- * @brief Returns the index of the pattern represented by an item.
- * @param item A graphic item.
- * @return The pattern index, or -1 if this is not a pattern item of the scene.
+ * @brief Returns the pattern at the specified point.
+ * @param xy A point in scene coordinates.
+ * @return Index of the pattern whose frames bounding box contains this point,
+ * or -1 if there is no pattern here.
+ * If several patterns overlap, the one with the highest index is returned.
  */
-int TilesetScene::get_pattern_index(const QGraphicsItem* item) {
+int TilesetScene::get_pattern_index_at(const QPoint& xy) const {
 
-  const PatternItem* pattern_item = qgraphicsitem_cast<const PatternItem*>(item);
-  if (pattern_item == nullptr) {
+  const QList<int>& indexes = get_pattern_indexes_in(
+        QRect(xy, QSize(1, 1)), Qt::IntersectsItemBoundingRect);
+  if (indexes.isEmpty()) {
     return -1;
   }
+  return indexes.last();
+}
+
+/**
+ * @brief Returns the patterns in a rectangle.
+ * @param area A rectangle in scene coordinates.
+ * @param mode Qt::ContainsItemBoundingRect to only get patterns whose
+ * frames bounding box is entirely in the rectangle,
+ * Qt::IntersectsItemBoundingRect to get patterns that intersect it.
+ * @return Indexes of these patterns in ascending order.
+ */
+QList<int> TilesetScene::get_pattern_indexes_in(
+    const QRect& area, Qt::ItemSelectionMode mode) const {
+
+  QList<int> result;
+  if (area.isEmpty()) {
+    return result;
+  }
+
+  if (pattern_cells_dirty) {
+    build_pattern_cells();
+  }
+  if (pattern_cells.isEmpty()) {
+    return result;
+  }
+
+  // Only look at patterns registered in cells that the area covers.
+  const int min_column = qBound(0, area.left() / cell_size, num_columns - 1);
+  const int max_column = qBound(0, area.right() / cell_size, num_columns - 1);
+  const int min_row = qBound(0, area.top() / cell_size, num_rows - 1);
+  const int max_row = qBound(0, area.bottom() / cell_size, num_rows - 1);
+  for (int row = min_row; row <= max_row; ++row) {
+    for (int column = min_column; column <= max_column; ++column) {
+      result.append(pattern_cells.at(row * num_columns + column));
+    }
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+
+  auto it = result.begin();
+  while (it != result.end()) {
+    const QRect& box = model.get_pattern_frames_bounding_box(*it);
+    const bool match = (mode == Qt::ContainsItemBoundingRect) ?
+          area.contains(box) : area.intersects(box);
+    if (match) {
+      ++it;
+    }
+    else {
+      it = result.erase(it);
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Rebuilds the grid of patterns after they have changed.
+ */
+void TilesetScene::build_pattern_cells() const {
 
-  return pattern_item->get_index();
+  pattern_cells_dirty = false;
+  pattern_cells.clear();
+
+  const QSize& image_size = model.get_patterns_image().size();
+  num_columns = qMax(1, (image_size.width() + cell_size - 1) / cell_size);
+  num_rows = qMax(1, (image_size.height() + cell_size - 1) / cell_size);
+  pattern_cells.resize(num_columns * num_rows);
+
+  for (int i = 0; i < model.get_num_patterns(); ++i) {
+    // Patterns outside the image are stored in border cells.
+    const QRect& box = model.get_pattern_frames_bounding_box(i);
+    const int min_column = qBound(0, box.left() / cell_size, num_columns - 1);
+    const int max_column = qBound(0, box.right() / cell_size, num_columns - 1);
+    const int min_row = qBound(0, box.top() / cell_size, num_rows - 1);
+    const int max_row = qBound(0, box.bottom() / cell_size, num_rows - 1);
+    for (int row = min_row; row <= max_row; ++row) {
+      for (int column = min_column; column <= max_column; ++column) {
+        pattern_cells[row * num_columns + column].append(i);
+      }
+    }
+  }
 }
 
 /**
@@ -142,20 +194,46 @@ void TilesetScene::drawBackground(QPainter* painter, const QRectF& rect) {
   // Draw the background color.
   painter->fillRect(rect, backgroundBrush());
 
-  // Draw the full PNG image of the tileset.
+  // Draw the exposed part of the PNG image of the tileset.
   const QImage& patterns_image = model.get_patterns_image();
   if (!patterns_image.isNull()) {
-    painter->drawImage(0, 0, patterns_image);
+    const QRectF& exposed = rect.intersected(QRectF(patterns_image.rect()));
+    painter->drawImage(exposed, patterns_image, exposed);
   }
 }
 
 /**
- * @brief Create all patterns items in the scene.
+ * @brief Draws the selection marker of selected patterns.
+ * @param painter The painter.
+ * @param rect The exposed rectangle in scene coordinates.
+ */
+void TilesetScene::drawForeground(QPainter* painter, const QRectF& rect) {
+
+  if (model.is_selection_empty()) {
+    return;
+  }
+
+  const QList<int>& indexes = get_pattern_indexes_in(
+        rect.toAlignedRect(), Qt::IntersectsItemBoundingRect);
+  for (int index : indexes) {
+    if (!model.is_selected(index)) {
+      continue;
+    }
+
+    const QList<QRect>& frames = model.get_pattern_frames(index);
+    for (const QRect& frame : frames) {
+      GuiTools::draw_rectangle_border(*painter, frame, Qt::blue, 1);
+    }
+  }
+}
+
+/**
+ * @brief Initializes the scene.
  */
 void TilesetScene::build() {
 
   clear();
-  pattern_items.clear();
+  pattern_cells_dirty = true;
 
   if (model.get_patterns_image().isNull()) {
     // The tileset image does not exist yet.
@@ -167,20 +245,12 @@ void TilesetScene::build() {
   }
 
   setSceneRect(QRectF(QPoint(0, 0), model.get_patterns_image().size()));
-  for (int i = 0; i < model.get_num_patterns(); ++i) {
-
-    // TODO make a function to create an item.
-    PatternItem* pattern_item = new PatternItem(model, i);
-    addItem(pattern_item);
-    pattern_items.append(pattern_item);
-  }
-
 }
 
 /**
  * @brief Slot called when the tileset selection has changed.
  *
- * The selection on the scene is updated.
+ * The selection markers of patterns that changed are redrawn.
  *
  * @param selected Items that have just been selected.
  * @param deselected Item that have just been deselected.
@@ -188,19 +258,11 @@ void TilesetScene::build() {
 void TilesetScene::update_selection_to_scene(
     const QItemSelection& selected, const QItemSelection& deselected) {
 
-  const bool was_blocked = signalsBlocked();
-  blockSignals(true);
-
-  // Update the scene with the change.
-  bool changed = false;
   const QModelIndexList& selected_indexes = selected.indexes();
   for (const QModelIndex& model_index : selected_indexes) {
     int index = model_index.row();
     if (model.pattern_exists(index)) {
-      if (!pattern_items[index]->isSelected()) {
-        pattern_items[index]->setSelected(true);
-        changed = true;
-      }
+      update(model.get_pattern_frames_bounding_box(index));
     }
   }
 
@@ -208,37 +270,9 @@ void TilesetScene::update_selection_to_scene(
   for (const QModelIndex& model_index : deselected_indexes) {
     int index = model_index.row();
     if (model.pattern_exists(index)) {
-      if (pattern_items[index]->isSelected()) {
-        pattern_items[index]->setSelected(false);
-        changed = true;
-      }
-    }
-  }
-  blockSignals(was_blocked);
-
-  if (changed) {
-    emit selectionChanged();
-  }
-}
-
-/**
- * @brief Slot called when the scene selection has changed.
- *
- * The new selection is forwarded to the tileset model.
- */
-void TilesetScene::set_selection_from_scene() {
-
-  // Forward the change to the tileset.
-  QList<int> indexes;
-  const QList<QGraphicsItem*>& selected_items = selectedItems();
-  for (QGraphicsItem* item : selected_items) {
-    PatternItem* pattern_item = qgraphicsitem_cast<PatternItem*>(item);
-    if (pattern_item != nullptr) {
-      indexes << pattern_item->get_index();
+      update(model.get_pattern_frames_bounding_box(index));
     }
   }
-
-  model.set_selected_indexes(indexes);
 }
 
 /**
@@ -246,18 +280,7 @@ void TilesetScene::set_selection_from_scene() {
  */
 void TilesetScene::select_all() {
 
-  const bool was_blocked = signalsBlocked();
-  blockSignals(true);
-  for (PatternItem* item : pattern_items) {
-    if (item == nullptr) {
-      continue;
-    }
-    item->setSelected(true);
-  }
-  blockSignals(was_blocked);
-
-  // Emit the signal only once.
-  emit selectionChanged();
+  model.select_all();
 }
 
 /**
@@ -265,18 +288,16 @@ void TilesetScene::select_all() {
  */
 void TilesetScene::unselect_all() {
 
-  const bool was_blocked = signalsBlocked();
-  blockSignals(true);
-  for (PatternItem* item : pattern_items) {
-    if (item == nullptr) {
-      continue;
-    }
-    item->setSelected(false);
-  }
-  blockSignals(was_blocked);
+  model.clear_selection();
+}
 
-  // Emit the signal only once.
-  emit selectionChanged();
+/**
+ * @brief Invalidates the pattern grid and redraws the scene.
+ */
+void TilesetScene::patterns_changed() {
+
+  pattern_cells_dirty = true;
+  update();
 }
 
 /**
@@ -285,12 +306,8 @@ void TilesetScene::unselect_all() {
  */
 void TilesetScene::update_pattern_position(int index) {
 
-  const QRect& box = model.get_pattern_frames_bounding_box(index);
-  PatternItem* pattern_item = qgraphicsitem_cast<PatternItem*>(pattern_items[index]);
-  if (pattern_item != nullptr) {
-    pattern_item->setPos(box.topLeft());
-    pattern_item->setPixmap(model.get_pattern_image_all_frames(index));
-  }
+  Q_UNUSED(index);
+  patterns_changed();
 }
 
 /**
@@ -299,61 +316,39 @@ void TilesetScene::update_pattern_position(int index) {
  */
 void TilesetScene::update_pattern_animation(int index) {
 
-  // Redraw the area containing the pattern: the selection marker may
-  // have changed.
-  const QRect& box = model.get_pattern_frames_bounding_box(index);
-  update(box);
+  // The frames of the pattern may have changed.
+  Q_UNUSED(index);
+  patterns_changed();
 }
 
 /**
  * @brief Slot called when a pattern is created.
- *
- * Elements are shifted in the items list.
- *
  * @param new_index Index of the newly created pattern.
  * @param new_id Id of the pattern.
  */
 void TilesetScene::pattern_created(
-    int new_index, const QString& /* new_id */) {
-
-  // Keep the items list in sync with patterns in the model.
-  PatternItem* pattern_item = new PatternItem(model, new_index);
-  addItem(pattern_item);
-  pattern_items.insert(new_index, pattern_item);
+    int /* new_index */, const QString& /* new_id */) {
 
-  // Each item stores its order, so we need to update them.
-  for (int i = 0; i < pattern_items.size(); ++i) {
-    pattern_items[i]->set_index(i);
-  }
+  // Indexes of patterns after this one have changed.
+  patterns_changed();
 }
 
 /**
  * @brief Slot called when a pattern is deleted.
- *
- * Elements are shifted in the items list.
- *
  * @param old_index Index of the pattern before it was deleted.
  * @param old_id Id of the deleted pattern.
  */
 void TilesetScene::pattern_deleted(
-    int old_index, const QString& /* old_id */) {
+    int /* old_index */, const QString& /* old_id */) {
 
-  // Keep the items list in sync with patterns in the model.
-  std::unique_ptr<PatternItem> item = std::unique_ptr<PatternItem>(
-        pattern_items.takeAt(old_index));
-
-  // Each item stores its order, so we need to update them.
-  for (int i = 0; i < pattern_items.size(); ++i) {
-    pattern_items[i]->set_index(i);
-  }
-
-  removeItem(item.get());
+  // Indexes of patterns after this one have changed.
+  patterns_changed();
 }
 
 /**
  * @brief Slot called when the id of a pattern changes.
  *
- * This changes its order in the items list.
+ * This changes its order in the tileset.
  *
  * @param old_index Index of the pattern before the change.
  * @param old_id Id of the pattern before the change.
@@ -361,16 +356,10 @@ void TilesetScene::pattern_deleted(
  * @param new_id Id of the pattern after the change.
  */
 void TilesetScene::pattern_id_changed(
-    int old_index, const QString& /* old_id */,
-    int new_index, const QString& /* new_id */) {
-
-  // Keep the items list ordered as patterns in the model.
-  pattern_items.move(old_index, new_index);
+    int /* old_index */, const QString& /* old_id */,
+    int /* new_index */, const QString& /* new_id */) {
 
-  // Each item stores its order, so we need to update them.
-  for (int i = 0; i < pattern_items.size(); ++i) {
-    pattern_items[i]->set_index(i);
-  }
+  patterns_changed();
 }
 
 /**
@@ -378,101 +367,7 @@ void TilesetScene::pattern_id_changed(
  */
 void TilesetScene::image_changed() {
 
-  for (int i = 0; i < pattern_items.size(); ++i) {
-    pattern_items[i]->rebuild_pixmap();
-  }
-}
-
-/**
- * @brief Creates a pattern item.
- * @param model The tileset.
- * @param index Index of the pattern in the tileset.
- */
-PatternItem::PatternItem(TilesetModel& model, int index) :
-  QGraphicsPixmapItem(),
-  model(model),
-  index(index) {
-
-  QRect frame = model.get_pattern_frames_bounding_box(index);
-  setPos(frame.topLeft());
-  setFlags(ItemIsSelectable | ItemIsFocusable);
-  rebuild_pixmap();
-}
-
-/**
- * @brief Returns the index of the pattern in the tileset.
- * @return The pattern index.
- */
-int PatternItem::get_index() const {
-  return index;
-}
-
-/**
- * @brief Sets the index of the pattern in the tileset.
- * @param index The new index.
- */
-void PatternItem::set_index(int index) {
-  this->index = index;
-}
-
-/**
- * @brief Creates or recreates the pixmap of this item.
- *
- * This function should be called when the PNG image of the tileset has changed.
- */
-void PatternItem::rebuild_pixmap() {
-
-  setPixmap(model.get_pattern_image_all_frames(index));
-}
-
-/**
- * @brief Paints the pattern item.
- *
- * Reimplemented to draw our own selection marker.
- *
- * @param painter The painter.
- * @param option Style option of the item.
- * @param widget The widget being painted or nullptr.
- */
-void PatternItem::paint(QPainter* painter,
-                        const QStyleOptionGraphicsItem* option,
-                        QWidget* widget) {
-
-  if (!model.pattern_exists(index)) {
-    // Bug in the editor.
-    qCritical() << TilesetScene::tr("No such pattern index: %1").arg(index);
-    return;
-  }
-
-  QRect box = model.get_pattern_frames_bounding_box(index);
-  QPoint top_left = box.topLeft();
-  box.translate(-top_left);
-
-  // Start with an opaque background, to erase anything below
-  // if the pattern has transparency.
-  if (scene() != nullptr) {
-    painter->fillRect(box, scene()->backgroundBrush());
-  } else {
-    painter->fillRect(box, widget->palette().base());
-  }
-
-  const bool selected = option->state & QStyle::State_Selected;
-
-  // First, paint the item like if there was no selection, to avoid
-  // Qt's built-in selection marker.
-  QStyleOptionGraphicsItem option_deselected = *option;
-  option_deselected.state &= ~QStyle::State_Selected;
-  QGraphicsPixmapItem::paint(painter, &option_deselected, widget);
-
-  // Add our selection marker.
-  if (selected) {
-    const QList<QRect>& frames = model.get_pattern_frames(index);
-
-    for (QRect frame : frames) {
-      frame.translate(-top_left);
-      GuiTools::draw_rectangle_border(*painter, frame, Qt::blue, 1);
-    }
-  }
+  patterns_changed();
 }
 
 }
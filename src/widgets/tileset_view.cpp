@@ -345,11 +345,8 @@ void TilesetView::mousePressEvent(QMouseEvent* event) {
 
   if (state == State::NORMAL) {
 
-    QList<QGraphicsItem*> items_under_mouse = items(
-          QRect(event->pos(), QSize(1, 1)),
-          Qt::IntersectsItemBoundingRect  // Pick transparent items too.
-    );
-    QGraphicsItem* item = items_under_mouse.empty() ? nullptr : items_under_mouse.first();
+    // Transparent patterns are picked too.
+    const int index = scene->get_pattern_index_at(mapToScene(event->pos()).toPoint());
 
     const bool control_or_shift = (event->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier));
 
@@ -358,18 +355,17 @@ void TilesetView::mousePressEvent(QMouseEvent* event) {
       // If ctrl or shift is pressed, keep the existing selection.
       keep_selected = true;
     }
-    else if (item != nullptr && item->isSelected()) {
+    else if (index != -1 && model->is_selected(index)) {
       // When clicking an already selected item, keep the existing selection too.
       keep_selected = true;
     }
     if (!keep_selected) {
-      scene->clearSelection();
+      model->clear_selection();
     }
 
     if (event->button() == Qt::LeftButton) {
-      if (item != nullptr &&
-          item->isSelected() &&
-          !model->is_selection_empty() &&
+      if (index != -1 &&
+          model->is_selected(index) &&
           !control_or_shift &&
           !is_read_only()) {
         // Clicking on an already selected item: allow to move it.
@@ -377,14 +373,14 @@ void TilesetView::mousePressEvent(QMouseEvent* event) {
       }
       else {
         // Otherwise initialize a selection rectangle.
-        initially_selected_items = scene->selectedItems();
+        initially_selected_indexes = model->get_selected_indexes();
         start_state_drawing_rectangle(event->pos());
       }
     }
     else {
-      if (item != nullptr && !item->isSelected()) {
+      if (index != -1 && !model->is_selected(index)) {
         // Select the right-clicked item.
-        item->setSelected(true);
+        model->add_to_selected(index);
         emit selection_changed_by_user();
       }
     }
@@ -416,11 +412,8 @@ void TilesetView::mouseReleaseEvent(QMouseEvent* event) {
     if (event->button() == Qt::LeftButton || event->button() == Qt::RightButton) {
 
       // Left or right button: possibly change the selection.
-      QList<QGraphicsItem*> items_under_mouse = items(
-            QRect(event->pos(), QSize(1, 1)),
-            Qt::IntersectsItemBoundingRect  // Pick transparent items too.
-            );
-      QGraphicsItem* item = items_under_mouse.empty() ? nullptr : items_under_mouse.first();
+      // Transparent patterns are picked too.
+      const int index = scene->get_pattern_index_at(mapToScene(event->pos()).toPoint());
 
       const bool control_or_shift = (event->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier));
 
@@ -429,35 +422,35 @@ void TilesetView::mouseReleaseEvent(QMouseEvent* event) {
         // If ctrl or shift is pressed, keep the existing selection.
         keep_selected = true;
       }
-      else if (item != nullptr && item->isSelected()) {
+      else if (index != -1 && model->is_selected(index)) {
         // When clicking an already selected item, keep the existing selection too.
         keep_selected = true;
       }
 
       if (!keep_selected) {
         bool selection_was_empty = get_model()->is_selection_empty();
-        scene->clearSelection();
+        model->clear_selection();
 
-        if (item == nullptr && selection_was_empty) {
+        if (index == -1 && selection_was_empty) {
           // The user clicked outside any item, to unselect everything.
           emit selection_changed_by_user();
         }
       }
 
-      if (item != nullptr) {
+      if (index != -1) {
         // Clicked an item.
 
         if (event->button() == Qt::LeftButton) {
 
           if (control_or_shift) {
             // Left-clicking an item while pressing control or shift: toggle it.
-            item->setSelected(!item->isSelected());
+            model->toggle_selected(index);
             emit selection_changed_by_user();
           }
           else {
-            if (!item->isSelected()) {
+            if (!model->is_selected(index)) {
               // Select the item.
-              item->setSelected(true);
+              model->add_to_selected(index);
               emit selection_changed_by_user();
             }
           }
@@ -522,8 +515,12 @@ void TilesetView::contextMenuEvent(QContextMenuEvent* event) {
     where = event->pos();
   }
   else {
-    QList<QGraphicsItem*> selected_items = scene->selectedItems();
-    where = mapFromScene(selected_items.first()->pos() + QPoint(8, 8));
+    const QList<int>& selected_indexes = model->get_selected_indexes();
+    if (selected_indexes.isEmpty()) {
+      return;
+    }
+    const QRect& box = model->get_pattern_frames_bounding_box(selected_indexes.first());
+    where = mapFromScene(box.topLeft() + QPoint(8, 8));
   }
 
   show_context_menu(where);
@@ -770,7 +767,7 @@ void TilesetView::end_state_drawing_rectangle() {
   QRect rectangle = current_area_items.first()->rect().toRect();
   if (!rectangle.isEmpty() &&
       sceneRect().contains(rectangle) &&
-      get_items_intersecting_current_areas().isEmpty() &&
+      get_patterns_intersecting_current_areas().isEmpty() &&
       model->is_selection_empty() &&
       !is_read_only()) {
 
@@ -809,7 +806,7 @@ void TilesetView::end_state_drawing_rectangle() {
   }
 
   clear_current_areas();
-  initially_selected_items.clear();
+  initially_selected_indexes.clear();
   start_state_normal();
 }
 
@@ -878,7 +875,7 @@ void TilesetView::end_state_moving_patterns() {
   box.translate(delta);
   if (!box.isEmpty() &&
       sceneRect().contains(box) &&
-      get_items_intersecting_current_areas().isEmpty() &&
+      get_patterns_intersecting_current_areas().isEmpty() &&
       !model->is_selection_empty() &&
       !is_read_only() &&
       dragging_current_point != dragging_start_point) {
@@ -893,7 +890,7 @@ void TilesetView::end_state_moving_patterns() {
     QAction* duplicate_pattern_action = new QAction(
       QIcon(":/images/icon_copy.png"), tr("Duplicate here"), this);
     duplicate_pattern_action->setEnabled(
-      get_items_intersecting_current_areas(false).isEmpty());
+      get_patterns_intersecting_current_areas(false).isEmpty());
     connect(duplicate_pattern_action, &QAction::triggered, [this, delta] {
       emit duplicate_selected_patterns_requested(delta);
     });
@@ -938,12 +935,12 @@ void TilesetView::dragMoveEvent(QDragMoveEvent* event) {
     QGraphicsRectItem* item = new QGraphicsRectItem(area);
 
     // Check overlapping existing patterns.
-    QList<QGraphicsItem*> items = scene->items(
+    const QList<int>& overlapping_indexes = scene->get_pattern_indexes_in(
       area.adjusted(1, 1, -1, -1), Qt::IntersectsItemBoundingRect);
 
     if (!area.isEmpty() &&
         sceneRect().contains(area) &&
-        items.isEmpty() &&
+        overlapping_indexes.isEmpty() &&
         !is_read_only()) {
       item->setPen(QPen(Qt::yellow));
     } else {
@@ -1002,16 +999,17 @@ void TilesetView::update_current_areas(
     current_area_items.first()->setRect(area);
 
     // Select items strictly in the rectangle.
-    scene->clearSelection();
-    QPainterPath path;
-    path.addRect(QRect(area.topLeft() - QPoint(1, 1),
-                       area.size() + QSize(2, 2)));
-    scene->setSelectionArea(path, Qt::ContainsItemBoundingRect);
+    QList<int> indexes = scene->get_pattern_indexes_in(
+          QRect(area.topLeft() - QPoint(1, 1), area.size() + QSize(2, 2)),
+          Qt::ContainsItemBoundingRect);
 
     // Re-select items that were already selected if Ctrl or Shift was pressed.
-    for (QGraphicsItem* item : initially_selected_items) {
-      item->setSelected(true);
+    for (int index : initially_selected_indexes) {
+      if (!indexes.contains(index)) {
+        indexes << index;
+      }
     }
+    model->set_selected_indexes(indexes);
   }
 }
 
@@ -1028,31 +1026,32 @@ void TilesetView::clear_current_areas() {
 }
 
 /**
- * @brief Returns all items that intersect the rectangles drawn by the user
- * except selected items.
+ * @brief Returns all patterns that intersect the rectangles drawn by the user
+ * except selected patterns.
  * @param ignore_selected @c true if the selection should be ignored.
- * @return The items that intersect the drawn rectangle.
+ * @return Indexes of the patterns that intersect the drawn rectangles.
  */
-QList<QGraphicsItem*> TilesetView::get_items_intersecting_current_areas(
+QList<int> TilesetView::get_patterns_intersecting_current_areas(
     bool ignore_selected) const {
 
-  QList<QGraphicsItem*> items;
+  QList<int> indexes;
 
   for (QGraphicsRectItem* item : current_area_items) {
     QRect area = item->rect().toRect().adjusted(1, 1, -1, -1);
-    items.append(scene->items(area, Qt::IntersectsItemBoundingRect));
-    items.removeAll(item); // Ignore the drawn rectangle itself.
-  }
-
-  // Ignore selected items.
-  if (ignore_selected) {
-    const QList<QGraphicsItem*> selected_items = scene->selectedItems();
-    for (QGraphicsItem* item : selected_items) {
-      items.removeAll(item);
+    const QList<int>& area_indexes = scene->get_pattern_indexes_in(
+          area, Qt::IntersectsItemBoundingRect);
+    for (int index : area_indexes) {
+      // Ignore selected patterns.
+      if (ignore_selected && model->is_selected(index)) {
+        continue;
+      }
+      if (!indexes.contains(index)) {
+        indexes << index;
+      }
     }
   }
 
-  return items;
+  return indexes;
 }
 
 /**
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "widgets/translation_matrix_dialog.h"
+#include "quest.h"
+#include <QHeaderView>
+
+namespace SolarusEditor {
+
+/**
+ * @brief Creates a translation matrix dialog.
+ * @param quest The quest.
+ * @param parent The parent object or nullptr.
+ */
+TranslationMatrixDialog::TranslationMatrixDialog(Quest& quest, QWidget* parent) :
+  QDialog(parent),
+  ui(),
+  quest(quest),
+  model(quest) {
+
+  ui.setupUi(this);
+
+  ui.kind_field->addItem(tr("Dialogs"), static_cast<int>(TranslationMatrixModel::Kind::DIALOGS));
+  ui.kind_field->addItem(tr("Strings"), static_cast<int>(TranslationMatrixModel::Kind::STRINGS));
+  ui.reference_field->set_resource_type(ResourceType::LANGUAGE);
+  ui.reference_field->set_quest(quest);
+
+  ui.table_view->setModel(&model);
+  ui.table_view->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+  ui.table_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+  connect(ui.kind_field, SIGNAL(activated(int)),
+          this, SLOT(kind_selector_activated()));
+  connect(ui.reference_field, SIGNAL(activated(QString)),
+          this, SLOT(reference_selector_activated()));
+  connect(ui.problems_only_field, SIGNAL(toggled(bool)),
+          this, SLOT(update_rows()));
+  connect(ui.table_view, SIGNAL(doubleClicked(QModelIndex)),
+          this, SLOT(cell_activated(QModelIndex)));
+  connect(&model, SIGNAL(modelReset()),
+          this, SLOT(update_rows()));
+  connect(&model, SIGNAL(dataChanged(QModelIndex, QModelIndex)),
+          this, SLOT(update_rows()));
+
+  ui.status_label->setText(tr("Loading..."));
+  model.load(TranslationMatrixModel::Kind::DIALOGS);
+}
+
+/**
+ * @brief Sets the language other languages are compared to.
+ * @param language_id A language id.
+ */
+void TranslationMatrixDialog::set_reference_language(const QString& language_id) {
+
+  ui.reference_field->set_selected_id(language_id);
+  model.set_reference_language(language_id);
+}
+
+/**
+ * @brief Slot called when a file of the quest is saved.
+ * @param path Path of the saved file.
+ */
+void TranslationMatrixDialog::file_saved(const QString& path) {
+
+  model.file_saved(path);
+}
+
+/**
+ * @brief Slot called when the user changes the kind of files shown.
+ */
+void TranslationMatrixDialog::kind_selector_activated() {
+
+  const TranslationMatrixModel::Kind kind =
+      static_cast<TranslationMatrixModel::Kind>(ui.kind_field->currentData().toInt());
+  if (kind == model.get_kind()) {
+    return;
+  }
+
+  ui.status_label->setText(tr("Loading..."));
+  model.load(kind);
+}
+
+/**
+ * @brief Slot called when the user changes the reference language.
+ */
+void TranslationMatrixDialog::reference_selector_activated() {
+
+  model.set_reference_language(ui.reference_field->get_selected_id());
+}
+
+/**
+ * @brief Slot called when the user double-clicks a cell.
+ *
+ * Opens the dialogs or strings file of the language of this cell.
+ *
+ * @param index Index of the cell.
+ */
+void TranslationMatrixDialog::cell_activated(const QModelIndex& index) {
+
+  const QString& language_id = model.get_language(index.column());
+  if (language_id.isEmpty()) {
+    return;
+  }
+
+  emit open_file_requested(
+        quest,
+        model.get_kind() == TranslationMatrixModel::Kind::DIALOGS ?
+          quest.get_dialogs_path(language_id) :
+          quest.get_strings_path(language_id));
+}
+
+/**
+ * @brief Updates the visible rows and the status text.
+ */
+void TranslationMatrixDialog::update_rows() {
+
+  if (model.is_loading()) {
+    return;
+  }
+
+  ui.reference_field->set_selected_id(model.get_reference_language());
+
+  const bool problems_only = ui.problems_only_field->isChecked();
+  int num_missing = 0;
+  int num_outdated = 0;
+  for (int row = 0; row < model.rowCount(); ++row) {
+    const int flags = model.get_row_flags(row);
+    if (flags & TranslationMatrixModel::MISSING) {
+      ++num_missing;
+    }
+    if (flags & TranslationMatrixModel::OUTDATED) {
+      ++num_outdated;
+    }
+    ui.table_view->setRowHidden(row, problems_only && flags == 0);
+  }
+
+  ui.status_label->setText(tr("%1 keys, %2 with missing translations, %3 with outdated translations").
+                           arg(model.rowCount()).arg(num_missing).arg(num_outdated));
+}
+
+}
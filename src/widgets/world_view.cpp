@@ -0,0 +1,778 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "widgets/pan_tool.h"
+#include "widgets/world_view.h"
+#include "widgets/zoom_tool.h"
+#include "color.h"
+#include "data_file_cache.h"
+#include "point.h"
+#include "quest.h"
+#include "quest_database.h"
+#include "rectangle.h"
+#include "size.h"
+#include <solarus/core/MapData.h>
+#include <solarus/entities/TilesetData.h>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QGraphicsItem>
+#include <QHash>
+#include <QMouseEvent>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QScrollBar>
+#include <QStyleOptionGraphicsItem>
+#include <QtConcurrent>
+#include <QtMath>
+
+namespace SolarusEditor {
+
+namespace {
+
+/**
+ * @brief Scale of map thumbnails.
+ */
+constexpr double thumbnail_scale = 0.125;
+
+/**
+ * @brief Maximum number of maps drawn at full scale at the same time.
+ */
+constexpr int max_detailed_maps = 32;
+
+}  // Anonymous namespace.
+
+/**
+ * @brief Tilesets loaded by worker threads.
+ *
+ * Each tileset is loaded once and never modified, so workers can use it
+ * without locking once they have it.
+ */
+class WorldView::TilesetStore {
+
+public:
+
+  /**
+   * @brief What workers need from a tileset to draw tiles.
+   */
+  struct Tileset {
+    QColor background_color;            /**< Background color of maps. */
+    QHash<QString, QImage> patterns;    /**< First frame of each pattern. */
+  };
+
+  explicit TilesetStore(const Quest& quest);
+
+  qint64 get_date(const QString& tileset_id);
+  bool is_up_to_date(const QMap<QString, qint64>& tileset_dates);
+  std::shared_ptr<const Tileset> get_tileset(const QString& tileset_id);
+
+private:
+
+  const Quest& quest;                   /**< The quest. */
+  QMutex mutex;                         /**< Protects the members below. */
+  QHash<QString, qint64> dates;         /**< Modification date of tilesets. */
+  QHash<QString, std::shared_ptr<const Tileset>>
+      tilesets;                         /**< Tilesets already loaded. */
+
+};
+
+/**
+ * @brief Creates an empty tileset store.
+ * @param quest The quest.
+ */
+WorldView::TilesetStore::TilesetStore(const Quest& quest) :
+  quest(quest),
+  mutex(),
+  dates(),
+  tilesets() {
+
+}
+
+/**
+ * @brief Returns the modification date of a tileset.
+ *
+ * This is the most recent date of its data file and of its tiles image.
+ *
+ * @param tileset_id Id of a tileset.
+ * @return The modification date in milliseconds since epoch.
+ */
+qint64 WorldView::TilesetStore::get_date(const QString& tileset_id) {
+
+  {
+    QMutexLocker locker(&mutex);
+    auto it = dates.constFind(tileset_id);
+    if (it != dates.constEnd()) {
+      return it.value();
+    }
+  }
+
+  const qint64 date = qMax(
+        QFileInfo(quest.get_tileset_data_file_path(tileset_id)).lastModified().toMSecsSinceEpoch(),
+        QFileInfo(quest.get_tileset_tiles_image_path(tileset_id)).lastModified().toMSecsSinceEpoch());
+
+  QMutexLocker locker(&mutex);
+  dates.insert(tileset_id, date);
+  return date;
+}
+
+/**
+ * @brief Returns whether tilesets were not modified since a map was drawn.
+ * @param tileset_dates Modification date of the tilesets when the map was drawn.
+ * @return @c true if no tileset was modified.
+ */
+bool WorldView::TilesetStore::is_up_to_date(const QMap<QString, qint64>& tileset_dates) {
+
+  for (auto it = tileset_dates.constBegin(); it != tileset_dates.constEnd(); ++it) {
+    if (get_date(it.key()) != it.value()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Returns a tileset, loading it if necessary.
+ * @param tileset_id Id of a tileset.
+ * @return The tileset, or nullptr if it cannot be loaded.
+ */
+std::shared_ptr<const WorldView::TilesetStore::Tileset>
+WorldView::TilesetStore::get_tileset(const QString& tileset_id) {
+
+  {
+    QMutexLocker locker(&mutex);
+    auto it = tilesets.constFind(tileset_id);
+    if (it != tilesets.constEnd()) {
+      return it.value();
+    }
+  }
+
+  // Load it without locking: other workers may load it too,
+  // only the first one is kept.
+  std::shared_ptr<Tileset> tileset;
+  Solarus::TilesetData tileset_data;
+  const QImage& tiles_image = QImage(quest.get_tileset_tiles_image_path(tileset_id)).
+      convertToFormat(QImage::Format_ARGB32_Premultiplied);
+  if (tileset_data.import_from_file(quest.get_tileset_data_file_path(tileset_id).toStdString()) &&
+      !tiles_image.isNull()) {
+    tileset = std::make_shared<Tileset>();
+    tileset->background_color = Color::to_qcolor(tileset_data.get_background_color());
+    for (const auto& kvp : tileset_data.get_patterns()) {
+      const QRect& frame = Rectangle::to_qrect(kvp.second.get_frame());
+      tileset->patterns.insert(QString::fromStdString(kvp.first), tiles_image.copy(frame));
+    }
+  }
+
+  QMutexLocker locker(&mutex);
+  auto it = tilesets.constFind(tileset_id);
+  if (it != tilesets.constEnd()) {
+    return it.value();
+  }
+  tilesets.insert(tileset_id, tileset);
+  return tileset;
+}
+
+/**
+ * @brief Graphic item showing a map in the world view.
+ *
+ * It shows the full scale image of the map if any, and its thumbnail otherwise.
+ */
+class WorldView::MapItem : public QGraphicsItem {
+
+public:
+
+  MapItem(const QString& map_id, const QRect& area, const QImage& thumbnail);
+
+  const QString& get_map_id() const;
+  bool has_detail() const;
+  void set_detail(const QImage& image);
+
+  QRectF boundingRect() const override;
+  void paint(QPainter* painter,
+             const QStyleOptionGraphicsItem* option,
+             QWidget* widget = nullptr) override;
+
+private:
+
+  QString map_id;                       /**< Id of the map. */
+  QSize size;                           /**< Size of the map. */
+  QPixmap thumbnail;                    /**< The map at a reduced scale. */
+  QPixmap detail;                       /**< The map at full scale or a null pixmap. */
+
+};
+
+/**
+ * @brief Creates a map item.
+ * @param map_id Id of the map.
+ * @param area Location and size of the map in its world.
+ * @param thumbnail The map at a reduced scale.
+ */
+WorldView::MapItem::MapItem(const QString& map_id, const QRect& area, const QImage& thumbnail) :
+  map_id(map_id),
+  size(area.size()),
+  thumbnail(QPixmap::fromImage(thumbnail)),
+  detail() {
+
+  setPos(area.topLeft());
+  setToolTip(map_id);
+}
+
+/**
+ * @brief Returns the id of the map of this item.
+ * @return The map id.
+ */
+const QString& WorldView::MapItem::get_map_id() const {
+  return map_id;
+}
+
+/**
+ * @brief Returns whether the map is currently shown at full scale.
+ * @return @c true if the full scale image is loaded.
+ */
+bool WorldView::MapItem::has_detail() const {
+  return !detail.isNull();
+}
+
+/**
+ * @brief Sets the image of the map at full scale.
+ * @param image The full scale image, or a null image to show the thumbnail.
+ */
+void WorldView::MapItem::set_detail(const QImage& image) {
+
+  detail = image.isNull() ? QPixmap() : QPixmap::fromImage(image);
+  update();
+}
+
+/**
+ * @brief Returns the bounding rectangle of the item.
+ * @return The bounding rectangle.
+ */
+QRectF WorldView::MapItem::boundingRect() const {
+  return QRectF(QPointF(0, 0), size);
+}
+
+/**
+ * @brief Paints the map.
+ * @param painter The painter.
+ * @param option Style option of the item.
+ * @param widget The widget being painted or nullptr.
+ */
+void WorldView::MapItem::paint(QPainter* painter,
+                               const QStyleOptionGraphicsItem* option,
+                               QWidget* widget) {
+
+  Q_UNUSED(option);
+  Q_UNUSED(widget);
+
+  const QRectF& rect = boundingRect();
+  const QPixmap& pixmap = detail.isNull() ? thumbnail : detail;
+  if (pixmap.isNull()) {
+    painter->fillRect(rect, Qt::darkGray);
+  }
+  else {
+    painter->drawPixmap(rect, pixmap, pixmap.rect());
+  }
+
+  // Draw the border and the map id at screen size.
+  painter->save();
+  const QRectF& screen_rect = painter->transform().mapRect(rect);
+  painter->resetTransform();
+  painter->setPen(QPen(Qt::black, 1));
+  painter->drawRect(screen_rect.adjusted(0, 0, -1, -1));
+  if (screen_rect.width() > 40 && screen_rect.height() > 16) {
+    const QRectF& text_rect = screen_rect.adjusted(4, 2, -4, -2);
+    painter->setPen(Qt::black);
+    painter->drawText(text_rect.translated(1, 1), Qt::AlignLeft | Qt::AlignTop, map_id);
+    painter->setPen(Qt::white);
+    painter->drawText(text_rect, Qt::AlignLeft | Qt::AlignTop, map_id);
+  }
+  painter->restore();
+}
+
+/**
+ * @brief Creates an empty world view.
+ * @param quest The quest.
+ * @param parent The parent widget or nullptr.
+ */
+WorldView::WorldView(Quest& quest, QWidget* parent) :
+  QGraphicsView(parent),
+  quest(quest),
+  world(),
+  initial_map_id(),
+  zoom(thumbnail_scale),
+  tilesets(),
+  map_items(),
+  pending_details(),
+  drawing_details(),
+  thumbnail_job(),
+  detail_job() {
+
+  setWindowFlags(Qt::Window);
+  setScene(new QGraphicsScene(this));
+  setBackgroundBrush(Qt::gray);
+  setDragMode(QGraphicsView::ScrollHandDrag);
+  setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+  setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
+  setTransform(QTransform::fromScale(zoom, zoom));
+  resize(800, 600);
+
+  new PanTool(this);
+  new ZoomTool(this);
+
+  connect(&thumbnail_job, SIGNAL(resultReadyAt(int)),
+          this, SLOT(thumbnail_loaded(int)));
+  connect(&thumbnail_job, SIGNAL(finished()),
+          this, SLOT(update_visible_area()));
+  connect(&detail_job, SIGNAL(resultReadyAt(int)),
+          this, SLOT(detail_loaded(int)));
+  connect(&detail_job, SIGNAL(finished()),
+          this, SLOT(detail_job_finished()));
+  connect(horizontalScrollBar(), SIGNAL(valueChanged(int)),
+          this, SLOT(update_visible_area()));
+  connect(verticalScrollBar(), SIGNAL(valueChanged(int)),
+          this, SLOT(update_visible_area()));
+}
+
+/**
+ * @brief Destroys the world view.
+ */
+WorldView::~WorldView() {
+
+  cancel_jobs();
+}
+
+/**
+ * @brief Returns the world currently shown.
+ * @return The world, or an empty string if the map shown has no world.
+ */
+QString WorldView::get_world() const {
+  return world;
+}
+
+/**
+ * @brief Shows all maps of the world of the given map.
+ *
+ * Maps appear as soon as their thumbnail is ready.
+ * If the map has no world, only this map is shown.
+ *
+ * @param map_id Id of a map.
+ */
+void WorldView::show_world_of_map(const QString& map_id) {
+
+  clear();
+
+  // Only load this map here, to know which world to show.
+  // Others are loaded by workers.
+  Solarus::MapData map;
+  if (!DataFileCache::load_map_data(quest, quest.get_map_data_file_path(map_id), map)) {
+    return;
+  }
+
+  world = map.has_world() ? QString::fromStdString(map.get_world()) : QString();
+  initial_map_id = map_id;
+  setWindowTitle(world.isEmpty() ?
+                   tr("World of map '%1'").arg(map_id) :
+                   tr("World '%1'").arg(world));
+
+  tilesets.reset(new TilesetStore(quest));
+  const QStringList& map_ids = world.isEmpty() ?
+        QStringList(map_id) :
+        quest.get_database().get_elements(ResourceType::MAP);
+  QList<MapRequest> requests;
+  for (const QString& id : map_ids) {
+    requests << MapRequest{ &quest, tilesets.get(), id, world };
+  }
+  thumbnail_job.setFuture(QtConcurrent::mapped(requests, &WorldView::load_thumbnail));
+}
+
+/**
+ * @brief Stops loading maps and removes all maps shown.
+ */
+void WorldView::clear() {
+
+  cancel_jobs();
+  scene()->clear();
+  map_items.clear();
+  pending_details.clear();
+  drawing_details.clear();
+  world.clear();
+  initial_map_id.clear();
+  tilesets.reset();
+}
+
+/**
+ * @brief Cancels the work in progress and waits for workers to stop.
+ */
+void WorldView::cancel_jobs() {
+
+  thumbnail_job.cancel();
+  detail_job.cancel();
+  thumbnail_job.waitForFinished();
+  detail_job.waitForFinished();
+}
+
+/**
+ * @brief Loads the thumbnail of a map from the cache if it is up to date
+ * with the map.
+ *
+ * The caller should also check the modification date of the tilesets.
+ * This function can be called from worker threads.
+ *
+ * @param[in] quest The quest.
+ * @param[in] path Path of the map data file.
+ * @param[out] thumbnail The thumbnail to fill. Unchanged in case of failure.
+ * @return @c true if the thumbnail was loaded from the cache.
+ */
+bool WorldView::load_cached_thumbnail(
+    const Quest& quest, const QString& path, MapThumbnail& thumbnail) {
+
+  MapThumbnail result;
+  const bool success = DataFileCache::read_snapshot(
+        quest, path, "thumbnails", [&result](QDataStream& stream) {
+    stream >> result.world >> result.area >> result.tilesets >> result.image;
+  });
+  if (!success) {
+    return false;
+  }
+
+  thumbnail = result;
+  return true;
+}
+
+/**
+ * @brief Writes the thumbnail of a map to the cache.
+ *
+ * This function can be called from worker threads.
+ *
+ * @param quest The quest.
+ * @param path Path of the map data file, which must be up to date with the thumbnail.
+ * @param thumbnail The thumbnail.
+ */
+void WorldView::save_cached_thumbnail(
+    const Quest& quest, const QString& path, const MapThumbnail& thumbnail) {
+
+  DataFileCache::write_snapshot(quest, path, "thumbnails", [&thumbnail](QDataStream& stream) {
+    stream << thumbnail.world << thumbnail.area << thumbnail.tilesets << thumbnail.image;
+  });
+}
+
+/**
+ * @brief Loads the thumbnail of a map in a worker thread.
+ *
+ * The thumbnail is drawn if the one in the cache is obsolete.
+ * Maps of other worlds are not drawn.
+ *
+ * @param request The map to load.
+ * @return The thumbnail.
+ */
+WorldView::MapImage WorldView::load_thumbnail(const MapRequest& request) {
+
+  const Quest& quest = *request.quest;
+  MapImage result;
+  result.map_id = request.map_id;
+  result.valid = false;
+
+  const QString& path = quest.get_map_data_file_path(request.map_id);
+  MapThumbnail& thumbnail = result.thumbnail;
+  if (load_cached_thumbnail(quest, path, thumbnail) &&
+      request.tilesets->is_up_to_date(thumbnail.tilesets) &&
+      (thumbnail.world != request.world || !thumbnail.image.isNull())) {
+    result.valid = true;
+    return result;
+  }
+
+  result.thumbnail = MapThumbnail();
+  Solarus::MapData map;
+  if (!DataFileCache::load_map_data(quest, path, map)) {
+    return result;
+  }
+
+  thumbnail.world = map.has_world() ? QString::fromStdString(map.get_world()) : QString();
+  thumbnail.area = QRect(Point::to_qpoint(map.get_location()), Size::to_qsize(map.get_size()));
+  if (thumbnail.world == request.world) {
+    thumbnail.image = draw_map(map, thumbnail_scale, *request.tilesets, thumbnail.tilesets);
+  }
+  // Maps of other worlds are cached without image to know their world faster.
+  save_cached_thumbnail(quest, path, thumbnail);
+  result.valid = true;
+  return result;
+}
+
+/**
+ * @brief Draws a map at full scale in a worker thread.
+ * @param request The map to draw.
+ * @return The image of the map.
+ */
+WorldView::MapImage WorldView::load_detail(const MapRequest& request) {
+
+  const Quest& quest = *request.quest;
+  MapImage result;
+  result.map_id = request.map_id;
+  result.valid = false;
+
+  Solarus::MapData map;
+  if (!DataFileCache::load_map_data(quest, quest.get_map_data_file_path(request.map_id), map)) {
+    return result;
+  }
+
+  MapThumbnail& thumbnail = result.thumbnail;
+  thumbnail.area = QRect(Point::to_qpoint(map.get_location()), Size::to_qsize(map.get_size()));
+  thumbnail.image = draw_map(map, 1.0, *request.tilesets, thumbnail.tilesets);
+  result.valid = true;
+  return result;
+}
+
+/**
+ * @brief Draws the tiles of a map.
+ *
+ * This function can be called from worker threads.
+ *
+ * @param[in] map The map to draw.
+ * @param[in] scale Scale of the image to create.
+ * @param[in] tilesets Where to get tilesets.
+ * @param[out] tileset_dates Modification date of each tileset used.
+ * @return The image of the map.
+ */
+QImage WorldView::draw_map(
+    const Solarus::MapData& map,
+    double scale,
+    TilesetStore& tilesets,
+    QMap<QString, qint64>& tileset_dates) {
+
+  const QSize& size = Size::to_qsize(map.get_size());
+  QImage image(qMax(1, qCeil(size.width() * scale)),
+               qMax(1, qCeil(size.height() * scale)),
+               QImage::Format_ARGB32_Premultiplied);
+
+  const QString& map_tileset_id = QString::fromStdString(map.get_tileset_id());
+  tileset_dates.insert(map_tileset_id, tilesets.get_date(map_tileset_id));
+  std::shared_ptr<const TilesetStore::Tileset> map_tileset = tilesets.get_tileset(map_tileset_id);
+  image.fill(map_tileset != nullptr ? map_tileset->background_color : QColor(Qt::black));
+
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::SmoothPixmapTransform, scale < 1.0);
+  painter.scale(scale, scale);
+
+  for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
+    for (int i = 0; i < map.get_num_entities(layer); ++i) {
+
+      const Solarus::EntityData& entity = map.get_entity(Solarus::EntityIndex(layer, i));
+      if (entity.get_type() != Solarus::EntityType::TILE &&
+          entity.get_type() != Solarus::EntityType::DYNAMIC_TILE) {
+        continue;
+      }
+
+      // Tiles may use another tileset than the one of the map.
+      std::shared_ptr<const TilesetStore::Tileset> tileset = map_tileset;
+      if (entity.is_string("tileset") && !entity.get_string("tileset").empty()) {
+        const QString& tileset_id = QString::fromStdString(entity.get_string("tileset"));
+        tileset_dates.insert(tileset_id, tilesets.get_date(tileset_id));
+        tileset = tilesets.get_tileset(tileset_id);
+      }
+      if (tileset == nullptr) {
+        continue;
+      }
+
+      const QImage& pattern = tileset->patterns.value(
+            QString::fromStdString(entity.get_string("pattern")));
+      if (pattern.isNull()) {
+        continue;
+      }
+
+      const QRect rect(Point::to_qpoint(entity.get_xy()),
+                       QSize(entity.get_integer("width"), entity.get_integer("height")));
+      painter.setBrushOrigin(rect.topLeft());
+      painter.fillRect(rect, QBrush(pattern));
+    }
+  }
+
+  return image;
+}
+
+/**
+ * @brief Slot called when the thumbnail of a map is loaded.
+ * @param index Index of the map in the current job.
+ */
+void WorldView::thumbnail_loaded(int index) {
+
+  const MapImage& result = thumbnail_job.resultAt(index);
+  if (!result.valid ||
+      result.thumbnail.world != world ||
+      map_items.contains(result.map_id)) {
+    return;
+  }
+
+  MapItem* item = new MapItem(result.map_id, result.thumbnail.area, result.thumbnail.image);
+  scene()->addItem(item);
+  map_items.insert(result.map_id, item);
+  scene()->setSceneRect(scene()->itemsBoundingRect());
+
+  if (result.map_id == initial_map_id) {
+    centerOn(item);
+  }
+}
+
+/**
+ * @brief Slot called when a map is drawn at full scale.
+ * @param index Index of the map in the current job.
+ */
+void WorldView::detail_loaded(int index) {
+
+  const MapImage& result = detail_job.resultAt(index);
+  MapItem* item = map_items.value(result.map_id);
+  if (!result.valid || item == nullptr) {
+    return;
+  }
+
+  item->set_detail(result.thumbnail.image);
+}
+
+/**
+ * @brief Slot called when all maps of the current job are drawn at full scale.
+ */
+void WorldView::detail_job_finished() {
+
+  drawing_details.clear();
+  start_next_detail_job();
+}
+
+/**
+ * @brief Starts drawing pending maps at full scale if no job is running.
+ */
+void WorldView::start_next_detail_job() {
+
+  if (detail_job.isRunning() || pending_details.isEmpty() || tilesets == nullptr) {
+    return;
+  }
+
+  QList<MapRequest> requests;
+  for (const QString& map_id : pending_details) {
+    requests << MapRequest{ &quest, tilesets.get(), map_id, world };
+  }
+  drawing_details = pending_details;
+  pending_details.clear();
+  detail_job.setFuture(QtConcurrent::mapped(requests, &WorldView::load_detail));
+}
+
+/**
+ * @brief Updates which maps are shown at full scale.
+ *
+ * Maps near the visible area are drawn at full scale when the zoom is
+ * higher than the thumbnail scale.
+ * Maps far from it go back to their thumbnail to save memory.
+ */
+void WorldView::update_visible_area() {
+
+  const QRectF& visible_area = mapToScene(viewport()->rect()).boundingRect();
+  const qreal margin_x = visible_area.width() / 2;
+  const qreal margin_y = visible_area.height() / 2;
+  const QRectF& near_area = visible_area.adjusted(-margin_x, -margin_y, margin_x, margin_y);
+  const QRectF& far_area = near_area.adjusted(-margin_x, -margin_y, margin_x, margin_y);
+  const bool detail_wanted = zoom > thumbnail_scale;
+
+  int num_detailed_maps = 0;
+  for (MapItem* item : map_items) {
+    const QRectF& map_area = item->sceneBoundingRect();
+    const QString& map_id = item->get_map_id();
+    if (detail_wanted && map_area.intersects(near_area)) {
+      if (!item->has_detail() && !drawing_details.contains(map_id)) {
+        pending_details.insert(map_id);
+      }
+      ++num_detailed_maps;
+    }
+    else {
+      pending_details.remove(map_id);
+      if (item->has_detail() && (!detail_wanted || !map_area.intersects(far_area))) {
+        item->set_detail(QImage());
+      }
+    }
+  }
+
+  if (num_detailed_maps > max_detailed_maps) {
+    // Zoomed in on too many maps at once: keep thumbnails.
+    pending_details.clear();
+  }
+  start_next_detail_job();
+}
+
+/**
+ * @brief Scales the view.
+ * @param zoom The new zoom.
+ */
+void WorldView::set_zoom(double zoom) {
+
+  this->zoom = zoom;
+  setTransform(QTransform::fromScale(zoom, zoom));
+  update_visible_area();
+}
+
+/**
+ * @brief Scales the view by a factor of 2.
+ *
+ * The maximum zoom value is 2.0: this function does nothing if you try to
+ * zoom more.
+ */
+void WorldView::zoom_in() {
+
+  if (zoom < 2.0) {
+    set_zoom(zoom * 2.0);
+  }
+}
+
+/**
+ * @brief Scales the view by a factor of 0.5.
+ *
+ * The minimum zoom value is 1/64: this function does nothing if you try to
+ * zoom less.
+ */
+void WorldView::zoom_out() {
+
+  if (zoom > 1.0 / 64.0) {
+    set_zoom(zoom / 2.0);
+  }
+}
+
+/**
+ * @brief Receives a mouse double click event.
+ *
+ * Opens the map under the cursor.
+ *
+ * @param event The event to handle.
+ */
+void WorldView::mouseDoubleClickEvent(QMouseEvent* event) {
+
+  for (QGraphicsItem* item : items(event->pos())) {
+    MapItem* map_item = dynamic_cast<MapItem*>(item);
+    if (map_item != nullptr) {
+      emit open_file_requested(quest, quest.get_map_data_file_path(map_item->get_map_id()));
+      return;
+    }
+  }
+
+  QGraphicsView::mouseDoubleClickEvent(event);
+}
+
+/**
+ * @brief Receives a resize event.
+ * @param event The event to handle.
+ */
+void WorldView::resizeEvent(QResizeEvent* event) {
+
+  QGraphicsView::resizeEvent(event);
+  update_visible_area();
+}
+
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2014-2018 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "data_file_parser.h"
+#include <solarus/core/DialogResources.h>
+#include <solarus/core/MapData.h>
+#include <solarus/core/QuestDatabase.h>
+#include <solarus/core/StringResources.h>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QTextStream>
+#include <string>
+
+/**
+ * @file
+ * @brief Compares the native data file parser with the Lua loader of Solarus.
+ *
+ * Usage: data_file_parser_test quest_data_path...
+ *
+ * Every map, dialogs, strings and project_db.dat file of each quest data
+ * directory is loaded with both. The results are exported again by Solarus
+ * and must be identical. Tilesets and sprites are not compared because the
+ * native parser does not support them.
+ *
+ * Returns 0 if all files loaded by the native parser give the same data
+ * as the Lua loader.
+ */
+
+namespace SolarusEditor {
+
+namespace {
+
+/**
+ * @brief Loads a data file with both parsers and compares the results.
+ * @param path Path of the data file.
+ * @param native_import The native parser function for this kind of file.
+ * @param out Stream where the result is reported.
+ * @return @c false if the native parser succeeded but gave different data
+ * than the Lua loader.
+ */
+template<typename Data>
+bool compare_file(
+    const QString& path,
+    bool (*native_import)(const QString&, Data&),
+    QTextStream& out
+) {
+  Data native_data;
+  if (!native_import(path, native_data)) {
+    out << "SKIPPED (Lua only)  " << path << endl;
+    return true;
+  }
+
+  Data lua_data;
+  if (!lua_data.import_from_file(path.toStdString())) {
+    out << "FAILED (Lua error)  " << path << endl;
+    return false;
+  }
+
+  std::string native_buffer;
+  std::string lua_buffer;
+  if (!native_data.export_to_buffer(native_buffer) ||
+      !lua_data.export_to_buffer(lua_buffer)) {
+    out << "FAILED (export)     " << path << endl;
+    return false;
+  }
+
+  if (native_buffer != lua_buffer) {
+    out << "FAILED (different)  " << path << endl;
+    out << "--- Lua loader:" << endl << QString::fromStdString(lua_buffer);
+    out << "--- Native parser:" << endl << QString::fromStdString(native_buffer);
+    return false;
+  }
+
+  out << "OK                  " << path << endl;
+  return true;
+}
+
+/**
+ * @brief Compares the data files of a quest data directory.
+ * @param data_path Path of the data directory.
+ * @param out Stream where the results are reported.
+ * @return The number of files that failed.
+ */
+int compare_quest(const QString& data_path, QTextStream& out) {
+
+  int num_failed = 0;
+  const QDir data_dir(data_path);
+  if (!data_dir.exists()) {
+    out << "FAILED (no such directory)  " << data_path << endl;
+    return 1;
+  }
+
+  QDirIterator it(data_path, QStringList() << "*.dat", QDir::Files, QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    const QString path = it.next();
+    const QString relative_path = data_dir.relativeFilePath(path);
+    const QString file_name = it.fileName();
+
+    bool success = true;
+    if (relative_path == "project_db.dat") {
+      success = compare_file<Solarus::QuestDatabase>(path, &DataFileParser::import_quest_database, out);
+    }
+    else if (relative_path.startsWith("maps/")) {
+      success = compare_file<Solarus::MapData>(path, &DataFileParser::import_map, out);
+    }
+    else if (relative_path.startsWith("languages/") && file_name == "dialogs.dat") {
+      success = compare_file<Solarus::DialogResources>(path, &DataFileParser::import_dialogs, out);
+    }
+    else if (relative_path.startsWith("languages/") && file_name == "strings.dat") {
+      success = compare_file<Solarus::StringResources>(path, &DataFileParser::import_strings, out);
+    }
+
+    if (!success) {
+      ++num_failed;
+    }
+  }
+  return num_failed;
+}
+
+}  // Anonymous namespace.
+
+}
+
+/**
+ * @brief Entry point of the comparison.
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments: quest data directories.
+ * @return 0 in case of success.
+ */
+int main(int argc, char** argv) {
+
+  QTextStream out(stdout);
+  if (argc < 2) {
+    out << "Usage: " << argv[0] << " quest_data_path..." << endl;
+    return 1;
+  }
+
+  int num_failed = 0;
+  for (int i = 1; i < argc; ++i) {
+    num_failed += SolarusEditor::compare_quest(QString::fromLocal8Bit(argv[i]), out);
+  }
+
+  if (num_failed > 0) {
+    out << num_failed << " file(s) differ" << endl;
+    return 1;
+  }
+  return 0;
+}